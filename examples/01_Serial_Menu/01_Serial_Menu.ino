@@ -40,6 +40,9 @@ void setup()
     Serial.begin(115200);
     Serial.println();
     Serial.println("Example 01_Serial_Menu");
+
+    // Output the log messages from a low priority task
+    r4aLogSetup();
 }
 
 //*********************************************************************
@@ -12,7 +12,10 @@
 #define TELNET_PORT             23
 #define MAX_TELNET_CLIENTS      4
 
-WiFiMulti wifiMulti;
+// Time allowed for the cached connection attempt (3 seconds), the scan
+// and the connection timeout (10 seconds) for each of the two access
+// points
+#define WIFI_CONNECT_TIMEOUT_MSEC   (30 * 1000)
 
 //****************************************
 // Forward routine declarations
@@ -26,6 +29,8 @@ void serverInfo(const R4A_MENU_ENTRY * menuEntry, const char * command, Print *
 // Globals
 //****************************************
 
+uint16_t telnetPort = TELNET_PORT;
+
 R4A_TELNET_SERVER telnet(4,
                          r4aTelnetContextProcessInput,
                          contextCreate,
@@ -37,8 +42,16 @@ R4A_TELNET_SERVER telnet(4,
 
 enum MENU_TABLE_INDEX
 {
-    mtiTelnetMenu = R4A_MENU_MAIN + 1,
+    mtiConfigMenu = R4A_MENU_MAIN + 1,
+    mtiTelnetMenu,
+};
+
+// Application configuration values
+const R4A_CONFIG_ENTRY configTable[] =
+{
+    R4A_CONFIG("telnetPort",    telnetPort,     "Telnet server port"),
 };
+const int configTableEntries = sizeof(configTable) / sizeof(configTable[0]);
 
 const R4A_MENU_ENTRY telnetMenuTable[] =
 {
@@ -53,6 +66,9 @@ const R4A_MENU_ENTRY telnetMenuTable[] =
 const R4A_MENU_ENTRY mainMenuTable[] =
 {
     // Command  menuRoutine     menuParam       HelpRoutine align   HelpText
+    {"config",  nullptr,        mtiConfigMenu,  nullptr,    0,      "Enter the configuration menu"},
+    {"memory",  r4aMemoryMenuDisplay, 0,        nullptr,    0,      "Display the heap and stack usage"},
+    {"metrics", r4aMetricsMenuDisplay, 0,       nullptr,    0,      "Display the metrics"},
     {"telnet",  nullptr,        mtiTelnetMenu,  nullptr,    0,      "Enter the telnet menu"},
     {"x",       nullptr,        R4A_MENU_NONE,  nullptr,    0,      "Exit the menu system"},
 };
@@ -62,55 +78,71 @@ const R4A_MENU_TABLE menuTable[] =
 {
     // menuName         preMenu routine             firstEntry              entryCount
     {"Main Menu",       nullptr,                    mainMenuTable,          MAIN_MENU_ENTRIES},
+    {"Config Menu",     nullptr,                    r4aConfigMenuTable,     R4A_CONFIG_MENU_ENTRIES},
     {"Telnet Menu",     nullptr,                    telnetMenuTable,        TELNET_MENU_ENTRIES},
 };
 const int menuTableEntries = sizeof(menuTable) / sizeof(menuTable[0]);
 
+// Menu shared by the telnet clients
+const R4A_MENU_COMPILED telnetMenu(menuTable, menuTableEntries);
+
 //*********************************************************************
 // Entry point for the application
 void setup()
 {
+    uint32_t startMsec;
+
     Serial.begin(115200);
     Serial.println();
     Serial.printf("%s\r\n", __FILE__);
 
-    // Scan WiFi for possible remote APs
-    Serial.println("Scanning WiFi ");
-    wifiMulti.addAP(wifiSSID1, wifiPassword1);
-    wifiMulti.addAP(wifiSSID2, wifiPassword2);
+    // Output the log messages from a low priority task
+    r4aLogSetup();
 
-    // Connect to a remote AP if possible
+    // Load the saved configuration
+    r4aConfigBegin(configTable, configTableEntries);
+
+    // Monitor the network link state
+    r4aLinkBegin();
+
+    // Connect to a remote AP, using the cached access point if possible
     Serial.println("Connecting Wifi ");
-    for (int loops = 10; loops > 0; loops--)
+    r4aWiFiAddAP(wifiSSID1, wifiPassword1);
+    r4aWiFiAddAP(wifiSSID2, wifiPassword2);
+    r4aWiFiBegin();
+    startMsec = millis();
+    while (!r4aLinkIsUp())
     {
-        if (wifiMulti.run() == WL_CONNECTED)
-            break;
-        else
+        r4aWiFiUpdate();
+        if ((millis() - startMsec) >= WIFI_CONNECT_TIMEOUT_MSEC)
         {
-            Serial.println(loops);
+            Serial.println("WiFi connect failed");
             delay(1000);
+            ESP.restart();
         }
-    }
-    if (wifiMulti.run() != WL_CONNECTED)
-    {
-        Serial.println("WiFi connect failed");
-        delay(1000);
-        ESP.restart();
+        delay(10);
     }
 
     // Start the telnet server
-    telnet.begin(WiFi.STA.localIP(), TELNET_PORT);
+    telnet.begin(WiFi.STA.localIP(), telnetPort);
 
     // Display the IP address
     Serial.println("");
-    Serial.printf("WiFi: %s:%d\r\n", WiFi.localIP().toString().c_str(), TELNET_PORT);
+    Serial.printf("WiFi: %s:%d\r\n", WiFi.localIP().toString().c_str(), telnetPort);
 }
 
 //*********************************************************************
 // Idle loop for the application
 void loop()
 {
-    telnet.update(wifiMulti.run() == WL_CONNECTED);
+    // Maintain the WiFi connection
+    r4aWiFiUpdate();
+
+    // Update the telnet server state
+    telnet.update();
+
+    // Save the configuration changes
+    r4aConfigUpdate();
 }
 
 //*********************************************************************
@@ -125,7 +157,7 @@ bool contextCreate(NetworkClient * client, void ** contextData)
 {
     // Return an optional object address to be used as a parameter for
     // r4aTelnetClientProcessInput
-    return r4aTelnetContextCreate(client, menuTable, menuTableEntries, contextData);
+    return r4aTelnetContextCreate(client, &telnetMenu, contextData);
 }
 
 //*********************************************************************
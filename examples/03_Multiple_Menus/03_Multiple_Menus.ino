@@ -9,8 +9,6 @@
 
 #include "secrets.h"
 
-WiFiMulti wifiMulti;
-
 //****************************************
 // Locals
 //****************************************
@@ -27,9 +25,15 @@ bool contextCreate24(NetworkClient * client, void ** contextData);
 void contextDelete(void * contextData);
 void listClients23(const R4A_MENU_ENTRY * menuEntry, const char * command, Print * display);
 void listClients24(const R4A_MENU_ENTRY * menuEntry, const char * command, Print * display);
+void ntpUpdate(intptr_t parameter);
+void serialMenuUpdate(intptr_t parameter);
 bool serialOutput(NetworkClient * client, void * contextData);
 void serverInfo23(const R4A_MENU_ENTRY * menuEntry, const char * command, Print * display);
 void serverInfo24(const R4A_MENU_ENTRY * menuEntry, const char * command, Print * display);
+bool telnetStart(intptr_t parameter);
+void telnetUpdate(intptr_t parameter);
+bool wifiStart(intptr_t parameter);
+void wifiUpdate(intptr_t parameter);
 
 //****************************************
 // Globals
@@ -45,6 +49,25 @@ R4A_TELNET_SERVER telnet24(4,
                            r4aTelnetContextDelete);
 R4A_TELNET_SERVER telnet25(4, serialOutput, nullptr, nullptr);
 
+R4A_TELNET_SERVER * const telnetServer[] = {&telnet23, &telnet24, &telnet25};
+const uint16_t telnetPort[] = {23, 24, 25};
+
+//****************************************
+// Services
+//****************************************
+
+const R4A_SERVICE services[] =
+{
+    // name         dependencies        start           update              parameter
+    {"Serial menu", 0,                  nullptr,        serialMenuUpdate,   0},
+    {"WiFi",        0,                  wifiStart,      wifiUpdate,         0},
+    {"NTP",         R4A_SERVICE_LINK,   nullptr,        ntpUpdate,          0},
+    {"Telnet 23",   R4A_SERVICE_LINK,   telnetStart,    telnetUpdate,       0},
+    {"Telnet 24",   R4A_SERVICE_LINK,   telnetStart,    telnetUpdate,       1},
+    {"Telnet 25",   R4A_SERVICE_LINK,   telnetStart,    telnetUpdate,       2},
+};
+const int serviceEntries = sizeof(services) / sizeof(services[0]);
+
 //****************************************
 // Menus
 //****************************************
@@ -99,6 +122,7 @@ const R4A_MENU_TABLE menuTable23[] =
     {"Telnet Menu",     nullptr,            telnetMenuTable23,  TELNET_MENU_23_ENTRIES},
 };
 const int menuTable23Entries = sizeof(menuTable23) / sizeof(menuTable23[0]);
+const R4A_MENU_COMPILED telnetMenu23(menuTable23, menuTable23Entries);
 
 // Main menu
 const R4A_MENU_ENTRY mainMenuTable24[] =
@@ -106,6 +130,9 @@ const R4A_MENU_ENTRY mainMenuTable24[] =
     // Command  menuRoutine     menuParam       HelpRoutine align   HelpText
     {"telnet",  nullptr,        mtiTelnetMenu,  nullptr,    0,      "Enter the telnet menu"},
     {"command", nullptr,        mtiCommandMenu, nullptr,    0,      "Enter the command menu"},
+    {"boot",    r4aServicesMenuDisplay, 0,      nullptr,    0,      "Display the boot timeline"},
+    {"memory",  r4aMemoryMenuDisplay, 0,        nullptr,    0,      "Display the heap and stack usage"},
+    {"metrics", r4aMetricsMenuDisplay, 0,       nullptr,    0,      "Display the metrics"},
     {"x",       nullptr,        R4A_MENU_NONE,  nullptr,    0,      "Exit the menu system"},
 };
 #define MAIN_MENU_24_ENTRIES    sizeof(mainMenuTable24) / sizeof(mainMenuTable24[0])
@@ -118,6 +145,7 @@ const R4A_MENU_TABLE menuTable24[] =
     {"Command Menu",    nullptr,            commandMenuTable,   COMMAND_MENU_ENTRIES},
 };
 const int menuTable24Entries = sizeof(menuTable24) / sizeof(menuTable24[0]);
+const R4A_MENU_COMPILED telnetMenu24(menuTable24, menuTable24Entries);
 
 R4A_MENU serialMenu(menuTable24, menuTable24Entries);
 
@@ -129,96 +157,27 @@ void setup()
     Serial.println();
     Serial.printf("%s\r\n", __FILE__);
 
-/*
-    // Start the WiFi network
-    Serial.println("Connecting to WiFi");
-    WiFi.begin(wifiSSID, wifiPassword);
-*/
-
-    // Scan WiFi for possible remote APs
-    Serial.println("Scanning WiFi ");
-    wifiMulti.addAP(wifiSSID1, wifiPassword1);
-    wifiMulti.addAP(wifiSSID2, wifiPassword2);
-
-    // Connect to a remote AP if possible
-    Serial.println("Connecting Wifi ");
-    for (int loops = 10; loops > 0; loops--)
-    {
-        if (wifiMulti.run() == WL_CONNECTED)
-            break;
-        else
-        {
-            Serial.println(loops);
-            delay(1000);
-        }
-    }
-    if (wifiMulti.run() != WL_CONNECTED)
-    {
-        Serial.println("WiFi connect failed");
-        delay(1000);
-        ESP.restart();
-    }
-
-    // Start the telnet server
-    telnet23.begin(WiFi.STA.localIP(), 23);
-    telnet24.begin(WiFi.STA.localIP(), 24);
-    telnet25.begin(WiFi.STA.localIP(), 25);
+    // Output the log messages from a low priority task
+    r4aLogSetup();
+
+    // Monitor the network link state
+    r4aLinkBegin();
+
+    // Specify the remote APs
+    r4aWiFiAddAP(wifiSSID1, wifiPassword1);
+    r4aWiFiAddAP(wifiSSID2, wifiPassword2);
+
+    // Start the services, the network services start in the background
+    // once the link is up
+    r4aServicesBegin(services, serviceEntries);
 }
 
 //*********************************************************************
 // Idle loop for the application
 void loop()
 {
-    static bool previousConnected23;
-    static bool previousConnected24;
-    static bool previousConnected25;
-    bool wifiConnected;
-
-/*
-    // Determine if WiFi is connected
-    wifiConnected = (WiFi.status() == WL_CONNECTED);
-*/
-    // Update the telnet server state
-    wifiConnected = (wifiMulti.run() == WL_CONNECTED);
-
-    // Check for NTP updates
-    r4aNtpUpdate(wifiConnected);
-
-    // Update the telnet server state
-    telnet23.update(wifiConnected);
-    if (previousConnected23 != wifiConnected)
-    {
-        previousConnected23 = wifiConnected;
-        if (wifiConnected)
-            Serial.printf("Telnet23: %s:%d\r\n",
-                          telnet23.ipAddress().toString().c_str(),
-                          telnet23.port());
-    }
-
-    // Update the telnet server state
-    telnet24.update(wifiConnected);
-    if (previousConnected24 != wifiConnected)
-    {
-        previousConnected24 = wifiConnected;
-        if (wifiConnected)
-            Serial.printf("Telnet24: %s:%d\r\n",
-                          telnet24.ipAddress().toString().c_str(),
-                          telnet24.port());
-    }
-
-    // Update the telnet server state
-    telnet25.update(wifiConnected);
-    if (previousConnected25 != wifiConnected)
-    {
-        previousConnected25 = wifiConnected;
-        if (wifiConnected)
-            Serial.printf("Telnet25: %s:%d\r\n",
-                          telnet25.ipAddress().toString().c_str(),
-                          telnet25.port());
-    }
-
-    // Process commands from the serial port
-    r4aSerialMenu(&serialMenu);
+    // Start and update the services
+    r4aServicesUpdate();
 }
 
 //*********************************************************************
@@ -233,10 +192,7 @@ bool contextCreate23(NetworkClient * client, void ** contextData)
 {
     // Return an optional object address to be used as a parameter for
     // r4aTelnetClientProcessInput
-    return r4aTelnetContextCreate(client,
-                                  menuTable23,
-                                  menuTable23Entries,
-                                  contextData);
+    return r4aTelnetContextCreate(client, &telnetMenu23, contextData);
 }
 
 //*********************************************************************
@@ -251,10 +207,7 @@ bool contextCreate24(NetworkClient * client, void ** contextData)
 {
     // Return an optional object address to be used as a parameter for
     // r4aTelnetClientProcessInput
-    return r4aTelnetContextCreate(client,
-                                  menuTable24,
-                                  menuTable24Entries,
-                                  contextData);
+    return r4aTelnetContextCreate(client, &telnetMenu24, contextData);
 }
 
 //*********************************************************************
@@ -279,6 +232,24 @@ void listClients24(const R4A_MENU_ENTRY * menuEntry, const char * command, Print
     telnet24.listClients(display);
 }
 
+//*********************************************************************
+// Update the NTP client
+// Inputs:
+//   parameter: Parameter value from the service table
+void ntpUpdate(intptr_t parameter)
+{
+    r4aNtpUpdate();
+}
+
+//*********************************************************************
+// Process commands from the serial port
+// Inputs:
+//   parameter: Parameter value from the service table
+void serialMenuUpdate(intptr_t parameter)
+{
+    r4aSerialMenu(&serialMenu);
+}
+
 //*********************************************************************
 // Process input from the telnet client
 // Inputs:
@@ -315,3 +286,54 @@ void serverInfo24(const R4A_MENU_ENTRY * menuEntry, const char * command, Print
 {
     telnet24.serverInfo(display);
 }
+
+//*********************************************************************
+// Start the telnet server
+// Inputs:
+//   parameter: Index into the telnet server list
+// Outputs:
+//   Returns true when the server is running
+bool telnetStart(intptr_t parameter)
+{
+    R4A_TELNET_SERVER * telnet;
+
+    telnet = telnetServer[parameter];
+    if (!telnet->begin(WiFi.STA.localIP(), telnetPort[parameter]))
+        return false;
+    Serial.printf("Telnet%d: %s:%d\r\n",
+                  telnetPort[parameter],
+                  telnet->ipAddress().toString().c_str(),
+                  telnet->port());
+    return true;
+}
+
+//*********************************************************************
+// Update the telnet server state
+// Inputs:
+//   parameter: Index into the telnet server list
+void telnetUpdate(intptr_t parameter)
+{
+    telnetServer[parameter]->update();
+}
+
+//*********************************************************************
+// Start connecting to a remote AP, using the cached access point if
+// possible
+// Inputs:
+//   parameter: Parameter value from the service table
+// Outputs:
+//   Returns true when the connection has started
+bool wifiStart(intptr_t parameter)
+{
+    r4aWiFiBegin();
+    return true;
+}
+
+//*********************************************************************
+// Maintain the WiFi connection
+// Inputs:
+//   parameter: Parameter value from the service table
+void wifiUpdate(intptr_t parameter)
+{
+    r4aWiFiUpdate();
+}
@@ -19,6 +19,12 @@ void setup()
     Serial.begin(115200);
     Serial.println();
 
+    // Output the log messages from a low priority task
+    r4aLogSetup();
+
+    // Monitor the network link state
+    r4aLinkBegin();
+
     // Start the WiFi network
     WiFi.begin(wifiSSID, wifiPassword);
 
@@ -30,9 +36,6 @@ void setup()
 // Idle loop for the application
 void loop()
 {
-    bool wifiConnected;
-
-    // Notify the NTP client of WiFi changes
-    wifiConnected = (WiFi.status() == WL_CONNECTED);
-    r4aNtpUpdate(wifiConnected);
+    // Update the NTP client, the link state comes from the network events
+    r4aNtpUpdate();
 }
@@ -40,7 +40,7 @@ const int menuTableEntries = sizeof(menuTable) / sizeof(menuTable[0]);
 //****************************************
 
 BluetoothSerial btSerial;
-R4A_MENU bluetoothMenu(menuTable, menuTableEntries);
+R4A_BLUETOOTH_CONSOLE btConsole(&btSerial, menuTable, menuTableEntries);
 
 //*********************************************************************
 // Entry point for the application
@@ -51,6 +51,9 @@ void setup()
     Serial.println();
     Serial.printf("%s\r\n", __FILE__);
 
+    // Output the log messages from a low priority task
+    r4aLogSetup();
+
     // Initialize the bluetooth serial port
     if (btSerial.begin(BLUETOOTH_NAME) == false)
         r4aReportFatalError("Failed to establish Bluetooth serial port!");
@@ -61,31 +64,9 @@ void setup()
 // Idle loop for the application
 void loop()
 {
-    bool connected;
-    bool done;
-    static bool previouslyConnected;
-
-    // Determine if a new connection was established
-    connected = btSerial.hasClient();
-    if (previouslyConnected != connected)
-    {
-        previouslyConnected = connected;
-
-        // Display the initial menu upon connection
-        if (connected)
-        {
-            bluetoothMenu.process(nullptr, &btSerial);
-            previouslyConnected = connected;
-        }
-    }
-
-    // Process the serial commands
-    if (connected)
-    {
-        done = r4aBluetoothMenu(&bluetoothMenu, &btSerial);
-        if (done)
-            btSerial.disconnect();
-    }
+    // Process the Bluetooth connection and commands
+    if (btConsole.update())
+        btSerial.disconnect();
 }
 
 //*********************************************************************
@@ -0,0 +1,246 @@
+/**********************************************************************
+  Allocation_test.cpp
+
+  Robots-For-All (R4A)
+  Host test of the heap use by the buffer based APIs
+
+  Runs the NTP date and time formatting, the menu command parsing and
+  the telnet line reading in a loop and verifies that the number of
+  heap allocations does not change.  The malloc family is wrapped by
+  the linker (--wrap) and operator new is replaced to count the
+  allocations, the default operator delete calls free.  The deprecated
+  String versions are run last to verify that the counters see their
+  allocations.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+#include "ClientFake.h"
+#include <atomic>
+#include <new>
+
+//****************************************
+// Constants
+//****************************************
+
+#define LOOPS           1000    // Number of passes through the hot paths
+#define SECONDS         1700000000  // Tue Nov 14 22:13:20 2023 UTC
+
+//****************************************
+// Locals
+//****************************************
+
+static std::atomic<uint64_t> allocations; // Number of heap allocations
+static int failures;            // Number of failed checks
+static R4A_MENU_COMPILED * menu; // Menu shared by the menu and telnet tests
+static R4A_MENU_CURSOR menuCursor; // Position in the menu for the menu test
+static int parameterCount;      // Number of parameters parsed
+static int parameterSum;        // Sum of the parsed parameters
+static NetworkClient * telnetClient; // Client used for the output
+static void * telnetContext;    // Telnet session
+
+//****************************************
+// Allocation counters
+//****************************************
+
+extern "C" void * __real_calloc(size_t count, size_t length);
+extern "C" void * __real_malloc(size_t length);
+extern "C" void * __real_realloc(void * buffer, size_t length);
+
+//*********************************************************************
+extern "C" void * __wrap_calloc(size_t count, size_t length)
+{
+    allocations += 1;
+    return __real_calloc(count, length);
+}
+
+//*********************************************************************
+extern "C" void * __wrap_malloc(size_t length)
+{
+    allocations += 1;
+    return __real_malloc(length);
+}
+
+//*********************************************************************
+extern "C" void * __wrap_realloc(void * buffer, size_t length)
+{
+    allocations += 1;
+    return __real_realloc(buffer, length);
+}
+
+//*********************************************************************
+void * operator new(size_t length)
+{
+    void * buffer;
+
+    allocations += 1;
+    buffer = __real_malloc(length);
+    if (!buffer)
+        throw std::bad_alloc();
+    return buffer;
+}
+
+//*********************************************************************
+// Parse the parameters using the view and buffer versions
+static void parseCommand(const R4A_MENU_ENTRY * menuEntry,
+                         const char * command,
+                         Print * display)
+{
+    char buffer[32];
+    size_t length;
+    const char * parameters;
+    int value;
+
+    // Locate the parameters in the command
+    parameters = r4aMenuGetParameters(menuEntry, command, &length);
+    if (sscanf(parameters, "%d", &value) == 1)
+    {
+        parameterCount += 1;
+        parameterSum += value;
+    }
+
+    // Copy the parameters
+    r4aMenuGetParameters(menuEntry, command, buffer, sizeof(buffer));
+    display->println(buffer);
+}
+
+//****************************************
+// Menus
+//****************************************
+
+const R4A_MENU_ENTRY mainMenuTable[] =
+{
+    // Command  menuRoutine     menuParam       HelpRoutine align   HelpText
+    {"set",     parseCommand,   0,              nullptr,    5,      "Parse the parameters"},
+    {"exit",    nullptr,        R4A_MENU_NONE,  nullptr,    0,      "Exit the menu system"},
+};
+#define MAIN_MENU_ENTRIES       sizeof(mainMenuTable) / sizeof(mainMenuTable[0])
+
+const R4A_MENU_TABLE menuTable[] =
+{
+    // menuName         preMenu routine             firstEntry              entryCount
+    {"Main Menu",       nullptr,                    mainMenuTable,          MAIN_MENU_ENTRIES},
+};
+const int menuTableEntries = sizeof(menuTable) / sizeof(menuTable[0]);
+
+//*********************************************************************
+// Verify a condition
+static void check(bool condition, const char * description)
+{
+    if (!condition)
+    {
+        printf("FAIL: %s\n", description);
+        failures += 1;
+    }
+}
+
+//*********************************************************************
+// Format the dates and times
+static void ntpFormat()
+{
+    char date[R4A_NTP_STRING_BYTES];
+    char time12[R4A_NTP_STRING_BYTES];
+    char time24[R4A_NTP_STRING_BYTES];
+
+    r4aNtpGetDate(SECONDS, date, sizeof(date));
+    r4aNtpGetTime12(SECONDS, time12, sizeof(time12));
+    r4aNtpGetTime24(SECONDS, time24, sizeof(time24));
+    if (strcmp(date, "2023-11-14") || strcmp(time12, "10:13:20 PM")
+        || strcmp(time24, "22:13:20"))
+        failures += 1;
+}
+
+//*********************************************************************
+// Run the loop and get the number of allocations
+// Inputs:
+//   routine: Address of the routine to run
+// Outputs:
+//   Returns the number of allocations made by the loop
+static uint64_t countAllocations(void (* routine)())
+{
+    uint64_t start;
+
+    // Allocate any one time buffers, such as the stdout buffer
+    routine();
+
+    // Count the allocations in the loop
+    start = allocations;
+    for (int index = 0; index < LOOPS; index++)
+        routine();
+    return allocations - start;
+}
+
+//*********************************************************************
+// Read and process the telnet lines
+static void telnetRead()
+{
+    // Deliver a command in pieces, then a complete command
+    clientFakeInput("set 1");
+    r4aTelnetContextProcessInput(telnetClient, telnetContext);
+    clientFakeInput("2 \r\n");
+    r4aTelnetContextProcessInput(telnetClient, telnetContext);
+    clientFakeInput("set 30\r\n");
+    r4aTelnetContextProcessInput(telnetClient, telnetContext);
+}
+
+//*********************************************************************
+// Parse the menu commands
+static void menuParse()
+{
+    menu->process(&menuCursor, "set 7", telnetClient);
+    menu->process(&menuCursor, "set   35   ", telnetClient);
+}
+
+//*********************************************************************
+// Use the deprecated String versions
+static void stringVersions()
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    String date(r4aNtpGetDate(SECONDS));
+#pragma GCC diagnostic pop
+}
+
+//*********************************************************************
+int main()
+{
+    uint64_t count;
+
+    // Create the menu and the telnet session
+    menu = new R4A_MENU_COMPILED(menuTable, menuTableEntries);
+    telnetClient = new NetworkClient();
+    check(r4aTelnetContextCreate(telnetClient, menu, &telnetContext), "Telnet context created");
+
+    // Verify that the buffer based routines do not allocate
+    count = countAllocations(ntpFormat);
+    printf("NTP formatting: %lu allocations in %d loops\n", (unsigned long)count, LOOPS);
+    check(count == 0, "NTP formatting does not allocate");
+
+    parameterCount = 0;
+    parameterSum = 0;
+    count = countAllocations(menuParse);
+    printf("Menu parsing: %lu allocations in %d loops\n", (unsigned long)count, LOOPS);
+    check(count == 0, "Menu parsing does not allocate");
+    check((parameterCount == 2 * (LOOPS + 1)) && (parameterSum == 42 * (LOOPS + 1)),
+          "Menu parameters parsed");
+
+    parameterCount = 0;
+    parameterSum = 0;
+    count = countAllocations(telnetRead);
+    printf("Telnet line reading: %lu allocations in %d loops\n", (unsigned long)count, LOOPS);
+    check(count == 0, "Telnet line reading does not allocate");
+    check((parameterCount == 2 * (LOOPS + 1)) && (parameterSum == 42 * (LOOPS + 1)),
+          "Telnet commands parsed");
+
+    // Verify that the counters see the String allocations
+    count = countAllocations(stringVersions);
+    printf("String versions: %lu allocations in %d loops\n", (unsigned long)count, LOOPS);
+    check(count >= LOOPS, "String allocations counted");
+
+    // Done with the telnet session
+    r4aTelnetContextDelete(telnetContext);
+    delete telnetClient;
+    delete menu;
+
+    printf("%s: %d failures\n", failures ? "FAIL" : "PASS", failures);
+    return failures ? 1 : 0;
+}
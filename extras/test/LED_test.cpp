@@ -0,0 +1,133 @@
+/**********************************************************************
+  LED_test.cpp
+
+  Robots-For-All (R4A)
+  Host test and benchmark of the two core LED encode
+
+  Encodes a string longer than 255 LEDs with the 5-bit SPI encoding,
+  first on a single thread and then split between the caller and the
+  encode task thread.  Verifies that both frames are byte-identical in
+  the color and palette modes and reports the encode time speedup.  The
+  speedup needs at least two host CPUs and is not checked.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+#include "Host.h"
+#include <thread>
+
+// Define the SPI encoding tables with external linkage when compiled as
+// C++, the Arduino build compiles the tables as C
+extern const uint8_t r4aLED3BitTable[];
+extern const uint8_t r4aLEDIntensityTable[];
+#include "LED_3_Bit_Table.c"
+#include "LED_Intensity_Table.c"
+
+//****************************************
+// Constants
+//****************************************
+
+#define BYTES_PER_COLOR     5       // 5-bit SPI encoding
+#define LEDS                20000   // Number of LEDs in the string
+#define UPDATES             50      // Number of frames to time
+
+//****************************************
+// Globals
+//****************************************
+
+R4A_SPI * r4aSpi;               // Used by R4A_LED_OUTPUT_SPI, not by the test
+
+//****************************************
+// Locals
+//****************************************
+
+static R4A_LED_OUTPUT_CAPTURE output(BYTES_PER_COLOR, r4aLEDIntensityTable);
+static int failures;            // Number of failed checks
+
+//*********************************************************************
+// Verify a condition
+static void check(bool condition, const char * description)
+{
+    if (!condition)
+    {
+        printf("FAIL: %s\n", description);
+        failures += 1;
+    }
+}
+
+//*********************************************************************
+// Encode the frame multiple times
+// Outputs:
+//   Returns the average encode time in microseconds
+static double encodeUsec()
+{
+    uint32_t startUsec;
+
+    startUsec = micros();
+    for (int update = 0; update < UPDATES; update++)
+    {
+        r4aLEDColorWritten = true;
+        r4aLEDUpdate(false);
+    }
+    return (double)(micros() - startUsec) / UPDATES;
+}
+
+//*********************************************************************
+int main()
+{
+    HostCapture display;
+    double dualUsec;
+    char expected[64];
+    std::string singleFrame;
+    double singleUsec;
+
+    // Mix the WS2812 and SK6812RGBW LEDs, use LED numbers above 255
+    check(r4aLEDSetup(&output, LEDS), "r4aLEDSetup");
+    check(r4aLEDs == LEDS, "r4aLEDs holds more than 255 LEDs");
+    for (int led = 0; led < LEDS; led++)
+    {
+        if (led % 3)
+            r4aLEDSetColorRgb(led, (led * 0x010305) & R4A_LED_WHITE_RGB);
+        else
+            r4aLEDSetColorWrgb(led, led * 0x01030507);
+    }
+    r4aLEDSetIntensity(200);
+
+    // Encode the frame on a single thread
+    singleUsec = encodeUsec();
+    singleFrame.assign((const char *)output.frame(), output.length());
+    check(output.length() == (LEDS * 3 + (LEDS + 2) / 3) * BYTES_PER_COLOR,
+          "Frame length");
+
+    // Encode the frame on two threads
+    check(r4aLEDEncodeParallel(), "r4aLEDEncodeParallel");
+    dualUsec = encodeUsec();
+    check((output.length() == (int)singleFrame.size())
+          && (memcmp(output.frame(), singleFrame.data(), singleFrame.size()) == 0),
+          "Two thread frame is byte-identical");
+    snprintf(expected, sizeof(expected), "Pass, %d LEDs, %d bytes", LEDS, output.length());
+    check(r4aLEDEncodeSelfTest(&display)
+          && (display.text.find(expected) != std::string::npos),
+          "Color mode self-test");
+
+    // Verify the palette mode
+    check(r4aLEDPaletteBegin(4), "r4aLEDPaletteBegin");
+    r4aLEDPaletteSetColorRgb(1, R4A_LED_RED);
+    r4aLEDPaletteSetColorWrgb(2, R4A_LED_WHITE_RGBW);
+    r4aLEDPaletteSetColorRgb(3, R4A_LED_YELLOW);
+    for (int led = 0; led < LEDS; led++)
+        r4aLEDPaletteSelect(led, led & 3);
+
+    // Every 4 LEDs use 13 colors: black, red, white (RGBW) and yellow
+    display.clear();
+    snprintf(expected, sizeof(expected), "Pass, %d LEDs, %d bytes",
+             LEDS, LEDS / 4 * 13 * BYTES_PER_COLOR);
+    check(r4aLEDEncodeSelfTest(&display)
+          && (display.text.find(expected) != std::string::npos),
+          "Palette mode self-test");
+
+    printf("%d LEDs, %d host CPUs: single thread %.0f uSec, two threads %.0f uSec, speedup %.2f\n",
+           LEDS, std::thread::hardware_concurrency(), singleUsec, dualUsec,
+           singleUsec / dualUsec);
+    printf("%s: %d failures\n", failures ? "FAIL" : "PASS", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,231 @@
+/**********************************************************************
+  Log_test.cpp
+
+  Robots-For-All (R4A)
+  Host test of the log ring and the record formatting
+
+  Verifies the immediate output before r4aLogSetup, the level and module
+  filtering, the argument formatting, the ring full handling and the
+  line truncation, then runs four producer threads against one consumer
+  and verifies that each record is output exactly once and in order.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+#include "Host.h"
+#include <thread>
+
+//****************************************
+// Constants
+//****************************************
+
+#define PRODUCERS           4
+#define PRODUCER_RECORDS    2000
+
+// The argument checks are done at compile time
+static_assert(r4aLogArgValid<int>(), "int argument");
+static_assert(r4aLogArgValid<char>(), "char argument");
+static_assert(r4aLogArgValid<const char *>(), "string argument");
+static_assert(r4aLogArgValid<R4A_SPI_PRIORITY>(), "enum argument");
+static_assert(!r4aLogArgValid<double>(), "double argument rejected");
+static_assert(!r4aLogArgValid<String>(), "String argument rejected");
+static_assert(!r4aLogArgValid<unsigned __int128>(), "Wide argument rejected");
+
+//****************************************
+// Locals
+//****************************************
+
+static HostCapture capture;     // Log output
+static int failures;            // Number of failed checks
+
+//*********************************************************************
+// Verify a condition
+static void check(bool condition, const char * description)
+{
+    if (!condition)
+    {
+        printf("FAIL: %s\n", description);
+        failures += 1;
+    }
+}
+
+//*********************************************************************
+// Get the message portion of the first output line
+static std::string message()
+{
+    size_t end;
+    size_t start;
+
+    start = capture.text.find(": ");
+    end = capture.text.find("\r\n");
+    if ((start == std::string::npos) || (end == std::string::npos))
+        return "";
+    return capture.text.substr(start + 2, end - start - 2);
+}
+
+//*********************************************************************
+// Verify the output before the drain task is started
+static void testImmediate()
+{
+    uint32_t written;
+
+    // The record is output immediately
+    r4aLogOutput = &capture;
+    capture.clear();
+    r4aLogInfo(R4A_MODULE_LED, "value %d", 5);
+    check(capture.text.find(" LED INFO: value 5\r\n") != std::string::npos,
+          "Record output before r4aLogSetup");
+
+    // The record level is compared with the module level
+    capture.clear();
+    r4aLogLevel[R4A_MODULE_LED] = R4A_LOG_LEVEL_ERROR;
+    r4aLogInfo(R4A_MODULE_LED, "hidden");
+    check(capture.text.empty(), "INFO record filtered at the ERROR level");
+    r4aLogError(R4A_MODULE_LED, "shown");
+    check(message() == "shown", "ERROR record output at the ERROR level");
+    r4aLogLevel[R4A_MODULE_LED] = R4A_LOG_LEVEL_INFO;
+
+    // Invalid module numbers are ignored
+    capture.clear();
+    written = r4aLogWritten;
+    r4aLog(R4A_MODULE_MAX, R4A_LOG_LEVEL_ERROR, "bad module");
+    r4aLog(255, R4A_LOG_LEVEL_ERROR, "bad module");
+    check(capture.text.empty() && (written == r4aLogWritten), "Invalid module ignored");
+}
+
+//*********************************************************************
+// Verify the argument formatting
+static void testFormatting()
+{
+    int32_t negative = -5;
+    static const char text[] = "text";
+    uint32_t value = 4000000000u;
+
+    capture.clear();
+    r4aLogWarning(R4A_MODULE_NTP, "%d %ld %x %c %s", negative, value, 0xbeef, 'A', text);
+    check(r4aLogDrain(&capture) == 1, "One record drained");
+    check(capture.text.find(" NTP WARNING: ") != std::string::npos, "Record prefix");
+    check(message() == "-5 4000000000 beef A text", "Five arguments formatted");
+
+    // The long lines are truncated
+    capture.clear();
+    r4aLogInfo(R4A_MODULE_NTP, "%s%s%s", "0123456789012345678901234567890123456789012345678901234567890123456789",
+               "0123456789012345678901234567890123456789012345678901234567890123456789",
+               "0123456789012345678901234567890123456789012345678901234567890123456789");
+    r4aLogDrain(&capture);
+    check((capture.text.size() < 160)
+          && (capture.text.compare(capture.text.size() - 2, 2, "\r\n") == 0),
+          "Long line truncated and terminated");
+}
+
+//*********************************************************************
+// Verify the ring full handling and the ring wrap
+static void testRingFull()
+{
+    char expected[32];
+    uint32_t dropped;
+    int index;
+    size_t offset;
+
+    // Fill the ring and drop the extra records
+    capture.clear();
+    dropped = r4aLogDropped;
+    for (index = 0; index < R4A_LOG_RECORDS + 3; index++)
+        r4aLogInfo(R4A_MODULE_LOG, "record %d", index);
+    check(r4aLogDropped == dropped + 3, "Records dropped when the ring is full");
+    check(r4aLogDrain(&capture) == R4A_LOG_RECORDS, "Full ring drained");
+    offset = 0;
+    for (index = 0; index < R4A_LOG_RECORDS; index++)
+    {
+        snprintf(expected, sizeof(expected), "record %d\r\n", index);
+        offset = capture.text.find(expected, offset);
+        if (offset == std::string::npos)
+            break;
+    }
+    check(index == R4A_LOG_RECORDS, "Records output in order");
+    check(r4aLogDrain(&capture) == 0, "Ring empty");
+
+    // Use the records again after the wrap
+    capture.clear();
+    for (index = 0; index < 3 * R4A_LOG_RECORDS / 2; index++)
+    {
+        r4aLogInfo(R4A_MODULE_LOG, "wrap %d", index);
+        if (r4aLogDrain(&capture) != 1)
+            break;
+    }
+    check(index == 3 * R4A_LOG_RECORDS / 2, "Records reused after the wrap");
+}
+
+//*********************************************************************
+// Log records from a producer thread
+static void producer(int thread)
+{
+    R4A_LOG_ARG args[2];
+
+    args[0] = thread;
+    for (int index = 0; index < PRODUCER_RECORDS; index++)
+    {
+        // Retry until the consumer makes space
+        args[1] = index;
+        while (!r4aLogRecord(R4A_MODULE_APPLICATION, R4A_LOG_LEVEL_INFO, "t%d n%d", args, 2))
+            std::this_thread::yield();
+    }
+}
+
+//*********************************************************************
+// Verify the ring with multiple producers and a consumer
+static void testProducers()
+{
+    int count;
+    int last[PRODUCERS];
+    const char * line;
+    int sequence;
+    std::thread threads[PRODUCERS];
+    int thread;
+
+    capture.clear();
+    for (thread = 0; thread < PRODUCERS; thread++)
+        threads[thread] = std::thread(producer, thread);
+
+    // Drain the records while the producers run
+    count = 0;
+    while (count < PRODUCERS * PRODUCER_RECORDS)
+    {
+        count += r4aLogDrain(&capture);
+        std::this_thread::yield();
+    }
+    for (thread = 0; thread < PRODUCERS; thread++)
+        threads[thread].join();
+    check(r4aLogDrain(&capture) == 0, "No extra records");
+
+    // Each producer's records are output once and in order
+    for (thread = 0; thread < PRODUCERS; thread++)
+        last[thread] = -1;
+    count = 0;
+    for (line = strstr(capture.text.c_str(), ": t"); line; line = strstr(line + 1, ": t"))
+    {
+        if (sscanf(line, ": t%d n%d", &thread, &sequence) != 2)
+            break;
+        if ((thread < 0) || (thread >= PRODUCERS) || (sequence != last[thread] + 1))
+            break;
+        last[thread] = sequence;
+        count += 1;
+    }
+    check(count == PRODUCERS * PRODUCER_RECORDS, "Each record output once in order");
+}
+
+//*********************************************************************
+int main()
+{
+    testImmediate();
+
+    // Use the ring, the test calls r4aLogDrain instead of the drain task
+    hostStartTasks = false;
+    check(r4aLogSetup(&capture), "r4aLogSetup");
+    hostStartTasks = true;
+
+    testFormatting();
+    testRingFull();
+    testProducers();
+    printf("%s: %d failures\n", failures ? "FAIL" : "PASS", failures);
+    return failures ? 1 : 0;
+}
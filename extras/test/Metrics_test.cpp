@@ -0,0 +1,216 @@
+/**********************************************************************
+  Metrics_test.cpp
+
+  Robots-For-All (R4A)
+  Host test of the metrics registry
+
+  Verifies the output formats, the rejection of a histogram without
+  bucket bounds, that a metric destructor waits for a task outputting
+  the metrics, and runs the metric construction and destruction against
+  the Prometheus output on another thread.  Built with the address
+  sanitizer to detect a metric used after it is freed.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+#include "Host.h"
+#include <atomic>
+#include <thread>
+
+//****************************************
+// Constants
+//****************************************
+
+#define STRESS_MSEC     300     // Duration of the stress test
+
+//****************************************
+// Types
+//****************************************
+
+// Print device that blocks the first write until released
+class BlockingPrint : public Print
+{
+  public:
+
+    std::atomic<bool> entered{false};
+    std::atomic<bool> release{false};
+
+    size_t write(uint8_t data) override
+    {
+        entered = true;
+        while (!release)
+            std::this_thread::yield();
+        return 1;
+    }
+
+    size_t write(const uint8_t * buffer, size_t length) override
+    {
+        for (size_t index = 0; index < length; index++)
+            write(buffer[index]);
+        return length;
+    }
+
+    using Print::write;
+};
+
+// Print device that discards the output
+class NullPrint : public Print
+{
+  public:
+
+    size_t bytes = 0;
+
+    size_t write(uint8_t data) override
+    {
+        bytes += 1;
+        return 1;
+    }
+
+    size_t write(const uint8_t * buffer, size_t length) override
+    {
+        bytes += length;
+        return length;
+    }
+
+    using Print::write;
+};
+
+//****************************************
+// Locals
+//****************************************
+
+static int failures;            // Number of failed checks
+
+//*********************************************************************
+// Verify a condition
+static void check(bool condition, const char * description)
+{
+    if (!condition)
+    {
+        printf("FAIL: %s\n", description);
+        failures += 1;
+    }
+}
+
+//*********************************************************************
+// Verify the output formats and the histogram without bounds
+static void testOutput()
+{
+    static const int32_t bounds[] = {10, 100};
+    uint32_t buckets[3] = {0};
+    HostCapture capture;
+    uint32_t emptyBuckets[1] = {0};
+
+    r4aLogOutput = &capture;
+    R4A_METRIC counter("test_requests_total", "Requests", R4A_METRIC_COUNTER, "port=\"80\"");
+    R4A_METRIC histogram("test_usec", "Time", bounds, 2, buckets);
+    R4A_METRIC empty("test_empty_usec", "No bounds", bounds, 0, emptyBuckets);
+    check(capture.text.find("Histogram test_empty_usec needs at least one bucket bound!")
+          != std::string::npos, "Histogram without bounds logged");
+
+    // Update the metrics
+    counter.add(3);
+    histogram.observe(5);
+    histogram.observe(50);
+    histogram.observe(500);
+    empty.observe(5);
+    check(emptyBuckets[0] == 0, "Histogram without bounds ignores the values");
+
+    // Verify the Prometheus output
+    capture.clear();
+    r4aMetricsPrometheus(&capture);
+    check(capture.text.find("test_requests_total{port=\"80\"} 3\n") != std::string::npos,
+          "Counter with labels");
+    check(capture.text.find("test_usec_bucket{le=\"100\"} 2\n") != std::string::npos,
+          "Cumulative bucket count");
+    check(capture.text.find("test_usec_bucket{le=\"+Inf\"} 3\n") != std::string::npos,
+          "Infinite bucket count");
+    check(capture.text.find("test_usec_sum 555\n") != std::string::npos, "Histogram sum");
+    check(capture.text.find("test_empty_usec") == std::string::npos,
+          "Histogram without bounds not output");
+
+    // Verify the display output
+    capture.clear();
+    r4aMetricsDisplay(&capture);
+    check(capture.text.find("    >  100        1\r\n") != std::string::npos,
+          "Display largest bound");
+    check(capture.text.find("test_empty_usec") == std::string::npos,
+          "Histogram without bounds not displayed");
+    r4aLogOutput = &Serial;
+}
+
+//*********************************************************************
+// Verify that the destructor waits for the task outputting the metrics
+static void testDestructorWaits()
+{
+    BlockingPrint blocking;
+    std::atomic<bool> deleted{false};
+    R4A_METRIC * metric;
+
+    metric = new R4A_METRIC("test_blocked", "Blocked", R4A_METRIC_GAUGE);
+
+    // Stop the output in the middle of the metrics
+    std::thread reader([&blocking]() { r4aMetricsDisplay(&blocking); });
+    while (!blocking.entered)
+        std::this_thread::yield();
+
+    // Delete the metric while the output is stopped
+    std::thread writer([&deleted, metric]()
+    {
+        delete metric;
+        deleted = true;
+    });
+    delay(50);
+    check(!deleted, "Destructor waits for the output");
+
+    // Finish the output
+    blocking.release = true;
+    reader.join();
+    writer.join();
+    check(deleted, "Destructor completes after the output");
+}
+
+//*********************************************************************
+// Create and destroy metrics while another thread outputs the metrics
+static void testStress()
+{
+    int created;
+    NullPrint output;
+    int passes;
+    std::atomic<bool> stop{false};
+
+    std::thread reader([&output, &passes, &stop]()
+    {
+        passes = 0;
+        while (!stop)
+        {
+            r4aMetricsPrometheus(&output);
+            passes += 1;
+        }
+    });
+
+    // Add and remove the metrics at the head and in the middle of the list
+    created = 0;
+    uint32_t startMsec = millis();
+    while ((millis() - startMsec) < STRESS_MSEC)
+    {
+        R4A_METRIC * first = new R4A_METRIC("test_first", "First", R4A_METRIC_COUNTER);
+        R4A_METRIC * second = new R4A_METRIC("test_second", "Second", R4A_METRIC_GAUGE);
+        delete first;
+        delete second;
+        created += 2;
+    }
+    stop = true;
+    reader.join();
+    printf("%d metrics created and destroyed during %d outputs\n", created, passes);
+    check((created > 0) && (passes > 0), "Stress test ran");
+}
+
+//*********************************************************************
+int main()
+{
+    testOutput();
+    testDestructorWaits();
+    testStress();
+    printf("%s: %d failures\n", failures ? "FAIL" : "PASS", failures);
+    return failures ? 1 : 0;
+}
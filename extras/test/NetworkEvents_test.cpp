@@ -0,0 +1,310 @@
+/**********************************************************************
+  NetworkEvents_test.cpp
+
+  Robots-For-All (R4A)
+  Host test of the patched NetworkEvents dispatch
+
+  Verifies that the handlers are called in registration order without
+  copies or allocations, that handlers may add or remove handlers during
+  the dispatch without skipping or repeating a handler, and reports the
+  time to dispatch an event to 32 handlers.
+**********************************************************************/
+
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <utility>
+#include "NetworkEvents.h"
+
+//****************************************
+// Locals
+//****************************************
+
+static size_t allocations;      // Number of calls to operator new
+static int calls[64];           // Calls to each handler
+static int callOrder[64];       // Handler numbers in call order
+static int callCount;           // Number of entries in callOrder
+static int failures;            // Number of failed checks
+
+//*********************************************************************
+// Count the allocations
+void * operator new(size_t bytes)
+{
+    void * data;
+
+    allocations += 1;
+    data = malloc(bytes ? bytes : 1);
+    if (!data)
+        throw std::bad_alloc();
+    return data;
+}
+
+//*********************************************************************
+void operator delete(void * data) noexcept
+{
+    free(data);
+}
+
+//*********************************************************************
+void operator delete(void * data, size_t bytes) noexcept
+{
+    free(data);
+}
+
+//****************************************
+// Test support
+//****************************************
+
+// Make the protected initialization available to the test
+class TestEvents : public NetworkEvents
+{
+  public:
+    using NetworkEvents::initNetworkEvents;
+};
+
+static TestEvents events;
+
+//*********************************************************************
+// Verify a condition
+static void check(bool condition, const char * description)
+{
+    if (!condition)
+    {
+        printf("FAIL: %s\n", description);
+        failures += 1;
+    }
+}
+
+//*********************************************************************
+// Reset the call history
+static void clearCalls()
+{
+    memset(calls, 0, sizeof(calls));
+    callCount = 0;
+}
+
+//*********************************************************************
+// Post an event and dispatch it
+static void dispatch(arduino_event_id_t id)
+{
+    arduino_event_t event;
+
+    memset(&event, 0, sizeof(event));
+    event.event_id = id;
+    events.postEvent(&event);
+    events.checkForEvent();
+}
+
+//*********************************************************************
+// Record a handler call
+static void record(int handler)
+{
+    calls[handler] += 1;
+    if (callCount < (int)(sizeof(callOrder) / sizeof(callOrder[0])))
+        callOrder[callCount++] = handler;
+}
+
+//****************************************
+// Handlers
+//****************************************
+
+static network_event_handle_t handleAdded;
+static network_event_handle_t handleLater;
+
+static void handler0(arduino_event_id_t event) { record(0); }
+static void handler1(arduino_event_id_t event) { record(1); }
+static void handler2(arduino_event_id_t event) { record(2); }
+static void handler3(arduino_event_t * event) { record(3); }
+
+//*********************************************************************
+// Remove this handler during the dispatch
+static void removeSelf(arduino_event_id_t event)
+{
+    record(4);
+    events.removeEvent(removeSelf, ARDUINO_EVENT_ETH_START);
+}
+
+//*********************************************************************
+// Add a handler during the dispatch
+static void addHandler(arduino_event_id_t event)
+{
+    record(5);
+    if (!handleAdded)
+        handleAdded = events.onEvent(handler2, ARDUINO_EVENT_ETH_STOP);
+}
+
+//*********************************************************************
+// Remove a later handler during the dispatch
+static void removeLater(arduino_event_id_t event)
+{
+    record(6);
+    events.removeEvent(handleLater);
+}
+
+//****************************************
+// Tests
+//****************************************
+
+//*********************************************************************
+// Verify the dispatch order and the event filtering
+static void testOrder()
+{
+    network_event_handle_t handles[4];
+
+    clearCalls();
+    handles[0] = events.onEvent(handler0, ARDUINO_EVENT_ETH_START);
+    handles[1] = events.onEvent(handler1);
+    handles[2] = events.onEvent(handler2, ARDUINO_EVENT_ETH_STOP);
+    handles[3] = events.onEvent(handler3, ARDUINO_EVENT_ETH_START);
+    check(events.onEvent(handler0, ARDUINO_EVENT_ETH_START) == 0, "Duplicate handler rejected");
+
+    dispatch(ARDUINO_EVENT_ETH_START);
+    check((callCount == 3) && (callOrder[0] == 0) && (callOrder[1] == 1) && (callOrder[2] == 3),
+          "ETH_START handlers called in registration order");
+
+    clearCalls();
+    dispatch(ARDUINO_EVENT_ETH_STOP);
+    check((callCount == 2) && (callOrder[0] == 1) && (callOrder[1] == 2),
+          "ETH_STOP handlers called in registration order");
+
+    clearCalls();
+    events.removeEvent(handler1);
+    dispatch(ARDUINO_EVENT_ETH_START);
+    check((callCount == 2) && (callOrder[0] == 0) && (callOrder[1] == 3),
+          "Removed handler not called");
+
+    events.removeEvent(handles[0]);
+    events.removeEvent(handles[2]);
+    events.removeEvent(handles[3]);
+    clearCalls();
+    dispatch(ARDUINO_EVENT_ETH_START);
+    dispatch(ARDUINO_EVENT_ETH_STOP);
+    check(callCount == 0, "All handlers removed");
+}
+
+//*********************************************************************
+// Verify the changes made by the handlers during the dispatch
+static void testChangesDuringDispatch()
+{
+    network_event_handle_t handles[4];
+
+    clearCalls();
+    handles[0] = events.onEvent(removeSelf, ARDUINO_EVENT_ETH_START);
+    handles[1] = events.onEvent(handler0, ARDUINO_EVENT_ETH_START);
+    handles[2] = events.onEvent(removeLater, ARDUINO_EVENT_ETH_START);
+    handleLater = events.onEvent(handler1, ARDUINO_EVENT_ETH_START);
+    handles[3] = events.onEvent(addHandler, ARDUINO_EVENT_ETH_START);
+
+    // removeSelf runs once, handler1 is removed before its turn, the
+    // handler added during the dispatch waits for the next event
+    dispatch(ARDUINO_EVENT_ETH_START);
+    check((calls[4] == 1) && (calls[0] == 1) && (calls[6] == 1) && (calls[5] == 1),
+          "Each remaining handler called exactly once");
+    check(calls[1] == 0, "Handler removed during the dispatch not called");
+    check(calls[2] == 0, "Handler added during the dispatch not called");
+    check((callCount == 4) && (callOrder[0] == 4) && (callOrder[1] == 0)
+          && (callOrder[2] == 6) && (callOrder[3] == 5),
+          "Handler order unchanged by the removals");
+
+    clearCalls();
+    dispatch(ARDUINO_EVENT_ETH_START);
+    check((calls[4] == 0) && (calls[0] == 1) && (calls[6] == 1) && (calls[5] == 1) && (calls[1] == 0),
+          "Removed handlers reclaimed after the dispatch");
+    dispatch(ARDUINO_EVENT_ETH_STOP);
+    check(calls[2] == 1, "Handler added during the dispatch called for the next event");
+
+    events.removeEvent(handles[1]);
+    events.removeEvent(handles[2]);
+    events.removeEvent(handles[3]);
+    events.removeEvent(handleAdded);
+}
+
+//*********************************************************************
+// Verify that the std::function handlers are not copied
+static void testNoCopies()
+{
+    std::string capture(64, 'x');
+    size_t count;
+    NetworkEventFuncCb handler;
+    network_event_handle_t handle;
+
+    clearCalls();
+
+    // The capture is too large for the small buffer, copying the handler
+    // would allocate
+    handler = [capture](arduino_event_id_t event, arduino_event_info_t info)
+    {
+        record(capture.size() == 64 ? 7 : 8);
+    };
+    handle = events.onEvent(handler, ARDUINO_EVENT_ETH_START);
+    dispatch(ARDUINO_EVENT_ETH_START);
+    count = allocations;
+    for (int i = 0; i < 100; i++)
+        dispatch(ARDUINO_EVENT_ETH_START);
+    check(allocations == count, "No allocations during the dispatch");
+    check(calls[7] == 101, "std::function handler called");
+    events.removeEvent(handle);
+}
+
+//*********************************************************************
+// Benchmark handler, the duplicate check compares the function addresses
+// so each handler must be a different function
+template<int HANDLER> static void benchmarkHandler(arduino_event_id_t event, arduino_event_info_t info)
+{
+    calls[HANDLER] += 1;
+}
+
+template<int... HANDLER> static void benchmarkHandlers(NetworkEventFuncCb * handlers, std::integer_sequence<int, HANDLER...>)
+{
+    NetworkEventFuncCb list[] = {benchmarkHandler<HANDLER>...};
+
+    for (size_t i = 0; i < sizeof...(HANDLER); i++)
+        handlers[i] = list[i];
+}
+
+//*********************************************************************
+// Measure the dispatch time for 32 handlers
+static void benchmark()
+{
+    const int eventCount = 100000;
+    const int handlerCount = 32;
+    NetworkEventFuncCb handlers[handlerCount];
+    network_event_handle_t handles[handlerCount];
+    double nsec;
+    std::chrono::steady_clock::time_point start;
+
+    // Half of the handlers are registered for all events
+    clearCalls();
+    benchmarkHandlers(handlers, std::make_integer_sequence<int, handlerCount>());
+    for (int i = 0; i < handlerCount; i++)
+    {
+        handles[i] = events.onEvent(handlers[i], (i & 1) ? ARDUINO_EVENT_ETH_START : ARDUINO_EVENT_MAX);
+        check(handles[i] != 0, "Benchmark handler registered");
+    }
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < eventCount; i++)
+        dispatch(ARDUINO_EVENT_ETH_START);
+    nsec = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    for (int i = 0; i < handlerCount; i++)
+        check(calls[i] == eventCount, "Benchmark handler called for each event");
+    printf("32 handler dispatch: %.0f nSec per event\n", nsec / eventCount);
+
+    for (int i = 0; i < handlerCount; i++)
+        events.removeEvent(handles[i]);
+}
+
+//*********************************************************************
+int main()
+{
+    check(events.initNetworkEvents(), "initNetworkEvents");
+    testOrder();
+    testChangesDuringDispatch();
+    testNoCopies();
+    benchmark();
+    printf("%s: %d failures\n", failures ? "FAIL" : "PASS", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,196 @@
+/**********************************************************************
+  SPI_test.cpp
+
+  Robots-For-All (R4A)
+  Host test and benchmark of the SPI transaction queue
+
+  Runs R4A_SPI_ESP32 over the host model of the SPI master driver and
+  verifies that the LED frame is sent in the background, that busy
+  tracks the driver completion and that no more than maxInFlight
+  transactions are queued to the driver.  The benchmark compares the
+  CPU time blocked per LED frame with the synchronous R4A_SPI.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+#include "SpiFake.h"
+
+//****************************************
+// Constants
+//****************************************
+
+#define CLOCK_HZ        2857142     // 3-bit LED encoding clock
+#define FRAME_BYTES     (300 * 4 * 3) // 300 RGBW LEDs, 3-bit encoding
+#define FRAMES          20
+#define SENSOR_BYTES    8
+
+//****************************************
+// Globals
+//****************************************
+
+R4A_SPI * r4aSpi;
+
+//****************************************
+// Locals
+//****************************************
+
+static int completions[8];      // Completion order of the transactions
+static int completionCount;     // Number of entries in completions
+static int failures;            // Number of failed checks
+
+//*********************************************************************
+// Verify a condition
+static void check(bool condition, const char * description)
+{
+    if (!condition)
+    {
+        printf("FAIL: %s\n", description);
+        failures += 1;
+    }
+}
+
+//*********************************************************************
+// Record the transaction completion
+static void completed(R4A_SPI_TRANSACTION * transaction)
+{
+    if (completionCount < (int)(sizeof(completions) / sizeof(completions[0])))
+        completions[completionCount++] = transaction->parameter;
+}
+
+//*********************************************************************
+// Verify that the frame is sent in the background
+static void testBackground()
+{
+    R4A_SPI_TRANSACTION frame;
+    static uint8_t frameData[FRAME_BYTES];
+    R4A_SPI_TRANSACTION sensor;
+    uint8_t sensorRx[SENSOR_BYTES];
+    uint8_t sensorTx[SENSOR_BYTES] = {1, 2, 3, 4, 5, 6, 7, 8};
+    R4A_SPI_ESP32 spi(2);
+    uint32_t startUsec;
+    uint32_t writeUsec;
+
+    check(spi.begin(2, 23, CLOCK_HZ), "begin");
+    memset(&frame, 0, sizeof(frame));
+    frame.txBuffer = frameData;
+    frame.length = sizeof(frameData);
+    frame.priority = R4A_SPI_PRIORITY_LOW;
+
+    // Queue the frame the same way as R4A_LED_OUTPUT_SPI::write
+    startUsec = micros();
+    check(spi.queue(&frame), "Frame queued");
+    spi.service();
+    writeUsec = micros() - startUsec;
+    check(writeUsec < 1000, "Frame write returns before the transfer completes");
+    check(frame.busy, "Frame busy while the driver sends it");
+    check(!spi.queue(&frame), "Busy frame not queued twice");
+
+    // A sensor read is started behind the frame without waiting
+    memset(&sensor, 0, sizeof(sensor));
+    memset(sensorRx, 0, sizeof(sensorRx));
+    sensor.txBuffer = sensorTx;
+    sensor.rxBuffer = sensorRx;
+    sensor.length = sizeof(sensorTx);
+    sensor.priority = R4A_SPI_PRIORITY_HIGH;
+    check(spi.queue(&sensor), "Sensor read queued");
+    spi.service();
+    check(spiFakeMaxQueued == 2, "Frame and sensor read in flight together");
+
+    // Wait for the completion
+    while (frame.busy || sensor.busy)
+        spi.service();
+    check((int32_t)(frame.completeUsec - startUsec) >= (FRAME_BYTES * 8 * 1000LL * 1000 / CLOCK_HZ),
+          "Frame busy until the bus time elapsed");
+    check(memcmp(sensorRx, sensorTx, sizeof(sensorTx)) == 0, "Sensor receive data");
+    check(spi.isIdle(), "Controller idle");
+}
+
+//*********************************************************************
+// Verify the in-flight limit and the priority order
+static void testInFlightLimit()
+{
+    uint8_t data[64];
+    int index;
+    R4A_SPI_ESP32 spi(2);
+    R4A_SPI_TRANSACTION transactions[6];
+
+    check(spi.begin(2, 23, CLOCK_HZ), "begin");
+    completionCount = 0;
+    memset(transactions, 0, sizeof(transactions));
+    for (index = 0; index < 6; index++)
+    {
+        transactions[index].txBuffer = data;
+        transactions[index].length = sizeof(data);
+        transactions[index].priority = (index < 3) ? R4A_SPI_PRIORITY_LOW : R4A_SPI_PRIORITY_HIGH;
+        transactions[index].callback = completed;
+        transactions[index].parameter = index;
+    }
+
+    // Queue the low priority transactions and start two of them
+    for (index = 0; index < 3; index++)
+        spi.queue(&transactions[index]);
+    spi.service();
+
+    // The high priority transactions pass the waiting low priority one
+    for (index = 3; index < 6; index++)
+        spi.queue(&transactions[index]);
+    while (!spi.isIdle())
+        spi.service();
+    check(spiFakeMaxQueued == 2, "Driver queue limited to maxInFlight");
+    check((completionCount == 6)
+          && (completions[0] == 0) && (completions[1] == 1)
+          && (completions[2] == 3) && (completions[3] == 4)
+          && (completions[4] == 5) && (completions[5] == 2),
+          "Transactions completed in priority order");
+}
+
+//*********************************************************************
+// Measure the CPU time blocked for each LED frame
+static void benchmark(R4A_SPI * spi, const char * name)
+{
+    uint32_t blockedUsec;
+    R4A_SPI_TRANSACTION frame;
+    static uint8_t frameData[FRAME_BYTES];
+    uint32_t loopsWhileBusy;
+    uint32_t startUsec;
+    uint32_t totalUsec;
+
+    check(spi->begin(2, 23, CLOCK_HZ), "begin");
+    memset(&frame, 0, sizeof(frame));
+    frame.txBuffer = frameData;
+    frame.length = sizeof(frameData);
+    blockedUsec = 0;
+    loopsWhileBusy = 0;
+    totalUsec = micros();
+    for (int index = 0; index < FRAMES; index++)
+    {
+        // Output the frame
+        startUsec = micros();
+        spi->queue(&frame);
+        spi->service();
+        blockedUsec += micros() - startUsec;
+
+        // Count the loop iterations available while the frame is sent
+        while (frame.busy)
+        {
+            spi->service();
+            loopsWhileBusy += 1;
+        }
+    }
+    totalUsec = micros() - totalUsec;
+    printf("%-9s %5u uSec blocked per %u byte frame, %u loops while busy, %u uSec per frame\n",
+           name, blockedUsec / FRAMES, FRAME_BYTES, loopsWhileBusy / FRAMES, totalUsec / FRAMES);
+}
+
+//*********************************************************************
+int main()
+{
+    R4A_SPI blocking;
+    R4A_SPI_ESP32 queued;
+
+    testBackground();
+    testInFlightLimit();
+    benchmark(&blocking, "R4A_SPI");
+    benchmark(&queued, "R4A_SPI_ESP32");
+    printf("%s: %d failures\n", failures ? "FAIL" : "PASS", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,193 @@
+/**********************************************************************
+  Serial_test.cpp
+
+  Robots-For-All (R4A)
+  Host test of the R4A_SERIAL_CONSOLE over the pseudo terminal UART
+
+  The test acts as the terminal program, writing the command lines to
+  the terminal side of the pseudo terminal and reading the console
+  output.  Verifies the command line editing, lines split across writes
+  and several lines in one write, the long line and pattern queue
+  overflow recovery and the exit command.  Reports the time for an
+  update call while waiting for input.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+#include "UartFake.h"
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+//****************************************
+// Constants
+//****************************************
+
+#define PORT            1       // UART number
+#define IDLE_UPDATES    100000  // Number of idle update calls to time
+#define WAIT_MSEC       1000    // Maximum time to wait for the data
+
+//****************************************
+// Locals
+//****************************************
+
+static std::vector<std::string> commands; // Commands received by echo
+static int failures;            // Number of failed checks
+static uint64_t written;        // Total bytes written to the terminal
+
+//*********************************************************************
+// Save the command line
+static void echoCommand(const R4A_MENU_ENTRY * menuEntry,
+                        const char * command,
+                        Print * display)
+{
+    commands.push_back(command);
+}
+
+//****************************************
+// Menus
+//****************************************
+
+const R4A_MENU_ENTRY mainMenuTable[] =
+{
+    // Command  menuRoutine     menuParam       HelpRoutine align   HelpText
+    {"echo",    echoCommand,    0,              nullptr,    4,      "Save the command"},
+    {"exit",    nullptr,        R4A_MENU_NONE,  nullptr,    0,      "Exit the menu system"},
+};
+#define MAIN_MENU_ENTRIES       sizeof(mainMenuTable) / sizeof(mainMenuTable[0])
+
+const R4A_MENU_TABLE menuTable[] =
+{
+    // menuName         preMenu routine             firstEntry              entryCount
+    {"Main Menu",       nullptr,                    mainMenuTable,          MAIN_MENU_ENTRIES},
+};
+const int menuTableEntries = sizeof(menuTable) / sizeof(menuTable[0]);
+
+//*********************************************************************
+// Verify a condition
+static void check(bool condition, const char * description)
+{
+    if (!condition)
+    {
+        printf("FAIL: %s\n", description);
+        failures += 1;
+    }
+}
+
+//*********************************************************************
+// Read the console output from the terminal
+// Outputs:
+//   Returns the output received since the previous call
+static std::string terminalRead()
+{
+    char buffer[256];
+    ssize_t bytes;
+    std::string output;
+
+    while ((bytes = read(uartFakeTerminal(PORT), buffer, sizeof(buffer))) > 0)
+        output.append(buffer, bytes);
+    return output;
+}
+
+//*********************************************************************
+// Type the data on the terminal and let the console process it
+// Inputs:
+//   console: Address of the serial console
+//   data: Data to write to the terminal
+// Outputs:
+//   Returns the console output
+static std::string terminalWrite(R4A_SERIAL_CONSOLE * console, const std::string & data)
+{
+    ssize_t bytes;
+    size_t offset;
+
+    // Write the data to the terminal
+    for (offset = 0; offset < data.size(); offset += (bytes > 0) ? bytes : 0)
+    {
+        bytes = write(uartFakeTerminal(PORT), &data[offset], data.size() - offset);
+        if (bytes <= 0)
+            delay(1);
+    }
+    written += data.size();
+
+    // Process the data
+    check(uartFakeWaitReceived(PORT, written, WAIT_MSEC), "Data received by the UART");
+    console->update();
+    return terminalRead();
+}
+
+//*********************************************************************
+int main()
+{
+    R4A_SERIAL_CONSOLE console(PORT, menuTable, menuTableEntries);
+    std::string line;
+    std::string output;
+    uint32_t startUsec;
+    double updateNsec;
+
+    // Display the menu
+    check(console.begin(), "begin");
+    check(terminalRead().find("Main Menu") != std::string::npos, "Menu displayed");
+
+    // Remove the backspace and delete characters, terminals send either
+    output = terminalWrite(&console, "echo abX\x7f" "c\b" "d\r");
+    check((commands.size() == 1) && (commands[0] == "echo abd"), "Line editing");
+    check(output.find("Main Menu") != std::string::npos, "Menu displayed after command");
+
+    // Remove the linefeed after the carriage return
+    commands.clear();
+    terminalWrite(&console, "echo two\r\n");
+    terminalWrite(&console, "echo three\r");
+    check((commands.size() == 2) && (commands[0] == "echo two") && (commands[1] == "echo three"),
+          "Carriage return and linefeed");
+
+    // Process a line split across writes once
+    commands.clear();
+    terminalWrite(&console, "echo fo");
+    check(commands.empty(), "Partial line not processed");
+    terminalWrite(&console, "ur\r");
+    check((commands.size() == 1) && (commands[0] == "echo four"), "Split line");
+
+    // Process several lines from a single write in order
+    commands.clear();
+    terminalWrite(&console, "echo 5\recho 6\recho 7\r");
+    check((commands.size() == 3) && (commands[0] == "echo 5") && (commands[2] == "echo 7"),
+          "Several lines in one write");
+
+    // Discard a line too long for the command buffer
+    commands.clear();
+    line = "echo " + std::string(R4A_SERIAL_COMMAND_BYTES, 'L') + "\r";
+    output = terminalWrite(&console, line);
+    check(output.find("Error: Command too long") != std::string::npos, "Long line rejected");
+    terminalWrite(&console, "echo after\r");
+    check((commands.size() == 1) && (commands[0] == "echo after"), "Line after the long line");
+
+    // Discard the input when the pattern queue overflows, the lines in
+    // the pattern queue are processed
+    commands.clear();
+    line.clear();
+    for (int index = 0; index < R4A_SERIAL_PATTERN_QUEUE + 2; index++)
+        line += "echo " + std::to_string(index) + "\r";
+    terminalWrite(&console, line);
+    check(commands.size() == R4A_SERIAL_PATTERN_QUEUE, "Pattern queue lines processed");
+    commands.clear();
+    terminalWrite(&console, "echo recovered\r");
+    check((commands.size() == 1) && (commands[0] == "echo recovered"),
+          "Line after the pattern queue overflow");
+
+    // Time the update while waiting for input
+    startUsec = micros();
+    for (int index = 0; index < IDLE_UPDATES; index++)
+        console.update();
+    updateNsec = (micros() - startUsec) * 1000. / IDLE_UPDATES;
+    printf("Idle update: %.0f nSec per call\n", updateNsec);
+
+    // Exit the menu system
+    terminalWrite(&console, "exit");
+    written += 1;
+    write(uartFakeTerminal(PORT), "\r", 1);
+    check(uartFakeWaitReceived(PORT, written, WAIT_MSEC), "Exit received");
+    check(console.update(), "Exit command");
+
+    printf("%s: %d failures\n", failures ? "FAIL" : "PASS", failures);
+    return failures ? 1 : 0;
+}
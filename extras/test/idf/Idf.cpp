@@ -0,0 +1,126 @@
+/**********************************************************************
+  Idf.cpp
+
+  Robots-For-All (R4A)
+  Single threaded host implementation of the ESP-IDF and FreeRTOS
+  routines used by the patched NetworkEvents.cpp
+**********************************************************************/
+
+#include <string.h>
+#include "esp_event.h"
+#include "esp32-hal.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+
+esp_event_base_t const ARDUINO_EVENTS = "ARDUINO_EVENTS";
+
+//*********************************************************************
+esp_err_t esp_event_loop_create_default()
+{
+    return ESP_OK;
+}
+
+//*********************************************************************
+BaseType_t xTaskCreateUniversal(TaskFunction_t task, const char * name, uint32_t stackBytes,
+                                void * parameter, UBaseType_t priority,
+                                TaskHandle_t * handle, BaseType_t core)
+{
+    static int hostTask;
+
+    *handle = &hostTask;
+    return pdPASS;
+}
+
+//*********************************************************************
+void vTaskDelete(TaskHandle_t task)
+{
+}
+
+//*********************************************************************
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t itemSize,
+                                 uint8_t * storage, StaticQueue_t * queue)
+{
+    queue->storage = storage;
+    queue->length = length;
+    queue->itemSize = itemSize;
+    queue->head = 0;
+    queue->count = 0;
+    return queue;
+}
+
+//*********************************************************************
+void vQueueDelete(QueueHandle_t queue)
+{
+}
+
+//*********************************************************************
+BaseType_t xQueueReceive(QueueHandle_t queue, void * item, TickType_t ticks)
+{
+    if (!queue->count)
+        return pdFALSE;
+    memcpy(item, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count -= 1;
+    return pdTRUE;
+}
+
+//*********************************************************************
+BaseType_t xQueueSend(QueueHandle_t queue, const void * item, TickType_t ticks)
+{
+    UBaseType_t tail;
+
+    if (queue->count >= queue->length)
+        return pdFAIL;
+    tail = (queue->head + queue->count) % queue->length;
+    memcpy(&queue->storage[tail * queue->itemSize], item, queue->itemSize);
+    queue->count += 1;
+    return pdPASS;
+}
+
+//*********************************************************************
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    return queue->count;
+}
+
+//*********************************************************************
+EventGroupHandle_t xEventGroupCreate()
+{
+    return new EventBits_t(0);
+}
+
+//*********************************************************************
+void vEventGroupDelete(EventGroupHandle_t group)
+{
+    delete group;
+}
+
+//*********************************************************************
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    *group |= bits;
+    return *group;
+}
+
+//*********************************************************************
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    EventBits_t previous;
+
+    previous = *group;
+    *group &= ~bits;
+    return previous;
+}
+
+//*********************************************************************
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+    return *group;
+}
+
+//*********************************************************************
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits,
+                                BaseType_t clear, BaseType_t all, TickType_t ticks)
+{
+    return *group;
+}
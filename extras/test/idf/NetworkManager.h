@@ -0,0 +1,3 @@
+// Host stand-in for the Arduino network manager
+#pragma once
+#include "NetworkEvents.h"
@@ -0,0 +1,16 @@
+// Host stand-in for the Arduino ESP32 HAL logging and task creation
+#pragma once
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define ARDUINO_EVENT_RUNNING_CORE  1
+
+#define log_e(format, ...)  fprintf(stderr, "E: " format "\n", ##__VA_ARGS__)
+#define log_w(format, ...)  fprintf(stderr, "W: " format "\n", ##__VA_ARGS__)
+#define log_v(format, ...)  do {} while (0)
+
+// The host does not start the task, the test calls the task routine
+BaseType_t xTaskCreateUniversal(TaskFunction_t task, const char * name, uint32_t stackBytes,
+                                void * parameter, UBaseType_t priority,
+                                TaskHandle_t * handle, BaseType_t core);
@@ -0,0 +1,3 @@
+// Host stand-in for the ESP-IDF Ethernet driver
+#pragma once
+typedef void * esp_eth_handle_t;
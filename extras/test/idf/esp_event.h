@@ -0,0 +1,6 @@
+// Host stand-in for the ESP-IDF default event loop
+#pragma once
+#include "esp_err.h"
+typedef const char * esp_event_base_t;
+#define ESP_EVENT_DECLARE_BASE(id) extern esp_event_base_t const id
+esp_err_t esp_event_loop_create_default();
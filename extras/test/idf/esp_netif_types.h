@@ -0,0 +1,10 @@
+// Host stand-in for the ESP-IDF network interface types
+#pragma once
+#include <stdint.h>
+typedef struct { uint32_t addr; } esp_ip4_addr_t;
+typedef struct { uint32_t addr[4]; uint8_t zone; } esp_ip6_addr_t;
+typedef struct { esp_ip4_addr_t ip, netmask, gw; } esp_netif_ip_info_t;
+typedef struct { esp_ip6_addr_t ip; } esp_netif_ip6_info_t;
+typedef struct { esp_ip4_addr_t ip; uint8_t mac[6]; } ip_event_ap_staipassigned_t;
+typedef struct { void * esp_netif; esp_netif_ip_info_t ip_info; bool ip_changed; } ip_event_got_ip_t;
+typedef struct { void * esp_netif; esp_netif_ip6_info_t ip6_info; int ip_index; } ip_event_got_ip6_t;
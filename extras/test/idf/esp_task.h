@@ -0,0 +1,3 @@
+// Host stand-in for the ESP-IDF task priorities
+#pragma once
+#define ESP_TASKD_EVENT_PRIO    20
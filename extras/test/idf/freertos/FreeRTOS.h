@@ -0,0 +1,20 @@
+// Host stand-in for the FreeRTOS types
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t EventBits_t;
+
+#define pdFALSE             0
+#define pdTRUE              1
+#define pdPASS              1
+#define pdFAIL              0
+#define portMAX_DELAY       0xffffffff
+#define portTICK_PERIOD_MS  1
+#define pdMS_TO_TICKS(x)    (x)
+
+#define BIT0    0x00000001
+#define BIT1    0x00000002
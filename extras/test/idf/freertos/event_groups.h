@@ -0,0 +1,11 @@
+// Host stand-in for the FreeRTOS event groups
+#pragma once
+#include "FreeRTOS.h"
+typedef EventBits_t * EventGroupHandle_t;
+EventGroupHandle_t xEventGroupCreate();
+void vEventGroupDelete(EventGroupHandle_t group);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits,
+                                BaseType_t clear, BaseType_t all, TickType_t ticks);
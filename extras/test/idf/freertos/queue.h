@@ -0,0 +1,20 @@
+// Host stand-in for the FreeRTOS queues, the host queue never blocks
+#pragma once
+#include "FreeRTOS.h"
+
+typedef struct
+{
+    uint8_t * storage;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t head;
+    UBaseType_t count;
+} StaticQueue_t;
+typedef StaticQueue_t * QueueHandle_t;
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t itemSize,
+                                 uint8_t * storage, StaticQueue_t * queue);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueReceive(QueueHandle_t queue, void * item, TickType_t ticks);
+BaseType_t xQueueSend(QueueHandle_t queue, const void * item, TickType_t ticks);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
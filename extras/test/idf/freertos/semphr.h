@@ -0,0 +1,3 @@
+// Host stand-in for the FreeRTOS semaphores
+#pragma once
+#include "queue.h"
@@ -0,0 +1,6 @@
+// Host stand-in for the FreeRTOS tasks
+#pragma once
+#include "FreeRTOS.h"
+typedef void * TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+void vTaskDelete(TaskHandle_t task);
@@ -0,0 +1,4 @@
+// Host stand-in for the ESP-IDF SoC capabilities, the WiFi events are
+// not needed to test the event dispatch
+#pragma once
+#define SOC_WIFI_SUPPORTED 0
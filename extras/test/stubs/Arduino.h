@@ -0,0 +1,152 @@
+// Host stand-in for the Arduino ESP32 core, Host.cpp implements the
+// routines used by the host tests
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <math.h>
+#include <strings.h>
+#include <new>
+#include <functional>
+#include <vector>
+typedef uint8_t byte;
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+#define MALLOC_CAP_DMA 1
+#define MALLOC_CAP_8BIT 2
+#define MALLOC_CAP_INTERNAL 4
+#define ESP_OK 0
+#define ESP_FAIL -1
+typedef int esp_err_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void * TaskHandle_t;
+typedef void * QueueHandle_t;
+typedef void * SemaphoreHandle_t;
+typedef void (*TaskFunction_t)(void *);
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xffffffff
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(x) (x)
+#define tskIDLE_PRIORITY 0
+#define configMAX_PRIORITIES 25
+typedef struct { volatile int owner; int count; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0,0}
+void portENTER_CRITICAL(portMUX_TYPE *);
+void portEXIT_CRITICAL(portMUX_TYPE *);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char *, uint32_t, void *, UBaseType_t, TaskHandle_t *, BaseType_t);
+void vTaskDelay(TickType_t);
+void vTaskDelete(TaskHandle_t);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+const char * pcTaskGetName(TaskHandle_t);
+BaseType_t xTaskNotifyGive(TaskHandle_t);
+uint32_t ulTaskNotifyTake(BaseType_t, TickType_t);
+QueueHandle_t xQueueCreate(UBaseType_t, UBaseType_t);
+BaseType_t xQueueReceive(QueueHandle_t, void *, TickType_t);
+BaseType_t xQueueSend(QueueHandle_t, const void *, TickType_t);
+BaseType_t xQueueReset(QueueHandle_t);
+void vQueueDelete(QueueHandle_t);
+BaseType_t xPortGetCoreID();
+void * heap_caps_malloc(size_t, uint32_t);
+size_t heap_caps_get_free_size(uint32_t);
+size_t heap_caps_get_largest_free_block(uint32_t);
+size_t heap_caps_get_minimum_free_size(uint32_t);
+int64_t esp_timer_get_time();
+uint32_t millis();
+uint32_t micros();
+void delayMicroseconds(uint32_t us);
+void delay(uint32_t);
+void yield();
+class String {
+public:
+  String(const char * s = "");
+  String(const String &);
+  String(char c);
+  String & operator=(const String &);
+  String & operator=(const char *);
+  String & operator+=(const char *);
+  String & operator+=(char);
+  String & operator+=(const String &);
+  const char * c_str() const;
+  unsigned int length() const;
+  String substring(unsigned int, unsigned int) const;
+  void trim();
+  void toCharArray(char *, unsigned int) const;
+  ~String();
+private:
+  char * _buffer;
+  void assign(const char *, size_t);
+  void append(const char *, size_t);
+};
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char * s) { return write((const uint8_t *)s, strlen(s)); }
+  size_t write(const char * b, size_t s) { return write((const uint8_t *)b, s); }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+  size_t printf(const char * format, ...) __attribute__((format(printf, 2, 3)));
+  size_t print(const char *);
+  size_t print(char);
+  size_t print(int, int = 10);
+  size_t print(unsigned int, int = 10);
+  size_t print(long, int = 10);
+  size_t print(unsigned long, int = 10);
+  size_t print(const String &);
+  size_t println(const char *);
+  size_t println(const String &);
+  size_t println(int, int = 10);
+  size_t println(unsigned int, int = 10);
+  size_t println(long, int = 10);
+  size_t println(unsigned long, int = 10);
+  size_t println();
+};
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  size_t readBytes(uint8_t *, size_t);
+  size_t readBytes(char *, size_t);
+  void setTimeout(unsigned long);
+};
+class IPAddress {
+public:
+  IPAddress();
+  IPAddress(uint32_t);
+  IPAddress(uint8_t, uint8_t, uint8_t, uint8_t);
+  operator uint32_t() const;
+  String toString() const;
+  bool operator==(const IPAddress &) const;
+  uint8_t operator[](int) const;
+private:
+  uint32_t _address;
+};
+class HardwareSerial : public Stream {
+public:
+  size_t write(uint8_t) override;
+  size_t write(const uint8_t *, size_t) override;
+  using Print::write;
+  int available() override; int read() override; int peek() override;
+  int availableForWrite() override;
+  void begin(unsigned long);
+  void onReceive(std::function<void(void)>, bool = false);
+  operator bool() const;
+protected:
+  int _uart_nr;
+  struct uart_struct_t * _uart;
+};
+extern HardwareSerial Serial;
+class ESPClass { public: void restart(); uint32_t getFreeHeap(); uint32_t getMinFreeHeap(); uint32_t getMaxAllocHeap(); };
+extern ESPClass ESP;
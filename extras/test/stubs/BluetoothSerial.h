@@ -0,0 +1,9 @@
+#pragma once
+#include <Arduino.h>
+class BluetoothSerial : public Stream {
+public:
+  size_t write(uint8_t) override; size_t write(const uint8_t *, size_t) override;
+  using Print::write;
+  int available() override; int read() override; int peek() override;
+  bool begin(const char *); bool hasClient(); bool disconnect(); void getBtAddress(uint8_t *);
+};
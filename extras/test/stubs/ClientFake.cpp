@@ -0,0 +1,187 @@
+/**********************************************************************
+  ClientFake.cpp
+
+  Robots-For-All (R4A)
+  Host model of a network client with scripted input
+
+  Every NetworkClient reads the string passed to clientFakeInput and
+  counts the output bytes without saving them.  The routines do not
+  allocate memory to allow the allocation tests to use them.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+#include "ClientFake.h"
+
+//****************************************
+// Globals
+//****************************************
+
+uint64_t clientFakeOutputBytes; // Bytes written by the NetworkClients
+
+//****************************************
+// Locals
+//****************************************
+
+static const char * clientFakeData = ""; // Input not yet read
+
+//*********************************************************************
+// Set the data returned by the NetworkClient reads
+void clientFakeInput(const char * data)
+{
+    clientFakeData = data;
+}
+
+//****************************************
+// IPAddress
+//****************************************
+
+//*********************************************************************
+IPAddress::IPAddress() : _address{0}
+{
+}
+
+//*********************************************************************
+IPAddress::IPAddress(uint32_t address) : _address{address}
+{
+}
+
+//*********************************************************************
+IPAddress::IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    : _address{(uint32_t)(a | (b << 8) | (c << 16) | (d << 24))}
+{
+}
+
+//*********************************************************************
+IPAddress::operator uint32_t() const
+{
+    return _address;
+}
+
+//*********************************************************************
+bool IPAddress::operator==(const IPAddress & address) const
+{
+    return _address == address._address;
+}
+
+//*********************************************************************
+uint8_t IPAddress::operator[](int index) const
+{
+    return _address >> (index * 8);
+}
+
+//*********************************************************************
+String IPAddress::toString() const
+{
+    char string[16];
+
+    snprintf(string, sizeof(string), "%d.%d.%d.%d",
+             _address & 0xff, (_address >> 8) & 0xff,
+             (_address >> 16) & 0xff, _address >> 24);
+    return String(string);
+}
+
+//****************************************
+// NetworkClient
+//****************************************
+
+//*********************************************************************
+NetworkClient::NetworkClient()
+{
+}
+
+//*********************************************************************
+int NetworkClient::available()
+{
+    return strlen(clientFakeData);
+}
+
+//*********************************************************************
+int NetworkClient::connect(const char * host, uint16_t port)
+{
+    return 1;
+}
+
+//*********************************************************************
+int NetworkClient::connect(IPAddress address, uint16_t port)
+{
+    return 1;
+}
+
+//*********************************************************************
+uint8_t NetworkClient::connected()
+{
+    return 1;
+}
+
+//*********************************************************************
+int NetworkClient::fd() const
+{
+    return -1;
+}
+
+//*********************************************************************
+NetworkClient::operator bool()
+{
+    return true;
+}
+
+//*********************************************************************
+int NetworkClient::peek()
+{
+    return *clientFakeData ? (uint8_t)*clientFakeData : -1;
+}
+
+//*********************************************************************
+int NetworkClient::read()
+{
+    if (!*clientFakeData)
+        return -1;
+    return (uint8_t)*clientFakeData++;
+}
+
+//*********************************************************************
+int NetworkClient::read(uint8_t * buffer, size_t length)
+{
+    size_t bytes;
+
+    bytes = 0;
+    while ((bytes < length) && *clientFakeData)
+        buffer[bytes++] = (uint8_t)*clientFakeData++;
+    return bytes;
+}
+
+//*********************************************************************
+IPAddress NetworkClient::remoteIP()
+{
+    return IPAddress(127, 0, 0, 1);
+}
+
+//*********************************************************************
+uint16_t NetworkClient::remotePort()
+{
+    return 23;
+}
+
+//*********************************************************************
+int NetworkClient::setNoDelay(bool noDelay)
+{
+    return 0;
+}
+
+//*********************************************************************
+void NetworkClient::stop()
+{
+}
+
+//*********************************************************************
+size_t NetworkClient::write(uint8_t data)
+{
+    return write(&data, 1);
+}
+
+//*********************************************************************
+size_t NetworkClient::write(const uint8_t * buffer, size_t length)
+{
+    clientFakeOutputBytes += length;
+    return length;
+}
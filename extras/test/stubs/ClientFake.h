@@ -0,0 +1,10 @@
+// Host model of a network client with scripted input, see ClientFake.cpp
+#pragma once
+#include <Network.h>
+
+// Set the data returned by the NetworkClient reads
+// Inputs:
+//   data: Zero terminated string, must remain valid until read
+void clientFakeInput(const char * data);
+
+extern uint64_t clientFakeOutputBytes; // Bytes written by the NetworkClients
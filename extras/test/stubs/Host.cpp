@@ -0,0 +1,670 @@
+/**********************************************************************
+  Host.cpp
+
+  Robots-For-All (R4A)
+  Host implementation of the Arduino ESP32 routines used by the tests
+
+  Time comes from the steady clock, the tasks run as threads and the
+  critical sections are recursive spin locks.  Serial writes to stdout.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+#include "Host.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+//****************************************
+// Types
+//****************************************
+
+// Task state, the notification count implements xTaskNotifyGive
+typedef struct _HOST_TASK
+{
+    std::condition_variable condition;
+    std::mutex mutex;
+    const char * name;
+    uint32_t notifications;
+} HOST_TASK;
+
+// Queue state, each item is a copy of the bytes passed to xQueueSend
+typedef struct _HOST_QUEUE
+{
+    std::condition_variable condition;
+    std::deque<std::string> items;
+    UBaseType_t itemSize;
+    UBaseType_t length;
+    std::mutex mutex;
+} HOST_QUEUE;
+
+//****************************************
+// Globals
+//****************************************
+
+ESPClass ESP;
+bool hostStartTasks = true;
+HardwareSerial Serial;
+
+//****************************************
+// Locals
+//****************************************
+
+static std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+static thread_local HOST_TASK * hostTask;
+static thread_local std::unique_ptr<HOST_TASK> hostThreadTask; // Freed at thread exit
+
+//*********************************************************************
+// Get the current task, allocate the state for the threads not started
+// by xTaskCreatePinnedToCore
+static HOST_TASK * hostCurrentTask()
+{
+    if (!hostTask)
+    {
+        hostThreadTask.reset(new HOST_TASK);
+        hostTask = hostThreadTask.get();
+        hostTask->name = "main";
+        hostTask->notifications = 0;
+    }
+    return hostTask;
+}
+
+//****************************************
+// Time
+//****************************************
+
+//*********************************************************************
+int64_t esp_timer_get_time()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - hostStart).count();
+}
+
+//*********************************************************************
+uint32_t micros()
+{
+    return (uint32_t)esp_timer_get_time();
+}
+
+//*********************************************************************
+uint32_t millis()
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+//*********************************************************************
+void delay(uint32_t msec)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(msec));
+}
+
+//*********************************************************************
+void delayMicroseconds(uint32_t usec)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(usec));
+}
+
+//*********************************************************************
+void yield()
+{
+    std::this_thread::yield();
+}
+
+//****************************************
+// Critical sections
+//****************************************
+
+//*********************************************************************
+void portENTER_CRITICAL(portMUX_TYPE * mux)
+{
+    int expected;
+    int self;
+
+    // The owner is a per-thread value, the lock is recursive
+    self = (int)(intptr_t)hostCurrentTask();
+    if (mux->owner == self)
+    {
+        mux->count += 1;
+        return;
+    }
+    do
+    {
+        expected = 0;
+    } while (!__atomic_compare_exchange_n(&mux->owner, &expected, self, false,
+                                          __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+    mux->count = 1;
+}
+
+//*********************************************************************
+void portEXIT_CRITICAL(portMUX_TYPE * mux)
+{
+    mux->count -= 1;
+    if (!mux->count)
+        __atomic_store_n(&mux->owner, 0, __ATOMIC_RELEASE);
+}
+
+//****************************************
+// Queues
+//****************************************
+
+//*********************************************************************
+void vQueueDelete(QueueHandle_t handle)
+{
+    delete (HOST_QUEUE *)handle;
+}
+
+//*********************************************************************
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    HOST_QUEUE * queue;
+
+    queue = new HOST_QUEUE;
+    queue->itemSize = itemSize;
+    queue->length = length;
+    return queue;
+}
+
+//*********************************************************************
+BaseType_t xQueueReceive(QueueHandle_t handle, void * item, TickType_t ticks)
+{
+    HOST_QUEUE * queue;
+
+    queue = (HOST_QUEUE *)handle;
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (ticks == portMAX_DELAY)
+        queue->condition.wait(lock, [queue] { return !queue->items.empty(); });
+    else if (ticks)
+        queue->condition.wait_for(lock, std::chrono::milliseconds(ticks),
+                                  [queue] { return !queue->items.empty(); });
+    if (queue->items.empty())
+        return pdFALSE;
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    return pdTRUE;
+}
+
+//*********************************************************************
+BaseType_t xQueueReset(QueueHandle_t handle)
+{
+    HOST_QUEUE * queue;
+
+    queue = (HOST_QUEUE *)handle;
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->items.clear();
+    return pdPASS;
+}
+
+//*********************************************************************
+BaseType_t xQueueSend(QueueHandle_t handle, const void * item, TickType_t ticks)
+{
+    HOST_QUEUE * queue;
+
+    // The host queues never wait for space
+    queue = (HOST_QUEUE *)handle;
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (queue->items.size() >= queue->length)
+            return pdFALSE;
+        queue->items.emplace_back((const char *)item, queue->itemSize);
+    }
+    queue->condition.notify_one();
+    return pdTRUE;
+}
+
+//****************************************
+// Tasks
+//****************************************
+
+//*********************************************************************
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t routine,
+                                   const char * name,
+                                   uint32_t stackBytes,
+                                   void * parameter,
+                                   UBaseType_t priority,
+                                   TaskHandle_t * handle,
+                                   BaseType_t core)
+{
+    HOST_TASK * task;
+
+    task = new HOST_TASK;
+    task->name = name;
+    task->notifications = 0;
+    if (handle)
+        *handle = task;
+    if (!hostStartTasks)
+        return pdPASS;
+    std::thread([routine, parameter, task]()
+    {
+        hostTask = task;
+        routine(parameter);
+    }).detach();
+    return pdPASS;
+}
+
+//*********************************************************************
+const char * pcTaskGetName(TaskHandle_t task)
+{
+    return task ? ((HOST_TASK *)task)->name : hostCurrentTask()->name;
+}
+
+//*********************************************************************
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    return 0;
+}
+
+//*********************************************************************
+uint32_t ulTaskNotifyTake(BaseType_t clearCount, TickType_t ticks)
+{
+    uint32_t count;
+    HOST_TASK * task;
+
+    task = hostCurrentTask();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    if (ticks == portMAX_DELAY)
+        task->condition.wait(lock, [task] { return task->notifications != 0; });
+    else
+        task->condition.wait_for(lock, std::chrono::milliseconds(ticks),
+                                 [task] { return task->notifications != 0; });
+    count = task->notifications;
+    if (count)
+        task->notifications = clearCount ? 0 : count - 1;
+    return count;
+}
+
+//*********************************************************************
+void vTaskDelay(TickType_t ticks)
+{
+    delay(ticks);
+}
+
+//*********************************************************************
+void vTaskDelete(TaskHandle_t task)
+{
+}
+
+//*********************************************************************
+BaseType_t xPortGetCoreID()
+{
+    return 0;
+}
+
+//*********************************************************************
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return hostCurrentTask();
+}
+
+//*********************************************************************
+BaseType_t xTaskNotifyGive(TaskHandle_t handle)
+{
+    HOST_TASK * task;
+
+    task = (HOST_TASK *)handle;
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->notifications += 1;
+    }
+    task->condition.notify_one();
+    return pdPASS;
+}
+
+//****************************************
+// Heap
+//****************************************
+
+//*********************************************************************
+void * heap_caps_malloc(size_t length, uint32_t caps)
+{
+    return malloc(length);
+}
+
+//*********************************************************************
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return 0;
+}
+
+//*********************************************************************
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return 0;
+}
+
+//*********************************************************************
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    return 0;
+}
+
+//*********************************************************************
+uint32_t ESPClass::getFreeHeap()
+{
+    return 0;
+}
+
+//*********************************************************************
+uint32_t ESPClass::getMaxAllocHeap()
+{
+    return 0;
+}
+
+//*********************************************************************
+uint32_t ESPClass::getMinFreeHeap()
+{
+    return 0;
+}
+
+//****************************************
+// Print
+//****************************************
+
+//*********************************************************************
+size_t Print::write(const uint8_t * buffer, size_t size)
+{
+    size_t count;
+
+    for (count = 0; count < size; count++)
+        if (!write(buffer[count]))
+            break;
+    return count;
+}
+
+//*********************************************************************
+size_t Print::printf(const char * format, ...)
+{
+    va_list args;
+    char buffer[256];
+    int length;
+
+    va_start(args, format);
+    length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0)
+        return 0;
+    if (length >= (int)sizeof(buffer))
+        length = sizeof(buffer) - 1;
+    return write((const uint8_t *)buffer, length);
+}
+
+//*********************************************************************
+size_t Print::print(const char * string)
+{
+    return write(string);
+}
+
+//*********************************************************************
+size_t Print::print(char character)
+{
+    return write((uint8_t)character);
+}
+
+//*********************************************************************
+size_t Print::print(int value, int base)
+{
+    return print((long)value, base);
+}
+
+//*********************************************************************
+size_t Print::print(unsigned int value, int base)
+{
+    return print((unsigned long)value, base);
+}
+
+//*********************************************************************
+size_t Print::print(long value, int base)
+{
+    return (base == 16) ? printf("%lx", value) : printf("%ld", value);
+}
+
+//*********************************************************************
+size_t Print::print(unsigned long value, int base)
+{
+    return (base == 16) ? printf("%lx", value) : printf("%lu", value);
+}
+
+//*********************************************************************
+size_t Print::println()
+{
+    return write("\r\n");
+}
+
+//*********************************************************************
+size_t Print::println(const char * string)
+{
+    return print(string) + println();
+}
+
+//*********************************************************************
+size_t Print::println(int value, int base)
+{
+    return print(value, base) + println();
+}
+
+//*********************************************************************
+size_t Print::println(unsigned int value, int base)
+{
+    return print(value, base) + println();
+}
+
+//*********************************************************************
+size_t Print::println(long value, int base)
+{
+    return print(value, base) + println();
+}
+
+//*********************************************************************
+size_t Print::println(unsigned long value, int base)
+{
+    return print(value, base) + println();
+}
+
+//****************************************
+// Serial, output to stdout, no input
+//****************************************
+
+//*********************************************************************
+HardwareSerial::operator bool() const
+{
+    return true;
+}
+
+//*********************************************************************
+int HardwareSerial::available()
+{
+    return 0;
+}
+
+//*********************************************************************
+int HardwareSerial::availableForWrite()
+{
+    return 4096;
+}
+
+//*********************************************************************
+void HardwareSerial::begin(unsigned long baudRate)
+{
+}
+
+//*********************************************************************
+int HardwareSerial::peek()
+{
+    return -1;
+}
+
+//*********************************************************************
+int HardwareSerial::read()
+{
+    return -1;
+}
+
+//*********************************************************************
+size_t HardwareSerial::write(uint8_t data)
+{
+    return write(&data, 1);
+}
+
+//*********************************************************************
+size_t HardwareSerial::write(const uint8_t * buffer, size_t length)
+{
+    return fwrite(buffer, 1, length, stdout);
+}
+
+//****************************************
+// String, allocated with malloc to allow the allocation tests to count
+// the String allocations
+//****************************************
+
+//*********************************************************************
+String::String(const char * string) : _buffer{nullptr}
+{
+    assign(string, strlen(string));
+}
+
+//*********************************************************************
+String::String(const String & string) : _buffer{nullptr}
+{
+    assign(string.c_str(), string.length());
+}
+
+//*********************************************************************
+String::String(char character) : _buffer{nullptr}
+{
+    assign(&character, 1);
+}
+
+//*********************************************************************
+String::~String()
+{
+    free(_buffer);
+}
+
+//*********************************************************************
+void String::append(const char * data, size_t length)
+{
+    size_t previous;
+
+    previous = this->length();
+    _buffer = (char *)realloc(_buffer, previous + length + 1);
+    memcpy(&_buffer[previous], data, length);
+    _buffer[previous + length] = 0;
+}
+
+//*********************************************************************
+void String::assign(const char * data, size_t length)
+{
+    char * buffer;
+
+    buffer = (char *)malloc(length + 1);
+    memcpy(buffer, data, length);
+    buffer[length] = 0;
+    free(_buffer);
+    _buffer = buffer;
+}
+
+//*********************************************************************
+const char * String::c_str() const
+{
+    return _buffer ? _buffer : "";
+}
+
+//*********************************************************************
+unsigned int String::length() const
+{
+    return _buffer ? strlen(_buffer) : 0;
+}
+
+//*********************************************************************
+String & String::operator=(const String & string)
+{
+    if (this != &string)
+        assign(string.c_str(), string.length());
+    return *this;
+}
+
+//*********************************************************************
+String & String::operator=(const char * string)
+{
+    assign(string, strlen(string));
+    return *this;
+}
+
+//*********************************************************************
+String & String::operator+=(const char * string)
+{
+    append(string, strlen(string));
+    return *this;
+}
+
+//*********************************************************************
+String & String::operator+=(char character)
+{
+    append(&character, 1);
+    return *this;
+}
+
+//*********************************************************************
+String & String::operator+=(const String & string)
+{
+    append(string.c_str(), string.length());
+    return *this;
+}
+
+//*********************************************************************
+String String::substring(unsigned int start, unsigned int end) const
+{
+    String string;
+
+    if ((end > length()) || (start > end))
+        return string;
+    string.assign(&c_str()[start], end - start);
+    return string;
+}
+
+//*********************************************************************
+void String::toCharArray(char * buffer, unsigned int length) const
+{
+    if (!length)
+        return;
+    strncpy(buffer, c_str(), length - 1);
+    buffer[length - 1] = 0;
+}
+
+//*********************************************************************
+void String::trim()
+{
+    const char * end;
+    const char * start;
+
+    start = c_str();
+    while (isspace((uint8_t)*start))
+        start++;
+    end = start + strlen(start);
+    while ((end > start) && isspace((uint8_t)end[-1]))
+        end--;
+    assign(start, end - start);
+}
+
+//****************************************
+// Board support library
+//****************************************
+
+//*********************************************************************
+const char * esp_err_to_name(esp_err_t code)
+{
+    static char name[16];
+
+    snprintf(name, sizeof(name), "0x%x", code);
+    return name;
+}
+
+//*********************************************************************
+// Serial.cpp replaces this routine in the tests that link it
+__attribute__((weak)) void r4aReportFatalError(const char * errorMessage, Print * display)
+{
+    display->printf("ERROR: %s\r\n", errorMessage);
+    abort();
+}
@@ -0,0 +1,41 @@
+// Test controls for the host implementation, see Host.cpp
+#pragma once
+
+// Start the tasks created by xTaskCreatePinnedToCore, false creates the
+// task handle without running the task, allowing a test to call the
+// task's work routine directly
+extern bool hostStartTasks;
+
+#include <Arduino.h>
+#include <mutex>
+#include <string>
+
+// Print device saving the output for the test to verify
+class HostCapture : public Print
+{
+  public:
+
+    std::mutex mutex;
+    std::string text;
+
+    // Discard the saved output
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        text.clear();
+    }
+
+    size_t write(uint8_t data) override
+    {
+        return write(&data, 1);
+    }
+
+    size_t write(const uint8_t * buffer, size_t length) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        text.append((const char *)buffer, length);
+        return length;
+    }
+
+    using Print::write;
+};
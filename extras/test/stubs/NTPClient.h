@@ -0,0 +1,3 @@
+#pragma once
+#include <Network.h>
+class NTPClient { public: NTPClient(NetworkUDP &); void begin(); bool update(); bool isTimeSet(); unsigned long getEpochTime(); String getFormattedTime(); int getHours(); int getMinutes(); int getSeconds(); void setTimeOffset(long); };
@@ -0,0 +1,42 @@
+#pragma once
+#include <Arduino.h>
+#include "NetworkEvents.h"
+class Client : public Stream {
+public:
+  virtual int connect(const char *, uint16_t) = 0;
+  virtual int read(uint8_t *, size_t) = 0;
+  virtual void stop() = 0;
+  virtual uint8_t connected() = 0;
+  using Stream::read;
+};
+class NetworkClient : public Client {
+public:
+  NetworkClient();
+  int connect(const char *, uint16_t) override;
+  int connect(IPAddress, uint16_t);
+  size_t write(uint8_t) override; size_t write(const uint8_t *, size_t) override;
+  using Print::write;
+  int available() override; int read() override; int peek() override;
+  int read(uint8_t *, size_t) override;
+  void stop() override; uint8_t connected() override;
+  IPAddress remoteIP(); uint16_t remotePort();
+  operator bool();
+  int setNoDelay(bool);
+  int fd() const;
+};
+class NetworkServer {
+public:
+  NetworkServer(uint16_t port);
+  void begin(); void setNoDelay(bool); bool hasClient(); NetworkClient accept();
+};
+class NetworkUDP : public Stream {
+public:
+  uint8_t begin(uint16_t); void stop();
+  int parsePacket(); int read(uint8_t *, size_t); int read(char *, size_t);
+  size_t write(uint8_t) override; size_t write(const uint8_t *, size_t) override;
+  int available() override; int read() override; int peek() override;
+  IPAddress remoteIP(); uint16_t remotePort(); void flush() override;
+  int beginPacket(IPAddress, uint16_t); int endPacket();
+};
+class NetworkManager : public NetworkEvents { public: bool begin(); };
+extern NetworkManager Network;
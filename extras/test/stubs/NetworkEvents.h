@@ -0,0 +1,21 @@
+#pragma once
+#include <Arduino.h>
+typedef enum { ARDUINO_EVENT_NONE, ARDUINO_EVENT_ETH_CONNECTED, ARDUINO_EVENT_ETH_DISCONNECTED, ARDUINO_EVENT_ETH_GOT_IP, ARDUINO_EVENT_ETH_LOST_IP,
+ ARDUINO_EVENT_ETH_STOP, ARDUINO_EVENT_WIFI_STA_CONNECTED, ARDUINO_EVENT_WIFI_STA_DISCONNECTED, ARDUINO_EVENT_WIFI_STA_GOT_IP, ARDUINO_EVENT_WIFI_STA_LOST_IP, ARDUINO_EVENT_WIFI_STA_STOP,
+ ARDUINO_EVENT_PPP_GOT_IP, ARDUINO_EVENT_PPP_LOST_IP, ARDUINO_EVENT_PPP_DISCONNECTED, ARDUINO_EVENT_MAX } arduino_event_id_t;
+typedef struct { uint8_t bssid[6]; uint8_t channel; uint8_t ssid[33]; uint8_t ssid_len; } wifi_event_sta_connected_t;
+typedef struct { uint32_t ip; } esp_ip4_addr_t;
+typedef struct { esp_ip4_addr_t ip, netmask, gw; } esp_netif_ip_info_t;
+typedef struct { esp_netif_ip_info_t ip_info; } ip_event_got_ip_t;
+typedef union { wifi_event_sta_connected_t wifi_sta_connected; ip_event_got_ip_t got_ip; } arduino_event_info_t;
+typedef struct { arduino_event_id_t event_id; arduino_event_info_t event_info; } arduino_event_t;
+typedef size_t network_event_handle_t;
+typedef void (*NetworkEventCb)(arduino_event_id_t event);
+typedef std::function<void(arduino_event_id_t event, arduino_event_info_t info)> NetworkEventFuncCb;
+typedef void (*NetworkEventSysCb)(arduino_event_t *event);
+class NetworkEvents { public:
+  network_event_handle_t onEvent(NetworkEventCb, arduino_event_id_t = ARDUINO_EVENT_MAX);
+  network_event_handle_t onEvent(NetworkEventFuncCb, arduino_event_id_t = ARDUINO_EVENT_MAX);
+  network_event_handle_t onEvent(NetworkEventSysCb, arduino_event_id_t = ARDUINO_EVENT_MAX);
+  void removeEvent(network_event_handle_t); const char * eventName(arduino_event_id_t);
+};
@@ -0,0 +1,187 @@
+/**********************************************************************
+  NtpFake.cpp
+
+  Robots-For-All (R4A)
+  Host stand-ins for the NTP client, TimeLib and the UDP port
+
+  The NTP client always reports NTP_FAKE_SECONDS and TimeLib converts
+  the seconds using UTC.  The link generation normally maintained by
+  Link.cpp stays zero, the link is down.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Constants
+//****************************************
+
+#define NTP_FAKE_SECONDS    1700000000  // Tue Nov 14 22:13:20 2023 UTC
+
+//****************************************
+// Globals
+//****************************************
+
+volatile uint32_t r4aLinkGenerationCount; // Link is down
+
+//*********************************************************************
+// Convert the seconds into the date and time
+// Inputs:
+//   seconds: Number of seconds since 1 Jan 1970
+// Outputs:
+//   Returns the date and time in UTC
+static struct tm timeLibConvert(time_t seconds)
+{
+    struct tm dateTime;
+
+    gmtime_r(&seconds, &dateTime);
+    return dateTime;
+}
+
+//****************************************
+// TimeLib
+//****************************************
+
+//*********************************************************************
+int day(time_t seconds)
+{
+    return timeLibConvert(seconds).tm_mday;
+}
+
+//*********************************************************************
+int hour(time_t seconds)
+{
+    return timeLibConvert(seconds).tm_hour;
+}
+
+//*********************************************************************
+int hourFormat12(time_t seconds)
+{
+    int hours;
+
+    hours = hour(seconds) % 12;
+    return hours ? hours : 12;
+}
+
+//*********************************************************************
+bool isAM(time_t seconds)
+{
+    return hour(seconds) < 12;
+}
+
+//*********************************************************************
+int minute(time_t seconds)
+{
+    return timeLibConvert(seconds).tm_min;
+}
+
+//*********************************************************************
+int month(time_t seconds)
+{
+    return timeLibConvert(seconds).tm_mon + 1;
+}
+
+//*********************************************************************
+int second(time_t seconds)
+{
+    return timeLibConvert(seconds).tm_sec;
+}
+
+//*********************************************************************
+int year(time_t seconds)
+{
+    return timeLibConvert(seconds).tm_year + 1900;
+}
+
+//****************************************
+// NTPClient
+//****************************************
+
+//*********************************************************************
+NTPClient::NTPClient(NetworkUDP & udp)
+{
+}
+
+//*********************************************************************
+void NTPClient::begin()
+{
+}
+
+//*********************************************************************
+unsigned long NTPClient::getEpochTime()
+{
+    return NTP_FAKE_SECONDS;
+}
+
+//*********************************************************************
+int NTPClient::getHours()
+{
+    return hour(NTP_FAKE_SECONDS);
+}
+
+//*********************************************************************
+int NTPClient::getMinutes()
+{
+    return minute(NTP_FAKE_SECONDS);
+}
+
+//*********************************************************************
+int NTPClient::getSeconds()
+{
+    return second(NTP_FAKE_SECONDS);
+}
+
+//*********************************************************************
+bool NTPClient::isTimeSet()
+{
+    return true;
+}
+
+//*********************************************************************
+void NTPClient::setTimeOffset(long seconds)
+{
+}
+
+//*********************************************************************
+bool NTPClient::update()
+{
+    return true;
+}
+
+//****************************************
+// NetworkUDP, no packets are received
+//****************************************
+
+//*********************************************************************
+int NetworkUDP::available()
+{
+    return 0;
+}
+
+//*********************************************************************
+void NetworkUDP::flush()
+{
+}
+
+//*********************************************************************
+int NetworkUDP::peek()
+{
+    return -1;
+}
+
+//*********************************************************************
+int NetworkUDP::read()
+{
+    return -1;
+}
+
+//*********************************************************************
+size_t NetworkUDP::write(uint8_t data)
+{
+    return 1;
+}
+
+//*********************************************************************
+size_t NetworkUDP::write(const uint8_t * buffer, size_t length)
+{
+    return length;
+}
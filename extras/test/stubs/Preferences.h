@@ -0,0 +1,23 @@
+#pragma once
+#include <Arduino.h>
+class Preferences {
+public:
+  bool begin(const char * name, bool readOnly = false, const char * partition = nullptr);
+  void end();
+  bool clear();
+  bool remove(const char * key);
+  bool isKey(const char * key);
+  size_t putBool(const char * key, bool value);
+  size_t putChar(const char * key, int8_t value);
+  size_t putUChar(const char * key, uint8_t value);
+  size_t putUShort(const char * key, uint16_t value);
+  size_t putULong(const char * key, uint32_t value);
+  size_t putString(const char * key, const char * value);
+  bool getBool(const char * key, bool defaultValue = false);
+  int8_t getChar(const char * key, int8_t defaultValue = 0);
+  uint8_t getUChar(const char * key, uint8_t defaultValue = 0);
+  uint16_t getUShort(const char * key, uint16_t defaultValue = 0);
+  uint32_t getULong(const char * key, uint32_t defaultValue = 0);
+  size_t getString(const char * key, char * value, size_t maxLen);
+  String getString(const char * key, String defaultValue = String());
+};
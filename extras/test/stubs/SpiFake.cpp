@@ -0,0 +1,168 @@
+/**********************************************************************
+  SpiFake.cpp
+
+  Robots-For-All (R4A)
+  Host model of the ESP-IDF SPI master driver
+
+  Each queued transaction occupies the bus for the time needed to shift
+  its bits at the device clock plus a fixed setup time.  The transmit
+  data is looped back to the receive buffer when the transaction
+  completes.  The base R4A_SPI routines, supplied by the board support
+  library on the target, perform blocking transfers using this model.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+#include "SpiFake.h"
+
+//****************************************
+// Types
+//****************************************
+
+struct spi_device_t
+{
+    uint32_t busyUntilUsec;     // Time when the bus becomes idle
+    int clockHz;                // SPI clock frequency
+    uint32_t completeUsec[SPI_FAKE_QUEUE_MAX]; // Completion times
+    int count;                  // Transactions in the queue
+    int head;                   // Oldest transaction
+    int queueSize;              // Driver queue depth
+    spi_transaction_t * queue[SPI_FAKE_QUEUE_MAX]; // Queued transactions
+};
+
+//****************************************
+// Globals
+//****************************************
+
+int spiFakeMaxQueued;           // Largest number of queued transactions
+uint32_t spiFakeSetupUsec = 10; // Driver overhead for each transaction
+
+//****************************************
+// Locals
+//****************************************
+
+static spi_device_t spiFakeDevice;
+static spi_device_handle_t spiFakeBlockingDevice;
+
+//*********************************************************************
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, spi_dma_chan_t dma_chan)
+{
+    return ESP_OK;
+}
+
+//*********************************************************************
+esp_err_t spi_bus_free(spi_host_device_t host_id)
+{
+    return ESP_OK;
+}
+
+//*********************************************************************
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config, spi_device_handle_t *handle)
+{
+    if ((dev_config->queue_size < 1) || (dev_config->queue_size > SPI_FAKE_QUEUE_MAX))
+        return ESP_ERR_INVALID_ARG;
+    memset(&spiFakeDevice, 0, sizeof(spiFakeDevice));
+    spiFakeDevice.clockHz = dev_config->clock_speed_hz;
+    spiFakeDevice.queueSize = dev_config->queue_size;
+    spiFakeMaxQueued = 0;
+    *handle = &spiFakeDevice;
+    return ESP_OK;
+}
+
+//*********************************************************************
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans_desc, TickType_t ticks_to_wait)
+{
+    uint32_t currentUsec;
+    int tail;
+
+    if (handle->count >= handle->queueSize)
+        return ESP_ERR_TIMEOUT;
+
+    // The transaction starts when the previous transaction completes
+    currentUsec = micros();
+    if ((!handle->count) || ((int32_t)(currentUsec - handle->busyUntilUsec) > 0))
+        handle->busyUntilUsec = currentUsec;
+    handle->busyUntilUsec += spiFakeSetupUsec
+                          + (uint32_t)(((uint64_t)trans_desc->length * 1000 * 1000) / handle->clockHz);
+    tail = (handle->head + handle->count) % SPI_FAKE_QUEUE_MAX;
+    handle->queue[tail] = trans_desc;
+    handle->completeUsec[tail] = handle->busyUntilUsec;
+    handle->count += 1;
+    if (spiFakeMaxQueued < handle->count)
+        spiFakeMaxQueued = handle->count;
+    return ESP_OK;
+}
+
+//*********************************************************************
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans_desc, TickType_t ticks_to_wait)
+{
+    int32_t deltaUsec;
+    spi_transaction_t * transaction;
+
+    if (!handle->count)
+        return ESP_ERR_TIMEOUT;
+
+    // Wait for the oldest transaction to complete
+    deltaUsec = (int32_t)(handle->completeUsec[handle->head] - micros());
+    if (deltaUsec > 0)
+    {
+        if (ticks_to_wait == 0)
+            return ESP_ERR_TIMEOUT;
+        delayMicroseconds(deltaUsec);
+    }
+
+    // Loop the transmit data back to the receive buffer
+    transaction = handle->queue[handle->head];
+    if (transaction->rx_buffer)
+        memcpy(transaction->rx_buffer, transaction->tx_buffer, transaction->length / 8);
+    handle->head = (handle->head + 1) % SPI_FAKE_QUEUE_MAX;
+    handle->count -= 1;
+    *trans_desc = transaction;
+    return ESP_OK;
+}
+
+//*********************************************************************
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc)
+{
+    esp_err_t status;
+    spi_transaction_t * transaction;
+
+    status = spi_device_queue_trans(handle, trans_desc, portMAX_DELAY);
+    if (status == ESP_OK)
+        status = spi_device_get_trans_result(handle, &transaction, portMAX_DELAY);
+    return status;
+}
+
+//****************************************
+// Blocking R4A_SPI, supplied by the board support library on the target
+//****************************************
+
+//*********************************************************************
+uint8_t * R4A_SPI::allocateDmaBuffer(int length)
+{
+    return (uint8_t *)malloc(length);
+}
+
+//*********************************************************************
+bool R4A_SPI::begin(uint8_t spiNumber, uint8_t pinMOSI, uint32_t clockHz)
+{
+    spi_device_interface_config_t deviceConfig;
+
+    memset(&deviceConfig, 0, sizeof(deviceConfig));
+    deviceConfig.clock_speed_hz = clockHz;
+    deviceConfig.queue_size = 1;
+    return spi_bus_add_device(SPI2_HOST, &deviceConfig, &spiFakeBlockingDevice) == ESP_OK;
+}
+
+//*********************************************************************
+void R4A_SPI::transfer(const uint8_t * txBuffer,
+                       uint8_t * rxBuffer,
+                       uint32_t length)
+{
+    spi_transaction_t descriptor;
+
+    memset(&descriptor, 0, sizeof(descriptor));
+    descriptor.length = length * 8;
+    descriptor.tx_buffer = txBuffer;
+    descriptor.rx_buffer = rxBuffer;
+    spi_device_transmit(spiFakeBlockingDevice, &descriptor);
+}
@@ -0,0 +1,8 @@
+// Host model of the ESP-IDF SPI master driver, see SpiFake.cpp
+#pragma once
+#include <stdint.h>
+
+#define SPI_FAKE_QUEUE_MAX  8       // Largest driver queue depth
+
+extern int spiFakeMaxQueued;        // Largest number of queued transactions
+extern uint32_t spiFakeSetupUsec;   // Driver overhead for each transaction
@@ -0,0 +1,3 @@
+#pragma once
+#include <time.h>
+int year(time_t); int month(time_t); int day(time_t); int hour(time_t); int hourFormat12(time_t); int minute(time_t); int second(time_t); bool isAM(time_t);
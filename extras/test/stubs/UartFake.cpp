@@ -0,0 +1,399 @@
+/**********************************************************************
+  UartFake.cpp
+
+  Robots-For-All (R4A)
+  Host model of the ESP-IDF UART driver using a pseudo terminal
+
+  The driver side of the pseudo terminal replaces the UART pins.  The
+  test writes to the terminal side as a terminal program would, and a
+  receive thread models the UART interrupt handler.  The thread fills
+  the receive buffer and records the position of each pattern character
+  in the pattern queue.  It sends a UART_PATTERN_DET event for each
+  pattern character, a UART_DATA event for the data without a pattern
+  and a UART_BUFFER_FULL event when the receive buffer is full.  Like
+  the driver, a pattern position is discarded when the pattern queue is
+  full, and uart_pattern_pop_pos then returns -1.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+#include "UartFake.h"
+#include <atomic>
+#include <deque>
+#include <fcntl.h>
+#include <mutex>
+#include <poll.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+//****************************************
+// Types
+//****************************************
+
+typedef struct _UART_FAKE
+{
+    int driver;                 // Driver side of the pseudo terminal
+    QueueHandle_t eventQueue;   // Driver events, nullptr when not used
+    bool installed;             // True when the driver is installed
+    std::mutex mutex;           // Synchronize with the receive thread
+    char pattern;               // Pattern character
+    bool patternEnabled;        // True when pattern detection is enabled
+    size_t patternMax;          // Size of the pattern queue
+    std::deque<uint64_t> patterns; // Pattern positions in received bytes
+    std::deque<uint8_t> rxBuffer; // Received data not yet read
+    size_t rxBytes;             // Size of the receive buffer
+    uint64_t rxDiscarded;       // Bytes read or flushed from the buffer
+    std::atomic<uint64_t> rxTotal; // Bytes received by the driver
+    std::thread rxThread;       // Models the receive interrupt
+    std::atomic<bool> stop;     // Stop the receive thread
+    int terminal;               // Terminal side of the pseudo terminal
+    int txBytes;                // Size of the transmit buffer
+} UART_FAKE;
+
+//****************************************
+// Locals
+//****************************************
+
+static UART_FAKE uartFake[UART_FAKE_PORTS];
+
+//*********************************************************************
+// Get the UART state
+// Inputs:
+//   port: UART number
+// Outputs:
+//   Returns the address of the state or nullptr when not installed
+static UART_FAKE * uartFakeGet(uart_port_t port)
+{
+    if ((port < 0) || (port >= UART_FAKE_PORTS) || (!uartFake[port].installed))
+        return nullptr;
+    return &uartFake[port];
+}
+
+//*********************************************************************
+// Send a driver event
+// Inputs:
+//   uart: Address of the UART state
+//   type: Event type
+//   size: Number of bytes associated with the event
+static void uartFakeEvent(UART_FAKE * uart, uart_event_type_t type, size_t size)
+{
+    uart_event_t event;
+
+    // The event is lost when the queue is full
+    if (uart->eventQueue)
+    {
+        memset(&event, 0, sizeof(event));
+        event.type = type;
+        event.size = size;
+        xQueueSend(uart->eventQueue, &event, 0);
+    }
+}
+
+//*********************************************************************
+// Receive the data written to the terminal
+// Inputs:
+//   uart: Address of the UART state
+static void uartFakeReceive(UART_FAKE * uart)
+{
+    uint8_t data[64];
+    int length;
+    bool pattern;
+    struct pollfd poller;
+
+    poller.fd = uart->driver;
+    poller.events = POLLIN;
+    while (!uart->stop)
+    {
+        if ((poll(&poller, 1, 10) <= 0) || !(poller.revents & POLLIN))
+            continue;
+        length = read(uart->driver, data, sizeof(data));
+        if (length <= 0)
+            continue;
+
+        // Model the receive interrupt
+        std::lock_guard<std::mutex> lock(uart->mutex);
+        pattern = false;
+        for (int index = 0; index < length; index++)
+        {
+            // The data is lost when the receive buffer is full
+            if (uart->rxBuffer.size() >= uart->rxBytes)
+            {
+                uartFakeEvent(uart, UART_BUFFER_FULL, length - index);
+                uart->rxTotal += length - index;
+                break;
+            }
+            uart->rxBuffer.push_back(data[index]);
+
+            // Record the pattern position
+            if (uart->patternEnabled && (data[index] == uart->pattern))
+            {
+                if (uart->patterns.size() < uart->patternMax)
+                    uart->patterns.push_back(uart->rxDiscarded + uart->rxBuffer.size() - 1);
+                uartFakeEvent(uart, UART_PATTERN_DET, uart->rxBuffer.size());
+                pattern = true;
+            }
+            uart->rxTotal += 1;
+        }
+        if (!pattern)
+            uartFakeEvent(uart, UART_DATA, length);
+    }
+}
+
+//*********************************************************************
+esp_err_t uart_driver_delete(uart_port_t port)
+{
+    UART_FAKE * uart;
+
+    uart = uartFakeGet(port);
+    if (!uart)
+        return ESP_ERR_INVALID_STATE;
+
+    // Stop the receive thread and close the pseudo terminal
+    uart->stop = true;
+    uart->rxThread.join();
+    close(uart->terminal);
+    close(uart->driver);
+    if (uart->eventQueue)
+        vQueueDelete(uart->eventQueue);
+    uart->installed = false;
+    return ESP_OK;
+}
+
+//*********************************************************************
+esp_err_t uart_driver_install(uart_port_t port,
+                              int rxBytes,
+                              int txBytes,
+                              int eventQueueSize,
+                              QueueHandle_t * eventQueue,
+                              int interruptFlags)
+{
+    struct termios settings;
+    UART_FAKE * uart;
+
+    if ((port < 0) || (port >= UART_FAKE_PORTS) || uartFake[port].installed)
+        return ESP_ERR_INVALID_ARG;
+    uart = &uartFake[port];
+
+    // Open the pseudo terminal, pass the bytes without changes
+    uart->driver = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((uart->driver < 0) || grantpt(uart->driver) || unlockpt(uart->driver))
+        return ESP_FAIL;
+    uart->terminal = open(ptsname(uart->driver), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (uart->terminal < 0)
+    {
+        close(uart->driver);
+        return ESP_FAIL;
+    }
+    tcgetattr(uart->terminal, &settings);
+    cfmakeraw(&settings);
+    tcsetattr(uart->terminal, TCSANOW, &settings);
+
+    // Initialize the driver state
+    uart->eventQueue = nullptr;
+    if (eventQueue && eventQueueSize)
+    {
+        uart->eventQueue = xQueueCreate(eventQueueSize, sizeof(uart_event_t));
+        *eventQueue = uart->eventQueue;
+    }
+    uart->patternEnabled = false;
+    uart->patternMax = 0;
+    uart->patterns.clear();
+    uart->rxBuffer.clear();
+    uart->rxBytes = rxBytes;
+    uart->rxDiscarded = 0;
+    uart->rxTotal = 0;
+    uart->stop = false;
+    uart->txBytes = txBytes;
+    uart->installed = true;
+    uart->rxThread = std::thread(uartFakeReceive, uart);
+    return ESP_OK;
+}
+
+//*********************************************************************
+esp_err_t uart_enable_pattern_det_baud_intr(uart_port_t port,
+                                            char pattern,
+                                            uint8_t count,
+                                            int characterTimeout,
+                                            int postIdle,
+                                            int preIdle)
+{
+    UART_FAKE * uart;
+
+    // Only single character patterns are modeled
+    uart = uartFakeGet(port);
+    if ((!uart) || (count != 1))
+        return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(uart->mutex);
+    uart->pattern = pattern;
+    uart->patternEnabled = true;
+    return ESP_OK;
+}
+
+//*********************************************************************
+esp_err_t uart_flush_input(uart_port_t port)
+{
+    UART_FAKE * uart;
+
+    uart = uartFakeGet(port);
+    if (!uart)
+        return ESP_ERR_INVALID_STATE;
+    std::lock_guard<std::mutex> lock(uart->mutex);
+    uart->rxDiscarded += uart->rxBuffer.size();
+    uart->rxBuffer.clear();
+    uart->patterns.clear();
+    return ESP_OK;
+}
+
+//*********************************************************************
+esp_err_t uart_get_tx_buffer_free_size(uart_port_t port, size_t * size)
+{
+    UART_FAKE * uart;
+
+    // The pseudo terminal accepts the data immediately
+    uart = uartFakeGet(port);
+    if (!uart)
+        return ESP_ERR_INVALID_STATE;
+    *size = uart->txBytes;
+    return ESP_OK;
+}
+
+//*********************************************************************
+bool uart_is_driver_installed(uart_port_t port)
+{
+    return (uartFakeGet(port) != nullptr);
+}
+
+//*********************************************************************
+esp_err_t uart_param_config(uart_port_t port, const uart_config_t * config)
+{
+    return uartFakeGet(port) ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+//*********************************************************************
+int uart_pattern_pop_pos(uart_port_t port)
+{
+    int position;
+    UART_FAKE * uart;
+
+    // Return the position relative to the next byte to read
+    uart = uartFakeGet(port);
+    if (!uart)
+        return -1;
+    std::lock_guard<std::mutex> lock(uart->mutex);
+    if (uart->patterns.empty())
+        return -1;
+    position = uart->patterns.front() - uart->rxDiscarded;
+    uart->patterns.pop_front();
+    return position;
+}
+
+//*********************************************************************
+esp_err_t uart_pattern_queue_reset(uart_port_t port, int queueLength)
+{
+    UART_FAKE * uart;
+
+    uart = uartFakeGet(port);
+    if (!uart)
+        return ESP_ERR_INVALID_STATE;
+    std::lock_guard<std::mutex> lock(uart->mutex);
+    uart->patternMax = queueLength;
+    uart->patterns.clear();
+    return ESP_OK;
+}
+
+//*********************************************************************
+int uart_read_bytes(uart_port_t port, void * buffer, uint32_t length, TickType_t ticks)
+{
+    uint32_t count;
+    uint32_t startMsec;
+    UART_FAKE * uart;
+
+    uart = uartFakeGet(port);
+    if (!uart)
+        return -1;
+
+    // Wait for the data
+    startMsec = millis();
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(uart->mutex);
+            count = std::min<size_t>(length, uart->rxBuffer.size());
+            if (count || ((millis() - startMsec) >= ticks))
+            {
+                std::copy_n(uart->rxBuffer.begin(), count, (uint8_t *)buffer);
+                uart->rxBuffer.erase(uart->rxBuffer.begin(), uart->rxBuffer.begin() + count);
+                uart->rxDiscarded += count;
+                return count;
+            }
+        }
+        delay(1);
+    }
+}
+
+//*********************************************************************
+esp_err_t uart_set_pin(uart_port_t port, int txPin, int rxPin, int rtsPin, int ctsPin)
+{
+    return uartFakeGet(port) ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+//*********************************************************************
+int uart_write_bytes(uart_port_t port, const void * buffer, size_t length)
+{
+    const uint8_t * data;
+    ssize_t bytes;
+    size_t remaining;
+    UART_FAKE * uart;
+
+    uart = uartFakeGet(port);
+    if (!uart)
+        return -1;
+
+    // Block until the terminal side accepts the data
+    data = (const uint8_t *)buffer;
+    remaining = length;
+    while (remaining)
+    {
+        bytes = write(uart->driver, data, remaining);
+        if (bytes < 0)
+        {
+            if ((errno != EAGAIN) && (errno != EINTR))
+                return -1;
+            delay(1);
+            continue;
+        }
+        data += bytes;
+        remaining -= bytes;
+    }
+    return length;
+}
+
+//*********************************************************************
+// Get the terminal side of the pseudo terminal for a UART
+int uartFakeTerminal(uart_port_t port)
+{
+    UART_FAKE * uart;
+
+    uart = uartFakeGet(port);
+    return uart ? uart->terminal : -1;
+}
+
+//*********************************************************************
+// Wait for the driver to receive the bytes written to the terminal
+bool uartFakeWaitReceived(uart_port_t port, uint64_t bytes, uint32_t msec)
+{
+    uint32_t startMsec;
+    UART_FAKE * uart;
+
+    uart = uartFakeGet(port);
+    if (!uart)
+        return false;
+    startMsec = millis();
+    while (uart->rxTotal < bytes)
+    {
+        if ((millis() - startMsec) >= msec)
+            return false;
+        delay(1);
+    }
+    return true;
+}
@@ -0,0 +1,22 @@
+// Host model of the ESP-IDF UART driver using a pseudo terminal, see
+// UartFake.cpp
+#pragma once
+#include <driver/uart.h>
+
+#define UART_FAKE_PORTS     3       // Number of UARTs
+
+// Get the terminal side of the pseudo terminal for a UART
+// Inputs:
+//   port: UART number
+// Outputs:
+//   Returns the file descriptor or -1 when the driver is not installed
+int uartFakeTerminal(uart_port_t port);
+
+// Wait for the driver to receive the bytes written to the terminal
+// Inputs:
+//   port: UART number
+//   bytes: Total number of bytes written to the terminal
+//   msec: Maximum time to wait in milliseconds
+// Outputs:
+//   Returns true when the bytes were received and false upon timeout
+bool uartFakeWaitReceived(uart_port_t port, uint64_t bytes, uint32_t msec);
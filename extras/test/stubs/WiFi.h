@@ -0,0 +1,18 @@
+#pragma once
+#include <Network.h>
+typedef enum { WL_IDLE_STATUS, WL_NO_SSID_AVAIL, WL_SCAN_COMPLETED, WL_CONNECTED, WL_CONNECT_FAILED, WL_CONNECTION_LOST, WL_DISCONNECTED } wl_status_t;
+class STAClass { public: IPAddress localIP(); };
+class WiFiClass { public:
+  wl_status_t begin(const char *, const char * = nullptr, int32_t = 0, const uint8_t * = nullptr, bool = true);
+  wl_status_t status(); IPAddress localIP(); IPAddress gatewayIP(); IPAddress subnetMask(); IPAddress dnsIP(uint8_t = 0);
+  bool config(IPAddress, IPAddress, IPAddress, IPAddress = IPAddress(), IPAddress = IPAddress());
+  bool disconnect(bool = false, bool = false); bool mode(int); bool setAutoReconnect(bool);
+  uint8_t * BSSID(); int32_t channel(); String SSID(); bool persistent(bool);
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+  int16_t scanNetworks(bool = false); int16_t scanComplete(); String SSID(uint8_t); int32_t RSSI(uint8_t); uint8_t * BSSID(uint8_t); int32_t channel(uint8_t); void scanDelete();
+  STAClass STA; };
+#define WIFI_STA 1
+extern WiFiClass WiFi;
+typedef NetworkUDP WiFiUDP;
+typedef NetworkClient WiFiClient;
@@ -0,0 +1 @@
+#include <Network.h>
@@ -0,0 +1,3 @@
+#pragma once
+#include <Arduino.h>
+class base64 { public: static String encode(const char *); };
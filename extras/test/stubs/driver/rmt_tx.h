@@ -0,0 +1,36 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+typedef int gpio_num_t;
+typedef struct rmt_channel_t * rmt_channel_handle_t;
+typedef struct rmt_encoder_t rmt_encoder_t;
+typedef rmt_encoder_t * rmt_encoder_handle_t;
+typedef enum { RMT_ENCODING_RESET = 0, RMT_ENCODING_COMPLETE = 1, RMT_ENCODING_MEM_FULL = 2 } rmt_encode_state_t;
+typedef union { struct { uint16_t duration0 : 15; uint16_t level0 : 1; uint16_t duration1 : 15; uint16_t level1 : 1; }; uint32_t val; } rmt_symbol_word_t;
+struct rmt_encoder_t {
+  size_t (*encode)(rmt_encoder_t *encoder, rmt_channel_handle_t tx_channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state);
+  esp_err_t (*reset)(rmt_encoder_t *encoder);
+  esp_err_t (*del)(rmt_encoder_t *encoder);
+};
+typedef int rmt_clock_source_t;
+#define RMT_CLK_SRC_DEFAULT 0
+typedef struct { gpio_num_t gpio_num; rmt_clock_source_t clk_src; uint32_t resolution_hz; size_t mem_block_symbols; size_t trans_queue_depth; int intr_priority; struct { uint32_t invert_out: 1; uint32_t with_dma: 1; uint32_t io_loop_back: 1; uint32_t io_od_mode: 1; } flags; } rmt_tx_channel_config_t;
+typedef struct { int loop_count; struct { uint32_t eot_level : 1; } flags; } rmt_transmit_config_t;
+typedef struct { rmt_symbol_word_t bit0; rmt_symbol_word_t bit1; struct { uint32_t msb_first: 1; } flags; } rmt_bytes_encoder_config_t;
+typedef struct { } rmt_copy_encoder_config_t;
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan);
+esp_err_t rmt_enable(rmt_channel_handle_t channel);
+esp_err_t rmt_disable(rmt_channel_handle_t channel);
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel);
+esp_err_t rmt_transmit(rmt_channel_handle_t tx_channel, rmt_encoder_handle_t encoder, const void *payload, size_t payload_bytes, const rmt_transmit_config_t *config);
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t tx_channel, int timeout_ms);
+esp_err_t rmt_new_bytes_encoder(const rmt_bytes_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder);
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t encoder);
+const char * esp_err_to_name(esp_err_t code);
+#define __containerof(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
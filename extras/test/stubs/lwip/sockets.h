@@ -0,0 +1,3 @@
+#pragma once
+#include <sys/select.h>
+#define TCP_SNDLOWAT 2921
@@ -0,0 +1,240 @@
+#!/usr/bin/env python3
+#**********************************************************************
+#  LED_3_Bit_Table.py
+#
+#  Robots-For-All (R4A)
+#  Generate or verify src/LED_3_Bit_Table.c
+#
+#  Each LED data bit is sent as three SPI bits, 0 as 100 and 1 as 110,
+#  most significant bit first.  Each color intensity (0 - 255) is
+#  converted into three SPI bytes.
+#
+#  The check verifies the table contents and the LED waveform timing at
+#  the R4A_LED_3_BITS_CLOCK_HZ, R4A_LED_3_BITS_CLOCK_MIN_HZ and
+#  R4A_LED_3_BITS_CLOCK_MAX_HZ values in src/R4A_Robot.h:
+#
+#    * The high times must be within the WS2812 and SK6812 limits, the
+#      LEDs sample the data a fixed time after each rising edge.
+#    * The bit period (high + low) must be within 1.25 +/- 0.6 uSec and
+#      the low times must be shorter than the reset time.  The low times
+#      outside the 800 KHz windows are listed as notes.
+#
+#  Usage:
+#      python3 extras/tools/LED_3_Bit_Table.py > src/LED_3_Bit_Table.c
+#      python3 extras/tools/LED_3_Bit_Table.py --check [--clock Hz]
+#**********************************************************************
+
+import os
+import re
+import sys
+
+#****************************************
+# Constants
+#****************************************
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..")
+HEADER_FILE = os.path.join(ROOT, "src", "R4A_Robot.h")
+TABLE_FILE = os.path.join(ROOT, "src", "LED_3_Bit_Table.c")
+
+# LED timing limits in uSec, (minimum, maximum), the data sheets specify
+# each time as the nominal value +/- 0.15 uSec
+LED_LIMITS = {
+    "WS2812": {
+        "T0H": (0.20, 0.50),
+        "T1H": (0.55, 0.85),
+        "T0L": (0.65, 0.95),
+        "T1L": (0.45, 0.75),
+        "period": (0.65, 1.85),
+        "reset": 50.0,
+    },
+    "SK6812RGBW": {
+        "T0H": (0.15, 0.45),
+        "T1H": (0.45, 0.75),
+        "T0L": (0.75, 1.05),
+        "T1L": (0.45, 0.75),
+        "period": (0.65, 1.85),
+        "reset": 80.0,
+    },
+}
+
+# SPI bits for each LED data bit
+ZERO_BITS = 0b100
+ONE_BITS = 0b110
+SPI_BITS = 3
+
+HEADER = """/**********************************************************************
+  LED_3_Bit_Table.c
+
+  Robots-For-All (R4A)
+  Table to convert a color intensity into a LED intensity using three
+  SPI bits for each LED data bit
+**********************************************************************/
+
+#include <unistd.h>
+
+//****************************************
+// Constants
+//****************************************
+
+const uint8_t r4aLED3BitTable[] =
+{
+"""
+
+TRAILER = "};\n"
+
+#*********************************************************************
+# Encode a color intensity into the SPI bytes
+# Inputs:
+#   value: Color intensity (0 - 255)
+# Outputs:
+#   Returns the list of SPI bytes
+def encode(value):
+    bits = 0
+    for bit in range(7, -1, -1):
+        bits = (bits << SPI_BITS) | (ONE_BITS if (value >> bit) & 1 else ZERO_BITS)
+    return [(bits >> 16) & 0xff, (bits >> 8) & 0xff, bits & 0xff]
+
+#*********************************************************************
+# Generate the table source
+# Outputs:
+#   Returns the contents of LED_3_Bit_Table.c
+def generate():
+    lines = [HEADER]
+    for value in range(256):
+        # Display the waveform above the bytes
+        waveform = "                    //       "
+        data = ""
+        for bit in range(7, -1, -1):
+            if (value >> bit) & 1:
+                waveform += "__   "
+                data += "  1_|"
+            else:
+                waveform += "_    "
+                data += " 0__|"
+        lines.append(waveform.rstrip() + "\n")
+        lines.append("    0x%02x, 0x%02x, 0x%02x, // %3d  |%s\n"
+                     % (*encode(value), value, data))
+    lines.append(TRAILER)
+    return "".join(lines)
+
+#*********************************************************************
+# Get the SPI clock values from R4A_Robot.h
+# Outputs:
+#   Returns a dictionary of the clock names and frequencies in Hertz
+def clocks():
+    values = {}
+    with open(HEADER_FILE) as file:
+        for line in file:
+            match = re.match(r"#define\s+(R4A_LED_3_BITS_CLOCK\w*_HZ)\s+(\d+)", line)
+            if match:
+                values[match.group(1)] = int(match.group(2))
+    return values
+
+#*********************************************************************
+# Measure the high and low times of the SPI bits for a LED data bit
+# Inputs:
+#   bits: SPI bits for the LED data bit
+#   clockHz: SPI clock frequency in Hertz
+# Outputs:
+#   Returns the high and low times in uSec
+def pulse(bits, clockHz):
+    high = 0
+    for bit in range(SPI_BITS - 1, -1, -1):
+        if not (bits >> bit) & 1:
+            break
+        high += 1
+    if bits & ((1 << (SPI_BITS - high)) - 1):
+        raise ValueError("SPI bits 0b{:b} are not a single pulse".format(bits))
+    bitUsec = 1000000.0 / clockHz
+    return high * bitUsec, (SPI_BITS - high) * bitUsec
+
+#*********************************************************************
+# Verify the LED timing at a SPI clock
+# Inputs:
+#   name: Name of the clock value
+#   clockHz: SPI clock frequency in Hertz
+# Outputs:
+#   Returns the number of errors
+def checkTiming(name, clockHz):
+    errors = 0
+    times = {}
+    times["T0H"], times["T0L"] = pulse(ZERO_BITS, clockHz)
+    times["T1H"], times["T1L"] = pulse(ONE_BITS, clockHz)
+    print("%s: %d Hz, T0H %.3f, T0L %.3f, T1H %.3f, T1L %.3f uSec"
+          % (name, clockHz, times["T0H"], times["T0L"], times["T1H"], times["T1L"]))
+
+    # Allow for rounding in the clock values
+    epsilon = 0.0005
+    for led, limits in LED_LIMITS.items():
+        # The high times are sampled by the LED
+        for time in ("T0H", "T1H"):
+            minimum, maximum = limits[time]
+            if not (minimum - epsilon) <= times[time] <= (maximum + epsilon):
+                print("ERROR: %s %s %.3f uSec is outside %.2f - %.2f uSec"
+                      % (led, time, times[time], minimum, maximum))
+                errors += 1
+
+        # The low times set the bit period
+        for bit in ("0", "1"):
+            period = times["T%sH" % bit] + times["T%sL" % bit]
+            minimum, maximum = limits["period"]
+            if not (minimum - epsilon) <= period <= (maximum + epsilon):
+                print("ERROR: %s %s bit period %.3f uSec is outside %.2f - %.2f uSec"
+                      % (led, bit, period, minimum, maximum))
+                errors += 1
+            time = "T%sL" % bit
+            if times[time] >= limits["reset"]:
+                print("ERROR: %s %s %.3f uSec resets the LEDs" % (led, time, times[time]))
+                errors += 1
+            minimum, maximum = limits[time]
+            if not (minimum - epsilon) <= times[time] <= (maximum + epsilon):
+                print("    Note: %s %s %.3f uSec is outside the 800 KHz window %.2f - %.2f uSec"
+                      % (led, time, times[time], minimum, maximum))
+    return errors
+
+#*********************************************************************
+# Verify the table contents and the LED timing
+# Inputs:
+#   clockHz: SPI clock to check in addition to the R4A_Robot.h values,
+#            None to check only the R4A_Robot.h values
+# Outputs:
+#   Returns the number of errors
+def check(clockHz):
+    errors = 0
+
+    # Verify the table contents
+    with open(TABLE_FILE) as file:
+        if file.read() != generate():
+            print("ERROR: %s does not match the generated table" % TABLE_FILE)
+            errors += 1
+        else:
+            print("%s matches the generated table" % TABLE_FILE)
+
+    # Verify the timing at each of the clock values
+    values = clocks()
+    if len(values) != 3:
+        print("ERROR: R4A_LED_3_BITS_CLOCK_*_HZ values not found in %s" % HEADER_FILE)
+        errors += 1
+    elif not (values["R4A_LED_3_BITS_CLOCK_MIN_HZ"]
+              <= values["R4A_LED_3_BITS_CLOCK_HZ"]
+              <= values["R4A_LED_3_BITS_CLOCK_MAX_HZ"]):
+        print("ERROR: R4A_LED_3_BITS_CLOCK_HZ is outside the MIN - MAX range")
+        errors += 1
+    if clockHz:
+        values["--clock"] = clockHz
+    for name, value in values.items():
+        errors += checkTiming(name, value)
+    return errors
+
+#*********************************************************************
+# Generate the table or verify the table in LED_3_Bit_Table.c
+if __name__ == "__main__":
+    if (len(sys.argv) > 1) and (sys.argv[1] == "--check"):
+        clockHz = None
+        if (len(sys.argv) > 3) and (sys.argv[2] == "--clock"):
+            clockHz = int(sys.argv[3])
+        errors = check(clockHz)
+        print("%d errors" % errors)
+        sys.exit(1 if errors else 0)
+    else:
+        sys.stdout.write(generate())
@@ -7,6 +7,8 @@
 #include "NetworkManager.h"
 #include "esp_task.h"
 #include "esp32-hal.h"
+#include <list>
+#include <mutex>
 
 typedef struct NetworkEventCbList {
   static network_event_handle_t current_id;
@@ -15,13 +17,84 @@ typedef struct NetworkEventCbList {
   NetworkEventFuncCb fcb;
   NetworkEventSysCb scb;
   arduino_event_id_t event;
+  bool removed;
 
-  NetworkEventCbList() : id(current_id++), cb(NULL), fcb(NULL), scb(NULL), event(ARDUINO_EVENT_NONE) {}
+  NetworkEventCbList() : id(current_id++), cb(NULL), fcb(NULL), scb(NULL), event(ARDUINO_EVENT_NONE), removed(false) {}
 } NetworkEventCbList_t;
 network_event_handle_t NetworkEventCbList::current_id = 1;
 
-// arduino dont like std::vectors move static here
-static std::vector<NetworkEventCbList_t> cbEventList;
+// The handlers live in list nodes which never move, the event task calls
+// them by reference.  A handler removed while events are being dispatched
+// is only marked as removed, its node is erased when the dispatch depth
+// returns to zero.
+// arduino dont like std::lists move static here
+static std::list<NetworkEventCbList_t> cbEventList;
+
+// Dispatch index, the handlers for event id are
+// cbEventIndex[cbEventIndexStart[id]] through cbEventIndex[cbEventIndexStart[id + 1] - 1]
+// in registration order, including the handlers registered for all events
+static std::vector<NetworkEventCbList_t *> cbEventIndex;
+static uint16_t cbEventIndexStart[ARDUINO_EVENT_MAX + 1];
+
+// The dispatch index is not changed while events are being dispatched,
+// handlers added during a dispatch are first called for the next event
+static uint32_t cbEventDispatchDepth;
+static bool cbEventIndexStale;
+
+// Protects cbEventList, the dispatch index and the dispatch depth.  The
+// lock is not held while the handlers run, allowing the handlers to add
+// or remove handlers.
+static std::recursive_mutex cbEventMutex;
+
+// Rebuild the dispatch index after a change to cbEventList, call while
+// holding cbEventMutex
+static void _rebuild_event_index() {
+  // Defer the rebuild until the dispatch completes
+  if (cbEventDispatchDepth) {
+    cbEventIndexStale = true;
+    return;
+  }
+  cbEventIndexStale = false;
+
+  // Reclaim the removed handlers
+  for (std::list<NetworkEventCbList_t>::iterator it = cbEventList.begin(); it != cbEventList.end();) {
+    if (it->removed) {
+      it = cbEventList.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  cbEventIndex.clear();
+  for (uint32_t id = 0; id < ARDUINO_EVENT_MAX; id++) {
+    cbEventIndexStart[id] = cbEventIndex.size();
+    for (NetworkEventCbList_t &entry : cbEventList) {
+      if ((entry.cb || entry.fcb || entry.scb) && (entry.event == (arduino_event_id_t)id || entry.event == ARDUINO_EVENT_MAX)) {
+        cbEventIndex.push_back(&entry);
+      }
+    }
+  }
+  cbEventIndexStart[ARDUINO_EVENT_MAX] = cbEventIndex.size();
+}
+
+// Remove a handler, call while holding cbEventMutex
+static void _remove_event_handler(std::list<NetworkEventCbList_t>::iterator entry) {
+  __atomic_store_n(&entry->removed, true, __ATOMIC_RELEASE);
+  _rebuild_event_index();
+}
+
+// Locate the handler at position index of cbEventList, call while holding
+// cbEventMutex
+static std::list<NetworkEventCbList_t>::iterator _event_handler_at(uint32_t index) {
+  std::list<NetworkEventCbList_t>::iterator entry = cbEventList.begin();
+  std::advance(entry, index);
+  return entry;
+}
+
+// Events are copied by value into the queue, the queue storage is
+// allocated statically to avoid heap allocations for each event
+static StaticQueue_t _arduino_event_queue_buffer;
+static uint8_t _arduino_event_queue_storage[ARDUINO_EVENT_QUEUE_LENGTH * sizeof(arduino_event_t)];
 
 static void _network_event_task(void *arg) {
   for (;;) {
@@ -30,7 +103,8 @@ static void _network_event_task(void *arg) {
   vTaskDelete(NULL);
 }
 
-NetworkEvents::NetworkEvents() : _arduino_event_group(NULL), _arduino_event_queue(NULL), _arduino_event_task_handle(NULL) {}
+NetworkEvents::NetworkEvents()
+  : _arduino_event_group(NULL), _arduino_event_queue(NULL), _arduino_event_task_handle(NULL), _queue_high_water_mark(0), _send_failures(0) {}
 
 NetworkEvents::~NetworkEvents() {
   if (_arduino_event_task_handle != NULL) {
@@ -42,10 +116,6 @@ NetworkEvents::~NetworkEvents() {
     _arduino_event_group = NULL;
   }
   if (_arduino_event_queue != NULL) {
-    arduino_event_t *event = NULL;
-    while (xQueueReceive(_arduino_event_queue, &event, 0) == pdTRUE) {
-      free(event);
-    }
     vQueueDelete(_arduino_event_queue);
     _arduino_event_queue = NULL;
   }
@@ -64,7 +134,8 @@ bool NetworkEvents::initNetworkEvents() {
   }
 
   if (!_arduino_event_queue) {
-    _arduino_event_queue = xQueueCreate(32, sizeof(arduino_event_t *));
+    _arduino_event_queue =
+      xQueueCreateStatic(ARDUINO_EVENT_QUEUE_LENGTH, sizeof(arduino_event_t), _arduino_event_queue_storage, &_arduino_event_queue_buffer);
     if (!_arduino_event_queue) {
       log_e("Network Event Queue Create Failed!");
       return false;
@@ -92,67 +163,83 @@ bool NetworkEvents::postEvent(arduino_event_t *data) {
   if (data == NULL || _arduino_event_queue == NULL) {
     return false;
   }
-  arduino_event_t *event = (arduino_event_t *)malloc(sizeof(arduino_event_t));
-  if (event == NULL) {
-    log_e("Arduino Event Malloc Failed!");
-    return false;
-  }
-  memcpy(event, data, sizeof(arduino_event_t));
-  if (xQueueSend(_arduino_event_queue, &event, portMAX_DELAY) != pdPASS) {
+  if (xQueueSend(_arduino_event_queue, data, pdMS_TO_TICKS(ARDUINO_EVENT_QUEUE_SEND_TIMEOUT_MS)) != pdPASS) {
+    __atomic_fetch_add(&_send_failures, 1, __ATOMIC_RELAXED);
     log_e("Arduino Event Send Failed!");
     return false;
   }
+  uint32_t waiting = uxQueueMessagesWaiting(_arduino_event_queue);
+  if (waiting > _queue_high_water_mark) {
+    _queue_high_water_mark = waiting;
+  }
   return true;
 }
 
 void NetworkEvents::checkForEvent() {
-  arduino_event_t *event = NULL;
+  arduino_event_t event_data;
+  arduino_event_t *event = &event_data;
   if (_arduino_event_queue == NULL) {
     return;
   }
-  if (xQueueReceive(_arduino_event_queue, &event, portMAX_DELAY) != pdTRUE) {
+  if (xQueueReceive(_arduino_event_queue, event, portMAX_DELAY) != pdTRUE) {
     return;
   }
-  if (event == NULL) {
+  log_v("Network Event: %d - %s", event->event_id, eventName(event->event_id));
+  if ((uint32_t)event->event_id >= ARDUINO_EVENT_MAX) {
     return;
   }
-  log_v("Network Event: %d - %s", event->event_id, eventName(event->event_id));
-  for (uint32_t i = 0; i < cbEventList.size(); i++) {
-    NetworkEventCbList_t entry = cbEventList[i];
-    if (entry.cb || entry.fcb || entry.scb) {
-      if (entry.event == (arduino_event_id_t)event->event_id || entry.event == ARDUINO_EVENT_MAX) {
-        if (entry.cb) {
-          entry.cb((arduino_event_id_t)event->event_id);
-        } else if (entry.fcb) {
-          entry.fcb((arduino_event_id_t)event->event_id, (arduino_event_info_t)event->event_info);
-        } else {
-          entry.scb(event);
-        }
-      }
+  // Freeze the dispatch index while the handlers run
+  cbEventMutex.lock();
+  cbEventDispatchDepth++;
+  uint32_t first = cbEventIndexStart[event->event_id];
+  uint32_t last = cbEventIndexStart[event->event_id + 1];
+  cbEventMutex.unlock();
+
+  // Only visit the handlers for this event id, skip the removed handlers
+  for (uint32_t index = first; index < last; index++) {
+    const NetworkEventCbList_t &entry = *cbEventIndex[index];
+    if (__atomic_load_n(&entry.removed, __ATOMIC_ACQUIRE)) {
+      continue;
     }
+    if (entry.cb) {
+      entry.cb((arduino_event_id_t)event->event_id);
+    } else if (entry.fcb) {
+      entry.fcb((arduino_event_id_t)event->event_id, (arduino_event_info_t)event->event_info);
+    } else {
+      entry.scb(event);
+    }
+  }
+
+  // Apply the changes made by the handlers
+  cbEventMutex.lock();
+  cbEventDispatchDepth--;
+  if (cbEventIndexStale) {
+    _rebuild_event_index();
   }
-  free(event);
+  cbEventMutex.unlock();
 }
 
 uint32_t NetworkEvents::findEvent(NetworkEventCb cbEvent, arduino_event_id_t event) {
+  std::lock_guard<std::recursive_mutex> lock(cbEventMutex);
   uint32_t i;
 
   if (!cbEvent) {
     return cbEventList.size();
   }
 
-  for (i = 0; i < cbEventList.size(); i++) {
-    NetworkEventCbList_t entry = cbEventList[i];
-    if (entry.cb == cbEvent && entry.event == event) {
+  i = 0;
+  for (const NetworkEventCbList_t &entry : cbEventList) {
+    if (!entry.removed && entry.cb == cbEvent && entry.event == event) {
       break;
     }
+    i++;
   }
   return i;
 }
 
-template<typename T, typename... U> static size_t getStdFunctionAddress(std::function<T(U...)> f) {
+template<typename T, typename... U> static size_t getStdFunctionAddress(const std::function<T(U...)> &f) {
   typedef T(fnType)(U...);
-  fnType **fnPointer = f.template target<fnType *>();
+  fnType *const *fnPointer = f.template target<fnType *>();
   if (fnPointer != nullptr) {
     return (size_t)*fnPointer;
   }
@@ -160,38 +247,43 @@ template<typename T, typename... U> static size_t getStdFunctionAddress(std::fun
 }
 
 uint32_t NetworkEvents::findEvent(NetworkEventFuncCb cbEvent, arduino_event_id_t event) {
+  std::lock_guard<std::recursive_mutex> lock(cbEventMutex);
   uint32_t i;
 
   if (!cbEvent) {
     return cbEventList.size();
   }
 
-  for (i = 0; i < cbEventList.size(); i++) {
-    NetworkEventCbList_t entry = cbEventList[i];
-    if (getStdFunctionAddress(entry.fcb) == getStdFunctionAddress(cbEvent) && entry.event == event) {
+  i = 0;
+  for (const NetworkEventCbList_t &entry : cbEventList) {
+    if (!entry.removed && getStdFunctionAddress(entry.fcb) == getStdFunctionAddress(cbEvent) && entry.event == event) {
       break;
     }
+    i++;
   }
   return i;
 }
 
 uint32_t NetworkEvents::findEvent(NetworkEventSysCb cbEvent, arduino_event_id_t event) {
+  std::lock_guard<std::recursive_mutex> lock(cbEventMutex);
   uint32_t i;
 
   if (!cbEvent) {
     return cbEventList.size();
   }
 
-  for (i = 0; i < cbEventList.size(); i++) {
-    NetworkEventCbList_t entry = cbEventList[i];
-    if (entry.scb == cbEvent && entry.event == event) {
+  i = 0;
+  for (const NetworkEventCbList_t &entry : cbEventList) {
+    if (!entry.removed && entry.scb == cbEvent && entry.event == event) {
       break;
     }
+    i++;
   }
   return i;
 }
 
 network_event_handle_t NetworkEvents::onEvent(NetworkEventCb cbEvent, arduino_event_id_t event) {
+  std::lock_guard<std::recursive_mutex> lock(cbEventMutex);
   if (!cbEvent) {
     return 0;
   }
@@ -207,10 +299,12 @@ network_event_handle_t NetworkEvents::onEvent(NetworkEventCb cbEvent, arduino_ev
   newEventHandler.scb = NULL;
   newEventHandler.event = event;
   cbEventList.push_back(newEventHandler);
+  _rebuild_event_index();
   return newEventHandler.id;
 }
 
 network_event_handle_t NetworkEvents::onEvent(NetworkEventFuncCb cbEvent, arduino_event_id_t event) {
+  std::lock_guard<std::recursive_mutex> lock(cbEventMutex);
   if (!cbEvent) {
     return 0;
   }
@@ -226,10 +320,12 @@ network_event_handle_t NetworkEvents::onEvent(NetworkEventFuncCb cbEvent, arduin
   newEventHandler.scb = NULL;
   newEventHandler.event = event;
   cbEventList.push_back(newEventHandler);
+  _rebuild_event_index();
   return newEventHandler.id;
 }
 
 network_event_handle_t NetworkEvents::onEvent(NetworkEventSysCb cbEvent, arduino_event_id_t event) {
+  std::lock_guard<std::recursive_mutex> lock(cbEventMutex);
   if (!cbEvent) {
     return 0;
   }
@@ -245,10 +341,12 @@ network_event_handle_t NetworkEvents::onEvent(NetworkEventSysCb cbEvent, arduino
   newEventHandler.scb = cbEvent;
   newEventHandler.event = event;
   cbEventList.push_back(newEventHandler);
+  _rebuild_event_index();
   return newEventHandler.id;
 }
 
 network_event_handle_t NetworkEvents::onSysEvent(NetworkEventCb cbEvent, arduino_event_id_t event) {
+  std::lock_guard<std::recursive_mutex> lock(cbEventMutex);
   if (!cbEvent) {
     return 0;
   }
@@ -264,10 +362,12 @@ network_event_handle_t NetworkEvents::onSysEvent(NetworkEventCb cbEvent, arduino
   newEventHandler.scb = NULL;
   newEventHandler.event = event;
   cbEventList.insert(cbEventList.begin(), newEventHandler);
+  _rebuild_event_index();
   return newEventHandler.id;
 }
 
 network_event_handle_t NetworkEvents::onSysEvent(NetworkEventFuncCb cbEvent, arduino_event_id_t event) {
+  std::lock_guard<std::recursive_mutex> lock(cbEventMutex);
   if (!cbEvent) {
     return 0;
   }
@@ -283,10 +383,12 @@ network_event_handle_t NetworkEvents::onSysEvent(NetworkEventFuncCb cbEvent, ard
   newEventHandler.scb = NULL;
   newEventHandler.event = event;
   cbEventList.insert(cbEventList.begin(), newEventHandler);
+  _rebuild_event_index();
   return newEventHandler.id;
 }
 
 network_event_handle_t NetworkEvents::onSysEvent(NetworkEventSysCb cbEvent, arduino_event_id_t event) {
+  std::lock_guard<std::recursive_mutex> lock(cbEventMutex);
   if (!cbEvent) {
     return 0;
   }
@@ -302,10 +404,12 @@ network_event_handle_t NetworkEvents::onSysEvent(NetworkEventSysCb cbEvent, ardu
   newEventHandler.scb = cbEvent;
   newEventHandler.event = event;
   cbEventList.insert(cbEventList.begin(), newEventHandler);
+  _rebuild_event_index();
   return newEventHandler.id;
 }
 
 void NetworkEvents::removeEvent(NetworkEventCb cbEvent, arduino_event_id_t event) {
+  std::lock_guard<std::recursive_mutex> lock(cbEventMutex);
   uint32_t i;
 
   if (!cbEvent) {
@@ -318,10 +422,11 @@ void NetworkEvents::removeEvent(NetworkEventCb cbEvent, arduino_event_id_t event
     return;
   }
 
-  cbEventList.erase(cbEventList.begin() + i);
+  _remove_event_handler(_event_handler_at(i));
 }
 
 void NetworkEvents::removeEvent(NetworkEventFuncCb cbEvent, arduino_event_id_t event) {
+  std::lock_guard<std::recursive_mutex> lock(cbEventMutex);
   uint32_t i;
 
   if (!cbEvent) {
@@ -334,10 +439,11 @@ void NetworkEvents::removeEvent(NetworkEventFuncCb cbEvent, arduino_event_id_t e
     return;
   }
 
-  cbEventList.erase(cbEventList.begin() + i);
+  _remove_event_handler(_event_handler_at(i));
 }
 
 void NetworkEvents::removeEvent(NetworkEventSysCb cbEvent, arduino_event_id_t event) {
+  std::lock_guard<std::recursive_mutex> lock(cbEventMutex);
   uint32_t i;
 
   if (!cbEvent) {
@@ -350,14 +456,14 @@ void NetworkEvents::removeEvent(NetworkEventSysCb cbEvent, arduino_event_id_t ev
     return;
   }
 
-  cbEventList.erase(cbEventList.begin() + i);
+  _remove_event_handler(_event_handler_at(i));
 }
 
 void NetworkEvents::removeEvent(network_event_handle_t id) {
-  for (uint32_t i = 0; i < cbEventList.size(); i++) {
-    NetworkEventCbList_t entry = cbEventList[i];
-    if (entry.id == id) {
-      cbEventList.erase(cbEventList.begin() + i);
+  std::lock_guard<std::recursive_mutex> lock(cbEventMutex);
+  for (std::list<NetworkEventCbList_t>::iterator entry = cbEventList.begin(); entry != cbEventList.end(); ++entry) {
+    if (entry->id == id && !entry->removed) {
+      _remove_event_handler(entry);
       return;
     }
   }
@@ -30,6 +30,16 @@ static const int WIFI_SCAN_DONE_BIT = BIT1;
 
 #define NET_HAS_IP6_GLOBAL_BIT 0
 
+// Number of events held by the event queue
+#ifndef ARDUINO_EVENT_QUEUE_LENGTH
+#define ARDUINO_EVENT_QUEUE_LENGTH 32
+#endif
+
+// Maximum time postEvent waits for space in the event queue
+#ifndef ARDUINO_EVENT_QUEUE_SEND_TIMEOUT_MS
+#define ARDUINO_EVENT_QUEUE_SEND_TIMEOUT_MS 100
+#endif
+
 ESP_EVENT_DECLARE_BASE(ARDUINO_EVENTS);
 
 typedef enum {
@@ -139,6 +149,15 @@ public:
   void checkForEvent();
   bool postEvent(arduino_event_t *event);
 
+  // Maximum number of events waiting in the event queue
+  uint32_t getQueueHighWaterMark() {
+    return _queue_high_water_mark;
+  }
+  // Number of events dropped because the event queue was full
+  uint32_t getSendFailures() {
+    return _send_failures;
+  }
+
   int getStatusBits();
   int waitStatusBits(int bits, uint32_t timeout_ms);
   int setStatusBits(int bits);
@@ -166,4 +185,6 @@ private:
   EventGroupHandle_t _arduino_event_group;
   QueueHandle_t _arduino_event_queue;
   TaskHandle_t _arduino_event_task_handle;
+  volatile uint32_t _queue_high_water_mark;
+  volatile uint32_t _send_failures;
 };
@@ -3,10 +3,34 @@
 
   Robots-For-All (R4A)
   Bluetooth stream support
+
+  Each write to the BluetoothSerial port may be sent as a separate
+  RFCOMM frame.  The Bluetooth console reads the input in blocks and
+  collects the menu output in a buffer which is sent as a single write
+  after each command response.  Each console object holds its own
+  command line and menu position, and each session starts at the main
+  menu.
 **********************************************************************/
 
 #include "R4A_Robot.h"
 
+//****************************************
+// Metrics
+//****************************************
+
+static R4A_METRIC r4aBluetoothMetricRxBytes("r4a_bluetooth_rx_bytes_total",
+                                            "Bytes received from the Bluetooth clients",
+                                            R4A_METRIC_COUNTER);
+static R4A_METRIC r4aBluetoothMetricSessions("r4a_bluetooth_sessions_total",
+                                             "Bluetooth console sessions",
+                                             R4A_METRIC_COUNTER);
+static R4A_METRIC r4aBluetoothMetricTxBytes("r4a_bluetooth_tx_bytes_total",
+                                            "Bytes sent to the Bluetooth clients",
+                                            R4A_METRIC_COUNTER);
+static R4A_METRIC r4aBluetoothMetricTxWrites("r4a_bluetooth_tx_writes_total",
+                                             "Writes to the Bluetooth serial port",
+                                             R4A_METRIC_COUNTER);
+
 //*********************************************************************
 // Read a line of input from a Serial port into a String
 String * r4aReadLine(bool echo, String * buffer, BluetoothSerial * port)
@@ -75,17 +99,16 @@ bool r4aBluetoothMenu(R4A_MENU * menu, BluetoothSerial * port)
 {
     const char * command;
     bool done;
-    String * line;
-    static String serialBuffer;
+    static char serialBuffer[R4A_BLUETOOTH_COMMAND_BYTES];
+
+    // Run any long command
+    menu->update(port);
 
     // Process input from the serial port
     done = false;
-    line = r4aReadLine(true, &serialBuffer, port);
-    if (line)
+    command = r4aReadLine(true, serialBuffer, sizeof(serialBuffer), port);
+    if (command)
     {
-        // Get the command
-        command = line->c_str();
-
         // Process the command
         done = menu->process(command, port);
         if (!done)
@@ -93,9 +116,212 @@ bool r4aBluetoothMenu(R4A_MENU * menu, BluetoothSerial * port)
             menu->process(nullptr, port);
 
         // Start building the next command
-        serialBuffer = "";
+        serialBuffer[0] = 0;
     }
 
     // Return the exit request status
     return done;
 }
+
+//*********************************************************************
+// Constructor
+R4A_BLUETOOTH_CONSOLE::R4A_BLUETOOTH_CONSOLE(BluetoothSerial * port,
+                                             const R4A_MENU_TABLE * menuTable,
+                                             int menuTableEntries,
+                                             bool echo)
+    : _commandLength{0}, _connected{false}, _cursor{}, _echo{echo},
+      _menu{R4A_MENU_COMPILED(menuTable, menuTableEntries)}, _port{port},
+      _writeLength{0}
+{
+}
+
+//*********************************************************************
+// Destructor
+R4A_BLUETOOTH_CONSOLE::~R4A_BLUETOOTH_CONSOLE()
+{
+    sessionEnd();
+}
+
+//*********************************************************************
+// Send the buffered output to the Bluetooth client
+void R4A_BLUETOOTH_CONSOLE::flush()
+{
+    if (_writeLength)
+    {
+        _port->write(_writeBuffer, _writeLength);
+        r4aBluetoothMetricTxBytes.add(_writeLength);
+        r4aBluetoothMetricTxWrites.add();
+    }
+    _writeLength = 0;
+}
+
+//*********************************************************************
+// Determine if a client is connected
+bool R4A_BLUETOOTH_CONSOLE::isConnected()
+{
+    return _connected;
+}
+
+//*********************************************************************
+// Process the input from the Bluetooth client
+bool R4A_BLUETOOTH_CONSOLE::processInput()
+{
+    int bytes;
+    uint8_t data;
+    bool done;
+    uint8_t input[R4A_BLUETOOTH_READ_BYTES];
+
+    // Read the input in blocks
+    done = false;
+    while ((!done) && ((bytes = _port->available()) > 0))
+    {
+        if (bytes > (int)sizeof(input))
+            bytes = sizeof(input);
+        bytes = _port->readBytes(input, bytes);
+        r4aBluetoothMetricRxBytes.add(bytes);
+
+        // Walk the input characters
+        for (int index = 0; index < bytes; index++)
+        {
+            data = input[index];
+
+            // Handle backspace
+            if (data == 8)
+            {
+                // Output a bell when the buffer is empty
+                if (_commandLength == 0)
+                    write(7);
+                else
+                {
+                    // Remove the character from the line
+                    write(data);
+                    write(' ');
+                    write(data);
+                    _commandLength -= 1;
+                }
+            }
+
+            // Process the command
+            else if (data == '\r')
+            {
+                if (_echo)
+                    println();
+                _command[_commandLength] = 0;
+                _commandLength = 0;
+                done = _menu.process(&_cursor, _command, this);
+                if (done)
+                    break;
+
+                // Display the menu
+                _menu.process(&_cursor, nullptr, this);
+            }
+
+            // Echo the linefeed
+            else if (data == '\n')
+            {
+                if (_echo)
+                    println();
+            }
+
+            // Output a bell when the command is too long
+            else if (_commandLength >= (sizeof(_command) - 1))
+                write(7);
+
+            // Add the character to the command
+            else
+            {
+                if (_echo)
+                    write(data);
+                _command[_commandLength++] = data;
+            }
+        }
+    }
+    return done;
+}
+
+//*********************************************************************
+// Start a session when the client connects
+void R4A_BLUETOOTH_CONSOLE::sessionBegin()
+{
+    _commandLength = 0;
+    _connected = true;
+    memset(&_cursor, 0, sizeof(_cursor));
+    _writeLength = 0;
+    r4aBluetoothMetricSessions.add();
+    r4aLogInfo(R4A_MODULE_BLUETOOTH, "Bluetooth client connected");
+
+    // Display the menu
+    _menu.process(&_cursor, nullptr, this);
+    flush();
+}
+
+//*********************************************************************
+// End the session when the client disconnects
+void R4A_BLUETOOTH_CONSOLE::sessionEnd()
+{
+    if (_connected)
+    {
+        _connected = false;
+        r4aLogInfo(R4A_MODULE_BLUETOOTH, "Bluetooth client disconnected");
+    }
+    _menu.cancel(&_cursor);
+    _commandLength = 0;
+    _writeLength = 0;
+}
+
+//*********************************************************************
+// Process the Bluetooth client connection and input
+bool R4A_BLUETOOTH_CONSOLE::update()
+{
+    bool connected;
+    bool done;
+
+    // Determine if the client connected or disconnected
+    connected = _port->hasClient();
+    if (connected && (!_connected))
+        sessionBegin();
+    else if ((!connected) && _connected)
+        sessionEnd();
+    if (!_connected)
+        return false;
+
+    // Process the input, run any long command and send the response
+    done = processInput();
+    if (!done)
+        _menu.update(&_cursor, this);
+    flush();
+    return done;
+}
+
+//*********************************************************************
+// Add a byte to the output buffer
+size_t R4A_BLUETOOTH_CONSOLE::write(uint8_t data)
+{
+    if (_writeLength >= sizeof(_writeBuffer))
+        flush();
+    _writeBuffer[_writeLength++] = data;
+    return 1;
+}
+
+//*********************************************************************
+// Add data to the output buffer
+size_t R4A_BLUETOOTH_CONSOLE::write(const uint8_t * buffer, size_t length)
+{
+    size_t bytes;
+    size_t bytesWritten;
+
+    bytesWritten = length;
+    while (length)
+    {
+        if (_writeLength >= sizeof(_writeBuffer))
+            flush();
+        bytes = sizeof(_writeBuffer) - _writeLength;
+        if (bytes > length)
+            bytes = length;
+        memcpy(&_writeBuffer[_writeLength], buffer, bytes);
+        _writeLength += bytes;
+        buffer += bytes;
+        length -= bytes;
+    }
+    return bytesWritten;
+}
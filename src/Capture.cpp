@@ -0,0 +1,553 @@
+/**********************************************************************
+  Capture.cpp
+
+  Robots-For-All (R4A)
+  Capture the network data for debugging
+
+  The network data is copied into a ring buffer as records containing
+  a timestamp, module, session and direction.  No formatting or output
+  is done on the network path, this keeps the timing of the connection
+  close to the timing without the capture.  The records are removed
+  later and output either as a hex dump, a pcap file or as a pcap
+  stream by the capture server.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Constants
+//****************************************
+
+#define R4A_CAPTURE_PCAP_MAGIC          0xa1b2c3d4
+#define R4A_CAPTURE_PCAP_LINKTYPE       147 // LINKTYPE_USER0
+#define R4A_CAPTURE_PSEUDO_HEADER_BYTES 4
+#define R4A_CAPTURE_SERVER_RECORDS      8   // Records sent per update
+
+const char * const r4aCaptureDirection[] =
+{
+    "RX",   // R4A_CAPTURE_RX
+    "TX",   // R4A_CAPTURE_TX
+};
+
+//****************************************
+// Types
+//****************************************
+
+typedef struct _R4A_CAPTURE_HEADER
+{
+    uint32_t usec;          // Microseconds since boot
+    uint16_t length;        // Number of data bytes in the record
+    uint16_t originalLength;// Number of data bytes received or sent
+    uint16_t session;       // Number identifying the connection
+    uint8_t module;         // Module using the connection
+    uint8_t direction;      // R4A_CAPTURE_RX or R4A_CAPTURE_TX
+} R4A_CAPTURE_HEADER;
+
+typedef struct _R4A_PCAP_FILE_HEADER
+{
+    uint32_t magic;
+    uint16_t versionMajor;
+    uint16_t versionMinor;
+    int32_t thisZone;
+    uint32_t sigFigs;
+    uint32_t snapLength;
+    uint32_t linkType;
+} R4A_PCAP_FILE_HEADER;
+
+typedef struct _R4A_PCAP_RECORD_HEADER
+{
+    uint32_t seconds;
+    uint32_t usec;
+    uint32_t includedLength;
+    uint32_t originalLength;
+} R4A_PCAP_RECORD_HEADER;
+
+//****************************************
+// Globals
+//****************************************
+
+volatile bool r4aCaptureEnable;
+volatile uint32_t r4aCaptureDropped;
+volatile uint32_t r4aCaptureRecords;
+
+//****************************************
+// Locals
+//****************************************
+
+static uint8_t r4aCaptureBuffer[R4A_CAPTURE_BUFFER_BYTES];
+static uint8_t r4aCaptureRecordData[R4A_CAPTURE_MAX_DATA];
+static volatile uint32_t r4aCaptureHead;    // Next byte to write
+static volatile uint32_t r4aCaptureTail;    // Next byte to read
+static portMUX_TYPE r4aCaptureMux = portMUX_INITIALIZER_UNLOCKED;
+
+static NetworkServer * r4aCaptureServer;
+static NetworkClient r4aCaptureServerClient;
+static uint16_t r4aCaptureServerPort;
+
+//*********************************************************************
+// Copy data into the ring buffer
+// Inputs:
+//   position: Position in the ring buffer
+//   data: Address of the data to copy
+//   length: Number of bytes to copy
+static void r4aCaptureCopyIn(uint32_t position,
+                             const uint8_t * data,
+                             uint32_t length)
+{
+    uint32_t bytes;
+    uint32_t offset;
+
+    offset = position % R4A_CAPTURE_BUFFER_BYTES;
+    bytes = R4A_CAPTURE_BUFFER_BYTES - offset;
+    if (bytes > length)
+        bytes = length;
+    memcpy(&r4aCaptureBuffer[offset], data, bytes);
+    if (length > bytes)
+        memcpy(r4aCaptureBuffer, &data[bytes], length - bytes);
+}
+
+//*********************************************************************
+// Copy data from the ring buffer
+// Inputs:
+//   position: Position in the ring buffer
+//   data: Address of the buffer to receive the data
+//   length: Number of bytes to copy
+static void r4aCaptureCopyOut(uint32_t position,
+                              uint8_t * data,
+                              uint32_t length)
+{
+    uint32_t bytes;
+    uint32_t offset;
+
+    offset = position % R4A_CAPTURE_BUFFER_BYTES;
+    bytes = R4A_CAPTURE_BUFFER_BYTES - offset;
+    if (bytes > length)
+        bytes = length;
+    memcpy(data, &r4aCaptureBuffer[offset], bytes);
+    if (length > bytes)
+        memcpy(&data[bytes], r4aCaptureBuffer, length - bytes);
+}
+
+//*********************************************************************
+// Remove a record from the ring buffer
+// Inputs:
+//   header: Buffer to receive the record header
+//   data: Buffer to receive the data, R4A_CAPTURE_MAX_DATA bytes
+//   end: Ring position where the removal stops
+// Outputs:
+//   Returns true when a record was returned and false when the ring is
+//   empty or the end position was reached
+static bool r4aCaptureRemove(R4A_CAPTURE_HEADER * header,
+                             uint8_t * data,
+                             uint32_t end)
+{
+    bool removed;
+
+    removed = false;
+    portENTER_CRITICAL(&r4aCaptureMux);
+    if ((int32_t)(end - r4aCaptureTail) > 0)
+    {
+        r4aCaptureCopyOut(r4aCaptureTail, (uint8_t *)header, sizeof(*header));
+        r4aCaptureCopyOut(r4aCaptureTail + sizeof(*header), data, header->length);
+        r4aCaptureTail += sizeof(*header) + header->length;
+        removed = true;
+    }
+    portEXIT_CRITICAL(&r4aCaptureMux);
+    return removed;
+}
+
+//*********************************************************************
+// Discard the captured data
+void r4aCaptureClear()
+{
+    portENTER_CRITICAL(&r4aCaptureMux);
+    r4aCaptureTail = r4aCaptureHead;
+    portEXIT_CRITICAL(&r4aCaptureMux);
+}
+
+//*********************************************************************
+// Save network data in the capture ring
+bool r4aCaptureData(uint8_t module,
+                    uint16_t session,
+                    uint8_t direction,
+                    const uint8_t * data,
+                    size_t length)
+{
+    R4A_CAPTURE_HEADER header;
+    bool saved;
+
+    // Build the record header, truncate large records
+    header.usec = micros();
+    header.originalLength = (length > 0xffff) ? 0xffff : length;
+    header.length = (length > R4A_CAPTURE_MAX_DATA) ? R4A_CAPTURE_MAX_DATA : length;
+    header.session = session;
+    header.module = module;
+    header.direction = direction;
+
+    // Place the record into the ring when space is available
+    saved = false;
+    portENTER_CRITICAL(&r4aCaptureMux);
+    if ((R4A_CAPTURE_BUFFER_BYTES - (r4aCaptureHead - r4aCaptureTail))
+        >= (sizeof(header) + header.length))
+    {
+        r4aCaptureCopyIn(r4aCaptureHead, (const uint8_t *)&header, sizeof(header));
+        r4aCaptureCopyIn(r4aCaptureHead + sizeof(header), data, header.length);
+        r4aCaptureHead += sizeof(header) + header.length;
+        saved = true;
+    }
+    portEXIT_CRITICAL(&r4aCaptureMux);
+
+    // Account for the record
+    if (saved)
+        __atomic_fetch_add(&r4aCaptureRecords, 1, __ATOMIC_RELAXED);
+    else
+        __atomic_fetch_add(&r4aCaptureDropped, 1, __ATOMIC_RELAXED);
+    return saved;
+}
+
+//*********************************************************************
+// Display the captured records in hexadecimal and ASCII
+// Inputs:
+//   display: Device used for output
+//   maxRecords: Maximum number of records to display
+//   end: Ring offset where the display stops
+// Outputs:
+//   Returns the number of records displayed
+static uint32_t r4aCaptureDisplayRecords(Print * display,
+                                         uint32_t maxRecords,
+                                         uint32_t end)
+{
+    R4A_CAPTURE_HEADER header;
+    uint32_t records;
+
+    for (records = 0; records < maxRecords; records++)
+    {
+        // Get the next record
+        if (!r4aCaptureRemove(&header, r4aCaptureRecordData, end))
+            break;
+
+        // Display the record header
+        display->printf("%ld.%06ld %s %d %s: %d bytes",
+                        header.usec / 1000000,
+                        header.usec % 1000000,
+                        r4aModuleName[header.module % R4A_MODULE_MAX],
+                        header.session,
+                        r4aCaptureDirection[header.direction & 1],
+                        header.originalLength);
+        if (header.length < header.originalLength)
+            display->printf(", %d captured", header.length);
+        display->println();
+
+        // Display the data
+        r4aDumpBuffer(0, r4aCaptureRecordData, header.length, display);
+    }
+    return records;
+}
+
+//*********************************************************************
+// Display the captured records in hexadecimal and ASCII
+uint32_t r4aCaptureDisplay(Print * display, uint32_t maxRecords)
+{
+    // Stop at the current end of the ring, the output may also be captured
+    return r4aCaptureDisplayRecords(display, maxRecords, r4aCaptureHead);
+}
+
+//*********************************************************************
+// Display the capture status
+void r4aCaptureDisplayStatus(Print * display)
+{
+    uint32_t pending;
+
+    pending = r4aCaptureHead - r4aCaptureTail;
+    display->printf("Capture: %s\r\n", r4aCaptureEnable ? "Enabled" : "Disabled");
+    display->printf("    %ld records captured, %ld dropped\r\n",
+                    r4aCaptureRecords, r4aCaptureDropped);
+    display->printf("    %ld of %d bytes pending\r\n",
+                    pending, R4A_CAPTURE_BUFFER_BYTES);
+    if (r4aCaptureServer)
+        display->printf("    Server port %d: %s\r\n",
+                        r4aCaptureServerPort,
+                        r4aCaptureServerClient.connected() ? "Connected" : "Listening");
+}
+
+//*********************************************************************
+// Output the captured records in pcap format
+uint32_t r4aCapturePcap(Print * output, uint32_t maxRecords)
+{
+    uint32_t end;
+    R4A_CAPTURE_HEADER header;
+    R4A_PCAP_RECORD_HEADER pcapHeader;
+    uint8_t pseudoHeader[R4A_CAPTURE_PSEUDO_HEADER_BYTES];
+    uint32_t records;
+
+    // Stop at the current end of the ring, the output may also be captured
+    end = r4aCaptureHead;
+    for (records = 0; records < maxRecords; records++)
+    {
+        // Get the next record
+        if (!r4aCaptureRemove(&header, r4aCaptureRecordData, end))
+            break;
+
+        // Build the pcap record header
+        pcapHeader.seconds = header.usec / 1000000;
+        pcapHeader.usec = header.usec % 1000000;
+        pcapHeader.includedLength = sizeof(pseudoHeader) + header.length;
+        pcapHeader.originalLength = sizeof(pseudoHeader) + header.originalLength;
+
+        // Build the pseudo header
+        pseudoHeader[0] = header.direction;
+        pseudoHeader[1] = header.module;
+        pseudoHeader[2] = header.session >> 8;
+        pseudoHeader[3] = header.session;
+
+        // Output the record
+        output->write((const uint8_t *)&pcapHeader, sizeof(pcapHeader));
+        output->write(pseudoHeader, sizeof(pseudoHeader));
+        output->write(r4aCaptureRecordData, header.length);
+    }
+    return records;
+}
+
+//*********************************************************************
+// Output the pcap file header
+void r4aCapturePcapHeader(Print * output)
+{
+    R4A_PCAP_FILE_HEADER header;
+
+    header.magic = R4A_CAPTURE_PCAP_MAGIC;
+    header.versionMajor = 2;
+    header.versionMinor = 4;
+    header.thisZone = 0;
+    header.sigFigs = 0;
+    header.snapLength = R4A_CAPTURE_PSEUDO_HEADER_BYTES + R4A_CAPTURE_MAX_DATA;
+    header.linkType = R4A_CAPTURE_PCAP_LINKTYPE;
+    output->write((const uint8_t *)&header, sizeof(header));
+}
+
+//*********************************************************************
+// Start the capture server
+bool r4aCaptureServerBegin(uint16_t port)
+{
+    if (!r4aCaptureServer)
+    {
+        r4aCaptureServer = r4aNew<NetworkServer>(R4A_MODULE_CAPTURE, port);
+        if (!r4aCaptureServer)
+        {
+            r4aLogError(R4A_MODULE_CAPTURE, "Failed to allocate the capture server!");
+            return false;
+        }
+        r4aCaptureServerPort = port;
+    }
+    return true;
+}
+
+//*********************************************************************
+// Update the capture server
+void r4aCaptureServerUpdate(bool connected)
+{
+    static bool serverBegin;
+    NetworkClient client;
+
+    if (!r4aCaptureServer)
+        return;
+
+    // Shutdown the server when the network fails
+    if (!connected)
+    {
+        if (r4aCaptureServerClient.connected())
+            r4aCaptureServerClient.stop();
+        serverBegin = false;
+        return;
+    }
+
+    // Start the server when the network is available
+    if (!serverBegin)
+    {
+        r4aCaptureServer->begin();
+        r4aCaptureServer->setNoDelay(true);
+        serverBegin = true;
+    }
+
+    // Check for a new client
+    if (r4aCaptureServer->hasClient())
+    {
+        client = r4aCaptureServer->accept();
+
+        // Only a single client is supported
+        if (r4aCaptureServerClient.connected())
+            client.stop();
+        else
+        {
+            r4aCaptureServerClient = client;
+            r4aCapturePcapHeader(&r4aCaptureServerClient);
+        }
+    }
+
+    // Stream the captured records to the client
+    if (r4aCaptureServerClient.connected())
+        r4aCapturePcap(&r4aCaptureServerClient, R4A_CAPTURE_SERVER_RECORDS);
+}
+
+//*********************************************************************
+// Update the capture server using the link state
+void r4aCaptureServerUpdate()
+{
+    static uint32_t linkGeneration;
+
+    r4aCaptureServerUpdate(r4aLinkIsUp(&linkGeneration));
+}
+
+//*********************************************************************
+// Constructor
+R4A_CAPTURE_CLIENT::R4A_CAPTURE_CLIENT(uint8_t module)
+    : NetworkClient(), _module{module}, _session{0}
+{
+}
+
+//*********************************************************************
+// Constructor
+R4A_CAPTURE_CLIENT::R4A_CAPTURE_CLIENT(const NetworkClient & client,
+                                       uint8_t module)
+    : NetworkClient(client), _module{module}, _session{0}
+{
+}
+
+//*********************************************************************
+// Determine the space available in the socket transmit buffer
+int R4A_CAPTURE_CLIENT::availableForWrite()
+{
+    int socket;
+    struct timeval timeout;
+    fd_set writeSet;
+
+    // Verify the connection
+    socket = fd();
+    if (socket < 0)
+        return 0;
+
+    // Determine if the socket has space without waiting
+    FD_ZERO(&writeSet);
+    FD_SET(socket, &writeSet);
+    timeout.tv_sec = 0;
+    timeout.tv_usec = 0;
+    if (select(socket + 1, nullptr, &writeSet, nullptr, &timeout) > 0)
+        return TCP_SNDLOWAT;
+
+    // Less space than a pager write
+    return 1;
+}
+
+//*********************************************************************
+// Read a byte from the network
+int R4A_CAPTURE_CLIENT::read()
+{
+    uint8_t value;
+
+    // NetworkClient::read() calls read(buffer, length) which captures
+    // the data, read the byte using the buffer routine to capture it once
+    if (read(&value, 1) == 1)
+        return value;
+    return -1;
+}
+
+//*********************************************************************
+// Read data from the network
+int R4A_CAPTURE_CLIENT::read(uint8_t * buffer, size_t length)
+{
+    int bytesRead;
+
+    bytesRead = NetworkClient::read(buffer, length);
+    if (r4aCaptureEnable && (bytesRead > 0))
+        r4aCaptureData(_module, session(), R4A_CAPTURE_RX, buffer, bytesRead);
+    return bytesRead;
+}
+
+//*********************************************************************
+// Get the session number for the capture record
+uint16_t R4A_CAPTURE_CLIENT::session()
+{
+    // Get the remote port once, avoid the system call on each capture
+    if (!_session)
+        _session = remotePort();
+    return _session;
+}
+
+//*********************************************************************
+// Write a byte to the network
+size_t R4A_CAPTURE_CLIENT::write(uint8_t data)
+{
+    // NetworkClient::write(data) calls write(buffer, length) which
+    // captures the data, write the byte using the buffer routine to
+    // capture it once
+    return write(&data, 1);
+}
+
+//*********************************************************************
+// Write data to the network
+size_t R4A_CAPTURE_CLIENT::write(const uint8_t * buffer, size_t length)
+{
+    size_t bytesWritten;
+
+    bytesWritten = NetworkClient::write(buffer, length);
+    if (r4aCaptureEnable && bytesWritten)
+        r4aCaptureData(_module, session(), R4A_CAPTURE_TX, buffer, bytesWritten);
+    return bytesWritten;
+}
+
+//*********************************************************************
+// Discard the captured data
+void r4aCaptureMenuClear(const R4A_MENU_ENTRY * menuEntry,
+                         const char * command,
+                         Print * display)
+{
+    r4aCaptureClear();
+}
+
+//*********************************************************************
+// Display the captured data
+void r4aCaptureMenuDisplay(const R4A_MENU_ENTRY * menuEntry,
+                           const char * command,
+                           Print * display)
+{
+    if (!r4aCaptureDisplay(display))
+        display->println("Capture is empty");
+}
+
+//*********************************************************************
+// Display the captured data one record per call
+int r4aCaptureMenuDisplayAsync(const R4A_MENU_ENTRY * menuEntry,
+                               const char * command,
+                               Print * display,
+                               intptr_t * state,
+                               bool cancel)
+{
+    // The remaining records stay in the ring when cancelled
+    if (cancel)
+        return R4A_MENU_ASYNC_DONE;
+
+    // Stop at the current end of the ring, the output may also be captured
+    if (command)
+    {
+        *state = (intptr_t)r4aCaptureHead;
+        if (!r4aCaptureDisplayRecords(display, 1, (uint32_t)*state))
+        {
+            display->println("Capture is empty");
+            return R4A_MENU_ASYNC_DONE;
+        }
+        return R4A_MENU_ASYNC_RUNNING;
+    }
+
+    // Display the next record
+    if (r4aCaptureDisplayRecords(display, 1, (uint32_t)*state))
+        return R4A_MENU_ASYNC_RUNNING;
+    return R4A_MENU_ASYNC_DONE;
+}
+
+//*********************************************************************
+// Display the capture status
+void r4aCaptureMenuStatus(const R4A_MENU_ENTRY * menuEntry,
+                          const char * command,
+                          Print * display)
+{
+    r4aCaptureDisplayStatus(display);
+}
@@ -0,0 +1,22 @@
+/**********************************************************************
+  Capture_Menu.cpp
+
+  Robots-For-All (R4A)
+  Capture menu support
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Capture menu
+//****************************************
+
+const R4A_MENU_ENTRY r4aCaptureMenuTable[] =
+{
+    // Command  menuRoutine             menuParam                       HelpRoutine         align   HelpText
+    {"c",       r4aCaptureMenuClear,    0,                              nullptr,            0,      "Discard the captured data"},   // 0
+    {"d",       nullptr,                0,                              nullptr,            0,      "Display the captured data",    r4aCaptureMenuDisplayAsync},    // 1
+    {"e",       r4aMenuBoolToggle,      (intptr_t)&r4aCaptureEnable,    r4aMenuBoolHelp,    0,      "Toggle network data capture"}, // 2
+    {"s",       r4aCaptureMenuStatus,   0,                              nullptr,            0,      "Display the capture status"},  // 3
+    {"x",       nullptr,                R4A_MENU_MAIN,                  nullptr,            0,      "Return to the main menu"},     // 4
+};                                                                                                                                  // 5
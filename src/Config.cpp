@@ -0,0 +1,673 @@
+/**********************************************************************
+  Config.cpp
+
+  Robots-For-All (R4A)
+  Persistent configuration store
+
+  The configuration tables describe the global variables saved in NVS.
+  The variables themselves are the working copy, the code reads them
+  directly.  A RAM cache holds the values last written to NVS.  The
+  update routine compares the variables with the cache to detect
+  changes made by the code, the menus or r4aConfigSet.  The changes are
+  written as a batch once they stop for R4A_CONFIG_COMMIT_DELAY_MSEC.
+  Only the changed keys are written, NVS spreads the writes across the
+  flash pages.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Constants
+//****************************************
+
+#define R4A_CONFIG_LINE_BYTES       128     // Longest key and value parameters
+#define R4A_CONFIG_NAMESPACE        "r4a"   // NVS namespace
+
+const char * const r4aConfigTypeName[] =
+{
+    "bool",     // R4A_CONFIG_TYPE_BOOL
+    "int8",     // R4A_CONFIG_TYPE_INT8
+    "uint8",    // R4A_CONFIG_TYPE_UINT8
+    "uint16",   // R4A_CONFIG_TYPE_UINT16
+    "uint32",   // R4A_CONFIG_TYPE_UINT32
+    "string",   // R4A_CONFIG_TYPE_STRING
+};
+
+//****************************************
+// Types
+//****************************************
+
+typedef struct _R4A_CONFIG_CACHE
+{
+    uint32_t value;     // Numeric value saved in NVS
+    char * string;      // String value saved in NVS
+    char * buffer;      // String buffer assigned to the variable
+} R4A_CONFIG_CACHE;
+
+//****************************************
+// Globals
+//****************************************
+
+const R4A_CONFIG_ENTRY r4aConfigTable[] =
+{
+    R4A_CONFIG("captureEnable",   r4aCaptureEnable,               "Capture network data"),
+    R4A_CONFIG("ledIntensity",    r4aLEDIntensity,                "LED intensity (0 - 255)"),
+    R4A_CONFIG("ntpDebug",        r4aNtpDebugStates,              "Display NTP state changes"),
+    R4A_CONFIG("ntripCompany",    r4aNtripClientCompany,          "NTRIP \"Company\" for your robot"),
+    R4A_CONFIG("ntripDebugRtcm",  r4aNtripClientDebugRtcm,        "Display NTRIP RTCM data"),
+    R4A_CONFIG("ntripDebugState", r4aNtripClientDebugState,       "Display NTRIP state changes"),
+    R4A_CONFIG("ntripEnable",     r4aNtripClientEnable,           "Enable the NTRIP client"),
+    R4A_CONFIG("ntripHost",       r4aNtripClientCasterHost,       "NTRIP caster host name"),
+    R4A_CONFIG("ntripMountPoint", r4aNtripClientCasterMountPoint, "NTRIP caster mount point"),
+    R4A_CONFIG_SECRET("ntripPassword", r4aNtripClientCasterUserPW, "NTRIP caster password"),
+    R4A_CONFIG("ntripPort",       r4aNtripClientCasterPort,       "NTRIP caster port"),
+    R4A_CONFIG("ntripProduct",    r4aNtripClientProduct,          "NTRIP \"Product\" for your robot"),
+    R4A_CONFIG("ntripRspDone",    r4aNtripClientResponseDone,     "NTRIP end of response timeout (mSec)"),
+    R4A_CONFIG("ntripRspTimeout", r4aNtripClientResponseTimeout,  "NTRIP RTCM data timeout (mSec)"),
+    R4A_CONFIG("ntripRxTimeout",  r4aNtripClientReceiveTimeout,   "NTRIP response timeout (mSec)"),
+    R4A_CONFIG("ntripUser",       r4aNtripClientCasterUser,       "NTRIP caster user (e-mail address)"),
+    R4A_CONFIG("ntripVersion",    r4aNtripClientProductVersion,   "NTRIP \"Version\" of your robot"),
+    R4A_CONFIG("tzHours",         r4aTimeZoneHours,               "Time zone hours"),
+    R4A_CONFIG("tzMinutes",       r4aTimeZoneMinutes,             "Time zone minutes"),
+    R4A_CONFIG("tzSeconds",       r4aTimeZoneSeconds,             "Time zone seconds"),
+    R4A_CONFIG("wifiDebug",       r4aWiFiDebugStates,             "Display WiFi state changes"),
+    R4A_CONFIG("wifiUseLease",    r4aWiFiUseCachedLease,          "Reuse the DHCP lease on reconnect"),
+};
+const int r4aConfigTableEntries = sizeof(r4aConfigTable) / sizeof(r4aConfigTable[0]);
+
+//****************************************
+// Locals
+//****************************************
+
+static const R4A_CONFIG_ENTRY * r4aConfigAppTable;
+static int r4aConfigAppEntries;
+static R4A_CONFIG_CACHE * r4aConfigCache;
+static uint32_t r4aConfigChangeMsec;    // Time when the changes were detected
+static bool r4aConfigDirty;             // Variables differ from NVS
+static Preferences r4aConfigPreferences;
+static uint32_t r4aConfigScanMsec;      // Time of the last change scan
+
+//****************************************
+// Metrics
+//****************************************
+
+static R4A_METRIC r4aConfigMetricCommits("r4a_config_commits_total",
+                                         "Configuration change batches written to NVS",
+                                         R4A_METRIC_COUNTER);
+static R4A_METRIC r4aConfigMetricWrites("r4a_config_writes_total",
+                                        "Configuration keys written to NVS",
+                                        R4A_METRIC_COUNTER);
+
+//*********************************************************************
+// Get the configuration entry
+// Inputs:
+//   index: Index of the entry, library entries followed by the application
+//          entries
+// Outputs:
+//   Returns the address of the entry
+static const R4A_CONFIG_ENTRY * r4aConfigEntry(int index)
+{
+    if (index < r4aConfigTableEntries)
+        return &r4aConfigTable[index];
+    return &r4aConfigAppTable[index - r4aConfigTableEntries];
+}
+
+//*********************************************************************
+// Locate the configuration entry
+// Inputs:
+//   key: Zero terminated key string
+// Outputs:
+//   Returns the index of the entry or -1 if not found
+static int r4aConfigFind(const char * key)
+{
+    int entries;
+
+    entries = r4aConfigTableEntries + r4aConfigAppEntries;
+    for (int index = 0; index < entries; index++)
+        if (r4aStricmp(r4aConfigEntry(index)->key, key) == 0)
+            return index;
+    return -1;
+}
+
+//*********************************************************************
+// Get the numeric value of the variable
+// Inputs:
+//   entry: Address of the configuration entry
+// Outputs:
+//   Returns the value of the variable
+static uint32_t r4aConfigGetValue(const R4A_CONFIG_ENTRY * entry)
+{
+    switch (entry->type)
+    {
+    default:
+        return 0;
+    case R4A_CONFIG_TYPE_BOOL:
+        return *(volatile bool *)entry->address;
+    case R4A_CONFIG_TYPE_INT8:
+        return (uint32_t)(int32_t)*(int8_t *)entry->address;
+    case R4A_CONFIG_TYPE_UINT8:
+        return *(uint8_t *)entry->address;
+    case R4A_CONFIG_TYPE_UINT16:
+        return *(uint16_t *)entry->address;
+    case R4A_CONFIG_TYPE_UINT32:
+        return *(uint32_t *)entry->address;
+    }
+}
+
+//*********************************************************************
+// Get the string value of the variable
+// Inputs:
+//   entry: Address of the configuration entry
+// Outputs:
+//   Returns the address of the zero terminated string
+static const char * r4aConfigGetString(const R4A_CONFIG_ENTRY * entry)
+{
+    const char * string;
+
+    string = *(const char **)entry->address;
+    return string ? string : "";
+}
+
+//*********************************************************************
+// Make a copy of a string
+// Inputs:
+//   string: Zero terminated string to copy
+// Outputs:
+//   Returns the address of the copy or nullptr upon failure
+static char * r4aConfigStringCopy(const char * string)
+{
+    char * copy;
+
+    copy = (char *)r4aMalloc(R4A_MODULE_CONFIG, strlen(string) + 1);
+    if (copy)
+        strcpy(copy, string);
+    return copy;
+}
+
+//*********************************************************************
+// Determine if the variable differs from the value saved in NVS
+// Inputs:
+//   index: Index of the entry
+// Outputs:
+//   Returns true if the variable was changed
+static bool r4aConfigChanged(int index)
+{
+    R4A_CONFIG_CACHE * cache;
+    const R4A_CONFIG_ENTRY * entry;
+
+    entry = r4aConfigEntry(index);
+    cache = &r4aConfigCache[index];
+    if (entry->type == R4A_CONFIG_TYPE_STRING)
+        return (strcmp(r4aConfigGetString(entry), cache->string ? cache->string : "") != 0);
+    return (r4aConfigGetValue(entry) != cache->value);
+}
+
+//*********************************************************************
+// Set the numeric value of the variable
+// Inputs:
+//   entry: Address of the configuration entry
+//   value: New value for the variable
+static void r4aConfigSetValue(const R4A_CONFIG_ENTRY * entry, uint32_t value)
+{
+    switch (entry->type)
+    {
+    case R4A_CONFIG_TYPE_BOOL:
+        *(volatile bool *)entry->address = (value != 0);
+        break;
+    case R4A_CONFIG_TYPE_INT8:
+        *(int8_t *)entry->address = (int8_t)value;
+        break;
+    case R4A_CONFIG_TYPE_UINT8:
+        *(uint8_t *)entry->address = (uint8_t)value;
+        break;
+    case R4A_CONFIG_TYPE_UINT16:
+        *(uint16_t *)entry->address = (uint16_t)value;
+        break;
+    case R4A_CONFIG_TYPE_UINT32:
+        *(uint32_t *)entry->address = value;
+        break;
+    }
+}
+
+//*********************************************************************
+// Set the string value of the variable
+// Inputs:
+//   index: Index of the entry
+//   string: Zero terminated string value
+// Outputs:
+//   Returns true if successful and false upon failure
+static bool r4aConfigSetString(int index, const char * string)
+{
+    char * buffer;
+    R4A_CONFIG_CACHE * cache;
+
+    // Allocate the buffer for the variable
+    buffer = r4aConfigStringCopy(string);
+    if (!buffer)
+        return false;
+
+    // Replace the previous buffer
+    cache = &r4aConfigCache[index];
+    *(const char **)r4aConfigEntry(index)->address = buffer;
+    r4aFree(cache->buffer);
+    cache->buffer = buffer;
+    return true;
+}
+
+//*********************************************************************
+// Save the value of the variable in the cache
+// Inputs:
+//   index: Index of the entry
+static void r4aConfigSnapshot(int index)
+{
+    R4A_CONFIG_CACHE * cache;
+    const R4A_CONFIG_ENTRY * entry;
+
+    entry = r4aConfigEntry(index);
+    cache = &r4aConfigCache[index];
+    if (entry->type != R4A_CONFIG_TYPE_STRING)
+        cache->value = r4aConfigGetValue(entry);
+    else
+    {
+        r4aFree(cache->string);
+        cache->string = r4aConfigStringCopy(r4aConfigGetString(entry));
+    }
+}
+
+//*********************************************************************
+// Write the value of the variable to NVS
+// Inputs:
+//   index: Index of the entry
+// Outputs:
+//   Returns true if successful and false upon failure
+static bool r4aConfigWrite(int index)
+{
+    size_t bytes;
+    const R4A_CONFIG_ENTRY * entry;
+    const char * string;
+
+    entry = r4aConfigEntry(index);
+    switch (entry->type)
+    {
+    default:
+        bytes = 0;
+        break;
+    case R4A_CONFIG_TYPE_BOOL:
+        bytes = r4aConfigPreferences.putBool(entry->key, r4aConfigGetValue(entry));
+        break;
+    case R4A_CONFIG_TYPE_INT8:
+        bytes = r4aConfigPreferences.putChar(entry->key, (int8_t)r4aConfigGetValue(entry));
+        break;
+    case R4A_CONFIG_TYPE_UINT8:
+        bytes = r4aConfigPreferences.putUChar(entry->key, r4aConfigGetValue(entry));
+        break;
+    case R4A_CONFIG_TYPE_UINT16:
+        bytes = r4aConfigPreferences.putUShort(entry->key, r4aConfigGetValue(entry));
+        break;
+    case R4A_CONFIG_TYPE_UINT32:
+        bytes = r4aConfigPreferences.putULong(entry->key, r4aConfigGetValue(entry));
+        break;
+    case R4A_CONFIG_TYPE_STRING:
+        // The length of an empty string is zero, use one byte to indicate
+        // success
+        string = r4aConfigGetString(entry);
+        bytes = r4aConfigPreferences.putString(entry->key, string);
+        if ((*string == 0) && r4aConfigPreferences.isKey(entry->key))
+            bytes = 1;
+        break;
+    }
+    if (!bytes)
+    {
+        r4aLogError(R4A_MODULE_CONFIG, "Failed to write %s to NVS!", entry->key);
+        return false;
+    }
+    r4aConfigMetricWrites.add();
+    r4aConfigSnapshot(index);
+    return true;
+}
+
+//*********************************************************************
+// Initialize the configuration store
+bool r4aConfigBegin(const R4A_CONFIG_ENTRY * appTable, int appEntries)
+{
+    R4A_CONFIG_CACHE * cache;
+    int entries;
+    const R4A_CONFIG_ENTRY * entry;
+    size_t length;
+    String string;
+
+    // Only initialize once
+    if (r4aConfigCache)
+        return true;
+
+    // Allocate the cache
+    entries = r4aConfigTableEntries + appEntries;
+    length = entries * sizeof(*cache);
+    cache = (R4A_CONFIG_CACHE *)r4aMalloc(R4A_MODULE_CONFIG, length);
+    if (!cache)
+    {
+        r4aLogError(R4A_MODULE_CONFIG, "Failed to allocate the configuration cache!");
+        return false;
+    }
+    memset(cache, 0, length);
+
+    // Open the NVS namespace
+    if (!r4aConfigPreferences.begin(R4A_CONFIG_NAMESPACE, false))
+    {
+        r4aLogError(R4A_MODULE_CONFIG, "Failed to open the NVS namespace!");
+        r4aFree(cache);
+        return false;
+    }
+    r4aConfigAppTable = appTable;
+    r4aConfigAppEntries = appEntries;
+    r4aConfigCache = cache;
+
+    // Load the saved values into the variables, keep the default values
+    // when the keys are not found
+    for (int index = 0; index < entries; index++)
+    {
+        entry = r4aConfigEntry(index);
+        if (r4aConfigPreferences.isKey(entry->key))
+        {
+            switch (entry->type)
+            {
+            case R4A_CONFIG_TYPE_BOOL:
+                r4aConfigSetValue(entry, r4aConfigPreferences.getBool(entry->key));
+                break;
+            case R4A_CONFIG_TYPE_INT8:
+                r4aConfigSetValue(entry, r4aConfigPreferences.getChar(entry->key));
+                break;
+            case R4A_CONFIG_TYPE_UINT8:
+                r4aConfigSetValue(entry, r4aConfigPreferences.getUChar(entry->key));
+                break;
+            case R4A_CONFIG_TYPE_UINT16:
+                r4aConfigSetValue(entry, r4aConfigPreferences.getUShort(entry->key));
+                break;
+            case R4A_CONFIG_TYPE_UINT32:
+                r4aConfigSetValue(entry, r4aConfigPreferences.getULong(entry->key));
+                break;
+            case R4A_CONFIG_TYPE_STRING:
+                string = r4aConfigPreferences.getString(entry->key);
+                r4aConfigSetString(index, string.c_str());
+                break;
+            }
+        }
+
+        // Remember the value saved in NVS
+        r4aConfigSnapshot(index);
+    }
+    r4aConfigScanMsec = millis();
+    return true;
+}
+
+//*********************************************************************
+// Write the changed values to NVS
+bool r4aConfigCommit()
+{
+    int entries;
+    bool success;
+
+    if (!r4aConfigCache)
+        return false;
+
+    // Write the changed values
+    success = true;
+    entries = r4aConfigTableEntries + r4aConfigAppEntries;
+    for (int index = 0; index < entries; index++)
+        if (r4aConfigChanged(index))
+            success &= r4aConfigWrite(index);
+    r4aConfigDirty = false;
+    r4aConfigMetricCommits.add();
+    return success;
+}
+
+//*********************************************************************
+// Display a configuration value
+// Inputs:
+//   index: Index of the entry
+//   display: Device used for output
+static void r4aConfigDisplayValue(int index, Print * display)
+{
+    const R4A_CONFIG_ENTRY * entry;
+
+    entry = r4aConfigEntry(index);
+    display->printf("%-16s %-6s %s", entry->key, r4aConfigTypeName[entry->type],
+                    r4aConfigChanged(index) ? "*" : " ");
+    switch (entry->type)
+    {
+    case R4A_CONFIG_TYPE_BOOL:
+        display->printf(" %-24s", r4aConfigGetValue(entry) ? "true" : "false");
+        break;
+    case R4A_CONFIG_TYPE_INT8:
+        display->printf(" %-24ld", (int32_t)r4aConfigGetValue(entry));
+        break;
+    case R4A_CONFIG_TYPE_UINT8:
+    case R4A_CONFIG_TYPE_UINT16:
+    case R4A_CONFIG_TYPE_UINT32:
+        display->printf(" %-24lu", r4aConfigGetValue(entry));
+        break;
+    case R4A_CONFIG_TYPE_STRING:
+        // Hide the secret values, only show that they are set
+        if (entry->secret && *r4aConfigGetString(entry))
+            display->printf(" \"%s\"", "********");
+        else
+            display->printf(" \"%s\"", r4aConfigGetString(entry));
+        break;
+    }
+    display->printf(" %s\r\n", entry->helpText);
+}
+
+//*********************************************************************
+// Display the configuration
+void r4aConfigDisplay(Print * display)
+{
+    int entries;
+
+    if (!r4aConfigCache)
+    {
+        display->println("Configuration store not started");
+        return;
+    }
+
+    // Display the values, * marks the values not yet written to NVS
+    entries = r4aConfigTableEntries + r4aConfigAppEntries;
+    for (int index = 0; index < entries; index++)
+        r4aConfigDisplayValue(index, display);
+}
+
+//*********************************************************************
+// Display a configuration value
+bool r4aConfigGet(const char * key, Print * display)
+{
+    int index;
+
+    index = r4aConfigCache ? r4aConfigFind(key) : -1;
+    if (index < 0)
+    {
+        display->printf("ERROR: Unknown key %s\r\n", key);
+        return false;
+    }
+    r4aConfigDisplayValue(index, display);
+    return true;
+}
+
+//*********************************************************************
+// Set a configuration value
+bool r4aConfigSet(const char * key, const char * value, Print * display)
+{
+    const R4A_CONFIG_ENTRY * entry;
+    char * end;
+    int index;
+    int32_t maximum;
+    int32_t minimum;
+    uint32_t number;
+
+    // Locate the entry
+    index = r4aConfigCache ? r4aConfigFind(key) : -1;
+    if (index < 0)
+    {
+        display->printf("ERROR: Unknown key %s\r\n", key);
+        return false;
+    }
+    entry = r4aConfigEntry(index);
+
+    // Set the value
+    switch (entry->type)
+    {
+    default:
+        return false;
+
+    case R4A_CONFIG_TYPE_BOOL:
+        if ((r4aStricmp(value, "1") == 0) || (r4aStricmp(value, "true") == 0)
+            || (r4aStricmp(value, "on") == 0))
+            number = 1;
+        else if ((r4aStricmp(value, "0") == 0) || (r4aStricmp(value, "false") == 0)
+            || (r4aStricmp(value, "off") == 0))
+            number = 0;
+        else
+        {
+            display->printf("ERROR: %s needs true or false\r\n", key);
+            return false;
+        }
+        r4aConfigSetValue(entry, number);
+        break;
+
+    case R4A_CONFIG_TYPE_INT8:
+        number = strtol(value, &end, 0);
+        if (*value && (*end == 0)
+            && ((int32_t)number >= -128) && ((int32_t)number <= 127))
+        {
+            r4aConfigSetValue(entry, number);
+            break;
+        }
+        display->printf("ERROR: %s needs a value in the range (-128 - 127)\r\n", key);
+        return false;
+
+    case R4A_CONFIG_TYPE_UINT8:
+    case R4A_CONFIG_TYPE_UINT16:
+    case R4A_CONFIG_TYPE_UINT32:
+        minimum = 0;
+        maximum = (entry->type == R4A_CONFIG_TYPE_UINT8) ? 0xff : 0xffff;
+        number = strtoul(value, &end, 0);
+        if (*value && (*value != '-') && (*end == 0)
+            && ((entry->type == R4A_CONFIG_TYPE_UINT32)
+                || (number <= (uint32_t)maximum)))
+        {
+            r4aConfigSetValue(entry, number);
+            break;
+        }
+        if (entry->type == R4A_CONFIG_TYPE_UINT32)
+            display->printf("ERROR: %s needs a positive value\r\n", key);
+        else
+            display->printf("ERROR: %s needs a value in the range (%ld - %ld)\r\n",
+                            key, minimum, maximum);
+        return false;
+
+    case R4A_CONFIG_TYPE_STRING:
+        if (!r4aConfigSetString(index, value))
+        {
+            display->printf("ERROR: Failed to allocate the %s buffer\r\n", key);
+            return false;
+        }
+        break;
+    }
+    return true;
+}
+
+//*********************************************************************
+// Detect the changed values and write them to NVS
+void r4aConfigUpdate()
+{
+    uint32_t currentMsec;
+    int entries;
+
+    if (!r4aConfigCache)
+        return;
+
+    // Scan the variables for changes
+    currentMsec = millis();
+    if ((currentMsec - r4aConfigScanMsec) >= R4A_CONFIG_SCAN_MSEC)
+    {
+        r4aConfigScanMsec = currentMsec;
+        if (!r4aConfigDirty)
+        {
+            entries = r4aConfigTableEntries + r4aConfigAppEntries;
+            for (int index = 0; index < entries; index++)
+            {
+                if (r4aConfigChanged(index))
+                {
+                    r4aConfigDirty = true;
+                    r4aConfigChangeMsec = currentMsec;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Write the batch of changes to NVS
+    if (r4aConfigDirty
+        && ((currentMsec - r4aConfigChangeMsec) >= R4A_CONFIG_COMMIT_DELAY_MSEC))
+        r4aConfigCommit();
+}
+
+//****************************************
+// Config Menu API
+//****************************************
+
+//*********************************************************************
+// Display a configuration value
+void r4aConfigMenuGet(const R4A_MENU_ENTRY * menuEntry,
+                      const char * command,
+                      Print * display)
+{
+    char key[R4A_CONFIG_LINE_BYTES];
+
+    r4aMenuGetParameters(menuEntry, command, key, sizeof(key));
+    r4aConfigGet(key, display);
+}
+
+//*********************************************************************
+// Display the configuration
+void r4aConfigMenuList(const R4A_MENU_ENTRY * menuEntry,
+                       const char * command,
+                       Print * display)
+{
+    r4aConfigDisplay(display);
+}
+
+//*********************************************************************
+// Write the configuration changes to NVS
+void r4aConfigMenuSave(const R4A_MENU_ENTRY * menuEntry,
+                       const char * command,
+                       Print * display)
+{
+    if (r4aConfigCommit())
+        display->println("Configuration saved");
+    else
+        display->println("ERROR: Failed to save the configuration!");
+}
+
+//*********************************************************************
+// Set a configuration value
+void r4aConfigMenuSet(const R4A_MENU_ENTRY * menuEntry,
+                      const char * command,
+                      Print * display)
+{
+    char * key;
+    char line[R4A_CONFIG_LINE_BYTES];
+    char * value;
+
+    // Split the parameters into the key and the value
+    key = r4aMenuGetParameters(menuEntry, command, line, sizeof(line));
+    value = key;
+    while (*value && (*value != ' ') && (*value != '\t'))
+        value++;
+    if (*value)
+        *value++ = 0;
+    while ((*value == ' ') || (*value == '\t'))
+        value++;
+
+    // Set the value
+    if (r4aConfigSet(key, value, display))
+        r4aConfigGet(key, display);
+}
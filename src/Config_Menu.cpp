@@ -0,0 +1,22 @@
+/**********************************************************************
+  Config_Menu.cpp
+
+  Robots-For-All (R4A)
+  Configuration menu support
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Configuration menu
+//****************************************
+
+const R4A_MENU_ENTRY r4aConfigMenuTable[] =
+{
+    // Command  menuRoutine         menuParam               HelpRoutine         align   HelpText
+    {"get",     r4aConfigMenuGet,   (intptr_t)"key",        r4aMenuHelpSuffix,  9,      "Display the value of key"},    // 0
+    {"list",    r4aConfigMenuList,  0,                      nullptr,            0,      "List the configuration"},      // 1
+    {"save",    r4aConfigMenuSave,  0,                      nullptr,            0,      "Write the changes to flash"},  // 2
+    {"set",     r4aConfigMenuSet,   (intptr_t)"key value",  r4aMenuHelpSuffix,  9,      "Set the value of key"},        // 3
+    {"x",       nullptr,            R4A_MENU_MAIN,          nullptr,            0,      "Return to the main menu"},     // 4
+};                                                                                                                          // 5
@@ -9,3 +9,24 @@
 
 // Support sub-menu processing by changing this value
 volatile R4A_COMMAND_PROCESSOR r4aProcessCommand;
+
+// Names of the library modules
+const char * const r4aModuleName[R4A_MODULE_MAX] =
+{
+    "Application",  // R4A_MODULE_APPLICATION
+    "Bluetooth",    // R4A_MODULE_BLUETOOTH
+    "LED",          // R4A_MODULE_LED
+    "Menu",         // R4A_MODULE_MENU
+    "NTP",          // R4A_MODULE_NTP
+    "NTRIP Client", // R4A_MODULE_NTRIP_CLIENT
+    "Robot",        // R4A_MODULE_ROBOT
+    "Serial",       // R4A_MODULE_SERIAL
+    "Telnet",       // R4A_MODULE_TELNET
+    "Capture",      // R4A_MODULE_CAPTURE
+    "Log",          // R4A_MODULE_LOG
+    "Metrics",      // R4A_MODULE_METRICS
+    "Link",         // R4A_MODULE_LINK
+    "WiFi",         // R4A_MODULE_WIFI
+    "Config",       // R4A_MODULE_CONFIG
+    "Service",      // R4A_MODULE_SERVICE
+};
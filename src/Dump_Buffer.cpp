@@ -7,55 +7,126 @@
 
 #include "R4A_Robot.h"
 
+//****************************************
+// Constants
+//****************************************
+
+//          1         2         3         4         5         6         7
+//0123456789012345678901234567890123456789012345678901234567890123456789012345678
+//0x00000000: 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f  ................\r\n
+
+#define R4A_DUMP_BYTES_PER_LINE     16
+#define R4A_DUMP_HEX_COLUMN         12
+#define R4A_DUMP_ASCII_COLUMN       (R4A_DUMP_HEX_COLUMN + (3 * R4A_DUMP_BYTES_PER_LINE) + 1)
+#define R4A_DUMP_LINE_LENGTH        (R4A_DUMP_ASCII_COLUMN + R4A_DUMP_BYTES_PER_LINE + 2)
+
+static const char r4aDumpHex[] = "0123456789abcdef";
+
 //*********************************************************************
-// Dump the contents of a buffer
-void r4aDumpBuffer(uint32_t offset,
-                   const uint8_t *buffer,
-                   uint32_t length,
-                   Print * display)
+// Format a line of the buffer dump
+// Inputs:
+//   line: Buffer to receive the line, R4A_DUMP_LINE_LENGTH bytes
+//   offset: Offset of the first byte on the line
+//   buffer: Address of the first data byte on the line
+//   bytes: Number of bytes to display on the line
+// Outputs:
+//   Returns the number of characters in the line
+static int r4aDumpBufferLine(char * line,
+                             uint32_t offset,
+                             const uint8_t * buffer,
+                             int bytes)
 {
-    int bytes;
-    const uint8_t *end;
+    char * ascii;
+    uint8_t data;
+    char * hex;
     int index;
-    char line[132];
+    int skip;
+
+    // Display the offset
+    line[0] = '0';
+    line[1] = 'x';
+    for (index = 0; index < 8; index++)
+        line[2 + index] = r4aDumpHex[(offset >> (28 - (index << 2))) & 0xf];
+    line[10] = ':';
 
-    end = &buffer[length];
-    while (buffer < end)
+    // Blank the data area and the leading ASCII bytes
+    skip = offset & (R4A_DUMP_BYTES_PER_LINE - 1);
+    memset(&line[11], ' ', R4A_DUMP_ASCII_COLUMN + skip - 11);
+
+    // Display the data bytes and the ASCII values
+    hex = &line[R4A_DUMP_HEX_COLUMN + (skip * 3)];
+    ascii = &line[R4A_DUMP_ASCII_COLUMN + skip];
+    for (index = 0; index < bytes; index++)
     {
-        // Determine the number of bytes to display on the line
-        bytes = end - buffer;
-        if (bytes > (16 - (offset & 0xf)))
-            bytes = 16 - (offset & 0xf);
+        data = buffer[index];
+        *hex++ = r4aDumpHex[data >> 4];
+        *hex++ = r4aDumpHex[data & 0xf];
+        hex++;
+        *ascii++ = ((data < ' ') || (data >= 0x7f)) ? '.' : data;
+    }
 
-        // Display the offset
-        sprintf(line, "0x%08lx: ", offset);
+    // Terminate the line
+    *ascii++ = '\r';
+    *ascii++ = '\n';
+    return ascii - line;
+}
 
-        // Skip leading bytes
-        for (index = 0; index < (offset & 0xf); index++)
-            strcat(&line[strlen(line)], "   ");
+//*********************************************************************
+// Dump the contents of a buffer
+void r4aDumpBuffer(uint32_t offset,
+                   const uint8_t *buffer,
+                   uint32_t length,
+                   Print * display)
+{
+    R4A_DUMP_CURSOR cursor;
 
-        // Display the data bytes
-        for (index = 0; index < bytes; index++)
-            sprintf(&line[strlen(line)], "%02x ", buffer[index]);
+    r4aDumpBufferBegin(&cursor, offset, buffer, length);
+    r4aDumpBufferContinue(&cursor, length, display);
+}
 
-        // Separate the data bytes from the ASCII
-        for (; index < (16 - (offset & 0xf)); index++)
-            strcat(&line[strlen(line)], "   ");
-        strcat(&line[strlen(line)], " ");
+//*********************************************************************
+// Start a streaming buffer dump
+void r4aDumpBufferBegin(R4A_DUMP_CURSOR * cursor,
+                        uint32_t offset,
+                        const uint8_t *buffer,
+                        uint32_t length)
+{
+    cursor->offset = offset;
+    cursor->buffer = buffer;
+    cursor->length = length;
+}
 
-        // Skip leading bytes
-        for (index = 0; index < (offset & 0xf); index++)
-            strcat(&line[strlen(line)], " ");
+//*********************************************************************
+// Continue a streaming buffer dump
+bool r4aDumpBufferContinue(R4A_DUMP_CURSOR * cursor,
+                           uint32_t maxBytes,
+                           Print * display)
+{
+    uint32_t bytes;
+    uint32_t displayed;
+    char line[R4A_DUMP_LINE_LENGTH];
 
-        // Display the ASCII values
-        for (index = 0; index < bytes; index++)
-            sprintf(&line[strlen(line)], "%c", ((buffer[index] < ' ') || (buffer[index] >= 0x7f)) ? '.' : buffer[index]);
+    // Display at least one line
+    displayed = 0;
+    while (cursor->length && ((displayed == 0) || (displayed < maxBytes)))
+    {
+        // Determine the number of bytes to display on the line
+        bytes = R4A_DUMP_BYTES_PER_LINE
+              - (cursor->offset & (R4A_DUMP_BYTES_PER_LINE - 1));
+        if (bytes > cursor->length)
+            bytes = cursor->length;
 
         // Output the line
-        display->printf("%s\r\n", line);
+        display->write((const uint8_t *)line,
+                       r4aDumpBufferLine(line, cursor->offset, cursor->buffer, bytes));
 
         // Set the next line of data
-        buffer += bytes;
-        offset += bytes;
+        cursor->buffer += bytes;
+        cursor->offset += bytes;
+        cursor->length -= bytes;
+        displayed += bytes;
     }
+
+    // Determine if the dump is complete
+    return (cursor->length == 0);
 }
@@ -11,11 +11,8 @@
 // Constants
 //****************************************
 
-#define R4A_LED_RESET       (5 * 6) // Zero bytes to cause reset
 #define R4A_LED_ONES        0       // One bytes to prevent reset
 
-extern const uint8_t r4aLEDIntensityTable[]; // Color intensity bits to bytes
-
 //****************************************
 // Globals
 //****************************************
@@ -24,9 +21,54 @@ uint32_t * r4aLEDColor;
 volatile bool r4aLEDColorWritten;
 uint8_t *  r4aLEDFourColorsBitmap;
 uint8_t r4aLEDIntensity = 255;
-uint8_t r4aLEDs;
+R4A_LED_OUTPUT * r4aLEDOutput;
+uint8_t * r4aLEDPaletteIndex;
+uint16_t r4aLEDs;
 uint8_t *  r4aLEDTxDmaBuffer;
 
+//****************************************
+// Locals
+//****************************************
+
+static uint8_t r4aLEDChannelMilliamps;      // Current for one color at 255
+static TaskHandle_t r4aLEDEncodeCaller;     // Task waiting for the second half
+static uint8_t * r4aLEDEncodeData;          // Second half start, then end
+static int r4aLEDEncodeFirst;               // First LED of the second half
+static uint8_t r4aLEDEncodeIntensity = 255; // Intensity after the power limit
+static TaskHandle_t r4aLEDEncodeTaskHandle; // Encodes the second half
+static uint8_t r4aLEDEncodingBytes;         // Output bytes per color byte
+static const uint8_t * r4aLEDEncodingTable; // nullptr to copy color byte
+static uint32_t r4aLEDPalette[R4A_LED_PALETTE_MAX];  // Palette colors
+static uint8_t * r4aLEDPaletteEncoded;      // Encoded palette colors
+static uint16_t r4aLEDPaletteCount[R4A_LED_PALETTE_MAX]; // LEDs per color
+static uint8_t r4aLEDPaletteEntries;        // Number of palette colors
+static uint16_t r4aLEDPaletteFourColors;    // One bit per palette color
+static int r4aLEDPaletteIntensity;          // Intensity used for encoding
+static uint8_t r4aLEDPaletteLength[R4A_LED_PALETTE_MAX]; // Encoded bytes
+static uint32_t r4aLEDPowerLimitMilliamps;  // Current limit, zero when disabled
+static uint32_t r4aLEDPowerSum;             // Sum of the color values
+
+//****************************************
+// Metrics
+//****************************************
+
+static const int32_t r4aLEDMetricEncodeBounds[] = {50, 100, 200, 500, 1000, 2000};
+static uint32_t r4aLEDMetricEncodeBuckets[sizeof(r4aLEDMetricEncodeBounds) / sizeof(int32_t) + 1];
+static R4A_METRIC r4aLEDMetricEncodeUsec("r4a_led_encode_usec",
+                                         "Microseconds to encode the LED colors",
+                                         r4aLEDMetricEncodeBounds,
+                                         sizeof(r4aLEDMetricEncodeBounds) / sizeof(int32_t),
+                                         r4aLEDMetricEncodeBuckets);
+static R4A_METRIC r4aLEDMetricMilliamps("r4a_led_milliamps",
+                                        "Estimated LED current in milliamps",
+                                        R4A_METRIC_GAUGE);
+static R4A_METRIC r4aLEDMetricPowerIntensity("r4a_led_power_intensity",
+                                             "Intensity after the power limit",
+                                             R4A_METRIC_GAUGE);
+static R4A_METRIC r4aLEDMetricUpdates("r4a_led_updates_total",
+                                      "LED color transfers",
+                                      R4A_METRIC_COUNTER);
+
 //*********************************************************************
 // The WS2812 LED specification uses the following bit definitions at
 // approximately 800 KHz:
@@ -57,7 +99,30 @@ uint8_t *  r4aLEDTxDmaBuffer;
 //
 //
 // This data stream is approximated using a SPI data stream clocked at
-// 4 MHz.
+// 4 MHz.  Each LED data bit is encoded as 5 SPI bits: 11000 for zero and
+// 11100 for one.  The 0.5 uSec high time for zero is at the WS2812
+// limit, the clock may be raised to 5.45 MHz (R4A_LED_5_BITS_CLOCK_*_HZ).
+//
+// The 3 bit encoding (R4A_LED_ENCODING_3_BITS) uses a SPI data stream
+// clocked at 2.86 MHz (80 MHz / 28).  Each LED data bit is encoded as 3
+// SPI bits: 100 for zero and 110 for one.
+//
+//         _____
+//  0:  __|     |__________|        0.35 uSec high, 0.7 uSec low
+//         __________
+//  1:  __|          |_____|        0.7 uSec high, 0.35 uSec low
+//
+// The LEDs sample the data a fixed time after each rising edge, so the
+// high times must stay within the limits of both LEDs.  The one high
+// time limits the clock to at least 2.67 MHz (0.75 uSec) and the zero
+// low time to at most 3.0 MHz (0.67 uSec), R4A_LED_OUTPUT_SPI::begin
+// rejects a clock outside R4A_LED_3_BITS_CLOCK_MIN_HZ -
+// R4A_LED_3_BITS_CLOCK_MAX_HZ.  The one low time is shorter than the
+// 800 KHz window but keeps the bit period within 1.25 +/- 0.6 uSec.
+// extras/tools/LED_3_Bit_Table.py --check verifies these times.
+//
+// The 3 bit encoding uses 40% less DMA memory and the frame takes 16%
+// less time on the bus.
 //
 // The color data is sent most significant bit first in the order of green
 // then red then blue.
@@ -71,31 +136,565 @@ uint8_t *  r4aLEDTxDmaBuffer;
 //                              +-----------+-----------+-----------+-----------+
 
 //*********************************************************************
-// Set the WS2812 LED colors
-void r4aLEDSetColorRgb(uint8_t ledNumber, uint32_t color)
+// Encode a color value into the frame buffer
+// Inputs:
+//   data: Address in the frame buffer to receive the encoded value
+//   intensity: Color value in the range of (0 - 255)
+// Outputs:
+//   Returns the address following the encoded value
+static inline uint8_t * r4aLEDEncode(uint8_t * data, int intensity)
 {
-    // Red Bits:   23 - 16
-    // Green Bits: 15 -  8
-    // Blue Bits:   7 -  0
+    // Scale the color value
+    intensity = (intensity * r4aLEDEncodeIntensity) / 255;
 
-    // Verify the LED number
-    if (ledNumber < r4aLEDs)
+    // Copy the value for the RMT output
+    if (!r4aLEDEncodingTable)
     {
-        // Indicate that this LED uses 3 colors
-        r4aLEDFourColorsBitmap[ledNumber >> 3] &= ~(1 << (ledNumber & 7));
+        *data++ = intensity;
+        return data;
+    }
 
-        // Set the LED color
-        r4aLEDColor[ledNumber] = color;
+    // Translate the value into the SPI bit stream
+    memcpy(data, &r4aLEDEncodingTable[intensity * r4aLEDEncodingBytes], r4aLEDEncodingBytes);
+    return data + r4aLEDEncodingBytes;
+}
+
+//*********************************************************************
+// Add up the color values of a LED
+// Inputs:
+//   color: White bits: 31 - 24, Red bits: 23 - 16, Green bits: 15 - 8,
+//          Blue bits; 7 - 0
+//   fourColors: True for a SK6812RGBW LED, false for a WS2812 LED
+// Outputs:
+//   Returns the sum of the color values
+static inline uint32_t r4aLEDChannelSum(uint32_t color, bool fourColors)
+{
+    uint32_t sum;
+
+    sum = ((color >> 16) & 0xff) + ((color >> 8) & 0xff) + (color & 0xff);
+    if (fourColors)
+        sum += color >> 24;
+    return sum;
+}
+
+//*********************************************************************
+// Update the sum of the color values when a LED color changes
+// Inputs:
+//   ledNumber: Index into the LED color array
+//   color: New color value for the LED
+//   fourColors: True for a SK6812RGBW LED, false for a WS2812 LED
+static inline void r4aLEDPowerUpdate(uint16_t ledNumber,
+                                     uint32_t color,
+                                     bool fourColors)
+{
+    bool previousFourColors;
+
+    previousFourColors = r4aLEDFourColorsBitmap[ledNumber >> 3] & (1 << (ledNumber & 7));
+    r4aLEDPowerSum += r4aLEDChannelSum(color, fourColors)
+                    - r4aLEDChannelSum(r4aLEDColor[ledNumber], previousFourColors);
+}
+
+//*********************************************************************
+// Encode the colors of a LED into the frame buffer
+// Inputs:
+//   data: Address in the frame buffer to receive the encoded colors
+//   color: White bits: 31 - 24, Red bits: 23 - 16, Green bits: 15 - 8,
+//          Blue bits; 7 - 0
+//   fourColors: True for a SK6812RGBW LED, false for a WS2812 LED
+// Outputs:
+//   Returns the address following the encoded colors
+static uint8_t * r4aLEDEncodeColor(uint8_t * data,
+                                   uint32_t color,
+                                   bool fourColors)
+{
+    // Determine the LED type
+    if (fourColors)
+    {
+        //                              +-----------+-----------+-----------+-----------+
+        //      SK6812RGBW LED  <-----  |7   Red   0|7  Green  0|7  Blue   0|7  White  0|
+        //                              +-----------+-----------+-----------+-----------+
+        //
+        // White Bits: 32 - 24
+        // Red Bits:   23 - 16
+        // Green Bits: 15 -  8
+        // Blue Bits:   7 -  0
+
+        // Red
+        data = r4aLEDEncode(data, (color >> 16) & 0xff);
+
+        // Green
+        data = r4aLEDEncode(data, (color >> 8) & 0xff);
+
+        // Blue
+        data = r4aLEDEncode(data, color & 0xff);
+
+        // White
+        data = r4aLEDEncode(data, (color >> 24) & 0xff);
+    }
+    else
+    {
+        //                          +-----------+-----------+-----------+
+        //      WS2812 LED  <-----  |7  Green  0|7   Red   0|7  Blue   0|
+        //                          +-----------+-----------+-----------+
+        //
+        // Red Bits:   23 - 16
+        // Green Bits: 15 -  8
+        // Blue Bits:   7 -  0
+
+        // Green
+        data = r4aLEDEncode(data, (color >> 8) & 0xff);
+
+        // Red
+        data = r4aLEDEncode(data, (color >> 16) & 0xff);
+
+        // Blue
+        data = r4aLEDEncode(data, color & 0xff);
+    }
+    return data;
+}
+
+//*********************************************************************
+// Encode the palette colors
+static void r4aLEDPaletteEncode()
+{
+    uint8_t * data;
+    bool fourColors;
+    int paletteBytes;
+
+    // Encode each of the palette colors using the current intensity
+    paletteBytes = 4 * r4aLEDEncodingBytes;
+    for (int index = 0; index < r4aLEDPaletteEntries; index++)
+    {
+        fourColors = (r4aLEDPaletteFourColors & (1 << index)) != 0;
+        data = &r4aLEDPaletteEncoded[index * paletteBytes];
+        r4aLEDPaletteLength[index] = r4aLEDEncodeColor(data,
+                                                       r4aLEDPalette[index],
+                                                       fourColors) - data;
+    }
+    r4aLEDPaletteIntensity = r4aLEDEncodeIntensity;
+}
+
+//*********************************************************************
+// Determine the number of encoded bytes for the leading LEDs
+// Inputs:
+//   endLED: Number of LEDs at the start of the string
+// Outputs:
+//   Returns the number of bytes in the frame buffer used by the LEDs
+static int r4aLEDEncodedBytes(int endLED)
+{
+    int colors;
+
+    // Add up the palette colors
+    if (r4aLEDPaletteIndex)
+    {
+        colors = 0;
+        for (int led = 0; led < endLED; led++)
+            colors += r4aLEDPaletteLength[r4aLEDPaletteIndex[led]];
+        return colors;
+    }
+
+    // Add the white color for the SK6812RGBW LEDs
+    colors = endLED * 3;
+    for (int led = 0; led < endLED; led++)
+        if (r4aLEDFourColorsBitmap[led >> 3] & (1 << (led & 7)))
+            colors += 1;
+    return colors * r4aLEDEncodingBytes;
+}
+
+//*********************************************************************
+// Encode a range of LEDs into the frame buffer
+// Inputs:
+//   data: Address in the frame buffer to receive the encoded colors
+//   firstLED: Index of the first LED to encode
+//   endLED: Index of the LED following the last LED to encode
+// Outputs:
+//   Returns the address following the encoded colors
+static uint8_t * r4aLEDEncodeRange(uint8_t * data, int firstLED, int endLED)
+{
+    uint8_t index;
+    int length;
+    int paletteBytes;
+
+    // Copy the pre-encoded palette colors
+    if (r4aLEDPaletteIndex)
+    {
+        paletteBytes = 4 * r4aLEDEncodingBytes;
+        for (int led = firstLED; led < endLED; led++)
+        {
+            index = r4aLEDPaletteIndex[led];
+            length = r4aLEDPaletteLength[index];
+            memcpy(data, &r4aLEDPaletteEncoded[index * paletteBytes], length);
+            data += length;
+        }
+    }
+
+    // Encode the LED colors
+    else
+        for (int led = firstLED; led < endLED; led++)
+            data = r4aLEDEncodeColor(data,
+                                     r4aLEDColor[led],
+                                     r4aLEDFourColorsBitmap[led >> 3] & (1 << (led & 7)));
+    return data;
+}
+
+//*********************************************************************
+// Encode all of the LEDs into the frame buffer
+// Inputs:
+//   data: Address in the frame buffer to receive the encoded colors
+//   parallel: True to encode the second half of the LEDs on the other
+//             core using the encode task
+// Outputs:
+//   Returns the address following the encoded colors
+static uint8_t * r4aLEDEncodeFrame(uint8_t * data, bool parallel)
+{
+    int half;
+
+    // Encode the second half of the LEDs on the other core
+    half = r4aLEDs;
+    if (parallel)
+    {
+        half = r4aLEDs / 2;
+        r4aLEDEncodeCaller = xTaskGetCurrentTaskHandle();
+        r4aLEDEncodeData = data + r4aLEDEncodedBytes(half);
+        r4aLEDEncodeFirst = half;
+        xTaskNotifyGive(r4aLEDEncodeTaskHandle);
+    }
+
+    // Encode the first half of the LEDs
+    data = r4aLEDEncodeRange(data, 0, half);
+
+    // Wait for the other core to finish the second half
+    if (half < r4aLEDs)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        data = r4aLEDEncodeData;
+    }
+    return data;
+}
+
+//*********************************************************************
+// Encode the second half of the LEDs when requested by r4aLEDUpdate
+// Inputs:
+//   parameter: Not used
+static void r4aLEDEncodeTask(void * parameter)
+{
+    while (true)
+    {
+        // Wait for the request
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Encode the LEDs and return the end of the data
+        r4aLEDEncodeData = r4aLEDEncodeRange(r4aLEDEncodeData,
+                                             r4aLEDEncodeFirst,
+                                             r4aLEDs);
+        xTaskNotifyGive(r4aLEDEncodeCaller);
+    }
+}
+
+//*********************************************************************
+// Verify that the parallel encode matches the single core encode
+bool r4aLEDEncodeSelfTest(Print * display)
+{
+    uint8_t * dualCore;
+    uint8_t * dualCoreEnd;
+    int length;
+    bool match;
+    uint8_t * patternBitmap;
+    uint32_t * patternColor;
+    uint32_t * savedColor;
+    uint8_t * savedBitmap;
+    uint8_t * singleCore;
+    uint8_t * singleCoreEnd;
+
+    // Verify that the LEDs and encode task are initialized
+    if (!r4aLEDOutput)
+    {
+        display->println("ERROR: Call r4aLEDSetup before r4aLEDEncodeSelfTest!");
+        return false;
+    }
+    if (!r4aLEDEncodeTaskHandle)
+    {
+        display->println("ERROR: Call r4aLEDEncodeParallel before r4aLEDEncodeSelfTest!");
+        return false;
+    }
+
+    dualCore = nullptr;
+    match = false;
+    patternBitmap = nullptr;
+    patternColor = nullptr;
+    savedBitmap = r4aLEDFourColorsBitmap;
+    savedColor = r4aLEDColor;
+    singleCore = nullptr;
+    do
+    {
+        // Replace the colors with a test pattern mixing 3 and 4 color LEDs,
+        // palette mode uses the current palette selections
+        if (r4aLEDColor)
+        {
+            patternColor = (uint32_t *)r4aMalloc(R4A_MODULE_LED, r4aLEDs << 2);
+            patternBitmap = (uint8_t *)r4aMalloc(R4A_MODULE_LED, (r4aLEDs + 7) >> 3);
+            if ((!patternColor) || (!patternBitmap))
+            {
+                display->println("ERROR: Failed to allocate the test pattern!");
+                break;
+            }
+            memset(patternBitmap, 0, (r4aLEDs + 7) >> 3);
+            for (int led = 0; led < r4aLEDs; led++)
+            {
+                patternColor[led] = (led + 1) * 0x01030507;
+                if ((led % 3) == 0)
+                    patternBitmap[led >> 3] |= 1 << (led & 7);
+            }
+            r4aLEDColor = patternColor;
+            r4aLEDFourColorsBitmap = patternBitmap;
+        }
+
+        // Encode the palette when the palette or intensity changes
+        if (r4aLEDPaletteIndex && (r4aLEDPaletteIntensity != r4aLEDEncodeIntensity))
+            r4aLEDPaletteEncode();
+
+        // Allocate the frame buffers
+        length = r4aLEDEncodedBytes(r4aLEDs);
+        singleCore = (uint8_t *)r4aMalloc(R4A_MODULE_LED, length);
+        dualCore = (uint8_t *)r4aMalloc(R4A_MODULE_LED, length);
+        if ((!singleCore) || (!dualCore))
+        {
+            display->println("ERROR: Failed to allocate the frame buffers!");
+            break;
+        }
+
+        // Encode the frame both ways and compare the results
+        singleCoreEnd = r4aLEDEncodeFrame(singleCore, false);
+        dualCoreEnd = r4aLEDEncodeFrame(dualCore, true);
+        match = ((singleCoreEnd - singleCore) == length)
+                && ((dualCoreEnd - dualCore) == length)
+                && (memcmp(singleCore, dualCore, length) == 0);
+        display->printf("LED encode self-test: %s, %d LEDs, %d bytes\r\n",
+                        match ? "Pass" : "FAIL", r4aLEDs, length);
+    } while (0);
+
+    // Restore the colors and free the buffers
+    r4aLEDColor = savedColor;
+    r4aLEDFourColorsBitmap = savedBitmap;
+    if (dualCore)
+        r4aFree(dualCore);
+    if (singleCore)
+        r4aFree(singleCore);
+    if (patternBitmap)
+        r4aFree(patternBitmap);
+    if (patternColor)
+        r4aFree(patternColor);
+    return match;
+}
+
+//*********************************************************************
+// Start the task that encodes half of the LEDs on the other core
+bool r4aLEDEncodeParallel(BaseType_t core, UBaseType_t priority)
+{
+    // Start the encode task
+    if (!r4aLEDEncodeTaskHandle)
+        xTaskCreatePinnedToCore(r4aLEDEncodeTask,
+                                "r4aLEDEncode",
+                                R4A_LED_ENCODE_TASK_STACK_SIZE,
+                                nullptr,
+                                priority,
+                                &r4aLEDEncodeTaskHandle,
+                                core);
+    if (r4aLEDEncodeTaskHandle)
+        r4aMemoryRegisterTask(R4A_MODULE_LED, r4aLEDEncodeTaskHandle);
+    else
+        r4aLogError(R4A_MODULE_LED, "Failed to start the LED encode task!");
+    return (r4aLEDEncodeTaskHandle != nullptr);
+}
+
+//*********************************************************************
+// Switch the LEDs to palette mode
+bool r4aLEDPaletteBegin(uint8_t entries)
+{
+    // Verify the state and the number of entries
+    if (!r4aLEDOutput)
+    {
+        r4aLogError(R4A_MODULE_LED, "Call r4aLEDSetup before r4aLEDPaletteBegin!");
+        return false;
+    }
+    if (r4aLEDPaletteIndex)
+    {
+        r4aLogError(R4A_MODULE_LED, "Palette mode already enabled!");
+        return false;
+    }
+    if ((entries < 1) || (entries > R4A_LED_PALETTE_MAX))
+    {
+        r4aLogError(R4A_MODULE_LED, "entries needs to be in the range of 1 - %d!",
+                    R4A_LED_PALETTE_MAX);
+        return false;
+    }
+
+    // Allocate the encoded palette, assume 4 colors per entry
+    r4aLEDPaletteEncoded = (uint8_t *)r4aMalloc(R4A_MODULE_LED,
+                                                entries * 4 * r4aLEDEncodingBytes);
+    if (!r4aLEDPaletteEncoded)
+    {
+        r4aLogError(R4A_MODULE_LED, "Failed to allocate r4aLEDPaletteEncoded!");
+        return false;
+    }
+
+    // Allocate the palette index for each LED, all LEDs use entry 0
+    r4aLEDPaletteIndex = (uint8_t *)r4aMalloc(R4A_MODULE_LED, r4aLEDs);
+    if (!r4aLEDPaletteIndex)
+    {
+        r4aLogError(R4A_MODULE_LED, "Failed to allocate r4aLEDPaletteIndex!");
+        r4aFree(r4aLEDPaletteEncoded);
+        r4aLEDPaletteEncoded = nullptr;
+        return false;
+    }
+    memset(r4aLEDPaletteIndex, 0, r4aLEDs);
+    memset(r4aLEDPaletteCount, 0, sizeof(r4aLEDPaletteCount));
+    r4aLEDPaletteCount[0] = r4aLEDs;
+
+    // Initialize the palette, all entries are black
+    memset(r4aLEDPalette, 0, sizeof(r4aLEDPalette));
+    r4aLEDPaletteEntries = entries;
+    r4aLEDPaletteFourColors = 0;
+    r4aLEDPaletteIntensity = -1;
+
+    // The color array is no longer used
+    r4aFree(r4aLEDColor);
+    r4aLEDColor = nullptr;
+    r4aLEDColorWritten = true;
+    return true;
+}
+
+//*********************************************************************
+// Select the palette color for a LED
+void r4aLEDPaletteSelect(uint16_t ledNumber, uint8_t paletteIndex)
+{
+    // Verify the mode and the parameters
+    if (!r4aLEDPaletteIndex)
+        r4aLogError(R4A_MODULE_LED, "Call r4aLEDPaletteBegin before r4aLEDPaletteSelect!");
+    else if (ledNumber >= r4aLEDs)
+        r4aLogError(R4A_MODULE_LED,
+                    "ledNumber needs to be in the range of 0 - %d!",
+                    r4aLEDs - 1);
+    else if (paletteIndex >= r4aLEDPaletteEntries)
+        r4aLogError(R4A_MODULE_LED,
+                    "paletteIndex needs to be in the range of 0 - %d!",
+                    r4aLEDPaletteEntries - 1);
+
+    // Select the color
+    else if (r4aLEDPaletteIndex[ledNumber] != paletteIndex)
+    {
+        r4aLEDPaletteCount[r4aLEDPaletteIndex[ledNumber]] -= 1;
+        r4aLEDPaletteCount[paletteIndex] += 1;
+        r4aLEDPaletteIndex[ledNumber] = paletteIndex;
         r4aLEDColorWritten = true;
     }
+}
+
+//*********************************************************************
+// Set a palette color
+// Inputs:
+//   paletteIndex: Index into the palette
+//   color: White bits: 31 - 24, Red bits: 23 - 16, Green bits: 15 - 8,
+//          Blue bits; 7 - 0
+//   fourColors: True for a SK6812RGBW LED, false for a WS2812 LED
+static void r4aLEDPaletteSetColor(uint8_t paletteIndex,
+                                  uint32_t color,
+                                  bool fourColors)
+{
+    // Verify the palette index
+    if (paletteIndex >= r4aLEDPaletteEntries)
+    {
+        r4aLogError(R4A_MODULE_LED,
+                    "paletteIndex needs to be in the range of 0 - %d!",
+                    r4aLEDPaletteEntries - 1);
+        return;
+    }
+
+    // Set the palette color
+    r4aLEDPalette[paletteIndex] = color;
+    if (fourColors)
+        r4aLEDPaletteFourColors |= 1 << paletteIndex;
     else
-        Serial.printf("ERROR: ledNumber needs to be in the range of 0 - %d!",
-                      r4aLEDs);
+        r4aLEDPaletteFourColors &= ~(1 << paletteIndex);
+
+    // Encode the palette on the next update
+    r4aLEDPaletteIntensity = -1;
+    r4aLEDColorWritten = true;
+}
+
+//*********************************************************************
+// Set a WS2812 palette color
+void r4aLEDPaletteSetColorRgb(uint8_t paletteIndex, uint32_t color)
+{
+    r4aLEDPaletteSetColor(paletteIndex, color & R4A_LED_WHITE_RGB, false);
+}
+
+//*********************************************************************
+// Set a SK6812RGBW palette color
+void r4aLEDPaletteSetColorWrgb(uint8_t paletteIndex, uint32_t color)
+{
+    r4aLEDPaletteSetColor(paletteIndex, color, true);
+}
+
+//*********************************************************************
+// Determine the intensity that keeps the LED current within the limit
+// Outputs:
+//   Returns the intensity value used to encode the colors
+static uint8_t r4aLEDPowerIntensity()
+{
+    uint64_t fullMilliamps;
+    uint64_t intensity;
+    uint32_t sum;
+
+    // Get the sum of the color values
+    sum = r4aLEDPowerSum;
+    if (r4aLEDPaletteIndex)
+    {
+        sum = 0;
+        for (int index = 0; index < r4aLEDPaletteEntries; index++)
+            sum += r4aLEDPaletteCount[index]
+                 * r4aLEDChannelSum(r4aLEDPalette[index],
+                                    r4aLEDPaletteFourColors & (1 << index));
+    }
+
+    // Estimate the current, 255 times too large, with full intensity
+    fullMilliamps = (uint64_t)sum * r4aLEDChannelMilliamps;
+
+    // Limit the intensity
+    intensity = r4aLEDIntensity;
+    if (r4aLEDPowerLimitMilliamps && fullMilliamps
+        && ((fullMilliamps * intensity) > ((uint64_t)r4aLEDPowerLimitMilliamps * 255 * 255)))
+        intensity = ((uint64_t)r4aLEDPowerLimitMilliamps * 255 * 255) / fullMilliamps;
+    r4aLEDMetricMilliamps.set((fullMilliamps * intensity) / (255 * 255));
+    r4aLEDMetricPowerIntensity.set(intensity);
+    return intensity;
+}
+
+//*********************************************************************
+// Limit the LED current
+void r4aLEDPowerLimit(uint32_t milliamps, uint8_t channelMilliamps)
+{
+    r4aLEDChannelMilliamps = channelMilliamps;
+    r4aLEDPowerLimitMilliamps = milliamps;
+    r4aLEDColorWritten = true;
 }
 
 //*********************************************************************
 // Set the WS2812 LED colors
-void r4aLEDSetColorRgb(uint8_t ledNumber,
+void r4aLEDSetColorRgb(uint16_t ledNumber, uint32_t color)
+{
+    // Red Bits:   23 - 16
+    // Green Bits: 15 -  8
+    // Blue Bits:   7 -  0
+
+    // Set the LED color and request an update
+    if (r4aLEDStoreColor(ledNumber, color, false))
+        r4aLEDColorWritten = true;
+}
+
+//*********************************************************************
+// Set the WS2812 LED colors
+void r4aLEDSetColorRgb(uint16_t ledNumber,
                        uint8_t red,
                        uint8_t green,
                        uint8_t blue)
@@ -107,48 +706,28 @@ void r4aLEDSetColorRgb(uint8_t ledNumber,
           | (((uint32_t)green) << R4A_LED_GREEN_SHIFT)
           | (((uint32_t)blue) << R4A_LED_BLUE_SHIFT);
 
-    // Verify the LED number
-    if (ledNumber < r4aLEDs)
-    {
-        // Indicate that this LED uses 3 colors
-        r4aLEDFourColorsBitmap[ledNumber >> 3] &= ~(1 << (ledNumber & 7));
-
-        // Set the LED color
-        r4aLEDColor[ledNumber] = color;
+    // Set the LED color and request an update
+    if (r4aLEDStoreColor(ledNumber, color, false))
         r4aLEDColorWritten = true;
-    }
-    else
-        Serial.printf("ERROR: ledNumber needs to be in the range of 0 - %d!",
-                      r4aLEDs);
 }
 
 //*********************************************************************
 // Set the SK6812RGBW LED colors
-void r4aLEDSetColorWrgb(uint8_t ledNumber, uint32_t color)
+void r4aLEDSetColorWrgb(uint16_t ledNumber, uint32_t color)
 {
     // White Bits: 32 - 24
     // Red Bits:   23 - 16
     // Green Bits: 15 -  8
     // Blue Bits:   7 -  0
 
-    // Verify the LED number
-    if (ledNumber < r4aLEDs)
-    {
-        // Indicate that this LED uses 4 colors
-        r4aLEDFourColorsBitmap[ledNumber >> 3] |= 1 << (ledNumber & 7);
-
-        // Set the LED color
-        r4aLEDColor[ledNumber] = color;
+    // Set the LED color and request an update
+    if (r4aLEDStoreColor(ledNumber, color, true))
         r4aLEDColorWritten = true;
-    }
-    else
-        Serial.printf("ERROR: ledNumber needs to be in the range of 0 - %d!",
-                      r4aLEDs);
 }
 
 //*********************************************************************
 // Set the SK6812RGBW LED colors
-void r4aLEDSetColorWrgb(uint8_t ledNumber,
+void r4aLEDSetColorWrgb(uint16_t ledNumber,
                         uint8_t white,
                         uint8_t red,
                         uint8_t green,
@@ -162,19 +741,9 @@ void r4aLEDSetColorWrgb(uint8_t ledNumber,
           | (((uint32_t)blue) << R4A_LED_BLUE_SHIFT)
           | (((uint32_t)white) << R4A_LED_WHITE_SHIFT);
 
-    // Verify the LED number
-    if (ledNumber < r4aLEDs)
-    {
-        // Indicate that this LED uses 4 colors
-        r4aLEDFourColorsBitmap[ledNumber >> 3] |= 1 << (ledNumber & 7);
-
-        // Set the LED color
-        r4aLEDColor[ledNumber] = color;
+    // Set the LED color and request an update
+    if (r4aLEDStoreColor(ledNumber, color, true))
         r4aLEDColorWritten = true;
-    }
-    else
-        Serial.printf("ERROR: ledNumber needs to be in the range of 0 - %d!",
-                      r4aLEDs);
 }
 
 //*********************************************************************
@@ -186,68 +755,122 @@ void r4aLEDSetIntensity(uint8_t intensity)
     r4aLEDColorWritten = true;
 }
 
+//*********************************************************************
+// Set the LED color without requesting an update
+bool r4aLEDStoreColor(uint16_t ledNumber, uint32_t color, bool fourColors)
+{
+    // Verify the mode and the LED number
+    if (r4aLEDColor && (ledNumber < r4aLEDs))
+    {
+        // Update the power estimate
+        r4aLEDPowerUpdate(ledNumber, color, fourColors);
+
+        // Indicate the number of colors used by this LED
+        if (fourColors)
+            r4aLEDFourColorsBitmap[ledNumber >> 3] |= 1 << (ledNumber & 7);
+        else
+            r4aLEDFourColorsBitmap[ledNumber >> 3] &= ~(1 << (ledNumber & 7));
+
+        // Set the LED color
+        r4aLEDColor[ledNumber] = color;
+        return true;
+    }
+    if (!r4aLEDColor)
+        r4aLogError(R4A_MODULE_LED, "Use r4aLEDPaletteSelect in palette mode!");
+    else
+        r4aLogError(R4A_MODULE_LED,
+                    "ledNumber needs to be in the range of 0 - %d!",
+                    r4aLEDs - 1);
+    return false;
+}
+
 //*********************************************************************
 // Initialize the LEDs
 bool r4aLEDSetup(uint8_t spiNumber,
                  uint8_t pinMOSI,
                  uint32_t clockHz,
-                 uint8_t numberOfLEDs)
+                 uint16_t numberOfLEDs,
+                 uint8_t encoding)
+{
+    R4A_LED_OUTPUT_SPI * output;
+
+    // Allocate the SPI output
+    output = r4aNew<R4A_LED_OUTPUT_SPI>(R4A_MODULE_LED,
+                                        spiNumber,
+                                        pinMOSI,
+                                        clockHz,
+                                        encoding);
+    if (!output)
+    {
+        r4aLogError(R4A_MODULE_LED, "Failed to allocate the SPI output!");
+        return false;
+    }
+
+    // Initialize the LEDs
+    if (r4aLEDSetup(output, numberOfLEDs))
+        return true;
+    r4aDelete(output);
+    return false;
+}
+
+//*********************************************************************
+// Initialize the LEDs
+bool r4aLEDSetup(R4A_LED_OUTPUT * output, uint16_t numberOfLEDs)
 {
     int ledBytes;
     int length;
 
     do
     {
-        // Determine if the SPI controller object was allocated
-        if (!r4aSpi)
-        {
-            Serial.println("ERROR: Failed to allocate r4aSpi!");
-            break;
-        }
-
         // Remember the number of LEDs
         r4aLEDs = numberOfLEDs;
 
-        // Allocate the TX DMA buffer
-        // This buffer needs to be in static RAM to allow DMA access
-        // Assume all LEDs support 4 colors, 8-bits per color and 5 SPI
-        // bits / color bit packed in 8 bits per byte
-        ledBytes = numberOfLEDs * 4 * 5;
-        length = R4A_LED_RESET + ledBytes + R4A_LED_ONES;
-        r4aLEDTxDmaBuffer = r4aSpi->allocateDmaBuffer(length);
+        // Get the encoding from the output device
+        r4aLEDEncodingBytes = output->bytesPerColor();
+        r4aLEDEncodingTable = output->table();
+
+        // Allocate the TX frame buffer
+        // The SPI output needs this buffer in static RAM to allow DMA access
+        // Assume all LEDs support 4 colors, 8-bits per color and 1, 3 or 5
+        // output bytes per color
+        ledBytes = numberOfLEDs * 4 * r4aLEDEncodingBytes;
+        length = output->resetBytes() + ledBytes + R4A_LED_ONES;
+        r4aLEDTxDmaBuffer = output->allocateBuffer(length);
         if (!r4aLEDTxDmaBuffer)
         {
-            Serial.println("ERROR: Failed to allocate r4aLEDTxDmaBuffer!");
+            r4aLogError(R4A_MODULE_LED, "Failed to allocate r4aLEDTxDmaBuffer!");
             break;
         }
         memset(r4aLEDTxDmaBuffer, 0, length);
 
         // Allocate the color array, assume four 8-bit colors per LED
         length = numberOfLEDs << 2;
-        r4aLEDColor = (uint32_t *)malloc(length);
+        r4aLEDColor = (uint32_t *)r4aMalloc(R4A_MODULE_LED, length);
         if (!r4aLEDColor)
         {
-            Serial.println("ERROR: Failed to allocate r4aLEDColor!");
+            r4aLogError(R4A_MODULE_LED, "Failed to allocate r4aLEDColor!");
             break;
         }
         memset(r4aLEDColor, 0, length);
+        r4aLEDPowerSum = 0;
 
         // Allocate the 4 color bitmap
         length = (numberOfLEDs + 7) >> 3;
-        r4aLEDFourColorsBitmap = (uint8_t *)malloc(length);
+        r4aLEDFourColorsBitmap = (uint8_t *)r4aMalloc(R4A_MODULE_LED, length);
         if (!r4aLEDFourColorsBitmap)
         {
-            Serial.println("ERROR: Failed to allocate r4aLEDFourColorsBitmap!");
+            r4aLogError(R4A_MODULE_LED, "Failed to allocate r4aLEDFourColorsBitmap!");
             break;
         }
 
         // Assume all LEDs are 4 color
         memset(r4aLEDFourColorsBitmap, 0xff, length);
 
-        // Initialize the SPI controller
-        if (r4aSpi->begin(spiNumber, pinMOSI, clockHz))
+        // Initialize the output device
+        if (output->begin())
         {
             // Turn off the LEDs
+            r4aLEDOutput = output;
             r4aLEDColorWritten = true;
             r4aLEDUpdate(true);
             return true;
@@ -257,17 +880,17 @@ bool r4aLEDSetup(uint8_t spiNumber,
     // Free the allocated memory
     if (r4aLEDColor)
     {
-        free(r4aLEDColor);
+        r4aFree(r4aLEDColor);
         r4aLEDColor = nullptr;
     }
     if (r4aLEDFourColorsBitmap)
     {
-        free(r4aLEDFourColorsBitmap);
+        r4aFree(r4aLEDFourColorsBitmap);
         r4aLEDFourColorsBitmap = nullptr;
     }
     if (r4aLEDTxDmaBuffer)
     {
-        free(r4aLEDTxDmaBuffer);
+        output->freeBuffer(r4aLEDTxDmaBuffer);
         r4aLEDTxDmaBuffer = nullptr;
     }
     return false;
@@ -277,9 +900,19 @@ bool r4aLEDSetup(uint8_t spiNumber,
 // Turn off the LEDs
 void r4aLEDsOff()
 {
+    // Select the first palette color
+    if (r4aLEDPaletteIndex)
+    {
+        memset(r4aLEDPaletteIndex, 0, r4aLEDs);
+        memset(r4aLEDPaletteCount, 0, sizeof(r4aLEDPaletteCount));
+        r4aLEDPaletteCount[0] = r4aLEDs;
+        r4aLEDColorWritten = true;
+        return;
+    }
+
     // Set the LED colors
-    for (uint8_t led = 0; led < r4aLEDs; led++)
-        if (r4aLEDFourColorsBitmap[led >> 7] & (1 << (led & 7)))
+    for (uint16_t led = 0; led < r4aLEDs; led++)
+        if (r4aLEDFourColorsBitmap[led >> 3] & (1 << (led & 7)))
             r4aLEDSetColorWrgb(led, 0);
         else
             r4aLEDSetColorRgb(led, 0);
@@ -289,104 +922,47 @@ void r4aLEDsOff()
 // Update the colors on the LEDs
 void r4aLEDUpdate(bool updateRequest)
 {
-    uint32_t color;
     uint8_t * data;
-    int index;
-    int intensity;
     static int length;
+    uint16_t resetBytes;
+    uint32_t startUsec;
+
+    // Don't change the frame buffer while the previous frame is being sent
+    if (r4aLEDOutput->busy())
+    {
+        // Retry the update on the next call
+        if (updateRequest)
+            r4aLEDColorWritten = true;
+        return;
+    }
 
     // Check for a color change
     if (r4aLEDColorWritten)
     {
+        startUsec = micros();
         r4aLEDColorWritten = false;
         updateRequest = true;
 
         // Add the reset sequence
         data = r4aLEDTxDmaBuffer;
-        if (R4A_LED_RESET == 0)
+        resetBytes = r4aLEDOutput->resetBytes();
+        if (resetBytes != 0)
         {
-            memset(data, 0, R4A_LED_RESET);
-            data += R4A_LED_RESET;
+            memset(data, 0, resetBytes);
+            data += resetBytes;
         }
 
-        // Walk the array of LEDs
-        for (int led = 0; led < r4aLEDs; led++)
-        {
-            // Copy the color array
-            color = r4aLEDColor[led];
+        // Limit the current
+        r4aLEDEncodeIntensity = r4aLEDPowerIntensity();
 
-            // Determine the LED type
-            if (r4aLEDFourColorsBitmap[led >> 3] & (1 << (led & 7)))
-            {
-                //                              +-----------+-----------+-----------+-----------+
-                //      SK6812RGBW LED  <-----  |7   Red   0|7  Green  0|7  Blue   0|7  White  0|
-                //                              +-----------+-----------+-----------+-----------+
-                //
-                // White Bits: 32 - 24
-                // Red Bits:   23 - 16
-                // Green Bits: 15 -  8
-                // Blue Bits:   7 -  0
-
-                // Red
-                intensity = (color >> 16) & 0xff;
-                intensity = (intensity * r4aLEDIntensity) / 255;
-                index = (intensity << 2) + intensity;
-                memcpy(data, &r4aLEDIntensityTable[index], 5);
-                data += 5;
-
-                // Green
-                intensity = (color >> 8) & 0xff;
-                intensity = (intensity * r4aLEDIntensity) / 255;
-                index = (intensity << 2) + intensity;
-                memcpy(data, &r4aLEDIntensityTable[index], 5);
-                data += 5;
-
-                // Blue
-                intensity = color & 0xff;
-                intensity = (intensity * r4aLEDIntensity) / 255;
-                index = (intensity << 2) + intensity;
-                memcpy(data, &r4aLEDIntensityTable[index], 5);
-                data += 5;
-
-                // White
-                intensity = (color >> 24) & 0xff;
-                intensity = (intensity * r4aLEDIntensity) / 255;
-                index = (intensity << 2) + intensity;
-                memcpy(data, &r4aLEDIntensityTable[index], 5);
-                data += 5;
-            }
-            else
-            {
-                //                          +-----------+-----------+-----------+
-                //      WS2812 LED  <-----  |7  Green  0|7   Red   0|7  Blue   0|
-                //                          +-----------+-----------+-----------+
-                //
-                // Red Bits:   23 - 16
-                // Green Bits: 15 -  8
-                // Blue Bits:   7 -  0
-
-                // Green
-                intensity = (color >> 8) & 0xff;
-                intensity = (intensity * r4aLEDIntensity) / 255;
-                index = (intensity << 2) + intensity;
-                memcpy(data, &r4aLEDIntensityTable[index], 5);
-                data += 5;
-
-                // Red
-                intensity = (color >> 16) & 0xff;
-                intensity = (intensity * r4aLEDIntensity) / 255;
-                index = (intensity << 2) + intensity;
-                memcpy(data, &r4aLEDIntensityTable[index], 5);
-                data += 5;
-
-                // Blue
-                intensity = color & 0xff;
-                intensity = (intensity * r4aLEDIntensity) / 255;
-                index = (intensity << 2) + intensity;
-                memcpy(data, &r4aLEDIntensityTable[index], 5);
-                data += 5;
-            }
-        }
+        // Encode the palette when the palette or intensity changes
+        if (r4aLEDPaletteIndex && (r4aLEDPaletteIntensity != r4aLEDEncodeIntensity))
+            r4aLEDPaletteEncode();
+
+        // Encode the LEDs, use both cores for the longer strings
+        data = r4aLEDEncodeFrame(data,
+                                 r4aLEDEncodeTaskHandle
+                                 && (r4aLEDs >= R4A_LED_PARALLEL_MIN_LEDS));
 
         // Set the ones
         if (R4A_LED_ONES != 0)
@@ -397,11 +973,15 @@ void r4aLEDUpdate(bool updateRequest)
 
         // Determine the amount of data to send to the LEDs
         length = data - r4aLEDTxDmaBuffer;
+        r4aLEDMetricEncodeUsec.observe(micros() - startUsec);
     }
 
     // Output the color data to the LEDs
     if (updateRequest)
-        r4aSpi->transfer(r4aLEDTxDmaBuffer, nullptr, length);
+    {
+        r4aLEDMetricUpdates.add();
+        r4aLEDOutput->write(r4aLEDTxDmaBuffer, length);
+    }
 }
 
 //****************************************
@@ -438,12 +1018,14 @@ bool r4aLEDMenuGetIntensity(const R4A_MENU_ENTRY * menuEntry,
                             uint8_t * intensity)
 {
     int i;
+    size_t length;
+    const char * parameters;
 
-    // Get the parameter name
-    String line = r4aMenuGetParameters(menuEntry, command);
+    // Get the parameters
+    parameters = r4aMenuGetParameters(menuEntry, command, &length);
 
     // Get the value
-    *values = sscanf(line.c_str(), "%d", &i);
+    *values = sscanf(parameters, "%d", &i);
 
     // Determine if the value is within range
     if ((*values == 1) && (i >= 0) && (i <= 255))
@@ -459,17 +1041,19 @@ bool r4aLEDMenuGetIntensity(const R4A_MENU_ENTRY * menuEntry,
 bool r4aLEDMenuGetLedColor(const R4A_MENU_ENTRY * menuEntry,
                            const char * command,
                            int * values,
-                           uint8_t * led,
+                           uint16_t * led,
                            uint32_t * color)
 {
     int c;
     int l;
+    size_t length;
+    const char * parameters;
 
-    // Get the parameter name
-    String line = r4aMenuGetParameters(menuEntry, command);
+    // Get the parameters
+    parameters = r4aMenuGetParameters(menuEntry, command, &length);
 
     // Get the values
-    *values = sscanf(line.c_str(), "%d %x", &l, &c);
+    *values = sscanf(parameters, "%d %x", &l, &c);
 
     // Determine if the values are within range
     if ((*values == 2)
@@ -493,7 +1077,7 @@ bool r4aLEDMenuGetLedColor(const R4A_MENU_ENTRY * menuEntry,
 //   display: Device used for output
 void r4aLEDMenuColor3(const R4A_MENU_ENTRY * menuEntry, const char * command, Print * display)
 {
-    uint8_t led;
+    uint16_t led;
     uint32_t color;
     int values;
 
@@ -522,7 +1106,7 @@ void r4aLEDMenuColor3(const R4A_MENU_ENTRY * menuEntry, const char * command, Pr
 //   display: Device used for output
 void r4aLEDMenuColor4(const R4A_MENU_ENTRY * menuEntry, const char * command, Print * display)
 {
-    uint8_t led;
+    uint16_t led;
     uint32_t color;
     int values;
 
@@ -550,42 +1134,89 @@ void r4aLEDMenuColor4(const R4A_MENU_ENTRY * menuEntry, const char * command, Pr
 //   command: Zero terminated command string
 //   display: Device used for output
 void r4aLEDMenuDisplay(const R4A_MENU_ENTRY * menuEntry, const char * command, Print * display)
+{
+    intptr_t position;
+
+    if (display)
+    {
+        position = 0;
+        while (r4aLEDMenuDisplayItem(menuEntry, display, &position))
+            ;
+    }
+}
+
+//*********************************************************************
+// Display the next line of the LED status
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   display: Device used for output
+//   position: Address of the line number, zero for the first line
+// Outputs:
+//   Returns true when a line was displayed and false at the end
+bool r4aLEDMenuDisplayItem(const R4A_MENU_ENTRY * menuEntry,
+                           Print * display,
+                           intptr_t * position)
 {
     uint8_t blue;
     uint32_t color;
     uint8_t green;
+    uint8_t index;
     uint32_t intensity;
+    int led;
     uint8_t red;
     uint8_t white;
 
-    if (display)
+    // Display the heading
+    led = *position - 1;
+    *position += 1;
+    if (led < 0)
     {
         //                ll:   xxx    xxx    xxx    xxx   0xxxxxxxxx   0xxxxxxxxx
         display->println("LED  White   Red   Green  Blue          Hex   Programmed");
         display->println("--------------------------------------------------------");
-        for (int led = 0; led < r4aLEDs; led++)
-        {
-            // Breakup the color value
-            color = r4aLEDColor[led];
-            white = color >> 24;
-            red = (color >> 16) & 0xff;
-            green = (color >> 8) & 0xff;
-            blue = color & 0xff;
-            intensity = (((white * r4aLEDIntensity) / 255) << 24)
-                      | (((red   * r4aLEDIntensity) / 255) << 16)
-                      | (((green * r4aLEDIntensity) / 255) << 8)
-                      |  ((blue  * r4aLEDIntensity) / 255);
-
-            if (r4aLEDFourColorsBitmap[led >> 3] & (1 << (led & 7)))
-                display->printf("%2d:   %3d    %3d    %3d    %3d   0x%08lx   0x%08lx\r\n",
-                                led, white, red, green, blue, color, intensity);
-
-            else
-                display->printf("%2d:          %3d    %3d    %3d     0x%06lx     0x%06lx\r\n",
-                                led, red, green, blue, color, intensity);
-        }
+        return true;
+    }
+
+    // Display the intensity after the LEDs
+    if (led >= r4aLEDs)
+    {
+        if (led > r4aLEDs)
+            return false;
         display->printf("Intensity: %d\r\n", r4aLEDIntensity);
+        if (r4aLEDPowerLimitMilliamps)
+            display->printf("Power limit: %ld mA, intensity %d\r\n",
+                            r4aLEDPowerLimitMilliamps, r4aLEDEncodeIntensity);
+        return true;
     }
+
+    // Display the palette index
+    if (r4aLEDPaletteIndex)
+    {
+        index = r4aLEDPaletteIndex[led];
+        display->printf("%2d:   Palette %d, 0x%08lx\r\n",
+                        led, index, r4aLEDPalette[index]);
+        return true;
+    }
+
+    // Breakup the color value
+    color = r4aLEDColor[led];
+    white = color >> 24;
+    red = (color >> 16) & 0xff;
+    green = (color >> 8) & 0xff;
+    blue = color & 0xff;
+    intensity = (((white * r4aLEDIntensity) / 255) << 24)
+              | (((red   * r4aLEDIntensity) / 255) << 16)
+              | (((green * r4aLEDIntensity) / 255) << 8)
+              |  ((blue  * r4aLEDIntensity) / 255);
+
+    if (r4aLEDFourColorsBitmap[led >> 3] & (1 << (led & 7)))
+        display->printf("%2d:   %3d    %3d    %3d    %3d   0x%08lx   0x%08lx\r\n",
+                        led, white, red, green, blue, color, intensity);
+
+    else
+        display->printf("%2d:          %3d    %3d    %3d     0x%06lx     0x%06lx\r\n",
+                        led, red, green, blue, color, intensity);
+    return true;
 }
 
 //*********************************************************************
@@ -622,3 +1253,14 @@ void r4aLEDMenuOff(const R4A_MENU_ENTRY * menuEntry, const char * command, Print
     r4aLEDsOff();
     r4aLEDUpdate(true);
 }
+
+//*********************************************************************
+// Verify the parallel LED encode
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   display: Device used for output
+void r4aLEDMenuSelfTest(const R4A_MENU_ENTRY * menuEntry, const char * command, Print * display)
+{
+    r4aLEDEncodeSelfTest(display);
+}
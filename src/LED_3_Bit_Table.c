@@ -0,0 +1,529 @@
+/**********************************************************************
+  LED_3_Bit_Table.c
+
+  Robots-For-All (R4A)
+  Table to convert a color intensity into a LED intensity using three
+  SPI bits for each LED data bit
+**********************************************************************/
+
+#include <unistd.h>
+
+//****************************************
+// Constants
+//****************************************
+
+const uint8_t r4aLED3BitTable[] =
+{
+                    //       _    _    _    _    _    _    _    _
+    0x92, 0x49, 0x24, //   0  | 0__| 0__| 0__| 0__| 0__| 0__| 0__| 0__|
+                    //       _    _    _    _    _    _    _    __
+    0x92, 0x49, 0x26, //   1  | 0__| 0__| 0__| 0__| 0__| 0__| 0__|  1_|
+                    //       _    _    _    _    _    _    __   _
+    0x92, 0x49, 0x34, //   2  | 0__| 0__| 0__| 0__| 0__| 0__|  1_| 0__|
+                    //       _    _    _    _    _    _    __   __
+    0x92, 0x49, 0x36, //   3  | 0__| 0__| 0__| 0__| 0__| 0__|  1_|  1_|
+                    //       _    _    _    _    _    __   _    _
+    0x92, 0x49, 0xa4, //   4  | 0__| 0__| 0__| 0__| 0__|  1_| 0__| 0__|
+                    //       _    _    _    _    _    __   _    __
+    0x92, 0x49, 0xa6, //   5  | 0__| 0__| 0__| 0__| 0__|  1_| 0__|  1_|
+                    //       _    _    _    _    _    __   __   _
+    0x92, 0x49, 0xb4, //   6  | 0__| 0__| 0__| 0__| 0__|  1_|  1_| 0__|
+                    //       _    _    _    _    _    __   __   __
+    0x92, 0x49, 0xb6, //   7  | 0__| 0__| 0__| 0__| 0__|  1_|  1_|  1_|
+                    //       _    _    _    _    __   _    _    _
+    0x92, 0x4d, 0x24, //   8  | 0__| 0__| 0__| 0__|  1_| 0__| 0__| 0__|
+                    //       _    _    _    _    __   _    _    __
+    0x92, 0x4d, 0x26, //   9  | 0__| 0__| 0__| 0__|  1_| 0__| 0__|  1_|
+                    //       _    _    _    _    __   _    __   _
+    0x92, 0x4d, 0x34, //  10  | 0__| 0__| 0__| 0__|  1_| 0__|  1_| 0__|
+                    //       _    _    _    _    __   _    __   __
+    0x92, 0x4d, 0x36, //  11  | 0__| 0__| 0__| 0__|  1_| 0__|  1_|  1_|
+                    //       _    _    _    _    __   __   _    _
+    0x92, 0x4d, 0xa4, //  12  | 0__| 0__| 0__| 0__|  1_|  1_| 0__| 0__|
+                    //       _    _    _    _    __   __   _    __
+    0x92, 0x4d, 0xa6, //  13  | 0__| 0__| 0__| 0__|  1_|  1_| 0__|  1_|
+                    //       _    _    _    _    __   __   __   _
+    0x92, 0x4d, 0xb4, //  14  | 0__| 0__| 0__| 0__|  1_|  1_|  1_| 0__|
+                    //       _    _    _    _    __   __   __   __
+    0x92, 0x4d, 0xb6, //  15  | 0__| 0__| 0__| 0__|  1_|  1_|  1_|  1_|
+                    //       _    _    _    __   _    _    _    _
+    0x92, 0x69, 0x24, //  16  | 0__| 0__| 0__|  1_| 0__| 0__| 0__| 0__|
+                    //       _    _    _    __   _    _    _    __
+    0x92, 0x69, 0x26, //  17  | 0__| 0__| 0__|  1_| 0__| 0__| 0__|  1_|
+                    //       _    _    _    __   _    _    __   _
+    0x92, 0x69, 0x34, //  18  | 0__| 0__| 0__|  1_| 0__| 0__|  1_| 0__|
+                    //       _    _    _    __   _    _    __   __
+    0x92, 0x69, 0x36, //  19  | 0__| 0__| 0__|  1_| 0__| 0__|  1_|  1_|
+                    //       _    _    _    __   _    __   _    _
+    0x92, 0x69, 0xa4, //  20  | 0__| 0__| 0__|  1_| 0__|  1_| 0__| 0__|
+                    //       _    _    _    __   _    __   _    __
+    0x92, 0x69, 0xa6, //  21  | 0__| 0__| 0__|  1_| 0__|  1_| 0__|  1_|
+                    //       _    _    _    __   _    __   __   _
+    0x92, 0x69, 0xb4, //  22  | 0__| 0__| 0__|  1_| 0__|  1_|  1_| 0__|
+                    //       _    _    _    __   _    __   __   __
+    0x92, 0x69, 0xb6, //  23  | 0__| 0__| 0__|  1_| 0__|  1_|  1_|  1_|
+                    //       _    _    _    __   __   _    _    _
+    0x92, 0x6d, 0x24, //  24  | 0__| 0__| 0__|  1_|  1_| 0__| 0__| 0__|
+                    //       _    _    _    __   __   _    _    __
+    0x92, 0x6d, 0x26, //  25  | 0__| 0__| 0__|  1_|  1_| 0__| 0__|  1_|
+                    //       _    _    _    __   __   _    __   _
+    0x92, 0x6d, 0x34, //  26  | 0__| 0__| 0__|  1_|  1_| 0__|  1_| 0__|
+                    //       _    _    _    __   __   _    __   __
+    0x92, 0x6d, 0x36, //  27  | 0__| 0__| 0__|  1_|  1_| 0__|  1_|  1_|
+                    //       _    _    _    __   __   __   _    _
+    0x92, 0x6d, 0xa4, //  28  | 0__| 0__| 0__|  1_|  1_|  1_| 0__| 0__|
+                    //       _    _    _    __   __   __   _    __
+    0x92, 0x6d, 0xa6, //  29  | 0__| 0__| 0__|  1_|  1_|  1_| 0__|  1_|
+                    //       _    _    _    __   __   __   __   _
+    0x92, 0x6d, 0xb4, //  30  | 0__| 0__| 0__|  1_|  1_|  1_|  1_| 0__|
+                    //       _    _    _    __   __   __   __   __
+    0x92, 0x6d, 0xb6, //  31  | 0__| 0__| 0__|  1_|  1_|  1_|  1_|  1_|
+                    //       _    _    __   _    _    _    _    _
+    0x93, 0x49, 0x24, //  32  | 0__| 0__|  1_| 0__| 0__| 0__| 0__| 0__|
+                    //       _    _    __   _    _    _    _    __
+    0x93, 0x49, 0x26, //  33  | 0__| 0__|  1_| 0__| 0__| 0__| 0__|  1_|
+                    //       _    _    __   _    _    _    __   _
+    0x93, 0x49, 0x34, //  34  | 0__| 0__|  1_| 0__| 0__| 0__|  1_| 0__|
+                    //       _    _    __   _    _    _    __   __
+    0x93, 0x49, 0x36, //  35  | 0__| 0__|  1_| 0__| 0__| 0__|  1_|  1_|
+                    //       _    _    __   _    _    __   _    _
+    0x93, 0x49, 0xa4, //  36  | 0__| 0__|  1_| 0__| 0__|  1_| 0__| 0__|
+                    //       _    _    __   _    _    __   _    __
+    0x93, 0x49, 0xa6, //  37  | 0__| 0__|  1_| 0__| 0__|  1_| 0__|  1_|
+                    //       _    _    __   _    _    __   __   _
+    0x93, 0x49, 0xb4, //  38  | 0__| 0__|  1_| 0__| 0__|  1_|  1_| 0__|
+                    //       _    _    __   _    _    __   __   __
+    0x93, 0x49, 0xb6, //  39  | 0__| 0__|  1_| 0__| 0__|  1_|  1_|  1_|
+                    //       _    _    __   _    __   _    _    _
+    0x93, 0x4d, 0x24, //  40  | 0__| 0__|  1_| 0__|  1_| 0__| 0__| 0__|
+                    //       _    _    __   _    __   _    _    __
+    0x93, 0x4d, 0x26, //  41  | 0__| 0__|  1_| 0__|  1_| 0__| 0__|  1_|
+                    //       _    _    __   _    __   _    __   _
+    0x93, 0x4d, 0x34, //  42  | 0__| 0__|  1_| 0__|  1_| 0__|  1_| 0__|
+                    //       _    _    __   _    __   _    __   __
+    0x93, 0x4d, 0x36, //  43  | 0__| 0__|  1_| 0__|  1_| 0__|  1_|  1_|
+                    //       _    _    __   _    __   __   _    _
+    0x93, 0x4d, 0xa4, //  44  | 0__| 0__|  1_| 0__|  1_|  1_| 0__| 0__|
+                    //       _    _    __   _    __   __   _    __
+    0x93, 0x4d, 0xa6, //  45  | 0__| 0__|  1_| 0__|  1_|  1_| 0__|  1_|
+                    //       _    _    __   _    __   __   __   _
+    0x93, 0x4d, 0xb4, //  46  | 0__| 0__|  1_| 0__|  1_|  1_|  1_| 0__|
+                    //       _    _    __   _    __   __   __   __
+    0x93, 0x4d, 0xb6, //  47  | 0__| 0__|  1_| 0__|  1_|  1_|  1_|  1_|
+                    //       _    _    __   __   _    _    _    _
+    0x93, 0x69, 0x24, //  48  | 0__| 0__|  1_|  1_| 0__| 0__| 0__| 0__|
+                    //       _    _    __   __   _    _    _    __
+    0x93, 0x69, 0x26, //  49  | 0__| 0__|  1_|  1_| 0__| 0__| 0__|  1_|
+                    //       _    _    __   __   _    _    __   _
+    0x93, 0x69, 0x34, //  50  | 0__| 0__|  1_|  1_| 0__| 0__|  1_| 0__|
+                    //       _    _    __   __   _    _    __   __
+    0x93, 0x69, 0x36, //  51  | 0__| 0__|  1_|  1_| 0__| 0__|  1_|  1_|
+                    //       _    _    __   __   _    __   _    _
+    0x93, 0x69, 0xa4, //  52  | 0__| 0__|  1_|  1_| 0__|  1_| 0__| 0__|
+                    //       _    _    __   __   _    __   _    __
+    0x93, 0x69, 0xa6, //  53  | 0__| 0__|  1_|  1_| 0__|  1_| 0__|  1_|
+                    //       _    _    __   __   _    __   __   _
+    0x93, 0x69, 0xb4, //  54  | 0__| 0__|  1_|  1_| 0__|  1_|  1_| 0__|
+                    //       _    _    __   __   _    __   __   __
+    0x93, 0x69, 0xb6, //  55  | 0__| 0__|  1_|  1_| 0__|  1_|  1_|  1_|
+                    //       _    _    __   __   __   _    _    _
+    0x93, 0x6d, 0x24, //  56  | 0__| 0__|  1_|  1_|  1_| 0__| 0__| 0__|
+                    //       _    _    __   __   __   _    _    __
+    0x93, 0x6d, 0x26, //  57  | 0__| 0__|  1_|  1_|  1_| 0__| 0__|  1_|
+                    //       _    _    __   __   __   _    __   _
+    0x93, 0x6d, 0x34, //  58  | 0__| 0__|  1_|  1_|  1_| 0__|  1_| 0__|
+                    //       _    _    __   __   __   _    __   __
+    0x93, 0x6d, 0x36, //  59  | 0__| 0__|  1_|  1_|  1_| 0__|  1_|  1_|
+                    //       _    _    __   __   __   __   _    _
+    0x93, 0x6d, 0xa4, //  60  | 0__| 0__|  1_|  1_|  1_|  1_| 0__| 0__|
+                    //       _    _    __   __   __   __   _    __
+    0x93, 0x6d, 0xa6, //  61  | 0__| 0__|  1_|  1_|  1_|  1_| 0__|  1_|
+                    //       _    _    __   __   __   __   __   _
+    0x93, 0x6d, 0xb4, //  62  | 0__| 0__|  1_|  1_|  1_|  1_|  1_| 0__|
+                    //       _    _    __   __   __   __   __   __
+    0x93, 0x6d, 0xb6, //  63  | 0__| 0__|  1_|  1_|  1_|  1_|  1_|  1_|
+                    //       _    __   _    _    _    _    _    _
+    0x9a, 0x49, 0x24, //  64  | 0__|  1_| 0__| 0__| 0__| 0__| 0__| 0__|
+                    //       _    __   _    _    _    _    _    __
+    0x9a, 0x49, 0x26, //  65  | 0__|  1_| 0__| 0__| 0__| 0__| 0__|  1_|
+                    //       _    __   _    _    _    _    __   _
+    0x9a, 0x49, 0x34, //  66  | 0__|  1_| 0__| 0__| 0__| 0__|  1_| 0__|
+                    //       _    __   _    _    _    _    __   __
+    0x9a, 0x49, 0x36, //  67  | 0__|  1_| 0__| 0__| 0__| 0__|  1_|  1_|
+                    //       _    __   _    _    _    __   _    _
+    0x9a, 0x49, 0xa4, //  68  | 0__|  1_| 0__| 0__| 0__|  1_| 0__| 0__|
+                    //       _    __   _    _    _    __   _    __
+    0x9a, 0x49, 0xa6, //  69  | 0__|  1_| 0__| 0__| 0__|  1_| 0__|  1_|
+                    //       _    __   _    _    _    __   __   _
+    0x9a, 0x49, 0xb4, //  70  | 0__|  1_| 0__| 0__| 0__|  1_|  1_| 0__|
+                    //       _    __   _    _    _    __   __   __
+    0x9a, 0x49, 0xb6, //  71  | 0__|  1_| 0__| 0__| 0__|  1_|  1_|  1_|
+                    //       _    __   _    _    __   _    _    _
+    0x9a, 0x4d, 0x24, //  72  | 0__|  1_| 0__| 0__|  1_| 0__| 0__| 0__|
+                    //       _    __   _    _    __   _    _    __
+    0x9a, 0x4d, 0x26, //  73  | 0__|  1_| 0__| 0__|  1_| 0__| 0__|  1_|
+                    //       _    __   _    _    __   _    __   _
+    0x9a, 0x4d, 0x34, //  74  | 0__|  1_| 0__| 0__|  1_| 0__|  1_| 0__|
+                    //       _    __   _    _    __   _    __   __
+    0x9a, 0x4d, 0x36, //  75  | 0__|  1_| 0__| 0__|  1_| 0__|  1_|  1_|
+                    //       _    __   _    _    __   __   _    _
+    0x9a, 0x4d, 0xa4, //  76  | 0__|  1_| 0__| 0__|  1_|  1_| 0__| 0__|
+                    //       _    __   _    _    __   __   _    __
+    0x9a, 0x4d, 0xa6, //  77  | 0__|  1_| 0__| 0__|  1_|  1_| 0__|  1_|
+                    //       _    __   _    _    __   __   __   _
+    0x9a, 0x4d, 0xb4, //  78  | 0__|  1_| 0__| 0__|  1_|  1_|  1_| 0__|
+                    //       _    __   _    _    __   __   __   __
+    0x9a, 0x4d, 0xb6, //  79  | 0__|  1_| 0__| 0__|  1_|  1_|  1_|  1_|
+                    //       _    __   _    __   _    _    _    _
+    0x9a, 0x69, 0x24, //  80  | 0__|  1_| 0__|  1_| 0__| 0__| 0__| 0__|
+                    //       _    __   _    __   _    _    _    __
+    0x9a, 0x69, 0x26, //  81  | 0__|  1_| 0__|  1_| 0__| 0__| 0__|  1_|
+                    //       _    __   _    __   _    _    __   _
+    0x9a, 0x69, 0x34, //  82  | 0__|  1_| 0__|  1_| 0__| 0__|  1_| 0__|
+                    //       _    __   _    __   _    _    __   __
+    0x9a, 0x69, 0x36, //  83  | 0__|  1_| 0__|  1_| 0__| 0__|  1_|  1_|
+                    //       _    __   _    __   _    __   _    _
+    0x9a, 0x69, 0xa4, //  84  | 0__|  1_| 0__|  1_| 0__|  1_| 0__| 0__|
+                    //       _    __   _    __   _    __   _    __
+    0x9a, 0x69, 0xa6, //  85  | 0__|  1_| 0__|  1_| 0__|  1_| 0__|  1_|
+                    //       _    __   _    __   _    __   __   _
+    0x9a, 0x69, 0xb4, //  86  | 0__|  1_| 0__|  1_| 0__|  1_|  1_| 0__|
+                    //       _    __   _    __   _    __   __   __
+    0x9a, 0x69, 0xb6, //  87  | 0__|  1_| 0__|  1_| 0__|  1_|  1_|  1_|
+                    //       _    __   _    __   __   _    _    _
+    0x9a, 0x6d, 0x24, //  88  | 0__|  1_| 0__|  1_|  1_| 0__| 0__| 0__|
+                    //       _    __   _    __   __   _    _    __
+    0x9a, 0x6d, 0x26, //  89  | 0__|  1_| 0__|  1_|  1_| 0__| 0__|  1_|
+                    //       _    __   _    __   __   _    __   _
+    0x9a, 0x6d, 0x34, //  90  | 0__|  1_| 0__|  1_|  1_| 0__|  1_| 0__|
+                    //       _    __   _    __   __   _    __   __
+    0x9a, 0x6d, 0x36, //  91  | 0__|  1_| 0__|  1_|  1_| 0__|  1_|  1_|
+                    //       _    __   _    __   __   __   _    _
+    0x9a, 0x6d, 0xa4, //  92  | 0__|  1_| 0__|  1_|  1_|  1_| 0__| 0__|
+                    //       _    __   _    __   __   __   _    __
+    0x9a, 0x6d, 0xa6, //  93  | 0__|  1_| 0__|  1_|  1_|  1_| 0__|  1_|
+                    //       _    __   _    __   __   __   __   _
+    0x9a, 0x6d, 0xb4, //  94  | 0__|  1_| 0__|  1_|  1_|  1_|  1_| 0__|
+                    //       _    __   _    __   __   __   __   __
+    0x9a, 0x6d, 0xb6, //  95  | 0__|  1_| 0__|  1_|  1_|  1_|  1_|  1_|
+                    //       _    __   __   _    _    _    _    _
+    0x9b, 0x49, 0x24, //  96  | 0__|  1_|  1_| 0__| 0__| 0__| 0__| 0__|
+                    //       _    __   __   _    _    _    _    __
+    0x9b, 0x49, 0x26, //  97  | 0__|  1_|  1_| 0__| 0__| 0__| 0__|  1_|
+                    //       _    __   __   _    _    _    __   _
+    0x9b, 0x49, 0x34, //  98  | 0__|  1_|  1_| 0__| 0__| 0__|  1_| 0__|
+                    //       _    __   __   _    _    _    __   __
+    0x9b, 0x49, 0x36, //  99  | 0__|  1_|  1_| 0__| 0__| 0__|  1_|  1_|
+                    //       _    __   __   _    _    __   _    _
+    0x9b, 0x49, 0xa4, // 100  | 0__|  1_|  1_| 0__| 0__|  1_| 0__| 0__|
+                    //       _    __   __   _    _    __   _    __
+    0x9b, 0x49, 0xa6, // 101  | 0__|  1_|  1_| 0__| 0__|  1_| 0__|  1_|
+                    //       _    __   __   _    _    __   __   _
+    0x9b, 0x49, 0xb4, // 102  | 0__|  1_|  1_| 0__| 0__|  1_|  1_| 0__|
+                    //       _    __   __   _    _    __   __   __
+    0x9b, 0x49, 0xb6, // 103  | 0__|  1_|  1_| 0__| 0__|  1_|  1_|  1_|
+                    //       _    __   __   _    __   _    _    _
+    0x9b, 0x4d, 0x24, // 104  | 0__|  1_|  1_| 0__|  1_| 0__| 0__| 0__|
+                    //       _    __   __   _    __   _    _    __
+    0x9b, 0x4d, 0x26, // 105  | 0__|  1_|  1_| 0__|  1_| 0__| 0__|  1_|
+                    //       _    __   __   _    __   _    __   _
+    0x9b, 0x4d, 0x34, // 106  | 0__|  1_|  1_| 0__|  1_| 0__|  1_| 0__|
+                    //       _    __   __   _    __   _    __   __
+    0x9b, 0x4d, 0x36, // 107  | 0__|  1_|  1_| 0__|  1_| 0__|  1_|  1_|
+                    //       _    __   __   _    __   __   _    _
+    0x9b, 0x4d, 0xa4, // 108  | 0__|  1_|  1_| 0__|  1_|  1_| 0__| 0__|
+                    //       _    __   __   _    __   __   _    __
+    0x9b, 0x4d, 0xa6, // 109  | 0__|  1_|  1_| 0__|  1_|  1_| 0__|  1_|
+                    //       _    __   __   _    __   __   __   _
+    0x9b, 0x4d, 0xb4, // 110  | 0__|  1_|  1_| 0__|  1_|  1_|  1_| 0__|
+                    //       _    __   __   _    __   __   __   __
+    0x9b, 0x4d, 0xb6, // 111  | 0__|  1_|  1_| 0__|  1_|  1_|  1_|  1_|
+                    //       _    __   __   __   _    _    _    _
+    0x9b, 0x69, 0x24, // 112  | 0__|  1_|  1_|  1_| 0__| 0__| 0__| 0__|
+                    //       _    __   __   __   _    _    _    __
+    0x9b, 0x69, 0x26, // 113  | 0__|  1_|  1_|  1_| 0__| 0__| 0__|  1_|
+                    //       _    __   __   __   _    _    __   _
+    0x9b, 0x69, 0x34, // 114  | 0__|  1_|  1_|  1_| 0__| 0__|  1_| 0__|
+                    //       _    __   __   __   _    _    __   __
+    0x9b, 0x69, 0x36, // 115  | 0__|  1_|  1_|  1_| 0__| 0__|  1_|  1_|
+                    //       _    __   __   __   _    __   _    _
+    0x9b, 0x69, 0xa4, // 116  | 0__|  1_|  1_|  1_| 0__|  1_| 0__| 0__|
+                    //       _    __   __   __   _    __   _    __
+    0x9b, 0x69, 0xa6, // 117  | 0__|  1_|  1_|  1_| 0__|  1_| 0__|  1_|
+                    //       _    __   __   __   _    __   __   _
+    0x9b, 0x69, 0xb4, // 118  | 0__|  1_|  1_|  1_| 0__|  1_|  1_| 0__|
+                    //       _    __   __   __   _    __   __   __
+    0x9b, 0x69, 0xb6, // 119  | 0__|  1_|  1_|  1_| 0__|  1_|  1_|  1_|
+                    //       _    __   __   __   __   _    _    _
+    0x9b, 0x6d, 0x24, // 120  | 0__|  1_|  1_|  1_|  1_| 0__| 0__| 0__|
+                    //       _    __   __   __   __   _    _    __
+    0x9b, 0x6d, 0x26, // 121  | 0__|  1_|  1_|  1_|  1_| 0__| 0__|  1_|
+                    //       _    __   __   __   __   _    __   _
+    0x9b, 0x6d, 0x34, // 122  | 0__|  1_|  1_|  1_|  1_| 0__|  1_| 0__|
+                    //       _    __   __   __   __   _    __   __
+    0x9b, 0x6d, 0x36, // 123  | 0__|  1_|  1_|  1_|  1_| 0__|  1_|  1_|
+                    //       _    __   __   __   __   __   _    _
+    0x9b, 0x6d, 0xa4, // 124  | 0__|  1_|  1_|  1_|  1_|  1_| 0__| 0__|
+                    //       _    __   __   __   __   __   _    __
+    0x9b, 0x6d, 0xa6, // 125  | 0__|  1_|  1_|  1_|  1_|  1_| 0__|  1_|
+                    //       _    __   __   __   __   __   __   _
+    0x9b, 0x6d, 0xb4, // 126  | 0__|  1_|  1_|  1_|  1_|  1_|  1_| 0__|
+                    //       _    __   __   __   __   __   __   __
+    0x9b, 0x6d, 0xb6, // 127  | 0__|  1_|  1_|  1_|  1_|  1_|  1_|  1_|
+                    //       __   _    _    _    _    _    _    _
+    0xd2, 0x49, 0x24, // 128  |  1_| 0__| 0__| 0__| 0__| 0__| 0__| 0__|
+                    //       __   _    _    _    _    _    _    __
+    0xd2, 0x49, 0x26, // 129  |  1_| 0__| 0__| 0__| 0__| 0__| 0__|  1_|
+                    //       __   _    _    _    _    _    __   _
+    0xd2, 0x49, 0x34, // 130  |  1_| 0__| 0__| 0__| 0__| 0__|  1_| 0__|
+                    //       __   _    _    _    _    _    __   __
+    0xd2, 0x49, 0x36, // 131  |  1_| 0__| 0__| 0__| 0__| 0__|  1_|  1_|
+                    //       __   _    _    _    _    __   _    _
+    0xd2, 0x49, 0xa4, // 132  |  1_| 0__| 0__| 0__| 0__|  1_| 0__| 0__|
+                    //       __   _    _    _    _    __   _    __
+    0xd2, 0x49, 0xa6, // 133  |  1_| 0__| 0__| 0__| 0__|  1_| 0__|  1_|
+                    //       __   _    _    _    _    __   __   _
+    0xd2, 0x49, 0xb4, // 134  |  1_| 0__| 0__| 0__| 0__|  1_|  1_| 0__|
+                    //       __   _    _    _    _    __   __   __
+    0xd2, 0x49, 0xb6, // 135  |  1_| 0__| 0__| 0__| 0__|  1_|  1_|  1_|
+                    //       __   _    _    _    __   _    _    _
+    0xd2, 0x4d, 0x24, // 136  |  1_| 0__| 0__| 0__|  1_| 0__| 0__| 0__|
+                    //       __   _    _    _    __   _    _    __
+    0xd2, 0x4d, 0x26, // 137  |  1_| 0__| 0__| 0__|  1_| 0__| 0__|  1_|
+                    //       __   _    _    _    __   _    __   _
+    0xd2, 0x4d, 0x34, // 138  |  1_| 0__| 0__| 0__|  1_| 0__|  1_| 0__|
+                    //       __   _    _    _    __   _    __   __
+    0xd2, 0x4d, 0x36, // 139  |  1_| 0__| 0__| 0__|  1_| 0__|  1_|  1_|
+                    //       __   _    _    _    __   __   _    _
+    0xd2, 0x4d, 0xa4, // 140  |  1_| 0__| 0__| 0__|  1_|  1_| 0__| 0__|
+                    //       __   _    _    _    __   __   _    __
+    0xd2, 0x4d, 0xa6, // 141  |  1_| 0__| 0__| 0__|  1_|  1_| 0__|  1_|
+                    //       __   _    _    _    __   __   __   _
+    0xd2, 0x4d, 0xb4, // 142  |  1_| 0__| 0__| 0__|  1_|  1_|  1_| 0__|
+                    //       __   _    _    _    __   __   __   __
+    0xd2, 0x4d, 0xb6, // 143  |  1_| 0__| 0__| 0__|  1_|  1_|  1_|  1_|
+                    //       __   _    _    __   _    _    _    _
+    0xd2, 0x69, 0x24, // 144  |  1_| 0__| 0__|  1_| 0__| 0__| 0__| 0__|
+                    //       __   _    _    __   _    _    _    __
+    0xd2, 0x69, 0x26, // 145  |  1_| 0__| 0__|  1_| 0__| 0__| 0__|  1_|
+                    //       __   _    _    __   _    _    __   _
+    0xd2, 0x69, 0x34, // 146  |  1_| 0__| 0__|  1_| 0__| 0__|  1_| 0__|
+                    //       __   _    _    __   _    _    __   __
+    0xd2, 0x69, 0x36, // 147  |  1_| 0__| 0__|  1_| 0__| 0__|  1_|  1_|
+                    //       __   _    _    __   _    __   _    _
+    0xd2, 0x69, 0xa4, // 148  |  1_| 0__| 0__|  1_| 0__|  1_| 0__| 0__|
+                    //       __   _    _    __   _    __   _    __
+    0xd2, 0x69, 0xa6, // 149  |  1_| 0__| 0__|  1_| 0__|  1_| 0__|  1_|
+                    //       __   _    _    __   _    __   __   _
+    0xd2, 0x69, 0xb4, // 150  |  1_| 0__| 0__|  1_| 0__|  1_|  1_| 0__|
+                    //       __   _    _    __   _    __   __   __
+    0xd2, 0x69, 0xb6, // 151  |  1_| 0__| 0__|  1_| 0__|  1_|  1_|  1_|
+                    //       __   _    _    __   __   _    _    _
+    0xd2, 0x6d, 0x24, // 152  |  1_| 0__| 0__|  1_|  1_| 0__| 0__| 0__|
+                    //       __   _    _    __   __   _    _    __
+    0xd2, 0x6d, 0x26, // 153  |  1_| 0__| 0__|  1_|  1_| 0__| 0__|  1_|
+                    //       __   _    _    __   __   _    __   _
+    0xd2, 0x6d, 0x34, // 154  |  1_| 0__| 0__|  1_|  1_| 0__|  1_| 0__|
+                    //       __   _    _    __   __   _    __   __
+    0xd2, 0x6d, 0x36, // 155  |  1_| 0__| 0__|  1_|  1_| 0__|  1_|  1_|
+                    //       __   _    _    __   __   __   _    _
+    0xd2, 0x6d, 0xa4, // 156  |  1_| 0__| 0__|  1_|  1_|  1_| 0__| 0__|
+                    //       __   _    _    __   __   __   _    __
+    0xd2, 0x6d, 0xa6, // 157  |  1_| 0__| 0__|  1_|  1_|  1_| 0__|  1_|
+                    //       __   _    _    __   __   __   __   _
+    0xd2, 0x6d, 0xb4, // 158  |  1_| 0__| 0__|  1_|  1_|  1_|  1_| 0__|
+                    //       __   _    _    __   __   __   __   __
+    0xd2, 0x6d, 0xb6, // 159  |  1_| 0__| 0__|  1_|  1_|  1_|  1_|  1_|
+                    //       __   _    __   _    _    _    _    _
+    0xd3, 0x49, 0x24, // 160  |  1_| 0__|  1_| 0__| 0__| 0__| 0__| 0__|
+                    //       __   _    __   _    _    _    _    __
+    0xd3, 0x49, 0x26, // 161  |  1_| 0__|  1_| 0__| 0__| 0__| 0__|  1_|
+                    //       __   _    __   _    _    _    __   _
+    0xd3, 0x49, 0x34, // 162  |  1_| 0__|  1_| 0__| 0__| 0__|  1_| 0__|
+                    //       __   _    __   _    _    _    __   __
+    0xd3, 0x49, 0x36, // 163  |  1_| 0__|  1_| 0__| 0__| 0__|  1_|  1_|
+                    //       __   _    __   _    _    __   _    _
+    0xd3, 0x49, 0xa4, // 164  |  1_| 0__|  1_| 0__| 0__|  1_| 0__| 0__|
+                    //       __   _    __   _    _    __   _    __
+    0xd3, 0x49, 0xa6, // 165  |  1_| 0__|  1_| 0__| 0__|  1_| 0__|  1_|
+                    //       __   _    __   _    _    __   __   _
+    0xd3, 0x49, 0xb4, // 166  |  1_| 0__|  1_| 0__| 0__|  1_|  1_| 0__|
+                    //       __   _    __   _    _    __   __   __
+    0xd3, 0x49, 0xb6, // 167  |  1_| 0__|  1_| 0__| 0__|  1_|  1_|  1_|
+                    //       __   _    __   _    __   _    _    _
+    0xd3, 0x4d, 0x24, // 168  |  1_| 0__|  1_| 0__|  1_| 0__| 0__| 0__|
+                    //       __   _    __   _    __   _    _    __
+    0xd3, 0x4d, 0x26, // 169  |  1_| 0__|  1_| 0__|  1_| 0__| 0__|  1_|
+                    //       __   _    __   _    __   _    __   _
+    0xd3, 0x4d, 0x34, // 170  |  1_| 0__|  1_| 0__|  1_| 0__|  1_| 0__|
+                    //       __   _    __   _    __   _    __   __
+    0xd3, 0x4d, 0x36, // 171  |  1_| 0__|  1_| 0__|  1_| 0__|  1_|  1_|
+                    //       __   _    __   _    __   __   _    _
+    0xd3, 0x4d, 0xa4, // 172  |  1_| 0__|  1_| 0__|  1_|  1_| 0__| 0__|
+                    //       __   _    __   _    __   __   _    __
+    0xd3, 0x4d, 0xa6, // 173  |  1_| 0__|  1_| 0__|  1_|  1_| 0__|  1_|
+                    //       __   _    __   _    __   __   __   _
+    0xd3, 0x4d, 0xb4, // 174  |  1_| 0__|  1_| 0__|  1_|  1_|  1_| 0__|
+                    //       __   _    __   _    __   __   __   __
+    0xd3, 0x4d, 0xb6, // 175  |  1_| 0__|  1_| 0__|  1_|  1_|  1_|  1_|
+                    //       __   _    __   __   _    _    _    _
+    0xd3, 0x69, 0x24, // 176  |  1_| 0__|  1_|  1_| 0__| 0__| 0__| 0__|
+                    //       __   _    __   __   _    _    _    __
+    0xd3, 0x69, 0x26, // 177  |  1_| 0__|  1_|  1_| 0__| 0__| 0__|  1_|
+                    //       __   _    __   __   _    _    __   _
+    0xd3, 0x69, 0x34, // 178  |  1_| 0__|  1_|  1_| 0__| 0__|  1_| 0__|
+                    //       __   _    __   __   _    _    __   __
+    0xd3, 0x69, 0x36, // 179  |  1_| 0__|  1_|  1_| 0__| 0__|  1_|  1_|
+                    //       __   _    __   __   _    __   _    _
+    0xd3, 0x69, 0xa4, // 180  |  1_| 0__|  1_|  1_| 0__|  1_| 0__| 0__|
+                    //       __   _    __   __   _    __   _    __
+    0xd3, 0x69, 0xa6, // 181  |  1_| 0__|  1_|  1_| 0__|  1_| 0__|  1_|
+                    //       __   _    __   __   _    __   __   _
+    0xd3, 0x69, 0xb4, // 182  |  1_| 0__|  1_|  1_| 0__|  1_|  1_| 0__|
+                    //       __   _    __   __   _    __   __   __
+    0xd3, 0x69, 0xb6, // 183  |  1_| 0__|  1_|  1_| 0__|  1_|  1_|  1_|
+                    //       __   _    __   __   __   _    _    _
+    0xd3, 0x6d, 0x24, // 184  |  1_| 0__|  1_|  1_|  1_| 0__| 0__| 0__|
+                    //       __   _    __   __   __   _    _    __
+    0xd3, 0x6d, 0x26, // 185  |  1_| 0__|  1_|  1_|  1_| 0__| 0__|  1_|
+                    //       __   _    __   __   __   _    __   _
+    0xd3, 0x6d, 0x34, // 186  |  1_| 0__|  1_|  1_|  1_| 0__|  1_| 0__|
+                    //       __   _    __   __   __   _    __   __
+    0xd3, 0x6d, 0x36, // 187  |  1_| 0__|  1_|  1_|  1_| 0__|  1_|  1_|
+                    //       __   _    __   __   __   __   _    _
+    0xd3, 0x6d, 0xa4, // 188  |  1_| 0__|  1_|  1_|  1_|  1_| 0__| 0__|
+                    //       __   _    __   __   __   __   _    __
+    0xd3, 0x6d, 0xa6, // 189  |  1_| 0__|  1_|  1_|  1_|  1_| 0__|  1_|
+                    //       __   _    __   __   __   __   __   _
+    0xd3, 0x6d, 0xb4, // 190  |  1_| 0__|  1_|  1_|  1_|  1_|  1_| 0__|
+                    //       __   _    __   __   __   __   __   __
+    0xd3, 0x6d, 0xb6, // 191  |  1_| 0__|  1_|  1_|  1_|  1_|  1_|  1_|
+                    //       __   __   _    _    _    _    _    _
+    0xda, 0x49, 0x24, // 192  |  1_|  1_| 0__| 0__| 0__| 0__| 0__| 0__|
+                    //       __   __   _    _    _    _    _    __
+    0xda, 0x49, 0x26, // 193  |  1_|  1_| 0__| 0__| 0__| 0__| 0__|  1_|
+                    //       __   __   _    _    _    _    __   _
+    0xda, 0x49, 0x34, // 194  |  1_|  1_| 0__| 0__| 0__| 0__|  1_| 0__|
+                    //       __   __   _    _    _    _    __   __
+    0xda, 0x49, 0x36, // 195  |  1_|  1_| 0__| 0__| 0__| 0__|  1_|  1_|
+                    //       __   __   _    _    _    __   _    _
+    0xda, 0x49, 0xa4, // 196  |  1_|  1_| 0__| 0__| 0__|  1_| 0__| 0__|
+                    //       __   __   _    _    _    __   _    __
+    0xda, 0x49, 0xa6, // 197  |  1_|  1_| 0__| 0__| 0__|  1_| 0__|  1_|
+                    //       __   __   _    _    _    __   __   _
+    0xda, 0x49, 0xb4, // 198  |  1_|  1_| 0__| 0__| 0__|  1_|  1_| 0__|
+                    //       __   __   _    _    _    __   __   __
+    0xda, 0x49, 0xb6, // 199  |  1_|  1_| 0__| 0__| 0__|  1_|  1_|  1_|
+                    //       __   __   _    _    __   _    _    _
+    0xda, 0x4d, 0x24, // 200  |  1_|  1_| 0__| 0__|  1_| 0__| 0__| 0__|
+                    //       __   __   _    _    __   _    _    __
+    0xda, 0x4d, 0x26, // 201  |  1_|  1_| 0__| 0__|  1_| 0__| 0__|  1_|
+                    //       __   __   _    _    __   _    __   _
+    0xda, 0x4d, 0x34, // 202  |  1_|  1_| 0__| 0__|  1_| 0__|  1_| 0__|
+                    //       __   __   _    _    __   _    __   __
+    0xda, 0x4d, 0x36, // 203  |  1_|  1_| 0__| 0__|  1_| 0__|  1_|  1_|
+                    //       __   __   _    _    __   __   _    _
+    0xda, 0x4d, 0xa4, // 204  |  1_|  1_| 0__| 0__|  1_|  1_| 0__| 0__|
+                    //       __   __   _    _    __   __   _    __
+    0xda, 0x4d, 0xa6, // 205  |  1_|  1_| 0__| 0__|  1_|  1_| 0__|  1_|
+                    //       __   __   _    _    __   __   __   _
+    0xda, 0x4d, 0xb4, // 206  |  1_|  1_| 0__| 0__|  1_|  1_|  1_| 0__|
+                    //       __   __   _    _    __   __   __   __
+    0xda, 0x4d, 0xb6, // 207  |  1_|  1_| 0__| 0__|  1_|  1_|  1_|  1_|
+                    //       __   __   _    __   _    _    _    _
+    0xda, 0x69, 0x24, // 208  |  1_|  1_| 0__|  1_| 0__| 0__| 0__| 0__|
+                    //       __   __   _    __   _    _    _    __
+    0xda, 0x69, 0x26, // 209  |  1_|  1_| 0__|  1_| 0__| 0__| 0__|  1_|
+                    //       __   __   _    __   _    _    __   _
+    0xda, 0x69, 0x34, // 210  |  1_|  1_| 0__|  1_| 0__| 0__|  1_| 0__|
+                    //       __   __   _    __   _    _    __   __
+    0xda, 0x69, 0x36, // 211  |  1_|  1_| 0__|  1_| 0__| 0__|  1_|  1_|
+                    //       __   __   _    __   _    __   _    _
+    0xda, 0x69, 0xa4, // 212  |  1_|  1_| 0__|  1_| 0__|  1_| 0__| 0__|
+                    //       __   __   _    __   _    __   _    __
+    0xda, 0x69, 0xa6, // 213  |  1_|  1_| 0__|  1_| 0__|  1_| 0__|  1_|
+                    //       __   __   _    __   _    __   __   _
+    0xda, 0x69, 0xb4, // 214  |  1_|  1_| 0__|  1_| 0__|  1_|  1_| 0__|
+                    //       __   __   _    __   _    __   __   __
+    0xda, 0x69, 0xb6, // 215  |  1_|  1_| 0__|  1_| 0__|  1_|  1_|  1_|
+                    //       __   __   _    __   __   _    _    _
+    0xda, 0x6d, 0x24, // 216  |  1_|  1_| 0__|  1_|  1_| 0__| 0__| 0__|
+                    //       __   __   _    __   __   _    _    __
+    0xda, 0x6d, 0x26, // 217  |  1_|  1_| 0__|  1_|  1_| 0__| 0__|  1_|
+                    //       __   __   _    __   __   _    __   _
+    0xda, 0x6d, 0x34, // 218  |  1_|  1_| 0__|  1_|  1_| 0__|  1_| 0__|
+                    //       __   __   _    __   __   _    __   __
+    0xda, 0x6d, 0x36, // 219  |  1_|  1_| 0__|  1_|  1_| 0__|  1_|  1_|
+                    //       __   __   _    __   __   __   _    _
+    0xda, 0x6d, 0xa4, // 220  |  1_|  1_| 0__|  1_|  1_|  1_| 0__| 0__|
+                    //       __   __   _    __   __   __   _    __
+    0xda, 0x6d, 0xa6, // 221  |  1_|  1_| 0__|  1_|  1_|  1_| 0__|  1_|
+                    //       __   __   _    __   __   __   __   _
+    0xda, 0x6d, 0xb4, // 222  |  1_|  1_| 0__|  1_|  1_|  1_|  1_| 0__|
+                    //       __   __   _    __   __   __   __   __
+    0xda, 0x6d, 0xb6, // 223  |  1_|  1_| 0__|  1_|  1_|  1_|  1_|  1_|
+                    //       __   __   __   _    _    _    _    _
+    0xdb, 0x49, 0x24, // 224  |  1_|  1_|  1_| 0__| 0__| 0__| 0__| 0__|
+                    //       __   __   __   _    _    _    _    __
+    0xdb, 0x49, 0x26, // 225  |  1_|  1_|  1_| 0__| 0__| 0__| 0__|  1_|
+                    //       __   __   __   _    _    _    __   _
+    0xdb, 0x49, 0x34, // 226  |  1_|  1_|  1_| 0__| 0__| 0__|  1_| 0__|
+                    //       __   __   __   _    _    _    __   __
+    0xdb, 0x49, 0x36, // 227  |  1_|  1_|  1_| 0__| 0__| 0__|  1_|  1_|
+                    //       __   __   __   _    _    __   _    _
+    0xdb, 0x49, 0xa4, // 228  |  1_|  1_|  1_| 0__| 0__|  1_| 0__| 0__|
+                    //       __   __   __   _    _    __   _    __
+    0xdb, 0x49, 0xa6, // 229  |  1_|  1_|  1_| 0__| 0__|  1_| 0__|  1_|
+                    //       __   __   __   _    _    __   __   _
+    0xdb, 0x49, 0xb4, // 230  |  1_|  1_|  1_| 0__| 0__|  1_|  1_| 0__|
+                    //       __   __   __   _    _    __   __   __
+    0xdb, 0x49, 0xb6, // 231  |  1_|  1_|  1_| 0__| 0__|  1_|  1_|  1_|
+                    //       __   __   __   _    __   _    _    _
+    0xdb, 0x4d, 0x24, // 232  |  1_|  1_|  1_| 0__|  1_| 0__| 0__| 0__|
+                    //       __   __   __   _    __   _    _    __
+    0xdb, 0x4d, 0x26, // 233  |  1_|  1_|  1_| 0__|  1_| 0__| 0__|  1_|
+                    //       __   __   __   _    __   _    __   _
+    0xdb, 0x4d, 0x34, // 234  |  1_|  1_|  1_| 0__|  1_| 0__|  1_| 0__|
+                    //       __   __   __   _    __   _    __   __
+    0xdb, 0x4d, 0x36, // 235  |  1_|  1_|  1_| 0__|  1_| 0__|  1_|  1_|
+                    //       __   __   __   _    __   __   _    _
+    0xdb, 0x4d, 0xa4, // 236  |  1_|  1_|  1_| 0__|  1_|  1_| 0__| 0__|
+                    //       __   __   __   _    __   __   _    __
+    0xdb, 0x4d, 0xa6, // 237  |  1_|  1_|  1_| 0__|  1_|  1_| 0__|  1_|
+                    //       __   __   __   _    __   __   __   _
+    0xdb, 0x4d, 0xb4, // 238  |  1_|  1_|  1_| 0__|  1_|  1_|  1_| 0__|
+                    //       __   __   __   _    __   __   __   __
+    0xdb, 0x4d, 0xb6, // 239  |  1_|  1_|  1_| 0__|  1_|  1_|  1_|  1_|
+                    //       __   __   __   __   _    _    _    _
+    0xdb, 0x69, 0x24, // 240  |  1_|  1_|  1_|  1_| 0__| 0__| 0__| 0__|
+                    //       __   __   __   __   _    _    _    __
+    0xdb, 0x69, 0x26, // 241  |  1_|  1_|  1_|  1_| 0__| 0__| 0__|  1_|
+                    //       __   __   __   __   _    _    __   _
+    0xdb, 0x69, 0x34, // 242  |  1_|  1_|  1_|  1_| 0__| 0__|  1_| 0__|
+                    //       __   __   __   __   _    _    __   __
+    0xdb, 0x69, 0x36, // 243  |  1_|  1_|  1_|  1_| 0__| 0__|  1_|  1_|
+                    //       __   __   __   __   _    __   _    _
+    0xdb, 0x69, 0xa4, // 244  |  1_|  1_|  1_|  1_| 0__|  1_| 0__| 0__|
+                    //       __   __   __   __   _    __   _    __
+    0xdb, 0x69, 0xa6, // 245  |  1_|  1_|  1_|  1_| 0__|  1_| 0__|  1_|
+                    //       __   __   __   __   _    __   __   _
+    0xdb, 0x69, 0xb4, // 246  |  1_|  1_|  1_|  1_| 0__|  1_|  1_| 0__|
+                    //       __   __   __   __   _    __   __   __
+    0xdb, 0x69, 0xb6, // 247  |  1_|  1_|  1_|  1_| 0__|  1_|  1_|  1_|
+                    //       __   __   __   __   __   _    _    _
+    0xdb, 0x6d, 0x24, // 248  |  1_|  1_|  1_|  1_|  1_| 0__| 0__| 0__|
+                    //       __   __   __   __   __   _    _    __
+    0xdb, 0x6d, 0x26, // 249  |  1_|  1_|  1_|  1_|  1_| 0__| 0__|  1_|
+                    //       __   __   __   __   __   _    __   _
+    0xdb, 0x6d, 0x34, // 250  |  1_|  1_|  1_|  1_|  1_| 0__|  1_| 0__|
+                    //       __   __   __   __   __   _    __   __
+    0xdb, 0x6d, 0x36, // 251  |  1_|  1_|  1_|  1_|  1_| 0__|  1_|  1_|
+                    //       __   __   __   __   __   __   _    _
+    0xdb, 0x6d, 0xa4, // 252  |  1_|  1_|  1_|  1_|  1_|  1_| 0__| 0__|
+                    //       __   __   __   __   __   __   _    __
+    0xdb, 0x6d, 0xa6, // 253  |  1_|  1_|  1_|  1_|  1_|  1_| 0__|  1_|
+                    //       __   __   __   __   __   __   __   _
+    0xdb, 0x6d, 0xb4, // 254  |  1_|  1_|  1_|  1_|  1_|  1_|  1_| 0__|
+                    //       __   __   __   __   __   __   __   __
+    0xdb, 0x6d, 0xb6, // 255  |  1_|  1_|  1_|  1_|  1_|  1_|  1_|  1_|
+};
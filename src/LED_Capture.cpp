@@ -0,0 +1,95 @@
+/**********************************************************************
+  LED_Capture.cpp
+
+  Robots-For-All (R4A)
+  Capture the LED frame in a buffer
+
+  The encoded frame is copied into the capture buffer instead of being
+  sent to the LEDs.  The output is never busy, so each r4aLEDUpdate
+  produces a frame.  The default constructor parameters copy the color
+  bytes, the SPI encoding is captured by passing the SPI table and
+  bytes per color.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//*********************************************************************
+// Constructor
+R4A_LED_OUTPUT_CAPTURE::R4A_LED_OUTPUT_CAPTURE(uint8_t bytesPerColor,
+                                               const uint8_t * table,
+                                               uint16_t resetBytes)
+    : R4A_LED_OUTPUT(bytesPerColor, table, resetBytes), _frame{nullptr},
+      _frames{0}, _frameBytes{0}, _length{0}
+{
+}
+
+//*********************************************************************
+// Destructor
+R4A_LED_OUTPUT_CAPTURE::~R4A_LED_OUTPUT_CAPTURE()
+{
+    if (_frame)
+    {
+        r4aFree(_frame);
+        _frame = nullptr;
+    }
+}
+
+//*********************************************************************
+// Allocate the frame buffer
+uint8_t * R4A_LED_OUTPUT_CAPTURE::allocateBuffer(int length)
+{
+    uint8_t * buffer;
+
+    // Allocate the capture buffer with the same size
+    if (_frame)
+        r4aFree(_frame);
+    _frameBytes = 0;
+    _length = 0;
+    _frame = (uint8_t *)r4aMalloc(R4A_MODULE_LED, length);
+    if (!_frame)
+        return nullptr;
+
+    // Allocate the frame buffer
+    buffer = (uint8_t *)r4aMalloc(R4A_MODULE_LED, length);
+    if (!buffer)
+    {
+        r4aFree(_frame);
+        _frame = nullptr;
+        return nullptr;
+    }
+    _frameBytes = length;
+    return buffer;
+}
+
+//*********************************************************************
+// Initialize the output device
+bool R4A_LED_OUTPUT_CAPTURE::begin()
+{
+    return true;
+}
+
+//*********************************************************************
+// Determine if the previous frame is still being output
+bool R4A_LED_OUTPUT_CAPTURE::busy()
+{
+    // The frame is copied by write
+    return false;
+}
+
+//*********************************************************************
+// Free the frame buffer
+void R4A_LED_OUTPUT_CAPTURE::freeBuffer(uint8_t * buffer)
+{
+    r4aFree(buffer);
+}
+
+//*********************************************************************
+// Copy the frame into the capture buffer
+void R4A_LED_OUTPUT_CAPTURE::write(const uint8_t * buffer, int length)
+{
+    if (length > _frameBytes)
+        length = _frameBytes;
+    memcpy(_frame, buffer, length);
+    _length = length;
+    _frames += 1;
+}
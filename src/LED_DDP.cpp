@@ -0,0 +1,263 @@
+/**********************************************************************
+  LED_DDP.cpp
+
+  Robots-For-All (R4A)
+  Receive LED frames using the Distributed Display Protocol (DDP)
+
+  A PC (xLights, WLED tools, ...) sends the pixel data in UDP packets
+  to port 4048.  The payload is decoded into r4aLEDColor and the frame
+  is output when the packet with the PUSH flag arrives.  The sequence
+  number in each packet is checked to count the lost packets.
+
+  See: http://www.3waylabs.com/ddp/
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Constants
+//****************************************
+
+#define R4A_DDP_BUFFER_BYTES        1500    // Largest UDP packet
+
+#define R4A_DDP_HEADER_BYTES        10      // Header without time code
+#define R4A_DDP_TIMECODE_BYTES      4       // Optional time code
+
+// Header byte 0: flags
+#define R4A_DDP_FLAGS_VERSION_MASK  0xc0
+#define R4A_DDP_FLAGS_VERSION_1     0x40
+#define R4A_DDP_FLAGS_TIMECODE      0x10
+#define R4A_DDP_FLAGS_STORAGE       0x08
+#define R4A_DDP_FLAGS_REPLY         0x04
+#define R4A_DDP_FLAGS_QUERY         0x02
+#define R4A_DDP_FLAGS_PUSH          0x01
+
+// Header byte 1: sequence number, 0 when not used
+#define R4A_DDP_SEQUENCE_MASK       0x0f
+
+// Header byte 2: data type
+#define R4A_DDP_TYPE_UNDEFINED      0x00
+#define R4A_DDP_TYPE_RGB_8          0x0b    // 3 colors, 8 bits per color
+#define R4A_DDP_TYPE_RGBW_8         0x1b    // 4 colors, 8 bits per color
+
+// Header byte 3: destination ID
+#define R4A_DDP_ID_DISPLAY          1       // Default output device
+
+//****************************************
+// Locals
+//****************************************
+
+static uint8_t * r4aLEDDdpBuffer;       // UDP packet buffer
+static uint32_t r4aLEDDdpLinkGeneration; // Link generation of the UDP port
+static bool r4aLEDDdpPending;           // Pushed frame waiting for output
+static uint16_t r4aLEDDdpPort;          // UDP port number
+static uint8_t r4aLEDDdpSequence;       // Previous sequence number
+static WiFiUDP * r4aLEDDdpUDP;          // UDP port, nullptr when link is down
+
+//****************************************
+// Metrics
+//****************************************
+
+static R4A_METRIC r4aLEDDdpMetricDropped("r4a_led_ddp_dropped_total",
+                                         "DDP packets lost, detected by the sequence number",
+                                         R4A_METRIC_COUNTER);
+static R4A_METRIC r4aLEDDdpMetricErrors("r4a_led_ddp_errors_total",
+                                        "DDP packets with an invalid header",
+                                        R4A_METRIC_COUNTER);
+static R4A_METRIC r4aLEDDdpMetricFrames("r4a_led_ddp_frames_total",
+                                        "DDP frames pushed to the LEDs",
+                                        R4A_METRIC_COUNTER);
+static R4A_METRIC r4aLEDDdpMetricPackets("r4a_led_ddp_packets_total",
+                                         "DDP packets received",
+                                         R4A_METRIC_COUNTER);
+
+//*********************************************************************
+// Decode the DDP packet into the LED color array
+// Inputs:
+//   packet: Address of the DDP packet
+//   length: Number of bytes in the packet
+// Outputs:
+//   Returns true if the frame should be pushed to the LEDs
+static bool r4aLEDDdpDecode(const uint8_t * packet, int length)
+{
+    uint8_t bytesPerLED;
+    uint32_t color;
+    const uint8_t * data;
+    uint16_t dataLength;
+    uint8_t flags;
+    int headerLength;
+    int led;
+    uint32_t offset;
+    uint8_t sequence;
+
+    // The DDP data is not used in palette mode
+    if (!r4aLEDColor)
+        return false;
+
+    // Validate the header
+    flags = packet[0];
+    headerLength = R4A_DDP_HEADER_BYTES;
+    if (flags & R4A_DDP_FLAGS_TIMECODE)
+        headerLength += R4A_DDP_TIMECODE_BYTES;
+    if ((length < headerLength)
+        || ((flags & R4A_DDP_FLAGS_VERSION_MASK) != R4A_DDP_FLAGS_VERSION_1)
+        || (flags & (R4A_DDP_FLAGS_QUERY | R4A_DDP_FLAGS_REPLY | R4A_DDP_FLAGS_STORAGE))
+        || (packet[3] != R4A_DDP_ID_DISPLAY))
+    {
+        r4aLEDDdpMetricErrors.add();
+        return false;
+    }
+
+    // Check for lost packets, the sequence number runs 1 - 15
+    sequence = packet[1] & R4A_DDP_SEQUENCE_MASK;
+    if (sequence && r4aLEDDdpSequence)
+        r4aLEDDdpMetricDropped.add((sequence + 15 - r4aLEDDdpSequence - 1) % 15);
+    r4aLEDDdpSequence = sequence;
+
+    // Determine the color layout
+    switch (packet[2])
+    {
+    default:
+        r4aLEDDdpMetricErrors.add();
+        return false;
+
+    case R4A_DDP_TYPE_UNDEFINED:
+    case R4A_DDP_TYPE_RGB_8:
+        bytesPerLED = 3;
+        break;
+
+    case R4A_DDP_TYPE_RGBW_8:
+        bytesPerLED = 4;
+        break;
+    }
+
+    // Locate the data, the offset is in bytes
+    offset = (packet[4] << 24) | (packet[5] << 16) | (packet[6] << 8) | packet[7];
+    dataLength = (packet[8] << 8) | packet[9];
+    if ((headerLength + dataLength) > length)
+    {
+        r4aLEDDdpMetricErrors.add();
+        return false;
+    }
+    data = &packet[headerLength];
+
+    // Copy the colors, ignore the LEDs beyond the end of the string
+    led = offset / bytesPerLED;
+    if (bytesPerLED == 3)
+    {
+        for (; (dataLength >= 3) && (led < r4aLEDs); led++)
+        {
+            color = (((uint32_t)data[0]) << R4A_LED_RED_SHIFT)
+                  | (((uint32_t)data[1]) << R4A_LED_GREEN_SHIFT)
+                  | (((uint32_t)data[2]) << R4A_LED_BLUE_SHIFT);
+            r4aLEDStoreColor(led, color, false);
+            data += 3;
+            dataLength -= 3;
+        }
+    }
+    else
+    {
+        for (; (dataLength >= 4) && (led < r4aLEDs); led++)
+        {
+            color = (((uint32_t)data[0]) << R4A_LED_RED_SHIFT)
+                  | (((uint32_t)data[1]) << R4A_LED_GREEN_SHIFT)
+                  | (((uint32_t)data[2]) << R4A_LED_BLUE_SHIFT)
+                  | (((uint32_t)data[3]) << R4A_LED_WHITE_SHIFT);
+            r4aLEDStoreColor(led, color, true);
+            data += 4;
+            dataLength -= 4;
+        }
+    }
+
+    // Output the frame when the last packet arrives
+    return (flags & R4A_DDP_FLAGS_PUSH) != 0;
+}
+
+//*********************************************************************
+// Start the DDP receiver
+bool r4aLEDDdpBegin(uint16_t port)
+{
+    // Verify that the LEDs are initialized
+    if (!r4aLEDOutput)
+    {
+        r4aLogError(R4A_MODULE_LED, "Call r4aLEDSetup before r4aLEDDdpBegin!");
+        return false;
+    }
+
+    // Allocate the packet buffer
+    if (!r4aLEDDdpBuffer)
+    {
+        r4aLEDDdpBuffer = (uint8_t *)r4aMalloc(R4A_MODULE_LED, R4A_DDP_BUFFER_BYTES);
+        if (!r4aLEDDdpBuffer)
+        {
+            r4aLogError(R4A_MODULE_LED, "Failed to allocate the DDP buffer!");
+            return false;
+        }
+    }
+    r4aLEDDdpPort = port;
+    return true;
+}
+
+//*********************************************************************
+// Receive the DDP packets and output the frames
+void r4aLEDDdpUpdate()
+{
+    int length;
+
+    // Wait for r4aLEDDdpBegin
+    if (!r4aLEDDdpBuffer)
+        return;
+
+    // Release the UDP port when the link goes down
+    if (!r4aLinkIsUp(&r4aLEDDdpLinkGeneration))
+    {
+        if (r4aLEDDdpUDP)
+        {
+            r4aLEDDdpUDP->stop();
+            r4aDelete(r4aLEDDdpUDP);
+            r4aLEDDdpUDP = nullptr;
+        }
+        return;
+    }
+
+    // Open the UDP port when the link comes up
+    if (!r4aLEDDdpUDP)
+    {
+        r4aLEDDdpUDP = r4aNew<WiFiUDP>(R4A_MODULE_LED);
+        if (!r4aLEDDdpUDP)
+            return;
+        if (!r4aLEDDdpUDP->begin(r4aLEDDdpPort))
+        {
+            r4aLogError(R4A_MODULE_LED, "Failed to open DDP UDP port %d!", r4aLEDDdpPort);
+            r4aDelete(r4aLEDDdpUDP);
+            r4aLEDDdpUDP = nullptr;
+            return;
+        }
+        r4aLEDDdpSequence = 0;
+        r4aLogInfo(R4A_MODULE_LED, "DDP receiver listening on UDP port %d", r4aLEDDdpPort);
+    }
+
+    // Decode the packets until a frame is pushed, leave the packets for
+    // the next frame in the UDP buffer until the pushed frame is output
+    while ((!r4aLEDDdpPending) && (r4aLEDDdpUDP->parsePacket() > 0))
+    {
+        length = r4aLEDDdpUDP->read(r4aLEDDdpBuffer, R4A_DDP_BUFFER_BYTES);
+        if (length <= 0)
+            break;
+        r4aLEDDdpMetricPackets.add();
+        if (r4aLEDDdpDecode(r4aLEDDdpBuffer, length))
+        {
+            r4aLEDDdpMetricFrames.add();
+            r4aLEDDdpPending = true;
+        }
+    }
+
+    // Output only the pushed frame, retry while the previous frame is
+    // being sent
+    if (r4aLEDDdpPending && !r4aLEDOutput->busy())
+    {
+        r4aLEDDdpPending = false;
+        r4aLEDColorWritten = true;
+        r4aLEDUpdate(false);
+    }
+}
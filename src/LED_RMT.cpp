@@ -0,0 +1,302 @@
+/**********************************************************************
+  LED_RMT.cpp
+
+  Robots-For-All (R4A)
+  Output the LED frame using the RMT peripheral
+
+  The frame buffer holds only the color bytes, one byte per color.  The
+  RMT driver calls the encoder as the RMT memory empties and the bytes
+  encoder converts the next color bytes into symbols.  The reset symbol
+  is added after the color data.  No SPI controller or DMA buffer is
+  needed.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Constants
+//****************************************
+
+#define R4A_LED_RMT_RESOLUTION_HZ   (10 * 1000 * 1000)  // 0.1 uSec ticks
+#define R4A_LED_RMT_MEMORY_SYMBOLS  64      // RMT memory block size
+#define R4A_LED_RMT_QUEUE_DEPTH     4       // Pending frames
+
+// Timing in 0.1 uSec ticks, between the WS2812 and SK6812RGBW values
+#define R4A_LED_RMT_T0H             3       // 0.3 uSec
+#define R4A_LED_RMT_T0L             9       // 0.9 uSec
+#define R4A_LED_RMT_T1H             7       // 0.7 uSec
+#define R4A_LED_RMT_T1L             6       // 0.6 uSec
+#define R4A_LED_RMT_RESET           800     // 80 uSec
+
+//****************************************
+// Types
+//****************************************
+
+typedef struct _R4A_LED_RMT_ENCODER
+{
+    rmt_encoder_t base;             // Must be first, routines called by RMT
+    rmt_encoder_t * bytesEncoder;   // Color bytes to symbols
+    rmt_encoder_t * copyEncoder;    // Reset symbol
+    int state;                      // 0: color data, 1: reset
+    rmt_symbol_word_t resetSymbol;  // Low level for the reset time
+} R4A_LED_RMT_ENCODER;
+
+//*********************************************************************
+// Delete the LED encoder
+// Inputs:
+//   encoder: Address of the base encoder
+// Outputs:
+//   Returns ESP_OK
+static esp_err_t r4aLEDRmtDelete(rmt_encoder_t * encoder)
+{
+    R4A_LED_RMT_ENCODER * ledEncoder;
+
+    ledEncoder = __containerof(encoder, R4A_LED_RMT_ENCODER, base);
+    if (ledEncoder->bytesEncoder)
+        rmt_del_encoder(ledEncoder->bytesEncoder);
+    if (ledEncoder->copyEncoder)
+        rmt_del_encoder(ledEncoder->copyEncoder);
+    r4aFree(ledEncoder);
+    return ESP_OK;
+}
+
+//*********************************************************************
+// Encode the color bytes and the reset symbol, called by the RMT driver
+// as the RMT memory empties
+// Inputs:
+//   encoder: Address of the base encoder
+//   channel: RMT channel handle
+//   data: Address of the color bytes
+//   length: Number of color bytes
+//   returnState: Address to receive the encoding state
+// Outputs:
+//   Returns the number of symbols encoded
+static size_t r4aLEDRmtEncode(rmt_encoder_t * encoder,
+                              rmt_channel_handle_t channel,
+                              const void * data,
+                              size_t length,
+                              rmt_encode_state_t * returnState)
+{
+    R4A_LED_RMT_ENCODER * ledEncoder;
+    rmt_encode_state_t sessionState;
+    int state;
+    size_t symbols;
+
+    ledEncoder = __containerof(encoder, R4A_LED_RMT_ENCODER, base);
+    sessionState = RMT_ENCODING_RESET;
+    state = RMT_ENCODING_RESET;
+    symbols = 0;
+    do
+    {
+        // Encode the color bytes
+        if (ledEncoder->state == 0)
+        {
+            symbols += ledEncoder->bytesEncoder->encode(ledEncoder->bytesEncoder,
+                                                        channel,
+                                                        data,
+                                                        length,
+                                                        &sessionState);
+            if (sessionState & RMT_ENCODING_COMPLETE)
+                ledEncoder->state = 1;
+            if (sessionState & RMT_ENCODING_MEM_FULL)
+            {
+                state |= RMT_ENCODING_MEM_FULL;
+                break;
+            }
+        }
+
+        // Add the reset symbol
+        symbols += ledEncoder->copyEncoder->encode(ledEncoder->copyEncoder,
+                                                   channel,
+                                                   &ledEncoder->resetSymbol,
+                                                   sizeof(ledEncoder->resetSymbol),
+                                                   &sessionState);
+        if (sessionState & RMT_ENCODING_COMPLETE)
+        {
+            ledEncoder->state = 0;
+            state |= RMT_ENCODING_COMPLETE;
+        }
+        if (sessionState & RMT_ENCODING_MEM_FULL)
+            state |= RMT_ENCODING_MEM_FULL;
+    } while (0);
+    *returnState = (rmt_encode_state_t)state;
+    return symbols;
+}
+
+//*********************************************************************
+// Reset the LED encoder
+// Inputs:
+//   encoder: Address of the base encoder
+// Outputs:
+//   Returns ESP_OK
+static esp_err_t r4aLEDRmtReset(rmt_encoder_t * encoder)
+{
+    R4A_LED_RMT_ENCODER * ledEncoder;
+
+    ledEncoder = __containerof(encoder, R4A_LED_RMT_ENCODER, base);
+    rmt_encoder_reset(ledEncoder->bytesEncoder);
+    rmt_encoder_reset(ledEncoder->copyEncoder);
+    ledEncoder->state = 0;
+    return ESP_OK;
+}
+
+//*********************************************************************
+// Constructor
+R4A_LED_OUTPUT_RMT::R4A_LED_OUTPUT_RMT(uint8_t pin)
+    : R4A_LED_OUTPUT(1, nullptr, 0), _channel{nullptr}, _encoder{nullptr},
+      _pin{pin}
+{
+}
+
+//*********************************************************************
+// Destructor
+R4A_LED_OUTPUT_RMT::~R4A_LED_OUTPUT_RMT()
+{
+    if (_channel)
+    {
+        rmt_tx_wait_all_done(_channel, -1);
+        rmt_disable(_channel);
+        rmt_del_channel(_channel);
+        _channel = nullptr;
+    }
+    if (_encoder)
+    {
+        rmt_del_encoder(_encoder);
+        _encoder = nullptr;
+    }
+}
+
+//*********************************************************************
+// Allocate the frame buffer
+uint8_t * R4A_LED_OUTPUT_RMT::allocateBuffer(int length)
+{
+    // The RMT driver reads the buffer using the CPU, DMA is not needed
+    return (uint8_t *)r4aMalloc(R4A_MODULE_LED, length);
+}
+
+//*********************************************************************
+// Initialize the RMT channel and encoder
+bool R4A_LED_OUTPUT_RMT::begin()
+{
+    rmt_bytes_encoder_config_t bytesConfig;
+    rmt_tx_channel_config_t channelConfig;
+    rmt_copy_encoder_config_t copyConfig;
+    esp_err_t error;
+    R4A_LED_RMT_ENCODER * ledEncoder;
+
+    do
+    {
+        // Allocate the LED encoder
+        ledEncoder = (R4A_LED_RMT_ENCODER *)r4aMalloc(R4A_MODULE_LED, sizeof(*ledEncoder));
+        if (!ledEncoder)
+        {
+            r4aLogError(R4A_MODULE_LED, "Failed to allocate the RMT encoder!");
+            break;
+        }
+        memset(ledEncoder, 0, sizeof(*ledEncoder));
+        ledEncoder->base.encode = r4aLEDRmtEncode;
+        ledEncoder->base.reset = r4aLEDRmtReset;
+        ledEncoder->base.del = r4aLEDRmtDelete;
+        _encoder = &ledEncoder->base;
+
+        // Create the color bytes encoder, most significant bit first
+        memset(&bytesConfig, 0, sizeof(bytesConfig));
+        bytesConfig.bit0.level0 = 1;
+        bytesConfig.bit0.duration0 = R4A_LED_RMT_T0H;
+        bytesConfig.bit0.level1 = 0;
+        bytesConfig.bit0.duration1 = R4A_LED_RMT_T0L;
+        bytesConfig.bit1.level0 = 1;
+        bytesConfig.bit1.duration0 = R4A_LED_RMT_T1H;
+        bytesConfig.bit1.level1 = 0;
+        bytesConfig.bit1.duration1 = R4A_LED_RMT_T1L;
+        bytesConfig.flags.msb_first = 1;
+        error = rmt_new_bytes_encoder(&bytesConfig, &ledEncoder->bytesEncoder);
+        if (error != ESP_OK)
+        {
+            r4aLogError(R4A_MODULE_LED, "Failed to create the RMT bytes encoder, error: %s!",
+                        esp_err_to_name(error));
+            break;
+        }
+
+        // Create the reset encoder
+        memset(&copyConfig, 0, sizeof(copyConfig));
+        error = rmt_new_copy_encoder(&copyConfig, &ledEncoder->copyEncoder);
+        if (error != ESP_OK)
+        {
+            r4aLogError(R4A_MODULE_LED, "Failed to create the RMT copy encoder, error: %s!",
+                        esp_err_to_name(error));
+            break;
+        }
+        ledEncoder->resetSymbol.level0 = 0;
+        ledEncoder->resetSymbol.duration0 = R4A_LED_RMT_RESET / 2;
+        ledEncoder->resetSymbol.level1 = 0;
+        ledEncoder->resetSymbol.duration1 = R4A_LED_RMT_RESET / 2;
+
+        // Create the RMT channel
+        memset(&channelConfig, 0, sizeof(channelConfig));
+        channelConfig.gpio_num = (gpio_num_t)_pin;
+        channelConfig.clk_src = RMT_CLK_SRC_DEFAULT;
+        channelConfig.resolution_hz = R4A_LED_RMT_RESOLUTION_HZ;
+        channelConfig.mem_block_symbols = R4A_LED_RMT_MEMORY_SYMBOLS;
+        channelConfig.trans_queue_depth = R4A_LED_RMT_QUEUE_DEPTH;
+        error = rmt_new_tx_channel(&channelConfig, &_channel);
+        if (error != ESP_OK)
+        {
+            r4aLogError(R4A_MODULE_LED, "Failed to create the RMT channel, error: %s!",
+                        esp_err_to_name(error));
+            _channel = nullptr;
+            break;
+        }
+
+        // Enable the RMT channel
+        error = rmt_enable(_channel);
+        if (error != ESP_OK)
+        {
+            r4aLogError(R4A_MODULE_LED, "Failed to enable the RMT channel, error: %s!",
+                        esp_err_to_name(error));
+            break;
+        }
+        return true;
+    } while (0);
+
+    // Release the resources
+    if (_channel)
+    {
+        rmt_del_channel(_channel);
+        _channel = nullptr;
+    }
+    if (_encoder)
+    {
+        rmt_del_encoder(_encoder);
+        _encoder = nullptr;
+    }
+    return false;
+}
+
+//*********************************************************************
+// Determine if the previous frame is still being output
+bool R4A_LED_OUTPUT_RMT::busy()
+{
+    return _channel && (rmt_tx_wait_all_done(_channel, 0) != ESP_OK);
+}
+
+//*********************************************************************
+// Free the frame buffer
+void R4A_LED_OUTPUT_RMT::freeBuffer(uint8_t * buffer)
+{
+    r4aFree(buffer);
+}
+
+//*********************************************************************
+// Start sending the frame to the LEDs
+void R4A_LED_OUTPUT_RMT::write(const uint8_t * buffer, int length)
+{
+    rmt_transmit_config_t config;
+    esp_err_t error;
+
+    memset(&config, 0, sizeof(config));
+    error = rmt_transmit(_channel, _encoder, buffer, length, &config);
+    if (error != ESP_OK)
+        r4aLogError(R4A_MODULE_LED, "Failed to transmit the LED frame, error: %s!",
+                    esp_err_to_name(error));
+}
@@ -0,0 +1,135 @@
+/**********************************************************************
+  LED_SPI.cpp
+
+  Robots-For-All (R4A)
+  Output the LED frame as a SPI bit stream
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Constants
+//****************************************
+
+#define R4A_LED_RESET       (5 * 6) // Zero bytes to cause reset
+
+extern const uint8_t r4aLED3BitTable[];      // Color intensity bits to 3 bytes
+extern const uint8_t r4aLEDIntensityTable[]; // Color intensity bits to 5 bytes
+
+//****************************************
+// Types
+//****************************************
+
+// SPI timing for an LED encoding
+typedef struct _R4A_LED_SPI_TIMING
+{
+    uint8_t bytesPerColor;      // SPI bytes for each color byte
+    const uint8_t * table;      // Color intensity to SPI bytes
+    uint32_t clockHz;           // Default SPI clock frequency
+    uint32_t minClockHz;        // Lowest clock within the LED limits
+    uint32_t maxClockHz;        // Highest clock within the LED limits
+} R4A_LED_SPI_TIMING;
+
+//****************************************
+// Locals
+//****************************************
+
+static R4A_SPI_TRANSACTION r4aLEDSpiTransaction;
+
+// Indexed by R4A_LED_ENCODING
+static const R4A_LED_SPI_TIMING r4aLEDSpiTiming[R4A_LED_ENCODING_MAX] =
+{
+    {5, r4aLEDIntensityTable, R4A_LED_5_BITS_CLOCK_HZ,
+     R4A_LED_5_BITS_CLOCK_MIN_HZ, R4A_LED_5_BITS_CLOCK_MAX_HZ},
+    {3, r4aLED3BitTable, R4A_LED_3_BITS_CLOCK_HZ,
+     R4A_LED_3_BITS_CLOCK_MIN_HZ, R4A_LED_3_BITS_CLOCK_MAX_HZ},
+};
+
+//*********************************************************************
+// Get the SPI timing for an encoding
+// Inputs:
+//   encoding: R4A_LED_ENCODING value
+// Outputs:
+//   Returns the address of the timing, the 5 bit timing for an unknown
+//   encoding
+static const R4A_LED_SPI_TIMING * r4aLEDSpiTimingGet(uint8_t encoding)
+{
+    if (encoding >= R4A_LED_ENCODING_MAX)
+        encoding = R4A_LED_ENCODING_5_BITS;
+    return &r4aLEDSpiTiming[encoding];
+}
+
+//*********************************************************************
+// Constructor
+R4A_LED_OUTPUT_SPI::R4A_LED_OUTPUT_SPI(uint8_t spiNumber,
+                                       uint8_t pinMOSI,
+                                       uint32_t clockHz,
+                                       uint8_t encoding)
+    : R4A_LED_OUTPUT(r4aLEDSpiTimingGet(encoding)->bytesPerColor,
+                     r4aLEDSpiTimingGet(encoding)->table,
+                     R4A_LED_RESET),
+      _clockHz{clockHz ? clockHz : r4aLEDSpiTimingGet(encoding)->clockHz},
+      _encoding{encoding}, _pinMOSI{pinMOSI}, _spiNumber{spiNumber}
+{
+}
+
+//*********************************************************************
+// Allocate the frame buffer
+uint8_t * R4A_LED_OUTPUT_SPI::allocateBuffer(int length)
+{
+    // Determine if the SPI controller object was allocated
+    if (!r4aSpi)
+    {
+        r4aLogError(R4A_MODULE_LED, "Failed to allocate r4aSpi!");
+        return nullptr;
+    }
+
+    // This buffer needs to be in static RAM to allow DMA access
+    return r4aSpi->allocateDmaBuffer(length);
+}
+
+//*********************************************************************
+// Initialize the SPI controller
+bool R4A_LED_OUTPUT_SPI::begin()
+{
+    const R4A_LED_SPI_TIMING * timing;
+
+    // Verify that the clock keeps the LED timing within the limits
+    timing = r4aLEDSpiTimingGet(_encoding);
+    if ((_clockHz < timing->minClockHz) || (_clockHz > timing->maxClockHz))
+    {
+        r4aLogError(R4A_MODULE_LED,
+                    "clockHz %ld is outside the %ld - %ld range of the encoding!",
+                    _clockHz, timing->minClockHz, timing->maxClockHz);
+        return false;
+    }
+    return r4aSpi->begin(_spiNumber, _pinMOSI, _clockHz);
+}
+
+//*********************************************************************
+// Determine if the previous frame is still being output
+bool R4A_LED_OUTPUT_SPI::busy()
+{
+    if (r4aLEDSpiTransaction.busy)
+        r4aSpi->service();
+    return r4aLEDSpiTransaction.busy;
+}
+
+//*********************************************************************
+// Free the frame buffer
+void R4A_LED_OUTPUT_SPI::freeBuffer(uint8_t * buffer)
+{
+    free(buffer);
+}
+
+//*********************************************************************
+// Start sending the frame to the LEDs
+void R4A_LED_OUTPUT_SPI::write(const uint8_t * buffer, int length)
+{
+    r4aLEDSpiTransaction.txBuffer = buffer;
+    r4aLEDSpiTransaction.rxBuffer = nullptr;
+    r4aLEDSpiTransaction.length = length;
+    r4aLEDSpiTransaction.priority = R4A_SPI_PRIORITY_LOW;
+    r4aSpi->queue(&r4aLEDSpiTransaction);
+    r4aSpi->service();
+}
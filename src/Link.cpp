@@ -0,0 +1,134 @@
+/**********************************************************************
+  Link.cpp
+
+  Robots-For-All (R4A)
+  Network link state support
+
+  The link state is maintained from the network events, removing the
+  need for each service to poll the WiFi layer.  The services read the
+  link state with a single atomic load and use the generation number to
+  detect a link that went down and came back up between two updates.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Constants
+//****************************************
+
+#define R4A_LINK_STA            1   // WiFi station has an IP address
+#define R4A_LINK_ETH            2   // Ethernet has an IP address
+#define R4A_LINK_PPP            4   // PPP has an IP address
+
+//****************************************
+// Globals
+//****************************************
+
+volatile uint32_t r4aLinkGenerationCount;
+volatile uint8_t r4aLinkInterfaces;
+
+//****************************************
+// Locals
+//****************************************
+
+static network_event_handle_t r4aLinkEventHandle;
+static portMUX_TYPE r4aLinkMux = portMUX_INITIALIZER_UNLOCKED;
+
+//*********************************************************************
+// Update the link state
+// Inputs:
+//   setBits: Interface bits to set
+//   clearBits: Interface bits to clear
+static void r4aLinkUpdate(uint8_t setBits, uint8_t clearBits)
+{
+    uint32_t generation;
+    bool linkUp;
+    uint8_t newInterfaces;
+    uint8_t oldInterfaces;
+
+    // Update the interface bits, the generation number is odd while the
+    // link is up
+    portENTER_CRITICAL(&r4aLinkMux);
+    oldInterfaces = r4aLinkInterfaces;
+    newInterfaces = (oldInterfaces | setBits) & ~clearBits;
+    r4aLinkInterfaces = newInterfaces;
+    linkUp = (newInterfaces != 0);
+    generation = r4aLinkGenerationCount;
+    if (linkUp != (oldInterfaces != 0))
+    {
+        generation += 1;
+        __atomic_store_n(&r4aLinkGenerationCount, generation, __ATOMIC_RELEASE);
+    }
+    portEXIT_CRITICAL(&r4aLinkMux);
+
+    // Done if the link state did not change
+    if (linkUp == (oldInterfaces != 0))
+        return;
+
+    // Display the link change
+    r4aLogInfo(R4A_MODULE_LINK, "Link %s, generation %ld",
+               linkUp ? "up" : "down", generation);
+}
+
+//*********************************************************************
+// Process the network events
+// Inputs:
+//   event: Address of the network event
+static void r4aLinkEvent(arduino_event_t * event)
+{
+    switch (event->event_id)
+    {
+    default:
+        break;
+
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+        r4aLinkUpdate(R4A_LINK_STA, 0);
+        break;
+
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+    case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+    case ARDUINO_EVENT_WIFI_STA_STOP:
+        r4aLinkUpdate(0, R4A_LINK_STA);
+        break;
+
+    case ARDUINO_EVENT_ETH_GOT_IP:
+        r4aLinkUpdate(R4A_LINK_ETH, 0);
+        break;
+
+    case ARDUINO_EVENT_ETH_DISCONNECTED:
+    case ARDUINO_EVENT_ETH_LOST_IP:
+    case ARDUINO_EVENT_ETH_STOP:
+        r4aLinkUpdate(0, R4A_LINK_ETH);
+        break;
+
+    case ARDUINO_EVENT_PPP_GOT_IP:
+        r4aLinkUpdate(R4A_LINK_PPP, 0);
+        break;
+
+    case ARDUINO_EVENT_PPP_DISCONNECTED:
+    case ARDUINO_EVENT_PPP_LOST_IP:
+        r4aLinkUpdate(0, R4A_LINK_PPP);
+        break;
+    }
+}
+
+//*********************************************************************
+// Start monitoring the network link state
+bool r4aLinkBegin()
+{
+    // Subscribe to the network events once
+    if (!r4aLinkEventHandle)
+    {
+        r4aLinkEventHandle = Network.onEvent(r4aLinkEvent);
+        if (!r4aLinkEventHandle)
+        {
+            r4aLogError(R4A_MODULE_LINK, "Failed to subscribe to network events!");
+            return false;
+        }
+
+        // Account for a connection made before the subscription
+        if (WiFi.status() == WL_CONNECTED)
+            r4aLinkUpdate(R4A_LINK_STA, 0);
+    }
+    return true;
+}
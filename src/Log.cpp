@@ -0,0 +1,387 @@
+/**********************************************************************
+  Log.cpp
+
+  Robots-For-All (R4A)
+  Lock-free logging support
+
+  Log records are saved in binary form (format address plus argument
+  values) into a ring buffer.  Formatting and output are performed
+  later by a low priority drain task or by calls to r4aLogDrain.  This
+  keeps the cost of logging small on the calling core and removes the
+  UART delays from the caller.  Until r4aLogSetup starts the drain task
+  the records are formatted and output immediately, this prevents the
+  loss of the messages when the drain task is not used.
+
+  The ring is a bounded multi-producer multi-consumer queue.  Each
+  record contains a sequence number that indicates when the record is
+  free and when it contains data:
+
+      sequence == position          --> Free, may be written
+      sequence == position + 1      --> Contains data, may be read
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Constants
+//****************************************
+
+#define R4A_LOG_DRAIN_DELAY_MSEC    10  // Drain task delay when idle
+#define R4A_LOG_LINE_LENGTH         160 // Maximum output line length
+#define R4A_LOG_MASK                (R4A_LOG_RECORDS - 1)
+#define R4A_LOG_TASK_STACK_SIZE     4096
+
+static_assert((R4A_LOG_RECORDS & R4A_LOG_MASK) == 0,
+              "R4A_LOG_RECORDS must be a power of 2");
+
+const char * const r4aLogLevelName[R4A_LOG_LEVEL_MAX] =
+{
+    "NONE",     // R4A_LOG_LEVEL_NONE
+    "ERROR",    // R4A_LOG_LEVEL_ERROR
+    "WARNING",  // R4A_LOG_LEVEL_WARNING
+    "INFO",     // R4A_LOG_LEVEL_INFO
+    "DEBUG",    // R4A_LOG_LEVEL_DEBUG
+};
+
+//****************************************
+// Types
+//****************************************
+
+typedef struct _R4A_LOG_ENTRY
+{
+    // The sequence value is stored relative to the record index, this
+    // allows the zero initialized ring to be used before r4aLogSetup
+    volatile uint32_t sequence;
+    const char * format;        // Address of the printf format string
+    uint32_t usec;              // Microseconds since boot
+    uint8_t module;             // Module generating the record
+    uint8_t level;              // Log level of the record
+    uint8_t argCount;           // Number of arguments
+    uint8_t core;               // CPU core generating the record
+    R4A_LOG_ARG args[R4A_LOG_MAX_ARGS]; // Argument values
+} R4A_LOG_ENTRY;
+
+//****************************************
+// Globals
+//****************************************
+
+volatile uint8_t r4aLogLevel[R4A_MODULE_MAX] =
+{
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_APPLICATION
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_BLUETOOTH
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_LED
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_MENU
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_NTP
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_NTRIP_CLIENT
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_ROBOT
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_SERIAL
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_TELNET
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_CAPTURE
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_LOG
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_METRICS
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_LINK
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_WIFI
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_CONFIG
+    R4A_LOG_LEVEL_INFO, // R4A_MODULE_SERVICE
+};
+Print * volatile r4aLogOutput = &Serial;
+volatile uint32_t r4aLogDropped;
+volatile uint32_t r4aLogWritten;
+
+//****************************************
+// Locals
+//****************************************
+
+static R4A_LOG_ENTRY r4aLogRing[R4A_LOG_RECORDS];
+static volatile uint32_t r4aLogHead;    // Next position to write
+static volatile uint32_t r4aLogTail;    // Next position to read
+static TaskHandle_t r4aLogTaskHandle;
+
+//*********************************************************************
+// Remove a record from the ring
+// Inputs:
+//   record: Buffer to receive the record
+// Outputs:
+//   Returns true when a record was returned and false when the ring is
+//   empty
+static bool r4aLogRemove(R4A_LOG_ENTRY * record)
+{
+    R4A_LOG_ENTRY * entry;
+    int32_t difference;
+    uint32_t index;
+    uint32_t position;
+
+    position = __atomic_load_n(&r4aLogTail, __ATOMIC_RELAXED);
+    while (true)
+    {
+        // Determine if the record contains data
+        index = position & R4A_LOG_MASK;
+        entry = &r4aLogRing[index];
+        difference = (int32_t)(__atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE)
+                               + index - (position + 1));
+        if (difference == 0)
+        {
+            // Attempt to take ownership of this record
+            if (__atomic_compare_exchange_n(&r4aLogTail, &position, position + 1,
+                                            true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+
+        // Ring is empty
+        else if (difference < 0)
+            return false;
+
+        // Another consumer removed the record, try the next one
+        else
+            position = __atomic_load_n(&r4aLogTail, __ATOMIC_RELAXED);
+    }
+
+    // Copy the record and free the entry for the producers
+    *record = *entry;
+    __atomic_store_n(&entry->sequence,
+                     position + R4A_LOG_RECORDS - index,
+                     __ATOMIC_RELEASE);
+    return true;
+}
+
+//*********************************************************************
+// Display the log status
+void r4aLogDisplayStatus(Print * display)
+{
+    uint32_t pending;
+
+    pending = __atomic_load_n(&r4aLogHead, __ATOMIC_RELAXED)
+            - __atomic_load_n(&r4aLogTail, __ATOMIC_RELAXED);
+    display->printf("Log: %ld records written, %ld dropped, %ld pending\r\n",
+                    r4aLogWritten, r4aLogDropped, pending);
+    display->printf("Drain task: %s\r\n", r4aLogTaskHandle ? "Running" : "Not running");
+    for (int module = 0; module < R4A_MODULE_MAX; module++)
+        display->printf("%2d: %-14s %d (%s)\r\n",
+                        module,
+                        r4aModuleName[module],
+                        r4aLogLevel[module],
+                        r4aLogLevelName[r4aLogLevel[module] % R4A_LOG_LEVEL_MAX]);
+}
+
+//*********************************************************************
+// Format and output a log record
+// Inputs:
+//   display: Device used for output
+//   record: Address of the log record
+static void r4aLogOutputRecord(Print * display, R4A_LOG_ENTRY * record)
+{
+    int length;
+    char line[R4A_LOG_LINE_LENGTH];
+
+    // Build the prefix
+    length = snprintf(line, sizeof(line), "%ld.%06ld %s %s: ",
+                      record->usec / 1000000,
+                      record->usec % 1000000,
+                      r4aModuleName[record->module % R4A_MODULE_MAX],
+                      r4aLogLevelName[record->level % R4A_LOG_LEVEL_MAX]);
+
+    // Format the message, all arguments are R4A_LOG_ARG values so the
+    // unused arguments are ignored by snprintf
+    for (int index = record->argCount; index < R4A_LOG_MAX_ARGS; index++)
+        record->args[index] = 0;
+    length += snprintf(&line[length], sizeof(line) - length - 2,
+                       record->format,
+                       record->args[0],
+                       record->args[1],
+                       record->args[2],
+                       record->args[3],
+                       record->args[4]);
+    if (length > (int)(sizeof(line) - 3))
+        length = sizeof(line) - 3;
+
+    // Terminate the line
+    line[length++] = '\r';
+    line[length++] = '\n';
+
+    // Output the line
+    if (display)
+        display->write((const uint8_t *)line, length);
+}
+
+//*********************************************************************
+// Display the log records
+uint32_t r4aLogDrain(Print * display, uint32_t maxRecords)
+{
+    R4A_LOG_ENTRY record;
+    uint32_t records;
+
+    for (records = 0; records < maxRecords; records++)
+    {
+        // Get the next record
+        if (!r4aLogRemove(&record))
+            break;
+
+        // Output the record
+        r4aLogOutputRecord(display, &record);
+    }
+    return records;
+}
+
+//*********************************************************************
+// Log drain task
+// Inputs:
+//   parameter: Not used
+static void r4aLogDrainTask(void * parameter)
+{
+    while (true)
+    {
+        // Delay when there is no more data to display
+        if (r4aLogDrain(r4aLogOutput, 16) < 16)
+            vTaskDelay(R4A_LOG_DRAIN_DELAY_MSEC / portTICK_PERIOD_MS);
+    }
+}
+
+//*********************************************************************
+// Display the log records
+void r4aLogMenuDrain(const R4A_MENU_ENTRY * menuEntry,
+                     const char * command,
+                     Print * display)
+{
+    if (!r4aLogDrain(display))
+        display->println("Log is empty");
+}
+
+//*********************************************************************
+// Display the log status
+void r4aLogMenuDisplay(const R4A_MENU_ENTRY * menuEntry,
+                       const char * command,
+                       Print * display)
+{
+    r4aLogDisplayStatus(display);
+}
+
+//*********************************************************************
+// Set the log level for a module
+void r4aLogMenuLevel(const R4A_MENU_ENTRY * menuEntry,
+                     const char * command,
+                     Print * display)
+{
+    size_t length;
+    int level;
+    int module;
+    const char * parameters;
+    int values;
+
+    // Get the module and level
+    parameters = r4aMenuGetParameters(menuEntry, command, &length);
+    values = sscanf(parameters, "%d %d", &module, &level);
+
+    // Validate the values
+    if ((values != 2) || (module < 0) || (module >= R4A_MODULE_MAX))
+        display->printf("ERROR: Please specify a module number in the range of (0 - %d)\r\n",
+                        R4A_MODULE_MAX - 1);
+    else if ((level < 0) || (level >= R4A_LOG_LEVEL_MAX))
+        display->printf("ERROR: Please specify a log level in the range of (0 - %d)\r\n",
+                        R4A_LOG_LEVEL_MAX - 1);
+    else
+        r4aLogLevel[module] = level;
+}
+
+//*********************************************************************
+// Save a log record in the ring
+bool r4aLogRecord(uint8_t module,
+                  uint8_t level,
+                  const char * format,
+                  const R4A_LOG_ARG * args,
+                  uint8_t argCount)
+{
+    R4A_LOG_ENTRY * entry;
+    int32_t difference;
+    uint32_t index;
+    uint32_t position;
+    R4A_LOG_ENTRY record;
+
+    // Validate the parameters
+    if (module >= R4A_MODULE_MAX)
+        module = R4A_MODULE_APPLICATION;
+    if (argCount > R4A_LOG_MAX_ARGS)
+        argCount = R4A_LOG_MAX_ARGS;
+
+    // Output the record immediately until the drain task is running
+    if (!r4aLogTaskHandle)
+    {
+        record.format = format;
+        record.usec = micros();
+        record.module = module;
+        record.level = level;
+        record.argCount = argCount;
+        record.core = xPortGetCoreID();
+        for (index = 0; index < argCount; index++)
+            record.args[index] = args[index];
+        r4aLogOutputRecord(r4aLogOutput, &record);
+        __atomic_fetch_add(&r4aLogWritten, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+
+    // Locate a free record
+    position = __atomic_load_n(&r4aLogHead, __ATOMIC_RELAXED);
+    while (true)
+    {
+        // Determine if the record is free
+        index = position & R4A_LOG_MASK;
+        entry = &r4aLogRing[index];
+        difference = (int32_t)(__atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE)
+                               + index - position);
+        if (difference == 0)
+        {
+            // Attempt to take ownership of this record
+            if (__atomic_compare_exchange_n(&r4aLogHead, &position, position + 1,
+                                            true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+
+        // The ring is full, drop this record
+        else if (difference < 0)
+        {
+            __atomic_fetch_add(&r4aLogDropped, 1, __ATOMIC_RELAXED);
+            return false;
+        }
+
+        // Another producer took the record, try the next one
+        else
+            position = __atomic_load_n(&r4aLogHead, __ATOMIC_RELAXED);
+    }
+
+    // Fill in the record
+    entry->format = format;
+    entry->usec = micros();
+    entry->module = module;
+    entry->level = level;
+    entry->argCount = argCount;
+    entry->core = xPortGetCoreID();
+    for (index = 0; index < argCount; index++)
+        entry->args[index] = args[index];
+
+    // Pass the record to the consumers
+    __atomic_store_n(&entry->sequence,
+                     position + 1 - (position & R4A_LOG_MASK),
+                     __ATOMIC_RELEASE);
+    __atomic_fetch_add(&r4aLogWritten, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+//*********************************************************************
+// Start the log drain task
+bool r4aLogSetup(Print * output, BaseType_t core, UBaseType_t priority)
+{
+    // Set the output device
+    r4aLogOutput = output;
+
+    // Start the drain task
+    if (!r4aLogTaskHandle)
+        xTaskCreatePinnedToCore(r4aLogDrainTask,
+                                "r4aLogDrain",
+                                R4A_LOG_TASK_STACK_SIZE,
+                                nullptr,
+                                priority,
+                                &r4aLogTaskHandle,
+                                core);
+    if (r4aLogTaskHandle)
+        r4aMemoryRegisterTask(R4A_MODULE_LOG, r4aLogTaskHandle);
+    return (r4aLogTaskHandle != nullptr);
+}
@@ -0,0 +1,21 @@
+/**********************************************************************
+  Log_Menu.cpp
+
+  Robots-For-All (R4A)
+  Log menu support
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Log menu
+//****************************************
+
+const R4A_MENU_ENTRY r4aLogMenuTable[] =
+{
+    // Command  menuRoutine         menuParam           HelpRoutine         align   HelpText
+    {"d",       r4aLogMenuDisplay,  0,                  nullptr,            0,      "Display the log status"},                  // 0
+    {"l",       r4aLogMenuLevel,    (intptr_t)"mm l",   r4aMenuHelpSuffix,  4,      "Set module mm log level l (0 - 4)"},      // 1
+    {"r",       r4aLogMenuDrain,    0,                  nullptr,            0,      "Display the log records"},                 // 2
+    {"x",       nullptr,            R4A_MENU_MAIN,      nullptr,            0,      "Return to the main menu"},                 // 3
+};                                                                                                                              // 4
@@ -0,0 +1,239 @@
+/**********************************************************************
+  Memory.cpp
+
+  Robots-For-All (R4A)
+  Heap and stack usage accounting
+
+  Each buffer allocated by r4aMalloc is preceded by a small header
+  holding the length and the module number.  The header allows r4aFree
+  to charge the release back to the module that made the allocation.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Types
+//****************************************
+
+// Header placed in front of each allocated buffer, a multiple of 8 bytes
+// to maintain the heap alignment
+typedef struct _R4A_MEMORY_HEADER
+{
+    uint32_t length;        // Number of bytes requested by the caller
+    uint32_t module;        // Module that allocated the buffer
+} R4A_MEMORY_HEADER;
+
+typedef struct _R4A_MEMORY_TASK_ENTRY
+{
+    TaskHandle_t task;      // Task handle, nullptr when the entry is free
+    uint8_t module;         // Module owning the task
+} R4A_MEMORY_TASK_ENTRY;
+
+//****************************************
+// Locals
+//****************************************
+
+static R4A_MEMORY_USAGE r4aMemoryUsage[R4A_MODULE_MAX];
+static R4A_MEMORY_TASK_ENTRY r4aMemoryTasks[R4A_MEMORY_MAX_TASKS];
+static portMUX_TYPE r4aMemoryMux = portMUX_INITIALIZER_UNLOCKED;
+
+//*********************************************************************
+// Free a buffer allocated by r4aMalloc
+void r4aFree(void * buffer)
+{
+    R4A_MEMORY_HEADER * header;
+    R4A_MEMORY_USAGE * usage;
+
+    if (buffer)
+    {
+        // Locate the header
+        header = ((R4A_MEMORY_HEADER *)buffer) - 1;
+        usage = &r4aMemoryUsage[header->module];
+
+        // Account for the release
+        __atomic_fetch_sub(&usage->currentBytes, header->length, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&usage->frees, 1, __ATOMIC_RELAXED);
+
+        // Release the buffer
+        free(header);
+    }
+}
+
+//*********************************************************************
+// Allocate a buffer from the heap and account for it by module
+void * r4aMalloc(uint8_t module, size_t length)
+{
+    uint32_t current;
+    R4A_MEMORY_HEADER * header;
+    uint32_t peak;
+    R4A_MEMORY_USAGE * usage;
+
+    // Validate the module
+    if (module >= R4A_MODULE_MAX)
+        module = R4A_MODULE_APPLICATION;
+    usage = &r4aMemoryUsage[module];
+
+    // Allocate the buffer
+    header = (R4A_MEMORY_HEADER *)malloc(sizeof(*header) + length);
+    if (!header)
+    {
+        __atomic_fetch_add(&usage->failures, 1, __ATOMIC_RELAXED);
+        return nullptr;
+    }
+    header->length = length;
+    header->module = module;
+
+    // Account for the allocation
+    __atomic_fetch_add(&usage->allocations, 1, __ATOMIC_RELAXED);
+    current = __atomic_add_fetch(&usage->currentBytes, length, __ATOMIC_RELAXED);
+
+    // Update the peak value
+    peak = __atomic_load_n(&usage->peakBytes, __ATOMIC_RELAXED);
+    while ((current > peak)
+        && (!__atomic_compare_exchange_n(&usage->peakBytes, &peak, current,
+                                         true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)));
+    return (void *)(header + 1);
+}
+
+//*********************************************************************
+// Display the memory usage
+void r4aMemoryDisplay(Print * display)
+{
+    int index;
+    R4A_MEMORY_REPORT report;
+    R4A_MEMORY_USAGE * usage;
+
+    r4aMemoryGetReport(&report);
+
+    // Display the heap usage
+    display->printf("Heap: %ld bytes free, %ld minimum free, %ld largest block\r\n",
+                    report.heapFree,
+                    report.heapMinimumFree,
+                    report.heapLargestBlock);
+
+    // Display the module usage
+    display->println("    Module           Current       Peak     Allocs      Frees   Failures");
+    for (index = 0; index < R4A_MODULE_MAX; index++)
+    {
+        usage = &report.module[index];
+        if (usage->allocations || usage->failures)
+            display->printf("    %-14s %9ld  %9ld  %9ld  %9ld  %9ld\r\n",
+                            r4aModuleName[index],
+                            usage->currentBytes,
+                            usage->peakBytes,
+                            usage->allocations,
+                            usage->frees,
+                            usage->failures);
+    }
+
+    // Display the stack usage
+    display->println("Stack:");
+    display->println("    Task             Module         Free bytes");
+    for (index = 0; index < report.taskCount; index++)
+        display->printf("    %-16s %-14s %9ld\r\n",
+                        report.task[index].name,
+                        r4aModuleName[report.task[index].module],
+                        report.task[index].stackFree);
+}
+
+//*********************************************************************
+// Get the memory usage
+void r4aMemoryGetReport(R4A_MEMORY_REPORT * report)
+{
+    int index;
+    R4A_MEMORY_TASK_ENTRY tasks[R4A_MEMORY_MAX_TASKS];
+
+    // Get the heap usage
+    report->heapFree = ESP.getFreeHeap();
+    report->heapMinimumFree = ESP.getMinFreeHeap();
+    report->heapLargestBlock = ESP.getMaxAllocHeap();
+
+    // Get the module usage
+    for (index = 0; index < R4A_MODULE_MAX; index++)
+    {
+        report->module[index].currentBytes = __atomic_load_n(&r4aMemoryUsage[index].currentBytes, __ATOMIC_RELAXED);
+        report->module[index].peakBytes = __atomic_load_n(&r4aMemoryUsage[index].peakBytes, __ATOMIC_RELAXED);
+        report->module[index].allocations = __atomic_load_n(&r4aMemoryUsage[index].allocations, __ATOMIC_RELAXED);
+        report->module[index].frees = __atomic_load_n(&r4aMemoryUsage[index].frees, __ATOMIC_RELAXED);
+        report->module[index].failures = __atomic_load_n(&r4aMemoryUsage[index].failures, __ATOMIC_RELAXED);
+    }
+
+    // Get a copy of the task list
+    portENTER_CRITICAL(&r4aMemoryMux);
+    memcpy(tasks, r4aMemoryTasks, sizeof(tasks));
+    portEXIT_CRITICAL(&r4aMemoryMux);
+
+    // Get the stack usage, the ESP32 reports the high water mark in bytes
+    report->taskCount = 0;
+    for (index = 0; index < R4A_MEMORY_MAX_TASKS; index++)
+    {
+        if (tasks[index].task)
+        {
+            report->task[report->taskCount].name = pcTaskGetName(tasks[index].task);
+            report->task[report->taskCount].module = tasks[index].module;
+            report->task[report->taskCount].stackFree = uxTaskGetStackHighWaterMark(tasks[index].task);
+            report->taskCount += 1;
+        }
+    }
+}
+
+//*********************************************************************
+// Register a task for stack usage reporting
+bool r4aMemoryRegisterTask(uint8_t module, TaskHandle_t task)
+{
+    int index;
+    bool registered;
+
+    // Validate the parameters
+    if (!task)
+        task = xTaskGetCurrentTaskHandle();
+    if (module >= R4A_MODULE_MAX)
+        module = R4A_MODULE_APPLICATION;
+
+    // Locate the existing entry or a free entry
+    registered = false;
+    portENTER_CRITICAL(&r4aMemoryMux);
+    for (index = 0; index < R4A_MEMORY_MAX_TASKS; index++)
+        if (r4aMemoryTasks[index].task == task)
+            break;
+    if (index >= R4A_MEMORY_MAX_TASKS)
+        for (index = 0; index < R4A_MEMORY_MAX_TASKS; index++)
+            if (!r4aMemoryTasks[index].task)
+                break;
+
+    // Save the task
+    if (index < R4A_MEMORY_MAX_TASKS)
+    {
+        r4aMemoryTasks[index].task = task;
+        r4aMemoryTasks[index].module = module;
+        registered = true;
+    }
+    portEXIT_CRITICAL(&r4aMemoryMux);
+    return registered;
+}
+
+//*********************************************************************
+// Remove a task from stack usage reporting
+void r4aMemoryRemoveTask(TaskHandle_t task)
+{
+    int index;
+
+    if (!task)
+        task = xTaskGetCurrentTaskHandle();
+    portENTER_CRITICAL(&r4aMemoryMux);
+    for (index = 0; index < R4A_MEMORY_MAX_TASKS; index++)
+    {
+        if (r4aMemoryTasks[index].task == task)
+            r4aMemoryTasks[index].task = nullptr;
+    }
+    portEXIT_CRITICAL(&r4aMemoryMux);
+}
+
+//*********************************************************************
+// Display the memory usage
+void r4aMemoryMenuDisplay(const R4A_MENU_ENTRY * menuEntry,
+                          const char * command,
+                          Print * display)
+{
+    r4aMemoryDisplay(display);
+}
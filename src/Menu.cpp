@@ -7,6 +7,49 @@
 
 #include "R4A_Robot.h"
 
+//****************************************
+// Types
+//****************************************
+
+typedef struct _R4A_MENU_PAGER_STATE
+{
+    intptr_t position;      // Position in the list
+    uint8_t items;          // Items displayed on this page
+    bool waiting;           // Waiting at the --More-- prompt
+} R4A_MENU_PAGER_STATE;
+
+//****************************************
+// Globals
+//****************************************
+
+uint8_t r4aMenuPagerLines = R4A_MENU_PAGER_LINES;
+
+//*********************************************************************
+// Constructor
+// Inputs:
+//   menuTable: Address of table containing the menu descriptions, the
+//              main menu must be the first entry in the table.
+//   menuEntries: Number of entries in the menu table
+//   blankLineBeforePreMenu: Display a blank line before the preMenu
+//   blankLineBeforeMenuHeader: Display a blank line before the menu header
+//   blankLineAfterMenuHeader: Display a blank line after the menu header
+//   alignCommands: Align the commands
+//   blankLineAfterMenu: Display a blank line after the menu
+R4A_MENU_COMPILED::R4A_MENU_COMPILED(const R4A_MENU_TABLE * menuTable,
+                                     int menuEntries,
+                                     bool blankLineBeforePreMenu,
+                                     bool blankLineBeforeMenuHeader,
+                                     bool blankLineAfterMenuHeader,
+                                     bool alignCommands,
+                                     bool blankLineAfterMenu)
+    : _menuTable{menuTable}, _menuTableEntries{menuEntries},
+      _blankLineBeforePreMenu{blankLineBeforePreMenu},
+      _blankLineBeforeMenuHeader{blankLineBeforeMenuHeader},
+      _blankLineAfterMenuHeader{blankLineAfterMenuHeader},
+      _alignCommands{alignCommands}, _blankLineAfterMenu{blankLineAfterMenu}
+{
+}
+
 //*********************************************************************
 // Constructor
 // Inputs:
@@ -25,70 +68,88 @@ R4A_MENU::R4A_MENU(const R4A_MENU_TABLE * menuTable,
                    bool blankLineAfterMenuHeader,
                    bool alignCommands,
                    bool blankLineAfterMenu)
-    : _debug{false}, _menu{nullptr}, _menuTable{menuTable},
-      _menuTableEntries{menuEntries},
-      _blankLineBeforePreMenu{blankLineBeforePreMenu},
-      _blankLineBeforeMenuHeader{blankLineBeforeMenuHeader},
-      _blankLineAfterMenuHeader{blankLineAfterMenuHeader},
-      _alignCommands{alignCommands}, _blankLineAfterMenu{blankLineAfterMenu}
+    : R4A_MENU_COMPILED(menuTable, menuEntries, blankLineBeforePreMenu,
+                        blankLineBeforeMenuHeader, blankLineAfterMenuHeader,
+                        alignCommands, blankLineAfterMenu),
+      _debug{false}, _menu{}
+{
+}
+
+//*********************************************************************
+// Cancel the long command
+void R4A_MENU_COMPILED::cancel(R4A_MENU_CURSOR * cursor, Print * display) const
 {
+    if (cursor->asyncEntry)
+    {
+        cursor->asyncEntry->asyncRoutine(cursor->asyncEntry,
+                                         nullptr,
+                                         nullptr,
+                                         &cursor->asyncState,
+                                         true);
+        cursor->asyncEntry = nullptr;
+        cursor->asyncState = 0;
+        if (display)
+            display->println("\r\nCommand cancelled");
+    }
 }
 
 //*********************************************************************
 // Process the menu command or display the menu
 // Returns true when exiting the menu system
-bool R4A_MENU::process(const char * command,
-                       Print * display)
+bool R4A_MENU_COMPILED::process(R4A_MENU_CURSOR * cursor,
+                                const char * command,
+                                Print * display,
+                                bool debug) const
 {
-    String align("");
+    const char * align;
     int alignSpaces;
     const char * cmd;
     bool found;
     int length;
     int maxLength;
+    const R4A_MENU_TABLE * menu;
     const R4A_MENU_ENTRY * menuEnd;
     const R4A_MENU_ENTRY * menuEntry;
     const char * spaces = "                                                  ";
     int spaceCount;
 
-    if (_debug)
+    // Get the session's menu position
+    menu = cursor->menu;
+    R4A_MENU_TRACE(debug, "command: %p, display: %p, menu: %p, asyncEntry: %p",
+                   command, display, menu, cursor->asyncEntry);
+
+    // Pass the input to the long command, the menu is displayed when the
+    // command completes
+    if (cursor->asyncEntry)
     {
-        Serial.printf("command: %p %s%s%s\r\n",
-                      command,
-                      command ? "(" : "",
-                      command ? command : "",
-                      command ? ")" : "");
-        Serial.printf("display: %p\r\n", display);
-        Serial.printf("_menu: %p\r\n", _menu);
+        if (command
+            && (cursor->asyncEntry->asyncRoutine(cursor->asyncEntry,
+                                                 command,
+                                                 display,
+                                                 &cursor->asyncState,
+                                                 true) == R4A_MENU_ASYNC_DONE))
+        {
+            cursor->asyncEntry = nullptr;
+            cursor->asyncState = 0;
+            display->println("Command cancelled");
+        }
+        return false;
     }
 
     // Always start with the main menu
-    if (!_menu)
-    {
-        _menu = &_menuTable[0];
-        if (_debug)
-            Serial.printf("_menu: %p\r\n", _menu);
-    }
+    if (!menu)
+        menu = &_menuTable[0];
 
     // Process the command
     if (command)
     {
         // Walk the menu table
-        menuEntry = _menu->firstEntry;
-        menuEnd = &menuEntry[_menu->menuEntryCount];
+        menuEntry = menu->firstEntry;
+        menuEnd = &menuEntry[menu->menuEntryCount];
         while (menuEntry < menuEnd)
         {
-            if (_debug)
-                Serial.printf("menuEntry: %p\r\n", menuEntry);
-
             // Determine if the command has parameters
             cmd = menuEntry->command;
-            if (_debug)
-                Serial.printf("menuEntry->command: %p %s%s%s\r\n",
-                              cmd,
-                              cmd ? "(" : "",
-                              cmd ? cmd : "",
-                              cmd ? ")" : "");
             if (menuEntry->align)
             {
                 length = strlen(cmd);
@@ -96,52 +157,46 @@ bool R4A_MENU::process(const char * command,
             }
             else
                 found = (r4aStricmp(command, cmd) == 0);
-            if (_debug)
-                Serial.printf("found: %d\r\n", found);
 
             // Determine if the command was found
             if (found)
             {
-                if (_debug)
-                    Serial.printf("menuEntry->menuRoutine: %p\r\n", menuEntry->menuRoutine);
+                R4A_MENU_TRACE(debug, "menuEntry: %p (%s), menuRoutine: %p, asyncRoutine: %p",
+                               menuEntry, cmd, menuEntry->menuRoutine,
+                               menuEntry->asyncRoutine);
 
-                // Process the command
-                if (menuEntry->menuRoutine)
+                // Start the long command
+                if (menuEntry->asyncRoutine)
                 {
-                    if (_debug)
-                    {
-                        Serial.printf("menuEntry: %p\r\n", menuEntry);
-                        Serial.printf("command: %p %s%s%s\r\n",
-                                      command,
-                                      command ? "(" : "",
-                                      command ? command : "",
-                                      command ? ")" : "");
-                        Serial.printf("display: %p\r\n", display);
-                    }
-                    menuEntry->menuRoutine(menuEntry, command, display);
+                    cursor->asyncState = 0;
+                    if (menuEntry->asyncRoutine(menuEntry,
+                                                command,
+                                                display,
+                                                &cursor->asyncState,
+                                                false) != R4A_MENU_ASYNC_DONE)
+                        cursor->asyncEntry = menuEntry;
                 }
+
+                // Process the command
+                else if (menuEntry->menuRoutine)
+                    menuEntry->menuRoutine(menuEntry, command, display);
                 else
                 {
                     // Get the next menu index
                     uint32_t index = (int)menuEntry->menuParameter;
-                    if (_debug)
-                    {
-                        Serial.printf("index: %ld\r\n", index);
-                        Serial.printf("_menuTableEntries: %d\r\n", _menuTableEntries);
-                    }
+                    R4A_MENU_TRACE(debug, "index: %ld, _menuTableEntries: %d",
+                                   index, _menuTableEntries);
 
                     // Validate the next menu index
                     if (index <= _menuTableEntries)
                     {
                         // Select the next menu
                         if (index)
-                            _menu = &_menuTable[index - 1];
+                            menu = &_menuTable[index - 1];
 
                         // Exit the menu system
                         else
-                            _menu = nullptr;
-                        if (_debug)
-                            Serial.printf("_menu: %p\r\n", _menu);
+                            menu = nullptr;
                     }
                     else
                         r4aReportFatalError("Invalid menu index!");
@@ -157,59 +212,43 @@ bool R4A_MENU::process(const char * command,
     }
     else
     {
+        R4A_MENU_TRACE(debug, "menuName: %s, preMenu: %p, firstEntry: %p, menuEntryCount: %ld",
+                       menu->menuName, menu->preMenu, menu->firstEntry,
+                       menu->menuEntryCount);
+
         // Start at the beginning of the line
         display->print('\r');
 
-        if (_debug)
-            Serial.printf("_menu->preMenu: %p\r\n", _menu->preMenu);
-        if (_menu->preMenu)
+        if (menu->preMenu)
         {
             // Separate the preMenu from previous output
-            if (_debug)
-                Serial.printf("_blankLineBeforePreMenu: %d\r\n", _blankLineBeforePreMenu);
             if (_blankLineBeforePreMenu)
                 display->println();
 
             // Display the data before the menu
-            _menu->preMenu(display);
+            menu->preMenu(display);
         }
 
         // Separate the preMenu display from the menu header
-        if (_debug)
-            Serial.printf("_blankLineBeforeMenuHeader: %d\r\n", _blankLineBeforeMenuHeader);
         if (_blankLineBeforeMenuHeader)
             display->println();
 
         // Display the menu header
-        if (_debug)
-            Serial.printf("_menu->menuName: %p %s%s%s\r\n",
-                          _menu->menuName,
-                          _menu->menuName ? "(" : "",
-                          _menu->menuName ? _menu->menuName : "",
-                          _menu->menuName ? ")" : "");
-        display->printf("%s\r\n", _menu->menuName);
-        for (int length = strlen(_menu->menuName); length > 0; length--)
+        display->printf("%s\r\n", menu->menuName);
+        for (int length = strlen(menu->menuName); length > 0; length--)
             display->print("-");
         display->println();
 
         // Separate the menu header from the commands
-        if (_debug)
-            Serial.printf("_blankLineAfterMenuHeader: %d\r\n", _blankLineAfterMenuHeader);
         if (_blankLineAfterMenuHeader)
             display->println();
 
         // Determine the maximum command length
-        if (_debug)
-        {
-            Serial.printf("_alignCommands: %d\r\n", _alignCommands);
-            Serial.printf("_menu->menuEntryCount: %ld\r\n", _menu->menuEntryCount);
-            Serial.printf("_menu->firstEntry: %p\r\n", _menu->firstEntry);
-        }
         maxLength = 0;
         if (_alignCommands)
         {
-            menuEntry = _menu->firstEntry;
-            menuEnd = &menuEntry[_menu->menuEntryCount];
+            menuEntry = menu->firstEntry;
+            menuEnd = &menuEntry[menu->menuEntryCount];
             while (menuEntry < menuEnd)
             {
                 length = strlen(menuEntry->command) + menuEntry->align + 1;
@@ -220,46 +259,30 @@ bool R4A_MENU::process(const char * command,
         }
 
         // Display the menu items
-        menuEntry = _menu->firstEntry;
-        menuEnd = &menuEntry[_menu->menuEntryCount];
+        menuEntry = menu->firstEntry;
+        menuEnd = &menuEntry[menu->menuEntryCount];
         while (menuEntry < menuEnd)
         {
-            if (_debug)
-            {
-                Serial.printf("menuEntry: %p\r\n", menuEntry);
-                Serial.printf("menuEntry->command: %p %s%s%s\r\n",
-                              menuEntry->command,
-                              menuEntry->command ? "(" : "",
-                              menuEntry->command ? menuEntry->command : "",
-                              menuEntry->command ? ")" : "");
-                Serial.printf("menuEntry->align: %d\r\n", menuEntry->align);
-                Serial.printf("menuEntry->helpRoutine: %p\r\n", menuEntry->helpRoutine);
-            }
-
-            // Align the menu items
+            // Align the menu items, use the end of the spaces string
+            spaceCount = strlen(spaces);
+            align = &spaces[spaceCount];
             if (_alignCommands)
             {
-                align = String("");
                 length = strlen(menuEntry->command) + menuEntry->align
                        + (menuEntry->align ? 1 : 0);
-                spaceCount = strlen(spaces);
                 alignSpaces = maxLength - length;
-                while (alignSpaces > 0)
-                {
-                    length = alignSpaces;
-                    if (length > spaceCount)
-                        length = spaceCount;
-                    align += &spaces[spaceCount - length];
-                    alignSpaces -= length;
-                }
+                if (alignSpaces > spaceCount)
+                    alignSpaces = spaceCount;
+                if (alignSpaces > 0)
+                    align = &spaces[spaceCount - alignSpaces];
             }
 
             // Display the menu item
             if (menuEntry->helpRoutine)
-                menuEntry->helpRoutine(menuEntry, align.c_str(), display);
+                menuEntry->helpRoutine(menuEntry, align, display);
             else
                 display->printf("%s: %s%s\r\n", menuEntry->command,
-                                align.c_str(), menuEntry->helpText);
+                                align, menuEntry->helpText);
             menuEntry++;
         }
 
@@ -268,10 +291,64 @@ bool R4A_MENU::process(const char * command,
             display->println();
     }
 
+    // Save the session's menu position
+    cursor->menu = menu;
+
     // Determine if exiting the menu system
-    if (_debug)
-        Serial.printf("_menu: %p\r\n", _menu);
-    return (_menu == nullptr);
+    R4A_MENU_TRACE(debug, "menu: %p", menu);
+    return (menu == nullptr);
+}
+
+//*********************************************************************
+// Process the menu command or display the menu
+// Returns true when exiting the menu system
+bool R4A_MENU::process(const char * command,
+                       Print * display)
+{
+    return R4A_MENU_COMPILED::process(&_menu, command, display, _debug);
+}
+
+//*********************************************************************
+// Run the long command for a time slice, display the menu when the
+// command completes
+bool R4A_MENU_COMPILED::update(R4A_MENU_CURSOR * cursor,
+                               Print * display) const
+{
+    uint32_t startUsec;
+    int status;
+
+    // Determine if a long command is running
+    if (!cursor->asyncEntry)
+        return false;
+
+    // Run the command until it completes, waits or the time slice expires
+    startUsec = micros();
+    do
+    {
+        status = cursor->asyncEntry->asyncRoutine(cursor->asyncEntry,
+                                                  nullptr,
+                                                  display,
+                                                  &cursor->asyncState,
+                                                  false);
+        if (status == R4A_MENU_ASYNC_DONE)
+        {
+            // The command is done, display the menu
+            cursor->asyncEntry = nullptr;
+            cursor->asyncState = 0;
+            process(cursor, nullptr, display);
+            return false;
+        }
+    } while ((status == R4A_MENU_ASYNC_RUNNING)
+             && ((micros() - startUsec) < R4A_MENU_ASYNC_BUDGET_USEC));
+    return true;
+}
+
+//*********************************************************************
+// Run the long command for a time slice, display the menu when the
+// command completes
+bool R4A_MENU::update(Print * display)
+{
+    return R4A_MENU_COMPILED::update(&_menu, display);
 }
 
 //*********************************************************************
@@ -286,7 +363,8 @@ void R4A_MENU::debug(bool enable)
 void R4A_MENU::display(Print * display)
 {
     display->printf("Menu @ %p\r\n", this);
-    display->printf("    _menu: %p\r\n", _menu);
+    display->printf("    _menu.menu: %p\r\n", _menu.menu);
+    display->printf("    _menu.asyncEntry: %p\r\n", _menu.asyncEntry);
     display->printf("    _menuTable: %p\r\n", _menuTable);
     display->printf("    _menuTableEntries: %d\r\n", _menuTableEntries);
     display->printf("    _blankLineBeforePreMenu: %d\r\n", _blankLineBeforePreMenu);
@@ -326,6 +404,50 @@ String r4aMenuGetParameters(const struct _R4A_MENU_ENTRY * menuEntry,
     return line;
 }
 
+//*********************************************************************
+// Locate the parameters in the command without copying them
+const char * r4aMenuGetParameters(const struct _R4A_MENU_ENTRY * menuEntry,
+                                  const char * command,
+                                  size_t * length)
+{
+    const char * end;
+    const char * parameters;
+
+    // Skip over the command and the leading white space
+    parameters = &command[strlen(menuEntry->command)];
+    while (isspace(*parameters))
+        parameters++;
+
+    // Skip over the trailing white space
+    end = &parameters[strlen(parameters)];
+    while ((end > parameters) && isspace(end[-1]))
+        end--;
+    *length = end - parameters;
+    return parameters;
+}
+
+//*********************************************************************
+// Copy the parameters into a buffer without the leading and trailing
+// white space
+char * r4aMenuGetParameters(const struct _R4A_MENU_ENTRY * menuEntry,
+                            const char * command,
+                            char * buffer,
+                            size_t bufferLength)
+{
+    size_t length;
+    const char * parameters;
+
+    // Truncate the long parameters
+    parameters = r4aMenuGetParameters(menuEntry, command, &length);
+    if (length >= bufferLength)
+        length = bufferLength - 1;
+
+    // Copy the parameters
+    memcpy(buffer, parameters, length);
+    buffer[length] = 0;
+    return buffer;
+}
+
 //*********************************************************************
 // Display the menu item with a suffix and help text.  The suffix is
 // specified as the menu parameter.
@@ -343,3 +465,75 @@ void r4aMenuHelpSuffix(const struct _R4A_MENU_ENTRY * menuEntry,
                     align,
                     menuEntry->helpText);
 }
+
+//*********************************************************************
+// Display a list one item at a time as the output drains
+int r4aMenuPager(const struct _R4A_MENU_ENTRY * menuEntry,
+                 const char * command,
+                 Print * display,
+                 intptr_t * state,
+                 bool cancel)
+{
+    R4A_MENU_PAGER_ITERATOR iterator;
+    R4A_MENU_PAGER_STATE * pager;
+    int space;
+
+    pager = (R4A_MENU_PAGER_STATE *)*state;
+    if (cancel)
+    {
+        // The Enter key at the --More-- prompt displays the next page
+        if (command && pager && pager->waiting && (command[0] == 0))
+        {
+            pager->items = 0;
+            pager->waiting = false;
+            return R4A_MENU_ASYNC_WAIT;
+        }
+
+        // End the list
+        r4aFree(pager);
+        *state = 0;
+        return R4A_MENU_ASYNC_DONE;
+    }
+
+    // Allocate the pager state on the first call
+    if (command)
+    {
+        pager = (R4A_MENU_PAGER_STATE *)r4aMalloc(R4A_MODULE_MENU, sizeof(*pager));
+        if (!pager)
+        {
+            display->println("ERROR: Failed to allocate the pager!");
+            return R4A_MENU_ASYNC_DONE;
+        }
+        memset(pager, 0, sizeof(*pager));
+        *state = (intptr_t)pager;
+    }
+
+    // Wait for the user at the --More-- prompt
+    if (pager->waiting)
+        return R4A_MENU_ASYNC_WAIT;
+
+    // Wait for the output to drain, zero is returned by the Print objects
+    // that don't report the space
+    space = display->availableForWrite();
+    if (space && (space < R4A_MENU_PAGER_WRITE_BYTES))
+        return R4A_MENU_ASYNC_WAIT;
+
+    // Display the next item
+    iterator = (R4A_MENU_PAGER_ITERATOR)menuEntry->menuParameter;
+    if (!iterator(menuEntry, display, &pager->position))
+    {
+        r4aFree(pager);
+        *state = 0;
+        return R4A_MENU_ASYNC_DONE;
+    }
+
+    // Prompt the user at the end of the page
+    pager->items += 1;
+    if (r4aMenuPagerLines && (pager->items >= r4aMenuPagerLines))
+    {
+        display->print("--More-- Enter: next page, other: quit");
+        pager->waiting = true;
+        return R4A_MENU_ASYNC_WAIT;
+    }
+    return R4A_MENU_ASYNC_RUNNING;
+}
@@ -0,0 +1,399 @@
+/**********************************************************************
+  Metrics.cpp
+
+  Robots-For-All (R4A)
+  Metrics registry with counters, gauges and histograms
+
+  Each metric adds itself to the registry list during construction and
+  removes itself during destruction.  The metrics with the same name are
+  separated by their labels.  Updates are single atomic operations so that
+  the metrics may be updated from either core without locks.  The list
+  changes are made holding r4aMetricMux.  The tasks walking the list are
+  counted and the destructor waits for them, so a metric is never freed
+  while the output routines may be using it.  The
+  metrics are output for people by the menu and in the Prometheus text
+  format for a dashboard.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Constants
+//****************************************
+
+#define R4A_METRICS_BUFFER_BYTES    512     // Network output buffer size
+
+const char * const r4aMetricTypeName[] =
+{
+    "counter",      // R4A_METRIC_COUNTER
+    "gauge",        // R4A_METRIC_GAUGE
+    "histogram",    // R4A_METRIC_HISTOGRAM
+};
+
+//****************************************
+// Types
+//****************************************
+
+// Collect the output into larger network writes
+class R4A_METRICS_BUFFER : public Print
+{
+  private:
+
+    uint8_t _buffer[R4A_METRICS_BUFFER_BYTES];
+    size_t _length;
+    Print * _output;
+
+  public:
+
+    // Constructor
+    // Inputs:
+    //   output: Device receiving the buffered data
+    R4A_METRICS_BUFFER(Print * output)
+        : _length{0}, _output{output}
+    {
+    }
+
+    // Destructor: Output the remaining data
+    ~R4A_METRICS_BUFFER()
+    {
+        flush();
+    }
+
+    // Output the buffered data
+    void flush()
+    {
+        if (_length)
+            _output->write(_buffer, _length);
+        _length = 0;
+    }
+
+    // Add a byte to the buffer
+    // Inputs:
+    //   data: Byte to add
+    // Outputs:
+    //   Returns the number of bytes written
+    size_t write(uint8_t data)
+    {
+        if (_length >= sizeof(_buffer))
+            flush();
+        _buffer[_length++] = data;
+        return 1;
+    }
+
+    // Add data to the buffer
+    // Inputs:
+    //   buffer: Address of the data
+    //   length: Number of bytes to add
+    // Outputs:
+    //   Returns the number of bytes written
+    size_t write(const uint8_t * buffer, size_t length)
+    {
+        size_t bytes;
+        size_t bytesWritten;
+
+        bytesWritten = length;
+        while (length)
+        {
+            if (_length >= sizeof(_buffer))
+                flush();
+            bytes = sizeof(_buffer) - _length;
+            if (bytes > length)
+                bytes = length;
+            memcpy(&_buffer[_length], buffer, bytes);
+            _length += bytes;
+            buffer += bytes;
+            length -= bytes;
+        }
+        return bytesWritten;
+    }
+};
+
+//****************************************
+// Locals
+//****************************************
+
+static R4A_METRIC * r4aMetricList;  // Registry of metrics
+static portMUX_TYPE r4aMetricMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint8_t r4aMetricReaders; // Tasks walking the registry
+
+//*********************************************************************
+// Add a metric to the registry
+// Inputs:
+//   metric: Address of the metric to add
+static void r4aMetricRegister(R4A_METRIC * metric)
+{
+    // Add the metric to the head of the list
+    portENTER_CRITICAL(&r4aMetricMux);
+    metric->_next = r4aMetricList;
+    __atomic_store_n(&r4aMetricList, metric, __ATOMIC_RELEASE);
+    portEXIT_CRITICAL(&r4aMetricMux);
+}
+
+//*********************************************************************
+// Start walking the registry, the metrics are not freed until
+// r4aMetricReadEnd is called
+// Outputs:
+//   Returns the address of the first metric
+static R4A_METRIC * r4aMetricReadBegin()
+{
+    R4A_METRIC * head;
+
+    portENTER_CRITICAL(&r4aMetricMux);
+    r4aMetricReaders += 1;
+    head = r4aMetricList;
+    portEXIT_CRITICAL(&r4aMetricMux);
+    return head;
+}
+
+//*********************************************************************
+// Done walking the registry
+static void r4aMetricReadEnd()
+{
+    portENTER_CRITICAL(&r4aMetricMux);
+    r4aMetricReaders -= 1;
+    portEXIT_CRITICAL(&r4aMetricMux);
+}
+
+//*********************************************************************
+// Constructor: Create and register a counter or gauge
+R4A_METRIC::R4A_METRIC(const char * name,
+                       const char * help,
+                       uint8_t type,
+                       const char * labels)
+    : _next{nullptr}, _name{name}, _help{help}, _labels{labels}, _type{type},
+      _bucketCount{0}, _bounds{nullptr}, _buckets{nullptr}, _value{0},
+      _sum{0}
+{
+    r4aMetricRegister(this);
+}
+
+//*********************************************************************
+// Constructor: Create and register a histogram
+R4A_METRIC::R4A_METRIC(const char * name,
+                       const char * help,
+                       const int32_t * bounds,
+                       uint8_t bucketCount,
+                       uint32_t * buckets)
+    : _next{nullptr}, _name{name}, _help{help}, _labels{nullptr},
+      _type{R4A_METRIC_HISTOGRAM},
+      _bucketCount{bucketCount}, _bounds{bounds}, _buckets{buckets},
+      _value{0}, _sum{0}
+{
+    // The output displays the largest bound, at least one is needed
+    if ((!bucketCount) || (!bounds) || (!buckets))
+    {
+        r4aLogError(R4A_MODULE_METRICS, "Histogram %s needs at least one bucket bound!", name);
+        return;
+    }
+    r4aMetricRegister(this);
+}
+
+//*********************************************************************
+// Destructor: Remove the metric from the registry
+R4A_METRIC::~R4A_METRIC()
+{
+    R4A_METRIC ** link;
+    bool wait;
+
+    // Unlink the metric, _next is left unchanged for the tasks walking
+    // the list
+    portENTER_CRITICAL(&r4aMetricMux);
+    for (link = &r4aMetricList; *link; link = &(*link)->_next)
+        if (*link == this)
+        {
+            __atomic_store_n(link, _next, __ATOMIC_RELEASE);
+            break;
+        }
+    wait = (r4aMetricReaders != 0);
+    portEXIT_CRITICAL(&r4aMetricMux);
+
+    // Wait until the tasks walking the list are done with this metric
+    while (wait)
+    {
+        delay(1);
+        wait = (__atomic_load_n(&r4aMetricReaders, __ATOMIC_ACQUIRE) != 0);
+    }
+}
+
+//*********************************************************************
+// Add a value to a histogram
+void R4A_METRIC::observe(int32_t value)
+{
+    int index;
+
+    // Ignore the values for a histogram without bounds
+    if (!_bucketCount)
+        return;
+
+    // Locate the bucket, the last bucket holds the values above the
+    // largest bound
+    for (index = 0; index < _bucketCount; index++)
+        if (value <= _bounds[index])
+            break;
+
+    // Account for the value
+    __atomic_fetch_add(&_buckets[index], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&_sum, value, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&_value, 1, __ATOMIC_RELAXED);
+}
+
+//*********************************************************************
+// Create the metrics context for a network client
+bool r4aMetricsContextCreate(NetworkClient * client, void ** contextData)
+{
+    uint8_t * matched;
+
+    // Allocate the end of request match count
+    matched = (uint8_t *)r4aMalloc(R4A_MODULE_METRICS, sizeof(*matched));
+    if (matched)
+        *matched = 0;
+    *contextData = (void *)matched;
+    return (matched != nullptr);
+}
+
+//*********************************************************************
+// Delete the metrics context
+void r4aMetricsContextDelete(void * contextData)
+{
+    r4aFree(contextData);
+}
+
+//*********************************************************************
+// Display the metrics
+void r4aMetricsDisplay(Print * display)
+{
+    int index;
+    R4A_METRIC * metric;
+    char name[64];
+
+    for (metric = r4aMetricReadBegin(); metric; metric = metric->_next)
+    {
+        if (metric->_type != R4A_METRIC_HISTOGRAM)
+        {
+            // Add the labels to the name
+            if (metric->_labels && *metric->_labels)
+                snprintf(name, sizeof(name), "%s{%s}", metric->_name, metric->_labels);
+            else
+                snprintf(name, sizeof(name), "%s", metric->_name);
+            display->printf("%-40s %ld\r\n", name, metric->_value);
+        }
+        else
+        {
+            display->printf("%-40s count: %ld, sum: %lld\r\n",
+                            metric->_name, metric->_value, metric->_sum);
+            for (index = 0; index < metric->_bucketCount; index++)
+                display->printf("    <= %-10ld %ld\r\n",
+                                metric->_bounds[index],
+                                metric->_buckets[index]);
+            display->printf("    >  %-10ld %ld\r\n",
+                            metric->_bounds[metric->_bucketCount - 1],
+                            metric->_buckets[metric->_bucketCount]);
+        }
+    }
+    r4aMetricReadEnd();
+}
+
+//*********************************************************************
+// Display the metrics
+void r4aMetricsMenuDisplay(const R4A_MENU_ENTRY * menuEntry,
+                           const char * command,
+                           Print * display)
+{
+    r4aMetricsDisplay(display);
+}
+
+//*********************************************************************
+// Serve the metrics to a HTTP client
+bool r4aMetricsProcessInput(NetworkClient * client, void * contextData)
+{
+    int data;
+    uint8_t * matched;
+
+    // Discard the request until the blank line at the end of the headers
+    matched = (uint8_t *)contextData;
+    while ((data = client->read()) >= 0)
+    {
+        if (data == '\n')
+            *matched += 1;
+        else if (data != '\r')
+            *matched = 0;
+        if (*matched < 2)
+            continue;
+
+        // Send the response
+        R4A_METRICS_BUFFER buffer(client);
+        buffer.print("HTTP/1.0 200 OK\r\n"
+                     "Content-Type: text/plain; version=0.0.4\r\n"
+                     "Connection: close\r\n"
+                     "\r\n");
+        r4aMetricsPrometheus(&buffer);
+        buffer.flush();
+        return true;
+    }
+    return false;
+}
+
+//*********************************************************************
+// Output the samples for a metric in the Prometheus text format
+// Inputs:
+//   output: Device used for output
+//   metric: Address of the metric
+static void r4aMetricsPrometheusSamples(Print * output, R4A_METRIC * metric)
+{
+    uint32_t count;
+    int index;
+
+    if (metric->_type != R4A_METRIC_HISTOGRAM)
+    {
+        if (metric->_labels && *metric->_labels)
+            output->printf("%s{%s} %ld\n", metric->_name, metric->_labels, metric->_value);
+        else
+            output->printf("%s %ld\n", metric->_name, metric->_value);
+    }
+    else
+    {
+        // Output the cumulative bucket counts
+        count = 0;
+        for (index = 0; index < metric->_bucketCount; index++)
+        {
+            count += metric->_buckets[index];
+            output->printf("%s_bucket{le=\"%ld\"} %ld\n",
+                           metric->_name, metric->_bounds[index], count);
+        }
+        count += metric->_buckets[metric->_bucketCount];
+        output->printf("%s_bucket{le=\"+Inf\"} %ld\n", metric->_name, count);
+        output->printf("%s_sum %lld\n", metric->_name, metric->_sum);
+        output->printf("%s_count %ld\n", metric->_name, count);
+    }
+}
+
+//*********************************************************************
+// Output the metrics in the Prometheus text format
+void r4aMetricsPrometheus(Print * output)
+{
+    R4A_METRIC * head;
+    R4A_METRIC * metric;
+    R4A_METRIC * previous;
+    R4A_METRIC * sample;
+
+    head = r4aMetricReadBegin();
+    for (metric = head; metric; metric = metric->_next)
+    {
+        // Skip the metrics already output with an earlier metric of the
+        // same name
+        for (previous = head; previous != metric; previous = previous->_next)
+            if (strcmp(previous->_name, metric->_name) == 0)
+                break;
+        if (previous != metric)
+            continue;
+
+        // Output the samples for all of the metrics with this name as a
+        // single group
+        output->printf("# HELP %s %s\n", metric->_name, metric->_help);
+        output->printf("# TYPE %s %s\n", metric->_name, r4aMetricTypeName[metric->_type]);
+        for (sample = metric; sample; sample = sample->_next)
+            if (strcmp(sample->_name, metric->_name) == 0)
+                r4aMetricsPrometheusSamples(output, sample);
+    }
+    r4aMetricReadEnd();
+}
@@ -49,18 +49,34 @@ bool r4aNtpOnline;
 
 static NTPClient * r4aNtpClient;
 static bool r4aNtpDisplayInitialTime;
+static uint32_t r4aNtpLinkGeneration;
 static uint8_t r4aNtpState;
 static long r4aNtpTimeZoneOffsetSeconds;
 static WiFiUDP * r4aNtpUDP;
 
+//****************************************
+// Metrics
+//****************************************
+
+static R4A_METRIC r4aNtpMetricOnline("r4a_ntp_online",
+                                     "One when the NTP time is valid",
+                                     R4A_METRIC_GAUGE);
+static R4A_METRIC r4aNtpMetricState("r4a_ntp_state",
+                                    "NTP state number",
+                                    R4A_METRIC_GAUGE);
+
 //*********************************************************************
 // Display the date and time
 void r4aNtpDisplayDateTime(Print * display)
 {
-    time_t seconds = r4aNtpGetEpochTime();
+    char date[R4A_NTP_STRING_BYTES];
+    time_t seconds;
+    char time[R4A_NTP_STRING_BYTES];
+
+    seconds = r4aNtpGetEpochTime();
     display->printf("%s %s\r\n",
-                    r4aNtpGetDate(seconds).c_str(),
-                    r4aNtpGetTime24(seconds).c_str());
+                    r4aNtpGetDate(seconds, date, sizeof(date)),
+                    r4aNtpGetTime24(seconds, time, sizeof(time)));
 }
 
 //*********************************************************************
@@ -68,14 +84,24 @@ void r4aNtpDisplayDateTime(Print * display)
 // Returns the date as yyyy-mm-dd or "Time not set"
 String r4aNtpGetDate(uint32_t seconds)
 {
-    char date[128];
+    char date[R4A_NTP_STRING_BYTES];
+
+    return String(r4aNtpGetDate(seconds, date, sizeof(date)));
+}
 
+//*********************************************************************
+// Get the date string
+// Returns the date as yyyy-mm-dd or "Time not set"
+const char * r4aNtpGetDate(uint32_t seconds, char * buffer, size_t bufferLength)
+{
     if (!seconds)
-        return String("Time not set");
+        snprintf(buffer, bufferLength, "Time not set");
 
     // Format the date
-    sprintf(date, "%4d-%02d-%02d", year(seconds), month(seconds), day(seconds));
-    return String(date);
+    else
+        snprintf(buffer, bufferLength, "%4d-%02d-%02d",
+                 year(seconds), month(seconds), day(seconds));
+    return buffer;
 }
 
 //*********************************************************************
@@ -95,10 +121,24 @@ uint32_t r4aNtpGetEpochTime()
 //*********************************************************************
 // Get the time as hh:mm:ss
 String r4aNtpGetTime()
+{
+    char time[R4A_NTP_STRING_BYTES];
+
+    return String(r4aNtpGetTime(time, sizeof(time)));
+}
+
+//*********************************************************************
+// Get the time as hh:mm:ss
+const char * r4aNtpGetTime(char * buffer, size_t bufferLength)
 {
     if (!r4aNtpIsTimeValid())
-        return "Time not set";
-    return r4aNtpClient->getFormattedTime();
+        snprintf(buffer, bufferLength, "Time not set");
+    else
+        snprintf(buffer, bufferLength, "%02d:%02d:%02d",
+                 r4aNtpClient->getHours(),
+                 r4aNtpClient->getMinutes(),
+                 r4aNtpClient->getSeconds());
+    return buffer;
 }
 
 //*********************************************************************
@@ -106,32 +146,50 @@ String r4aNtpGetTime()
 // Returns time as hh:mm:ss xM or "Time not set"
 String r4aNtpGetTime12(uint32_t seconds)
 {
-    char time[128];
+    char time[R4A_NTP_STRING_BYTES];
 
-    if (!seconds)
-        return String("Time not set");
+    return String(r4aNtpGetTime12(seconds, time, sizeof(time)));
+}
 
-    // Format the date
-    sprintf(time, "%2d:%02d:%02d %s",
-            hourFormat12(seconds),
-            minute(seconds),
-            second(seconds),
-            isAM(seconds) ? "AM" : "PM");
-    return String(time);
+//*********************************************************************
+// Get the time string in 12 hour format
+// Returns time as hh:mm:ss xM or "Time not set"
+const char * r4aNtpGetTime12(uint32_t seconds, char * buffer, size_t bufferLength)
+{
+    if (!seconds)
+        snprintf(buffer, bufferLength, "Time not set");
+
+    // Format the time
+    else
+        snprintf(buffer, bufferLength, "%2d:%02d:%02d %s",
+                 hourFormat12(seconds),
+                 minute(seconds),
+                 second(seconds),
+                 isAM(seconds) ? "AM" : "PM");
+    return buffer;
 }
 
 //*********************************************************************
 // Get the time string in 24 hour format
 String r4aNtpGetTime24(uint32_t seconds)
 {
-    char time[128];
+    char time[R4A_NTP_STRING_BYTES];
+
+    return String(r4aNtpGetTime24(seconds, time, sizeof(time)));
+}
 
+//*********************************************************************
+// Get the time string in 24 hour format
+const char * r4aNtpGetTime24(uint32_t seconds, char * buffer, size_t bufferLength)
+{
     if (!seconds)
-        return String("Time not set");
+        snprintf(buffer, bufferLength, "Time not set");
 
-    // Format the date
-    sprintf(time, "%2d:%02d:%02d", hour(seconds), minute(seconds), second(seconds));
-    return String(time);
+    // Format the time
+    else
+        snprintf(buffer, bufferLength, "%2d:%02d:%02d",
+                 hour(seconds), minute(seconds), second(seconds));
+    return buffer;
 }
 
 //*********************************************************************
@@ -161,12 +219,14 @@ void r4aNtpSetState(uint8_t newState)
             stateName = r4aNtpStateName[r4aNtpState];
 
         // Display the state transition
-        Serial.printf("(%d) %s --> %s (%d)\r\n",
-                      r4aNtpState, stateName, newStateName, newState);
+        r4aLogInfo(R4A_MODULE_NTP, "(%d) %s --> %s (%d)",
+                   r4aNtpState, stateName, newStateName, newState);
     }
 
     // Update the state
     r4aNtpState = newState;
+    r4aNtpMetricState.set(newState);
+    r4aNtpMetricOnline.set(r4aNtpOnline);
 }
 
 //*********************************************************************
@@ -251,7 +311,7 @@ void r4aNtpUpdate(bool wifiConnected)
         else
         {
             // Allocate the WiFi UDP object
-            r4aNtpUDP = new WiFiUDP();
+            r4aNtpUDP = r4aNew<WiFiUDP>(R4A_MODULE_NTP);
             if (r4aNtpUDP)
                 r4aNtpSetState(R4A_NTP_STATE_GET_NTP_CLIENT);
         }
@@ -264,7 +324,7 @@ void r4aNtpUpdate(bool wifiConnected)
         else
         {
             // Allocate the NTP client object
-            r4aNtpClient = new NTPClient(*r4aNtpUDP);
+            r4aNtpClient = r4aNew<NTPClient>(R4A_MODULE_NTP, *r4aNtpUDP);
             if (r4aNtpClient)
                 r4aNtpSetState(R4A_NTP_STATE_NTP_CLIENT_BEGIN);
         }
@@ -315,14 +375,21 @@ void r4aNtpUpdate(bool wifiConnected)
 
     case R4A_NTP_STATE_FREE_NTP_CLIENT:
         // Done with the NTP client
-        delete r4aNtpClient;
+        r4aDelete(r4aNtpClient);
         r4aNtpSetState(R4A_NTP_STATE_FREE_WIFI_UDP);
         break;
 
     case R4A_NTP_STATE_FREE_WIFI_UDP:
         // Done with the WiFi UDP object
-        delete r4aNtpUDP;
+        r4aDelete(r4aNtpUDP);
         r4aNtpSetState(R4A_NTP_STATE_WAIT_FOR_WIFI);
         break;
     }
 }
+
+//*********************************************************************
+// Update the NTP client and system time using the link state
+void r4aNtpUpdate()
+{
+    r4aNtpUpdate(r4aLinkIsUp(&r4aNtpLinkGeneration));
+}
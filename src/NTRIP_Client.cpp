@@ -97,10 +97,28 @@ volatile bool r4aNtripClientDebugState = false;     // Display NTRIP client stat
 volatile bool r4aNtripClientEnable = false;         // Enable the NTRIP client
 volatile bool r4aNtripClientForcedShutdown = false; // Enable the NTRIP client
 
+//****************************************
+// Metrics
+//****************************************
+
+static R4A_METRIC r4aNtripClientMetricConnections("r4a_ntrip_client_connection_attempts_total",
+                                                  "NTRIP caster connection attempts",
+                                                  R4A_METRIC_COUNTER);
+static R4A_METRIC r4aNtripClientMetricGnssBytes("r4a_ntrip_client_gnss_bytes_total",
+                                                "RTCM bytes pushed to the GNSS",
+                                                R4A_METRIC_COUNTER);
+static R4A_METRIC r4aNtripClientMetricRxBytes("r4a_ntrip_client_rx_bytes_total",
+                                              "RTCM bytes received from the NTRIP caster",
+                                              R4A_METRIC_COUNTER);
+static R4A_METRIC r4aNtripClientMetricState("r4a_ntrip_client_state",
+                                            "NTRIP client state number",
+                                            R4A_METRIC_GAUGE);
+
 //*********************************************************************
 // Constructor
 R4A_NTRIP_CLIENT::R4A_NTRIP_CLIENT()
     : _client{nullptr},
+      _linkGeneration{0},
       _state{NTRIP_CLIENT_OFF},
       _connectionDelayMsec{r4aNtripClientBbackoffIntervalMsec[0]},
       _connectionAttempts{0},
@@ -416,10 +434,12 @@ int R4A_NTRIP_CLIENT::rbAddData(int length)
 
         // Display the bytes read
         if (r4aNtripClientDebugRtcm)
-            Serial.printf("NTRIP RX --> buffer, %d RTCM bytes.\r\n", bytesRead);
+            r4aLogInfo(R4A_MODULE_NTRIP_CLIENT,
+                       "NTRIP RX --> buffer, %d RTCM bytes.", bytesRead);
 
         // Account for the data copied
         bytesWritten += bytesRead;
+        r4aNtripClientMetricRxBytes.add(bytesRead);
         _rbHead = _rbHead + bytesRead;
         if (_rbHead >= R4A_NTRIP_CLIENT_RING_BUFFER_BYTES)
             _rbHead = _rbHead - R4A_NTRIP_CLIENT_RING_BUFFER_BYTES;
@@ -508,13 +528,16 @@ int R4A_NTRIP_CLIENT::rbRemoveData(Print * display)
                                           display);
             if (bytesPushed == 0)
             {
-                Serial.printf("NTRIP buffer --> GNSS failed! bytesWritten: %d\r\n", bytesWritten);
+                r4aLogError(R4A_MODULE_NTRIP_CLIENT,
+                            "NTRIP buffer --> GNSS failed! bytesWritten: %d",
+                            bytesWritten);
                 break;
             }
 
             // Account for the data copied
             bytesAvailable -= bytesPushed;
             bytesWritten += bytesPushed;
+            r4aNtripClientMetricGnssBytes.add(bytesPushed);
             _rbTail = _rbTail + bytesPushed;
             if (_rbTail >= R4A_NTRIP_CLIENT_RING_BUFFER_BYTES)
                 _rbTail = _rbTail - R4A_NTRIP_CLIENT_RING_BUFFER_BYTES;
@@ -522,7 +545,8 @@ int R4A_NTRIP_CLIENT::rbRemoveData(Print * display)
 
         // Display the RTCM written to the GNSS
         if (r4aNtripClientDebugRtcm)
-            Serial.printf("NTRIP buffer --> GNSS, %d RTCM bytes.\r\n", bytesWritten);
+            r4aLogInfo(R4A_MODULE_NTRIP_CLIENT,
+                       "NTRIP buffer --> GNSS, %d RTCM bytes.", bytesWritten);
     }
 
     // Return the number of byte written
@@ -585,6 +609,7 @@ void R4A_NTRIP_CLIENT::setState(uint8_t newState)
 {
     Print * display;
 
+    r4aNtripClientMetricState.set(newState);
     if (!r4aNtripClientDebugState)
         _state = newState;
     else
@@ -631,7 +656,7 @@ bool R4A_NTRIP_CLIENT::stop(bool shutdown)
             _client->stop();
 
         // Free the NTRIP client resources
-        delete _client;
+        r4aDelete(_client);
         _client = nullptr;
     }
 
@@ -694,6 +719,7 @@ bool R4A_NTRIP_CLIENT::stop(bool shutdown)
 void R4A_NTRIP_CLIENT::update(bool wifiConnected)
 {
     Print * display = getSerial();
+    char time[R4A_NTP_STRING_BYTES];
 
     // Shutdown the NTRIP client when the mode or setting changes
     if ((!r4aNtripClientEnable) && (_state > NTRIP_CLIENT_OFF))
@@ -733,7 +759,8 @@ void R4A_NTRIP_CLIENT::update(bool wifiConnected)
         if (wifiConnected)
         {
             // Allocate the _client structure
-            _client = new NetworkClient();
+            _client = r4aNew<R4A_CAPTURE_CLIENT>(R4A_MODULE_NTRIP_CLIENT,
+                                                R4A_MODULE_NTRIP_CLIENT);
             if (!_client)
             {
                 // Failed to allocate the _client structure
@@ -745,6 +772,7 @@ void R4A_NTRIP_CLIENT::update(bool wifiConnected)
                 // Account for this connection attempt
                 _connectionAttempts += 1;
                 _connectionAttemptsTotal += 1;
+                r4aNtripClientMetricConnections.add();
 
                 // The network is available for the NTRIP client
                 setState(NTRIP_CLIENT_CONNECTING);
@@ -877,7 +905,7 @@ void R4A_NTRIP_CLIENT::update(bool wifiConnected)
                     if (r4aNtpOnline)
                         display->printf("NTRIP Client connected to %s:%d at %s\r\n",
                                         r4aNtripClientCasterHost, r4aNtripClientCasterPort,
-                                        r4aNtpGetTime24(r4aNtpGetEpochTime()).c_str());
+                                        r4aNtpGetTime24(r4aNtpGetEpochTime(), time, sizeof(time)));
                     else
                         display->printf("NTRIP Client connected to %s:%d\r\n",
                                         r4aNtripClientCasterHost, r4aNtripClientCasterPort);
@@ -977,7 +1005,7 @@ void R4A_NTRIP_CLIENT::update(bool wifiConnected)
                     // Timeout receiving NTRIP data, retry the NTRIP client connection
                     if (r4aNtpOnline)
                         display->printf("NTRIP Client timeout receiving data at %s\r\n",
-                                        r4aNtpGetTime24(r4aNtpGetEpochTime()).c_str());
+                                        r4aNtpGetTime24(r4aNtpGetEpochTime(), time, sizeof(time)));
                     else
                         display->println("NTRIP Client timeout receiving data");
                     restart();
@@ -1000,6 +1028,13 @@ void R4A_NTRIP_CLIENT::update(bool wifiConnected)
     }
 }
 
+//*********************************************************************
+// Update the NTRIP client using the link state
+void R4A_NTRIP_CLIENT::update()
+{
+    update(r4aLinkIsUp(&_linkGeneration));
+}
+
 //*********************************************************************
 // Verify the NTRIP client tables
 void R4A_NTRIP_CLIENT::validateTables()
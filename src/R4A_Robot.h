@@ -11,9 +11,17 @@
 #include <Arduino.h>            // Built-in
 #include <base64.h>             // Built-in, needed for NTRIP Client credential encoding
 #include <BluetoothSerial.h>    // Built-in
+#include <driver/rmt_tx.h>      // Built-in, needed for the RMT LED output
+#include <driver/spi_master.h>  // Built-in, needed for the queued SPI transactions
+#include <driver/uart.h>        // Built-in, needed for the UART serial console
 #include <esp32-hal-spi.h>      // Built-in
+#include <lwip/sockets.h>       // Built-in, needed for the socket transmit space
 #include <math.h>               // Built-in
 #include <Network.h>            // Built-in
+#include <new>                  // Built-in, needed for placement new in r4aNew
+#include <Preferences.h>        // Built-in, NVS storage for the configuration
+#include <type_traits>          // Built-in, needed for the r4aLog argument checks
+#include <utility>              // Built-in, needed for std::forward in r4aNew
 #include <WiFi.h>               // Built-in
 #include <WiFiMulti.h>          // Built-in
 #include <WiFiServer.h>         // Built-in
@@ -60,6 +68,174 @@
 #define R4A_EARTH_EQUATORIAL_RADIUS_KM  6378
 #define R4A_EARTH_POLE_RADIUS_KM        6357
 
+// Define the library modules, used to tag log records and allocations
+enum R4A_MODULE_ID
+{
+    R4A_MODULE_APPLICATION = 0, // Code outside of the library
+    R4A_MODULE_BLUETOOTH,       // Bluetooth console
+    R4A_MODULE_LED,             // Multi-color LEDs
+    R4A_MODULE_MENU,            // Menu system
+    R4A_MODULE_NTP,             // Network time protocol
+    R4A_MODULE_NTRIP_CLIENT,    // NTRIP client
+    R4A_MODULE_ROBOT,           // Robot challenge layer
+    R4A_MODULE_SERIAL,          // Serial console
+    R4A_MODULE_TELNET,          // Telnet server and clients
+    R4A_MODULE_CAPTURE,         // Network data capture
+    R4A_MODULE_LOG,             // Logging
+    R4A_MODULE_METRICS,         // Metrics registry
+    R4A_MODULE_LINK,            // Network link state
+    R4A_MODULE_WIFI,            // WiFi connection
+    R4A_MODULE_CONFIG,          // Configuration store
+    R4A_MODULE_SERVICE,         // Service startup
+    // Insert new modules here
+    R4A_MODULE_MAX              // Number of modules
+};
+
+extern const char * const r4aModuleName[R4A_MODULE_MAX];
+
+//****************************************
+// Capture API
+//****************************************
+
+#define R4A_CAPTURE_BUFFER_BYTES    8192    // Size of the capture ring buffer
+#define R4A_CAPTURE_MAX_DATA        1460    // Maximum data bytes per record
+
+#define R4A_CAPTURE_RX              0       // Data received from the remote system
+#define R4A_CAPTURE_TX              1       // Data sent to the remote system
+
+extern volatile bool r4aCaptureEnable;      // Set true to capture network data
+extern volatile uint32_t r4aCaptureDropped; // Records dropped due to a full ring
+extern volatile uint32_t r4aCaptureRecords; // Records placed in the ring
+
+// Discard the captured data
+void r4aCaptureClear();
+
+// Save network data in the capture ring.  This routine only copies the
+// data, formatting and output are done later by the drain routines.
+// Inputs:
+//   module: Module number (R4A_MODULE_ID) using the connection
+//   session: Number identifying the connection, typically the remote port
+//   direction: R4A_CAPTURE_RX or R4A_CAPTURE_TX
+//   data: Address of the data buffer
+//   length: Number of data bytes in the buffer
+// Outputs:
+//   Returns true if the data was saved and false if it was dropped
+bool r4aCaptureData(uint8_t module,
+                    uint16_t session,
+                    uint8_t direction,
+                    const uint8_t * data,
+                    size_t length);
+
+// Display the captured records in hexadecimal and ASCII
+// Inputs:
+//   display: Device used for output
+//   maxRecords: Maximum number of records to display
+// Outputs:
+//   Returns the number of records displayed
+uint32_t r4aCaptureDisplay(Print * display, uint32_t maxRecords = 0xffffffff);
+
+// Display the capture status
+// Inputs:
+//   display: Device used for output
+void r4aCaptureDisplayStatus(Print * display = &Serial);
+
+// Output the captured records in pcap format.  Each record starts with
+// a four byte pseudo header: direction, module, session (big endian).
+// Inputs:
+//   output: Device used for output, a file, a network client, etc.
+//   maxRecords: Maximum number of records to output
+// Outputs:
+//   Returns the number of records output
+uint32_t r4aCapturePcap(Print * output, uint32_t maxRecords = 0xffffffff);
+
+// Output the pcap file header
+// Inputs:
+//   output: Device used for output, a file, a network client, etc.
+void r4aCapturePcapHeader(Print * output);
+
+// Start the capture server, which streams the captured records in pcap
+// format to a single network client.  Use the following on the host:
+//     nc <robot IP address> <port> | wireshark -k -i -
+// Inputs:
+//   port: Port number for the capture server
+// Outputs:
+//   Returns true if successful and false upon failure
+bool r4aCaptureServerBegin(uint16_t port);
+
+// Update the capture server
+// Inputs:
+//   connected: True when the network is connected and false upon
+//              network failure
+void r4aCaptureServerUpdate(bool connected);
+
+// Update the capture server using the link state from r4aLinkBegin
+void r4aCaptureServerUpdate();
+
+// Network client that copies the data read and written into the capture
+// ring when r4aCaptureEnable is set
+class R4A_CAPTURE_CLIENT : public NetworkClient
+{
+  private:
+
+    uint8_t _module;    // Module using this connection
+    uint16_t _session;  // Remote port, zero until the first capture
+
+    // Get the session number for the capture record
+    uint16_t session();
+
+  public:
+
+    // Constructor
+    // Inputs:
+    //   module: Module number (R4A_MODULE_ID) using the connection
+    R4A_CAPTURE_CLIENT(uint8_t module);
+
+    // Constructor
+    // Inputs:
+    //   client: Connected network client
+    //   module: Module number (R4A_MODULE_ID) using the connection
+    R4A_CAPTURE_CLIENT(const NetworkClient & client, uint8_t module);
+
+    using NetworkClient::write;
+
+    // Determine the space available in the socket transmit buffer.  The
+    // socket only reports when the space exceeds the low water mark, so
+    // TCP_SNDLOWAT is returned when the socket is writable and one when
+    // it is not.
+    // Outputs:
+    //   Returns the estimated number of bytes that may be written, zero
+    //   when not connected
+    int availableForWrite() override;
+
+    // Read a byte from the network
+    // Outputs:
+    //   Returns the data byte or -1 if no data is available
+    int read() override;
+
+    // Read data from the network
+    // Inputs:
+    //   buffer: Address of the buffer to receive the data
+    //   length: Maximum number of bytes to read
+    // Outputs:
+    //   Returns the number of bytes read
+    int read(uint8_t * buffer, size_t length) override;
+
+    // Write a byte to the network
+    // Inputs:
+    //   data: Byte to write
+    // Outputs:
+    //   Returns the number of bytes written
+    size_t write(uint8_t data) override;
+
+    // Write data to the network
+    // Inputs:
+    //   buffer: Address of the buffer containing the data
+    //   length: Number of bytes to write
+    // Outputs:
+    //   Returns the number of bytes written
+    size_t write(const uint8_t * buffer, size_t length) override;
+};
+
 //****************************************
 // Command Processor API
 //****************************************
@@ -76,10 +252,130 @@ typedef bool (* R4A_COMMAND_PROCESSOR)(const char * command,
 // Support sub-menu processing by changing this value
 extern volatile R4A_COMMAND_PROCESSOR r4aProcessCommand;
 
+//****************************************
+// Config API
+//****************************************
+
+#define R4A_CONFIG_COMMIT_DELAY_MSEC    (10 * 1000) // Batch changes before writing NVS
+#define R4A_CONFIG_SCAN_MSEC            1000        // Interval between change scans
+
+enum R4A_CONFIG_TYPE
+{
+    R4A_CONFIG_TYPE_BOOL = 0,   // bool
+    R4A_CONFIG_TYPE_INT8,       // int8_t
+    R4A_CONFIG_TYPE_UINT8,      // uint8_t
+    R4A_CONFIG_TYPE_UINT16,     // uint16_t
+    R4A_CONFIG_TYPE_UINT32,     // uint32_t
+    R4A_CONFIG_TYPE_STRING,     // const char *
+};
+
+// Describe a persistent value, build with R4A_CONFIG
+typedef struct _R4A_CONFIG_ENTRY
+{
+    const char * key;       // NVS key, 15 characters maximum
+    uint8_t type;           // R4A_CONFIG_TYPE value
+    void * address;         // Address of the variable
+    const char * helpText;  // Description of the value
+    bool secret;            // True to hide the value in the display
+} R4A_CONFIG_ENTRY;
+
+// Select the R4A_CONFIG_TYPE value from the variable type, unsupported
+// variable types fail to compile
+constexpr uint8_t r4aConfigType(bool *) { return R4A_CONFIG_TYPE_BOOL; }
+constexpr uint8_t r4aConfigType(volatile bool *) { return R4A_CONFIG_TYPE_BOOL; }
+constexpr uint8_t r4aConfigType(int8_t *) { return R4A_CONFIG_TYPE_INT8; }
+constexpr uint8_t r4aConfigType(uint8_t *) { return R4A_CONFIG_TYPE_UINT8; }
+constexpr uint8_t r4aConfigType(uint16_t *) { return R4A_CONFIG_TYPE_UINT16; }
+constexpr uint8_t r4aConfigType(uint32_t *) { return R4A_CONFIG_TYPE_UINT32; }
+constexpr uint8_t r4aConfigType(const char ** ) { return R4A_CONFIG_TYPE_STRING; }
+
+// Verify the NVS key length at compile time
+// Inputs:
+//   key: NVS key, 15 characters maximum
+// Outputs:
+//   Returns the key
+template <size_t LENGTH>
+constexpr const char * r4aConfigKey(const char (&key)[LENGTH])
+{
+    static_assert(LENGTH <= 16, "NVS keys are limited to 15 characters");
+    return key;
+}
+
+// Build a configuration table entry
+// Inputs:
+//   key: NVS key, 15 characters maximum
+//   variable: Global variable holding the value
+//   helpText: Description of the value
+#define R4A_CONFIG(key, variable, helpText)     \
+    {r4aConfigKey(key), r4aConfigType(&variable), (void *)&variable, helpText, false}
+
+// Build a configuration table entry for a password or other secret, the
+// value is displayed as asterisks
+// Inputs:
+//   key: NVS key, 15 characters maximum
+//   variable: Global variable holding the value
+//   helpText: Description of the value
+#define R4A_CONFIG_SECRET(key, variable, helpText)  \
+    {r4aConfigKey(key), r4aConfigType(&variable), (void *)&variable, helpText, true}
+
+extern const R4A_CONFIG_ENTRY r4aConfigTable[]; // Library values
+extern const int r4aConfigTableEntries;
+
+// Initialize the configuration store, load the saved values into the
+// variables in the library and application tables
+// Inputs:
+//   appTable: Address of the application table, may be nullptr
+//   appEntries: Number of entries in the application table
+// Outputs:
+//   Returns true if successful and false upon failure
+bool r4aConfigBegin(const R4A_CONFIG_ENTRY * appTable = nullptr,
+                    int appEntries = 0);
+
+// Write the changed values to NVS
+// Outputs:
+//   Returns true if successful and false upon failure
+bool r4aConfigCommit();
+
+// Display the configuration
+// Inputs:
+//   display: Device used for output
+void r4aConfigDisplay(Print * display = &Serial);
+
+// Display a configuration value
+// Inputs:
+//   key: Zero terminated key string
+//   display: Device used for output
+// Outputs:
+//   Returns true if the key was found and false otherwise
+bool r4aConfigGet(const char * key, Print * display = &Serial);
+
+// Set a configuration value, the change is written to NVS by
+// r4aConfigUpdate after R4A_CONFIG_COMMIT_DELAY_MSEC
+// Inputs:
+//   key: Zero terminated key string
+//   value: Zero terminated value string
+//   display: Device used for error output
+// Outputs:
+//   Returns true if the value was set and false upon error
+bool r4aConfigSet(const char * key, const char * value, Print * display = &Serial);
+
+// Detect the changed values and write them to NVS after the changes
+// stop for R4A_CONFIG_COMMIT_DELAY_MSEC, call from the loop.  Values
+// changed by code or the other menus are saved as well.
+void r4aConfigUpdate();
+
 //****************************************
 // Dump Buffer API
 //****************************************
 
+// Position within a streaming buffer dump
+typedef struct _R4A_DUMP_CURSOR
+{
+    uint32_t offset;        // Offset of the next byte to display
+    const uint8_t * buffer; // Address of the next byte to display
+    uint32_t length;        // Number of bytes remaining to display
+} R4A_DUMP_CURSOR;
+
 // Display a buffer contents in hexadecimal and ASCII
 // Inputs:
 //   offset: Offset of the first byte in the buffer, 0 or buffer address
@@ -91,6 +387,33 @@ void r4aDumpBuffer(uint32_t offset,
                    uint32_t length,
                    Print * display = &Serial);
 
+// Start a streaming buffer dump, use r4aDumpBufferContinue to display
+// the data
+// Inputs:
+//   cursor: Address of the cursor to initialize
+//   offset: Offset of the first byte in the buffer, 0 or buffer address
+//   buffer: Address of the buffer containing the data, must remain valid
+//           until the dump completes
+//   length: Length of the buffer in bytes
+void r4aDumpBufferBegin(R4A_DUMP_CURSOR * cursor,
+                        uint32_t offset,
+                        const uint8_t *buffer,
+                        uint32_t length);
+
+// Display the next portion of a streaming buffer dump.  Whole lines are
+// displayed until at least maxBytes are output, allowing a large dump to
+// be spread over multiple calls to loop.
+// Inputs:
+//   cursor: Address of the cursor initialized by r4aDumpBufferBegin
+//   maxBytes: Number of data bytes to display during this call
+//   display: Device used for output
+// Outputs:
+//   Returns true when the dump is complete and false when more data
+//   remains to be displayed
+bool r4aDumpBufferContinue(R4A_DUMP_CURSOR * cursor,
+                           uint32_t maxBytes,
+                           Print * display = &Serial);
+
 //****************************************
 // GNSS API
 //****************************************
@@ -172,16 +495,320 @@ void r4aDumpBuffer(uint32_t offset,
 #define R4A_LED_WHITE_RGBW              0xff000000
 #define R4A_LED_YELLOW                  0x00ffff00
 
+enum R4A_LED_ENCODING
+{
+    R4A_LED_ENCODING_5_BITS = 0,    // 5 SPI bits per LED bit, 4 MHz SPI clock
+    R4A_LED_ENCODING_3_BITS,        // 3 SPI bits per LED bit, 2.86 MHz SPI clock
+    R4A_LED_ENCODING_MAX            // Number of encodings
+};
+
+// SPI clock for each encoding, the range keeps the LED high times within
+// the WS2812 and SK6812 limits, see LED.cpp and
+// extras/tools/LED_3_Bit_Table.py
+#define R4A_LED_3_BITS_CLOCK_HZ         2857143     // 80 MHz / 28
+#define R4A_LED_3_BITS_CLOCK_MIN_HZ     2666667     // 1: 0.75 uSec high
+#define R4A_LED_3_BITS_CLOCK_MAX_HZ     3000000     // 0: 0.67 uSec low
+#define R4A_LED_5_BITS_CLOCK_HZ         4000000
+#define R4A_LED_5_BITS_CLOCK_MIN_HZ     4000000     // 0: 0.5 uSec high
+#define R4A_LED_5_BITS_CLOCK_MAX_HZ     5454545     // 1: 0.55 uSec high
+
 #define R4A_LED_BLUE_SHIFT              0
 #define R4A_LED_GREEN_SHIFT             8
 #define R4A_LED_RED_SHIFT               16
 #define R4A_LED_WHITE_SHIFT             24
 
+// Device that sends the encoded frame to the LEDs
+class R4A_LED_OUTPUT
+{
+  protected:
+
+    uint8_t _bytesPerColor;     // Output bytes for each 8-bit color value
+    uint16_t _resetBytes;       // Zero bytes placed ahead of the color data
+    const uint8_t * _table;     // Color to output bytes, nullptr to copy
+
+  public:
+
+    // Constructor
+    // Inputs:
+    //   bytesPerColor: Number of output bytes for each 8-bit color value
+    //   table: Address of the color to output bytes table, nullptr to
+    //          copy the color value
+    //   resetBytes: Number of zero bytes placed ahead of the color data
+    R4A_LED_OUTPUT(uint8_t bytesPerColor,
+                   const uint8_t * table,
+                   uint16_t resetBytes)
+        : _bytesPerColor{bytesPerColor}, _resetBytes{resetBytes}, _table{table}
+    {
+    }
+
+    // Destructor: Allow the derived classes to release their resources
+    virtual ~R4A_LED_OUTPUT()
+    {
+    }
+
+    // Allocate the frame buffer
+    // Inputs:
+    //   length: Number of data bytes to allocate
+    // Outputs:
+    //   Returns the buffer address if successful and nullptr otherwise
+    virtual uint8_t * allocateBuffer(int length) = 0;
+
+    // Initialize the output device
+    // Outputs:
+    //   Returns true if successful and false upon failure
+    virtual bool begin() = 0;
+
+    // Determine if the previous frame is still being output
+    // Outputs:
+    //   Returns true while the frame buffer is in use
+    virtual bool busy() = 0;
+
+    // Get the number of output bytes for each 8-bit color value
+    // Outputs:
+    //   Returns the number of output bytes
+    uint8_t bytesPerColor()
+    {
+        return _bytesPerColor;
+    }
+
+    // Free the frame buffer
+    // Inputs:
+    //   buffer: Address of the buffer to free
+    virtual void freeBuffer(uint8_t * buffer) = 0;
+
+    // Get the number of zero bytes placed ahead of the color data
+    // Outputs:
+    //   Returns the number of zero bytes
+    uint16_t resetBytes()
+    {
+        return _resetBytes;
+    }
+
+    // Get the color to output bytes table
+    // Outputs:
+    //   Returns the table address or nullptr when the color is copied
+    const uint8_t * table()
+    {
+        return _table;
+    }
+
+    // Start sending the frame to the LEDs
+    // Inputs:
+    //   buffer: Address of the frame buffer
+    //   length: Number of bytes in the frame
+    virtual void write(const uint8_t * buffer, int length) = 0;
+};
+
+// Copy each encoded frame into a capture buffer instead of sending it
+// to the LEDs.  Used to simulate the LEDs and to verify the encoding
+// without the LED hardware.
+class R4A_LED_OUTPUT_CAPTURE : public R4A_LED_OUTPUT
+{
+  private:
+
+    uint8_t * _frame;       // Copy of the last frame written
+    uint32_t _frames;       // Number of frames written
+    int _frameBytes;        // Size of the capture buffer in bytes
+    int _length;            // Number of bytes in the last frame
+
+  public:
+
+    // Constructor
+    // Inputs:
+    //   bytesPerColor: Number of output bytes for each 8-bit color value
+    //   table: Address of the color to output bytes table, nullptr to
+    //          copy the color value
+    //   resetBytes: Number of zero bytes placed ahead of the color data
+    R4A_LED_OUTPUT_CAPTURE(uint8_t bytesPerColor = 1,
+                           const uint8_t * table = nullptr,
+                           uint16_t resetBytes = 0);
+
+    // Destructor: Release the capture buffer
+    ~R4A_LED_OUTPUT_CAPTURE();
+
+    // Get the last frame written
+    // Outputs:
+    //   Returns the address of the frame or nullptr before the first frame
+    const uint8_t * frame()
+    {
+        return _length ? _frame : nullptr;
+    }
+
+    // Get the number of frames written
+    // Outputs:
+    //   Returns the number of frames
+    uint32_t frames()
+    {
+        return _frames;
+    }
+
+    // Get the length of the last frame written
+    // Outputs:
+    //   Returns the number of bytes in the frame
+    int length()
+    {
+        return _length;
+    }
+
+    uint8_t * allocateBuffer(int length);
+    bool begin();
+    bool busy();
+    void freeBuffer(uint8_t * buffer);
+    void write(const uint8_t * buffer, int length);
+};
+
+// Output the LED frame using the RMT peripheral.  The RMT encoder
+// converts the color bytes into symbols as the RMT memory empties, so
+// the frame buffer holds only the color bytes.
+class R4A_LED_OUTPUT_RMT : public R4A_LED_OUTPUT
+{
+  private:
+
+    rmt_channel_handle_t _channel;  // RMT TX channel
+    rmt_encoder_handle_t _encoder;  // Color bytes to symbols encoder
+    uint8_t _pin;                   // Pin connected to the LED data line
+
+  public:
+
+    // Constructor
+    // Inputs:
+    //   pin: Pin number connected to the LED data line
+    R4A_LED_OUTPUT_RMT(uint8_t pin);
+
+    // Destructor: Release the RMT channel and encoder
+    ~R4A_LED_OUTPUT_RMT();
+
+    uint8_t * allocateBuffer(int length);
+    bool begin();
+    bool busy();
+    void freeBuffer(uint8_t * buffer);
+    void write(const uint8_t * buffer, int length);
+};
+
+// Output the LED frame as a SPI bit stream.  The frame is sent in the
+// background when r4aSpi is an R4A_SPI_ESP32, busy returns true until
+// the driver completes the transfer.
+class R4A_LED_OUTPUT_SPI : public R4A_LED_OUTPUT
+{
+  private:
+
+    uint32_t _clockHz;      // SPI clock frequency in Hertz
+    uint8_t _encoding;      // R4A_LED_ENCODING value
+    uint8_t _pinMOSI;       // SPI TX data pin number
+    uint8_t _spiNumber;     // Number of the SPI controller
+
+  public:
+
+    // Constructor
+    // Inputs:
+    //   spiNumber: Number of the SPI bus
+    //   pinMOSI: Pin number of the MOSI pin that connects to the SPI TX data line
+    //   clockHz: SPI clock frequency in Hertz, zero selects the clock for
+    //            the encoding.  begin fails when the clock is outside the
+    //            R4A_LED_*_CLOCK_MIN_HZ - R4A_LED_*_CLOCK_MAX_HZ range.
+    //   encoding: R4A_LED_ENCODING value selecting the SPI bits per LED bit
+    R4A_LED_OUTPUT_SPI(uint8_t spiNumber,
+                       uint8_t pinMOSI,
+                       uint32_t clockHz,
+                       uint8_t encoding = R4A_LED_ENCODING_5_BITS);
+
+    uint8_t * allocateBuffer(int length);
+    bool begin();
+    bool busy();
+    void freeBuffer(uint8_t * buffer);
+    void write(const uint8_t * buffer, int length);
+};
+
+#define R4A_LED_CHANNEL_MILLIAMPS       20      // Current for one color at 255
+#define R4A_LED_DDP_PORT                4048    // DDP UDP port number
+#define R4A_LED_ENCODE_TASK_STACK_SIZE  2048    // Parallel encode task stack
+#define R4A_LED_PARALLEL_MIN_LEDS       32      // Fewer LEDs use one core
+#define R4A_LED_PALETTE_MAX             16      // Maximum palette colors
+
+extern uint32_t * r4aLEDColor;          // Color value for each LED
+extern volatile bool r4aLEDColorWritten; // Set true when a color changes
+extern uint8_t * r4aLEDFourColorsBitmap; // One bit per LED, set for 4 colors
+extern uint8_t r4aLEDIntensity;         // Intensity scaling (0 - 255)
+extern R4A_LED_OUTPUT * r4aLEDOutput;
+extern uint8_t * r4aLEDPaletteIndex;    // Palette index per LED, palette mode
+extern uint16_t r4aLEDs;                // Number of LEDs in the string
+
+// Start the DDP receiver, frames sent by a PC are output to the LEDs
+// Inputs:
+//   port: UDP port number
+// Outputs:
+//   Returns true if successful and false upon failure
+bool r4aLEDDdpBegin(uint16_t port = R4A_LED_DDP_PORT);
+
+// Receive the DDP packets and output the frames, call from loop
+void r4aLEDDdpUpdate();
+
+// Start the task that encodes the second half of the LEDs on the other
+// core.  r4aLEDUpdate then encodes the first half while the task encodes
+// the second half into the following region of the frame buffer.  The
+// frame is output when both halves are done.
+// Inputs:
+//   core: Number of the core running the encode task, the other core
+//         should call r4aLEDUpdate
+//   priority: Priority of the encode task
+// Outputs:
+//   Returns true if successful and false upon failure
+bool r4aLEDEncodeParallel(BaseType_t core = 0, UBaseType_t priority = 2);
+
+// Verify that the parallel encode matches the single core encode.  A
+// test pattern is encoded both ways and the frames are compared.  The
+// current palette selections are used in palette mode.  Call from the
+// task calling r4aLEDUpdate.
+// Inputs:
+//   display: Device used for output
+// Outputs:
+//   Returns true if the frames match and false otherwise
+bool r4aLEDEncodeSelfTest(Print * display = &Serial);
+
+// Switch the LEDs to palette mode.  Each LED selects one of the palette
+// colors.  The palette colors are encoded when the palette or the
+// intensity changes and the frame is built by copying the encoded
+// colors.  The color array is freed, use r4aLEDPaletteSelect instead of
+// r4aLEDSetColorRgb and r4aLEDSetColorWrgb.  r4aLEDsOff selects palette
+// entry 0 which is initially black.
+// Inputs:
+//   entries: Number of palette colors (1 - R4A_LED_PALETTE_MAX)
+// Outputs:
+//   Returns true if successful and false upon failure
+bool r4aLEDPaletteBegin(uint8_t entries);
+
+// Select the palette color for a LED
+// Inputs:
+//   ledNumber: Index into the LED array
+//   paletteIndex: Index into the palette
+void r4aLEDPaletteSelect(uint16_t ledNumber, uint8_t paletteIndex);
+
+// Set a WS2812 palette color
+// Inputs:
+//   paletteIndex: Index into the palette
+//   color: Red bits: 23 - 16, Green bits: 15 - 8, Blue bits; 7 - 0
+void r4aLEDPaletteSetColorRgb(uint8_t paletteIndex, uint32_t color);
+
+// Set a SK6812RGBW palette color
+// Inputs:
+//   paletteIndex: Index into the palette
+//   color: White bits: 31 - 24, Red bits: 23 - 16, Green bits: 15 - 8, Blue bits; 7 - 0
+void r4aLEDPaletteSetColorWrgb(uint8_t paletteIndex, uint32_t color);
+
+// Limit the LED current by reducing the intensity.  The current is
+// estimated from the sum of the color values which is updated as each
+// LED color changes.
+// Inputs:
+//   milliamps: Maximum current for the LEDs, zero disables the limit
+//   channelMilliamps: Current used by one color at full intensity
+void r4aLEDPowerLimit(uint32_t milliamps,
+                      uint8_t channelMilliamps = R4A_LED_CHANNEL_MILLIAMPS);
+
 // Set the WS2812 LED colors
 // Inputs:
 //   ledNumber: Index into the LED color array
 //   color: Red bits: 23 - 16, Green bits: 15 - 8, Blue bits; 7 - 0
-void r4aLEDSetColorRgb(uint8_t ledNumber, uint32_t color);
+void r4aLEDSetColorRgb(uint16_t ledNumber, uint32_t color);
 
 // Set the WS2812 LED colors
 // Inputs:
@@ -189,7 +816,7 @@ void r4aLEDSetColorRgb(uint8_t ledNumber, uint32_t color);
 //   red: Intensity of the red LED
 //   green: Intensity of the green LED
 //   blue: Intensity of the blue LED
-void r4aLEDSetColorRgb(uint8_t ledNumber,
+void r4aLEDSetColorRgb(uint16_t ledNumber,
                        uint8_t red,
                        uint8_t green,
                        uint8_t blue);
@@ -198,7 +825,7 @@ void r4aLEDSetColorRgb(uint8_t ledNumber,
 // Inputs:
 //   ledNumber: Index into the LED color array
 //   color: White bits: 31 - 24, Red bits: 23 - 16, Green bits: 15 - 8, Blue bits; 7 - 0
-void r4aLEDSetColorWrgb(uint8_t ledNumber,
+void r4aLEDSetColorWrgb(uint16_t ledNumber,
                         uint32_t color);
 
 // Set the SK6812RGBW LED colors
@@ -208,7 +835,7 @@ void r4aLEDSetColorWrgb(uint8_t ledNumber,
 //   red: Intensity of the red LED
 //   green: Intensity of the green LED
 //   blue: Intensity of the blue LED
-void r4aLEDSetColorWrgb(uint8_t ledNumber,
+void r4aLEDSetColorWrgb(uint16_t ledNumber,
                         uint8_t white,
                         uint8_t red,
                         uint8_t green,
@@ -219,18 +846,41 @@ void r4aLEDSetColorWrgb(uint8_t ledNumber,
 //   Intensity: A number in the range of (0 - 255), 0 = off, 255 = on full
 void r4aLEDSetIntensity(uint8_t intensity);
 
+// Set the LED color without requesting an update.  Used to assemble a
+// frame from multiple sources, such as DDP packets, before requesting
+// the output.
+// Inputs:
+//   ledNumber: Index into the LED color array
+//   color: White bits: 31 - 24, Red bits: 23 - 16, Green bits: 15 - 8, Blue bits; 7 - 0
+//   fourColors: True for a SK6812RGBW LED, false for a WS2812 LED
+// Outputs:
+//   Returns true if successful and false upon failure
+bool r4aLEDStoreColor(uint16_t ledNumber, uint32_t color, bool fourColors);
+
 // Initialize the WS2812 LEDs
 // Inputs:
 //   spiNumber: Number of the SPI bus
 //   pinMOSI: Pin number of the MOSI pin that connects to the SPI TX data line
-//   ClockHz: SPI clock frequency in Hertz
+//   clockHz: SPI clock frequency in Hertz, zero selects the clock for the
+//            encoding.  The setup fails when the clock is outside the
+//            R4A_LED_*_CLOCK_MIN_HZ - R4A_LED_*_CLOCK_MAX_HZ range.
 //   numberOfLEDs: Number of multi-color LEDs in the string
+//   encoding: R4A_LED_ENCODING value selecting the SPI bits per LED bit
 // Outputs:
 //   Returns true for successful initialization and false upon error
 bool r4aLEDSetup(uint8_t spiNumber,
                  uint8_t pinMOSI,
                  uint32_t clockHz,
-                 uint8_t numberOfLEDs);
+                 uint16_t numberOfLEDs,
+                 uint8_t encoding = R4A_LED_ENCODING_5_BITS);
+
+// Initialize the LEDs
+// Inputs:
+//   output: Address of the LED output device, SPI or RMT
+//   numberOfLEDs: Number of multi-color LEDs in the string
+// Outputs:
+//   Returns true for successful initialization and false upon error
+bool r4aLEDSetup(R4A_LED_OUTPUT * output, uint16_t numberOfLEDs);
 
 // Turn off the LEDs
 void r4aLEDsOff();
@@ -241,6 +891,58 @@ void r4aLEDsOff();
 //                  When false only updates LEDs if color or intensity was changed
 void r4aLEDUpdate(bool updateRequest);
 
+//****************************************
+// Link API
+//****************************************
+
+extern volatile uint32_t r4aLinkGenerationCount; // Link state change count
+extern volatile uint8_t r4aLinkInterfaces;  // Interfaces with IP addresses
+
+// Start monitoring the network link state, subscribes to the network
+// events once
+// Outputs:
+//   Returns true if successful and false upon failure
+bool r4aLinkBegin();
+
+// Get the link generation number, the value changes each time the link
+// goes up or down and is odd while the link is up
+// Outputs:
+//   Returns the current link generation number
+inline uint32_t r4aLinkGeneration()
+{
+    return __atomic_load_n(&r4aLinkGenerationCount, __ATOMIC_ACQUIRE);
+}
+
+// Determine if the network link is available
+// Outputs:
+//   Returns true when an interface has an IP address, false otherwise
+inline bool r4aLinkIsUp()
+{
+    return (__atomic_load_n(&r4aLinkInterfaces, __ATOMIC_ACQUIRE) != 0);
+}
+
+// Determine if the network link is available to a service.  A link that
+// went down and came back up since the previous call is reported as down
+// once, allowing the service to release the connections made on the
+// previous link.
+// Inputs:
+//   linkGeneration: Address of the service's link generation, initialize
+//                   to zero
+// Outputs:
+//   Returns true when the link is up and has stayed up since the previous
+//   call, false otherwise
+inline bool r4aLinkIsUp(uint32_t * linkGeneration)
+{
+    uint32_t generation;
+    bool linkUp;
+
+    // Determine if the link went down since the previous call
+    generation = r4aLinkGeneration();
+    linkUp = (generation & 1) && ((*linkGeneration == 0) || (*linkGeneration == generation));
+    *linkGeneration = linkUp ? generation : 0;
+    return linkUp;
+}
+
 //****************************************
 // Lock API
 //****************************************
@@ -255,6 +957,226 @@ void r4aLockAcquire(volatile int * lock);
 //   lock: Address of the lock
 void r4aLockRelease(volatile int * lock);
 
+//****************************************
+// Log API
+//****************************************
+
+// Log levels, a record is saved when its level is less than or equal to
+// the module's log level
+#define R4A_LOG_LEVEL_NONE      0   // Logging disabled
+#define R4A_LOG_LEVEL_ERROR     1   // Errors
+#define R4A_LOG_LEVEL_WARNING   2   // Warnings
+#define R4A_LOG_LEVEL_INFO      3   // Informational messages
+#define R4A_LOG_LEVEL_DEBUG     4   // Debug messages
+#define R4A_LOG_LEVEL_MAX       5   // Number of log levels
+
+#define R4A_LOG_MAX_ARGS        5   // Maximum number of arguments per record
+#define R4A_LOG_RECORDS         128 // Number of records in the ring, power of 2
+
+// Log record argument value, 32 bits on the ESP32
+typedef uintptr_t R4A_LOG_ARG;
+
+extern volatile uint8_t r4aLogLevel[R4A_MODULE_MAX]; // Log level for each module
+extern Print * volatile r4aLogOutput;   // Device used by the drain task
+extern volatile uint32_t r4aLogDropped; // Number of records discarded due to a full ring
+extern volatile uint32_t r4aLogWritten; // Number of records placed in the ring
+
+// Display the log records
+// Inputs:
+//   display: Device used for output
+//   maxRecords: Maximum number of records to display
+// Outputs:
+//   Returns the number of records displayed
+uint32_t r4aLogDrain(Print * display, uint32_t maxRecords = R4A_LOG_RECORDS);
+
+// Display the log status
+// Inputs:
+//   display: Device used for output
+void r4aLogDisplayStatus(Print * display = &Serial);
+
+// Save a log record in the ring without formatting the output.  The
+// record holds the format address and the argument values, formatting
+// is done later by r4aLogDrain.  Until r4aLogSetup starts the drain task
+// the record is output immediately to r4aLogOutput.  Safe to call from
+// either core.
+// Inputs:
+//   module: Module number (R4A_MODULE_ID) generating the record
+//   level: Log level of the record
+//   format: Address of the zero terminated printf format string, must
+//           remain valid until the record is displayed
+//   args: Address of the array of argument values
+//   argCount: Number of arguments in the array
+// Outputs:
+//   Returns true if the record was saved and false if it was dropped
+bool r4aLogRecord(uint8_t module,
+                  uint8_t level,
+                  const char * format,
+                  const R4A_LOG_ARG * args,
+                  uint8_t argCount);
+
+// Determine if a value may be saved as a log record argument
+// Outputs:
+//   Returns true for an integer, character, enum or pointer type that
+//   fits in R4A_LOG_ARG (4 bytes on the ESP32)
+template<typename ARG>
+constexpr bool r4aLogArgValid()
+{
+    return (std::is_integral<ARG>::value
+            || std::is_enum<ARG>::value
+            || std::is_pointer<ARG>::value)
+        && (sizeof(ARG) <= sizeof(R4A_LOG_ARG));
+}
+
+// Start the log drain task
+// Inputs:
+//   output: Device used for output
+//   core: CPU core used to run the drain task
+//   priority: Priority of the drain task
+// Outputs:
+//   Returns true if the drain task is running and false upon failure
+bool r4aLogSetup(Print * output = &Serial,
+                 BaseType_t core = 0,
+                 UBaseType_t priority = 1);
+
+// Log a message
+// Only integer, character and pointer arguments are supported.  String
+// arguments (%s) must remain valid until the record is displayed.
+// Inputs:
+//   module: Module number (R4A_MODULE_ID) generating the record
+//   level: Log level of the record
+//   format: Address of the zero terminated printf format string
+//   args: Arguments for the format string
+template<typename... ARGS>
+inline void r4aLog(uint8_t module,
+                   uint8_t level,
+                   const char * format,
+                   ARGS... args)
+{
+    static_assert(sizeof...(args) <= R4A_LOG_MAX_ARGS,
+                  "Too many arguments for r4aLog");
+    static_assert((r4aLogArgValid<ARGS>() && ... && true),
+                  "r4aLog arguments must be integers, characters, enums or pointers of at most 32 bits");
+
+    // Only save the records that are enabled
+    if ((module < R4A_MODULE_MAX) && (level <= r4aLogLevel[module]))
+    {
+        const R4A_LOG_ARG values[] = {0, ((R4A_LOG_ARG)args)...};
+        r4aLogRecord(module, level, format, &values[1], sizeof...(args));
+    }
+}
+
+// Log a message at the error, warning, info or debug level, see r4aLog.
+// The arguments are saved and formatted later by the drain task, so the
+// format and each %s argument must point to a string that stays valid
+// and unchanged until the record is output.  Use string literals or
+// static strings, never a local buffer or String::c_str().
+#define r4aLogError(module, format, ...)    r4aLog(module, R4A_LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#define r4aLogWarning(module, format, ...)  r4aLog(module, R4A_LOG_LEVEL_WARNING, format, ##__VA_ARGS__)
+#define r4aLogInfo(module, format, ...)     r4aLog(module, R4A_LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define r4aLogDebug(module, format, ...)    r4aLog(module, R4A_LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+
+//****************************************
+// Memory API
+//****************************************
+
+#define R4A_MEMORY_MAX_TASKS    8   // Maximum number of registered tasks
+
+// Heap usage for a module
+typedef struct _R4A_MEMORY_USAGE
+{
+    uint32_t currentBytes;  // Bytes currently allocated
+    uint32_t peakBytes;     // Maximum number of bytes allocated
+    uint32_t allocations;   // Number of successful allocations
+    uint32_t frees;         // Number of buffers freed
+    uint32_t failures;      // Number of failed allocations
+} R4A_MEMORY_USAGE;
+
+// Stack usage for a task
+typedef struct _R4A_MEMORY_TASK
+{
+    const char * name;      // Name of the task
+    uint8_t module;         // Module (R4A_MODULE_ID) owning the task
+    uint32_t stackFree;     // Minimum number of stack bytes remaining
+} R4A_MEMORY_TASK;
+
+// Memory usage report
+typedef struct _R4A_MEMORY_REPORT
+{
+    uint32_t heapFree;          // Bytes currently available in the heap
+    uint32_t heapMinimumFree;   // Minimum heap bytes available since boot
+    uint32_t heapLargestBlock;  // Largest block that may be allocated
+    R4A_MEMORY_USAGE module[R4A_MODULE_MAX];  // Heap usage by each module
+    uint8_t taskCount;          // Number of valid entries in task
+    R4A_MEMORY_TASK task[R4A_MEMORY_MAX_TASKS]; // Stack usage by task
+} R4A_MEMORY_REPORT;
+
+// Display the memory usage
+// Inputs:
+//   display: Device used for output
+void r4aMemoryDisplay(Print * display = &Serial);
+
+// Get the memory usage
+// Inputs:
+//   report: Address of the buffer to receive the memory usage
+void r4aMemoryGetReport(R4A_MEMORY_REPORT * report);
+
+// Register a task for stack usage reporting
+// Inputs:
+//   module: Module number (R4A_MODULE_ID) owning the task
+//   task: Handle of the task, nullptr for the calling task
+// Outputs:
+//   Returns true if the task was registered and false if the task list
+//   is full
+bool r4aMemoryRegisterTask(uint8_t module, TaskHandle_t task = nullptr);
+
+// Remove a task from stack usage reporting, call before deleting the task
+// Inputs:
+//   task: Handle of the task, nullptr for the calling task
+void r4aMemoryRemoveTask(TaskHandle_t task = nullptr);
+
+// Free a buffer allocated by r4aMalloc
+// Inputs:
+//   buffer: Address of the buffer to free, may be nullptr
+void r4aFree(void * buffer);
+
+// Allocate a buffer from the heap and account for it by module
+// Inputs:
+//   module: Module number (R4A_MODULE_ID) allocating the buffer
+//   length: Number of bytes to allocate
+// Outputs:
+//   Returns the address of the buffer or nullptr upon failure
+void * r4aMalloc(uint8_t module, size_t length);
+
+// Delete an object allocated by r4aNew
+// Inputs:
+//   object: Address of the object to delete, may be nullptr
+template<typename TYPE>
+inline void r4aDelete(TYPE * object)
+{
+    if (object)
+    {
+        object->~TYPE();
+        r4aFree((void *)object);
+    }
+}
+
+// Allocate and construct an object, account for it by module
+// Inputs:
+//   module: Module number (R4A_MODULE_ID) allocating the object
+//   args: Arguments for the constructor
+// Outputs:
+//   Returns the address of the object or nullptr upon failure
+template<typename TYPE, typename... ARGS>
+inline TYPE * r4aNew(uint8_t module, ARGS&&... args)
+{
+    void * buffer;
+
+    buffer = r4aMalloc(module, sizeof(TYPE));
+    if (!buffer)
+        return nullptr;
+    return new (buffer) TYPE(std::forward<ARGS>(args)...);
+}
+
 //****************************************
 // Menu API
 //****************************************
@@ -284,6 +1206,41 @@ typedef void (*R4A_MENU_ROUTINE)(const struct _R4A_MENU_ENTRY * menuEntry,
                                  const char * command,
                                  Print * display);
 
+enum
+{
+    R4A_MENU_ASYNC_RUNNING = 0, // Call again in this time slice
+    R4A_MENU_ASYNC_DONE,        // Command complete
+    R4A_MENU_ASYNC_WAIT,        // Call again in the next time slice
+};
+
+// Process a long running menu item in slices.  The routine is called
+// repeatedly until it returns R4A_MENU_ASYNC_DONE.  The first call passes
+// the command line and a state value of zero, the following calls pass a
+// nullptr command.  The routine saves its progress in the state value,
+// which may hold an address of an allocated object.  Output is sent to
+// the display as it is generated, R4A_MENU_ASYNC_WAIT ends the time slice
+// while waiting for the output to drain or for the user.
+//
+// When the user enters another command the routine is called with cancel
+// set to true and the command.  The routine returns R4A_MENU_ASYNC_DONE
+// to end or R4A_MENU_ASYNC_WAIT to consume the input and continue.  When
+// the session ends the routine is called with cancel set to true and a
+// nullptr command and display, it must release its resources.
+// Inputs:
+//   menuEntry: Address of the menu entry associated with the command
+//   command: Full command line on the first call and when cancelled,
+//            nullptr otherwise
+//   display: Address of the Print object for output
+//   state: Address of the value holding the command state
+//   cancel: True when the command is cancelled
+// Outputs:
+//   Returns the R4A_MENU_ASYNC_* status
+typedef int (*R4A_MENU_ASYNC_ROUTINE)(const struct _R4A_MENU_ENTRY * menuEntry,
+                                       const char * command,
+                                       Print * display,
+                                       intptr_t * state,
+                                       bool cancel);
+
 // Display help for a menu item
 // Inputs:
 //   menuEntry: Address of the menu entry to display help
@@ -301,14 +1258,45 @@ typedef struct _R4A_MENU_ENTRY
     R4A_HELP_ROUTINE helpRoutine;   // Routine to display the help message
     int align;                      // Command length adjustment for alignment
     const char * helpText;          // Help text to display
+    R4A_MENU_ASYNC_ROUTINE asyncRoutine; // Long running command, used
+                                         // instead of menuRoutine
 } R4A_MENU_ENTRY;
 
-class R4A_MENU
+// Menu tracing is removed from the build unless R4A_MENU_DEBUG is set to
+// 1 in the build flags.  When built, the trace records are saved in the
+// log ring (R4A_MODULE_MENU at R4A_LOG_LEVEL_DEBUG) for the menus with
+// debugging enabled.
+#ifndef R4A_MENU_DEBUG
+#define R4A_MENU_DEBUG          0
+#endif  // R4A_MENU_DEBUG
+
+#if R4A_MENU_DEBUG
+#define R4A_MENU_TRACE(debug, format, ...)                          \
+    do                                                              \
+    {                                                               \
+        if (debug)                                                  \
+            r4aLogDebug(R4A_MODULE_MENU, format, ##__VA_ARGS__);    \
+    } while (0)
+#else   // R4A_MENU_DEBUG
+#define R4A_MENU_TRACE(debug, format, ...)      do {} while (0)
+#endif  // R4A_MENU_DEBUG
+
+#define R4A_MENU_ASYNC_BUDGET_USEC  2000    // Time per update for long commands
+
+// Per-session menu state
+typedef struct _R4A_MENU_CURSOR
 {
-  private:
+    const R4A_MENU_TABLE * menu;        // Current menu, nullptr selects the main menu
+    const R4A_MENU_ENTRY * asyncEntry;  // Running long command, nullptr when idle
+    intptr_t asyncState;                // State of the long command
+} R4A_MENU_CURSOR;
+
+// Menu description shared by all of the sessions.  Each session only
+// needs a R4A_MENU_CURSOR to hold its position in the menu system.
+class R4A_MENU_COMPILED
+{
+  protected:
 
-    bool _debug;                     // Set true to enable debugging
-    const R4A_MENU_TABLE * _menu;            // Current menu to display and use
     const R4A_MENU_TABLE * const _menuTable; // Address of all menu descriptions
     const int _menuTableEntries;             // Number of entries in the menu table
 
@@ -320,6 +1308,65 @@ class R4A_MENU
     bool _alignCommands;                // Align the commands
     bool _blankLineAfterMenu;           // Display a blank line after the menu
 
+    // Constructor
+    // Inputs:
+    //   menuTable: Address of table containing the menu descriptions, the
+    //              main menu must be the first entry in the table.
+    //   menuEntries: Number of entries in the menu table
+    //   blankLineBeforePreMenu: Display a blank line before the preMenu
+    //   blankLineBeforeMenuHeader: Display a blank line before the menu header
+    //   blankLineAfterMenuHeader: Display a blank line after the menu header
+    //   alignCommands: Align the commands
+    //   blankLineAfterMenu: Display a blank line after the menu
+    R4A_MENU_COMPILED(const R4A_MENU_TABLE * menuTable,
+                      int menuEntries,
+                      bool blankLineBeforePreMenu = true,
+                      bool blankLineBeforeMenuHeader = true,
+                      bool blankLineAfterMenuHeader = false,
+                      bool alignCommands = true,
+                      bool blankLineAfterMenu = false);
+
+    // Process a menu command when specified or display the menu when command
+    // is nullptr.
+    // Inputs:
+    //   cursor: Address of the session's current menu
+    //   command: Command string
+    //   display: Address of the Print object for output
+    //   debug: Set true to save the trace records when R4A_MENU_DEBUG is set
+    // Outputs:
+    //   True when exiting the menu system, false if still in the menu system
+    bool process(R4A_MENU_CURSOR * cursor,
+                 const char * command,
+                 Print * display = &Serial,
+                 bool debug = false) const;
+
+    // Cancel the long command
+    // Inputs:
+    //   cursor: Address of the session's current menu
+    //   display: Address of the Print object for output, may be nullptr
+    //            when the session has ended
+    void cancel(R4A_MENU_CURSOR * cursor, Print * display = nullptr) const;
+
+    // Run the long command for a time slice, display the menu when the
+    // command completes
+    // Inputs:
+    //   cursor: Address of the session's current menu
+    //   display: Address of the Print object for output
+    // Outputs:
+    //   Returns true while the long command is running
+    bool update(R4A_MENU_CURSOR * cursor, Print * display = &Serial) const;
+};
+
+// Menu with a single session
+class R4A_MENU : public R4A_MENU_COMPILED
+{
+  private:
+
+    bool _debug;                     // Set true to enable debugging
+    R4A_MENU_CURSOR _menu;           // Current menu to display and use
+
+  public:
+
     // Constructor
     // Inputs:
     //   menuTable: Address of table containing the menu descriptions, the
@@ -338,7 +1385,7 @@ class R4A_MENU
             bool alignCommands = true,
             bool blankLineAfterMenu = false);
 
-    // Enable or disable debugging
+    // Enable or disable the trace records, see R4A_MENU_DEBUG
     // Inputs:
     //   enable: Set true to enable debugging, false disables debugging
     void debug(bool enable);
@@ -358,6 +1405,14 @@ class R4A_MENU
     //   True when exiting the menu system, false if still in the menu system
     bool process(const char * command,
                  Print * display = &Serial);
+
+    // Run the long command for a time slice, display the menu when the
+    // command completes
+    // Inputs:
+    //   display: Address of the Print object for output
+    // Outputs:
+    //   Returns true while the long command is running
+    bool update(Print * display = &Serial);
 };
 
 // Display the boolean as enabled or disabled
@@ -381,17 +1436,257 @@ void r4aMenuBoolToggle(const R4A_MENU_ENTRY * menuEntry,
 // Inputs:
 //   menuEntry: Address of the object describing the menu entry
 //   command: Zero terminated command string
+[[deprecated("Use r4aMenuGetParameters with a buffer or length instead.")]]
 String r4aMenuGetParameters(const struct _R4A_MENU_ENTRY * menuEntry,
                             const char * command);
 
+// Locate the parameters in the command without copying them
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   length: Address of the value to receive the length of the parameters
+//           without the trailing white space
+// Outputs:
+//   Returns the address of the first parameter character in the command
+const char * r4aMenuGetParameters(const struct _R4A_MENU_ENTRY * menuEntry,
+                                  const char * command,
+                                  size_t * length);
+
+// Copy the parameters into a buffer without the leading and trailing
+// white space, long parameters are truncated
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   buffer: Address of the buffer to receive the zero terminated parameters
+//   bufferLength: Number of bytes in the buffer
+// Outputs:
+//   Returns the address of the buffer
+char * r4aMenuGetParameters(const struct _R4A_MENU_ENTRY * menuEntry,
+                            const char * command,
+                            char * buffer,
+                            size_t bufferLength);
+
 // Display the menu item with a suffix and help text
 // Inputs:
 //   menuEntry: Address of the object describing the menu entry
-//   align: Zero terminated string of spaces for alignment
+//   align: Zero terminated string of spaces for alignment
+//   display: Device used for output
+void r4aMenuHelpSuffix(const struct _R4A_MENU_ENTRY * menuEntry,
+                       const char * align,
+                       Print * display);
+
+#define R4A_MENU_PAGER_LINES        20      // Default items per page
+#define R4A_MENU_PAGER_WRITE_BYTES  128     // Output space needed for an item
+
+extern uint8_t r4aMenuPagerLines;   // Items per page, zero disables the prompt
+
+// Display the next item of a paged list
+// Inputs:
+//   menuEntry: Address of the menu entry associated with the command
+//   display: Address of the Print object for output
+//   position: Address of the list position, zero for the first item
+// Outputs:
+//   Returns true when an item was displayed and false at the end of the list
+typedef bool (*R4A_MENU_PAGER_ITERATOR)(const struct _R4A_MENU_ENTRY * menuEntry,
+                                        Print * display,
+                                        intptr_t * position);
+
+// Display a list one item at a time as the output drains.  The menu
+// parameter holds the R4A_MENU_PAGER_ITERATOR for the list.  A --More--
+// prompt is displayed after r4aMenuPagerLines items, the Enter key
+// displays the next page and other input ends the list.  Use as the
+// asyncRoutine in the menu entry.
+// Inputs:
+//   menuEntry: Address of the menu entry associated with the command
+//   command: Full command line on the first call and when cancelled,
+//            nullptr otherwise
+//   display: Address of the Print object for output
+//   state: Address of the value holding the pager state
+//   cancel: True when the command is cancelled
+// Outputs:
+//   Returns the R4A_MENU_ASYNC_* status
+int r4aMenuPager(const struct _R4A_MENU_ENTRY * menuEntry,
+                 const char * command,
+                 Print * display,
+                 intptr_t * state,
+                 bool cancel);
+
+//****************************************
+// Bluetooth Menu API
+//****************************************
+
+#define R4A_BLUETOOTH_COMMAND_BYTES 128     // Longest command line
+#define R4A_BLUETOOTH_READ_BYTES    64      // Bytes read from the port at once
+#define R4A_BLUETOOTH_WRITE_BYTES   512     // Output buffer size
+
+// Bluetooth console, the output is collected and sent to the SPP port
+// as a single write after each command response
+class R4A_BLUETOOTH_CONSOLE : public Print
+{
+  private:
+
+    char _command[R4A_BLUETOOTH_COMMAND_BYTES]; // Command being received
+    size_t _commandLength;      // Number of bytes in the command
+    bool _connected;            // True while a session is active
+    R4A_MENU_CURSOR _cursor;    // Position in the menu system
+    bool _echo;                 // Echo the input characters
+    R4A_MENU_COMPILED _menu;    // Menu description
+    BluetoothSerial * _port;    // Bluetooth serial port
+    uint8_t _writeBuffer[R4A_BLUETOOTH_WRITE_BYTES]; // Output buffer
+    size_t _writeLength;        // Number of bytes in the output buffer
+
+    // Process the input from the Bluetooth client
+    // Outputs:
+    //   Returns true when the client exits the menu system and false
+    //   otherwise
+    bool processInput();
+
+    // Start a session when the client connects
+    void sessionBegin();
+
+    // End the session when the client disconnects
+    void sessionEnd();
+
+  public:
+
+    // Constructor
+    // Inputs:
+    //   port: Address of a BluetoothSerial object
+    //   menuTable: Address of table containing the menu descriptions, the
+    //              main menu must be the first entry in the table.
+    //   menuTableEntries: Number of entries in the menu table
+    //   echo: Echo the input characters
+    R4A_BLUETOOTH_CONSOLE(BluetoothSerial * port,
+                          const R4A_MENU_TABLE * menuTable,
+                          int menuTableEntries,
+                          bool echo = true);
+
+    // Destructor
+    ~R4A_BLUETOOTH_CONSOLE();
+
+    // Send the buffered output to the Bluetooth client
+    void flush();
+
+    // Determine if a client is connected
+    // Outputs:
+    //   Returns true when a session is active
+    bool isConnected();
+
+    // Process the Bluetooth client connection and input, call from loop
+    // Outputs:
+    //   Returns true when the client exits the menu system and false
+    //   otherwise
+    bool update();
+
+    // Add a byte to the output buffer
+    // Inputs:
+    //   data: Byte to add
+    // Outputs:
+    //   Returns the number of bytes written
+    size_t write(uint8_t data);
+
+    // Add data to the output buffer
+    // Inputs:
+    //   buffer: Address of the data
+    //   length: Number of bytes to add
+    // Outputs:
+    //   Returns the number of bytes written
+    size_t write(const uint8_t * buffer, size_t length);
+};
+
+//****************************************
+// Capture Menu API
+//****************************************
+
+extern const R4A_MENU_ENTRY r4aCaptureMenuTable[];
+#define R4A_CAPTURE_MENU_ENTRIES    5
+
+// Discard the captured data
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   display: Device used for output
+void r4aCaptureMenuClear(const R4A_MENU_ENTRY * menuEntry,
+                         const char * command,
+                         Print * display);
+
+// Display the captured data
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   display: Device used for output
+void r4aCaptureMenuDisplay(const R4A_MENU_ENTRY * menuEntry,
+                           const char * command,
+                           Print * display);
+
+// Display the captured data one record per call, used as a long running
+// menu command
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string on the first call, nullptr
+//            afterwards
+//   display: Device used for output
+//   state: Address of the value holding the end of the displayed records
+//   cancel: True when the command is cancelled
+// Outputs:
+//   Returns the R4A_MENU_ASYNC_* status
+int r4aCaptureMenuDisplayAsync(const R4A_MENU_ENTRY * menuEntry,
+                               const char * command,
+                               Print * display,
+                               intptr_t * state,
+                               bool cancel);
+
+// Display the capture status
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   display: Device used for output
+void r4aCaptureMenuStatus(const R4A_MENU_ENTRY * menuEntry,
+                          const char * command,
+                          Print * display);
+
+//****************************************
+// Config Menu API
+//****************************************
+
+extern const R4A_MENU_ENTRY r4aConfigMenuTable[];
+#define R4A_CONFIG_MENU_ENTRIES     5
+
+// Display a configuration value
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   display: Device used for output
+void r4aConfigMenuGet(const R4A_MENU_ENTRY * menuEntry,
+                      const char * command,
+                      Print * display);
+
+// Display the configuration
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   display: Device used for output
+void r4aConfigMenuList(const R4A_MENU_ENTRY * menuEntry,
+                       const char * command,
+                       Print * display);
+
+// Write the configuration changes to NVS
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   display: Device used for output
+void r4aConfigMenuSave(const R4A_MENU_ENTRY * menuEntry,
+                       const char * command,
+                       Print * display);
+
+// Set a configuration value
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
 //   display: Device used for output
-void r4aMenuHelpSuffix(const struct _R4A_MENU_ENTRY * menuEntry,
-                       const char * align,
-                       Print * display);
+void r4aConfigMenuSet(const R4A_MENU_ENTRY * menuEntry,
+                      const char * command,
+                      Print * display);
 
 //****************************************
 // LED Menu API
@@ -427,6 +1722,17 @@ void r4aLEDMenuDisplay(const R4A_MENU_ENTRY * menuEntry,
                        const char * command,
                        Print * display);
 
+// Display the next line of the LED status, used with r4aMenuPager
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   display: Device used for output
+//   position: Address of the line number, zero for the first line
+// Outputs:
+//   Returns true when a line was displayed and false at the end
+bool r4aLEDMenuDisplayItem(const R4A_MENU_ENTRY * menuEntry,
+                           Print * display,
+                           intptr_t * position);
+
 // Display the help text with iii
 // Inputs:
 //   menuEntry: Address of the object describing the menu entry
@@ -461,6 +1767,193 @@ void r4aLEDMenuIntensity(const R4A_MENU_ENTRY * menuEntry, const char * command,
 //   display: Device used for output
 void r4aLEDMenuOff(const R4A_MENU_ENTRY * menuEntry, const char * command, Print * display);
 
+// Verify the parallel LED encode
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   display: Device used for output
+void r4aLEDMenuSelfTest(const R4A_MENU_ENTRY * menuEntry, const char * command, Print * display);
+
+//****************************************
+// Log Menu API
+//****************************************
+
+extern const R4A_MENU_ENTRY r4aLogMenuTable[];
+#define R4A_LOG_MENU_ENTRIES    4
+
+// Display the log records
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   display: Device used for output
+void r4aLogMenuDrain(const R4A_MENU_ENTRY * menuEntry,
+                     const char * command,
+                     Print * display);
+
+// Display the log status
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   display: Device used for output
+void r4aLogMenuDisplay(const R4A_MENU_ENTRY * menuEntry,
+                       const char * command,
+                       Print * display);
+
+// Set the log level for a module
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   display: Device used for output
+void r4aLogMenuLevel(const R4A_MENU_ENTRY * menuEntry,
+                     const char * command,
+                     Print * display);
+
+//****************************************
+// Memory Menu API
+//****************************************
+
+// Display the memory usage
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   display: Device used for output
+void r4aMemoryMenuDisplay(const R4A_MENU_ENTRY * menuEntry,
+                          const char * command,
+                          Print * display);
+
+//****************************************
+// Metrics API
+//****************************************
+
+#define R4A_METRIC_COUNTER      0   // Value only increases
+#define R4A_METRIC_GAUGE        1   // Value increases and decreases
+#define R4A_METRIC_HISTOGRAM    2   // Counts of values within buckets
+
+// A metric registers itself during construction, declare metrics as
+// global or static objects.  Updates use atomic operations and are safe
+// from either core.
+class R4A_METRIC
+{
+  public:
+
+    R4A_METRIC * _next;         // Next metric in the registry
+    const char * const _name;   // Metric name, [a-z_]
+    const char * const _help;   // Description of the metric
+    const char * const _labels; // Prometheus labels, nullptr or empty for none
+    const uint8_t _type;        // Metric type
+    const uint8_t _bucketCount; // Number of bucket bounds for a histogram
+    const int32_t * const _bounds;  // Ascending bucket upper bounds
+    uint32_t * const _buckets;  // _bucketCount + 1 bucket counts
+    volatile int32_t _value;    // Counter or gauge value, histogram count
+    volatile int64_t _sum;      // Sum of the histogram values
+
+    // Constructor: Create and register a counter or gauge
+    // Inputs:
+    //   name: Zero terminated metric name
+    //   help: Zero terminated description of the metric
+    //   type: R4A_METRIC_COUNTER or R4A_METRIC_GAUGE
+    //   labels: Address of the zero terminated labels, such as port="23",
+    //           used to separate the metrics with the same name.  The
+    //           labels may be changed until the metrics are output.
+    R4A_METRIC(const char * name,
+               const char * help,
+               uint8_t type,
+               const char * labels = nullptr);
+
+    // Constructor: Create and register a histogram
+    // Inputs:
+    //   name: Zero terminated metric name
+    //   help: Zero terminated description of the metric
+    //   bounds: Address of an array of ascending bucket upper bounds
+    //   bucketCount: Number of entries in the bounds array, a histogram
+    //                without bounds is logged as an error and not output
+    //   buckets: Address of an array of bucketCount + 1 bucket counts
+    R4A_METRIC(const char * name,
+               const char * help,
+               const int32_t * bounds,
+               uint8_t bucketCount,
+               uint32_t * buckets);
+
+    // Destructor: Remove the metric from the registry, waits while
+    // another task is outputting the metrics
+    ~R4A_METRIC();
+
+    // Add to a counter or gauge
+    // Inputs:
+    //   value: Value to add
+    inline void add(int32_t value = 1)
+    {
+        __atomic_fetch_add(&_value, value, __ATOMIC_RELAXED);
+    }
+
+    // Add a value to a histogram
+    // Inputs:
+    //   value: Value to add to the histogram
+    void observe(int32_t value);
+
+    // Set the gauge value
+    // Inputs:
+    //   value: New gauge value
+    inline void set(int32_t value)
+    {
+        __atomic_store_n(&_value, value, __ATOMIC_RELAXED);
+    }
+
+    // Subtract from a gauge
+    // Inputs:
+    //   value: Value to subtract
+    inline void subtract(int32_t value = 1)
+    {
+        __atomic_fetch_sub(&_value, value, __ATOMIC_RELAXED);
+    }
+};
+
+// Create the metrics context for a network client
+// Inputs:
+//   client: Address of a NetworkClient object
+//   contextData: Buffer to receive the address of the context
+// Outputs:
+//   Returns true if the routine was successful and false upon failure.
+bool r4aMetricsContextCreate(NetworkClient * client, void ** contextData);
+
+// Delete the metrics context
+// Inputs:
+//   contextData: Address of the context allocated by r4aMetricsContextCreate
+void r4aMetricsContextDelete(void * contextData);
+
+// Display the metrics
+// Inputs:
+//   display: Device used for output
+void r4aMetricsDisplay(Print * display = &Serial);
+
+// Serve the metrics to a HTTP client.  Use with R4A_TELNET_SERVER to
+// provide the Prometheus endpoint:
+//     R4A_TELNET_SERVER metricsServer(2,
+//                                     r4aMetricsProcessInput,
+//                                     r4aMetricsContextCreate,
+//                                     r4aMetricsContextDelete);
+// Inputs:
+//   client: Address of a NetworkClient object
+//   contextData: Address of the context allocated by r4aMetricsContextCreate
+// Outputs:
+//   Returns true when the response is complete and the client
+//   connection should be closed
+bool r4aMetricsProcessInput(NetworkClient * client, void * contextData);
+
+// Output the metrics in the Prometheus text format
+// Inputs:
+//   output: Device used for output
+void r4aMetricsPrometheus(Print * output);
+
+// Display the metrics
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   display: Device used for output
+void r4aMetricsMenuDisplay(const R4A_MENU_ENTRY * menuEntry,
+                           const char * command,
+                           Print * display);
+
 //****************************************
 // NTP API
 //****************************************
@@ -473,13 +1966,26 @@ extern bool r4aNtpOnline; // Set true while client is connected to NTP server
 //   display: Device used for output
 void r4aNtpDisplayDateTime(Print * display = &Serial);
 
+#define R4A_NTP_STRING_BYTES    16  // Buffer size for the date and time strings
+
 // Get the date string
 // Inputs:
 //   seconds: The number of seconds from 1 Jan 1970
 // Outputs:
 //   Returns the date as yyyy-mm-dd or "Time not set"
+[[deprecated("Use r4aNtpGetDate with a buffer instead.")]]
 String r4aNtpGetDate(uint32_t seconds);
 
+// Get the date string
+// Inputs:
+//   seconds: The number of seconds from 1 Jan 1970
+//   buffer: Address of the buffer to receive the date
+//   bufferLength: Number of bytes in the buffer, R4A_NTP_STRING_BYTES
+// Outputs:
+//   Returns the buffer address, containing the date as yyyy-mm-dd or
+//   "Time not set"
+const char * r4aNtpGetDate(uint32_t seconds, char * buffer, size_t bufferLength);
+
 // Get the number of seconds from 1 Jan 1970
 // Outputs:
 //   Returns the number of seconds from 1 Jan 1970
@@ -488,18 +1994,50 @@ uint32_t r4aNtpGetEpochTime();
 // Get the time as hh:mm:ss
 // Outputs:
 //   Returns time as hh:mm:ss or "Time not set"
+[[deprecated("Use r4aNtpGetTime with a buffer instead.")]]
 String r4aNtpGetTime();
 
+// Get the time as hh:mm:ss
+// Inputs:
+//   buffer: Address of the buffer to receive the time
+//   bufferLength: Number of bytes in the buffer, R4A_NTP_STRING_BYTES
+// Outputs:
+//   Returns the buffer address, containing the time as hh:mm:ss or
+//   "Time not set"
+const char * r4aNtpGetTime(char * buffer, size_t bufferLength);
+
 // Get the time string in 12 hour format
 // Outputs:
 //   Returns time as hh:mm:ss xM or "Time not set"
+[[deprecated("Use r4aNtpGetTime12 with a buffer instead.")]]
 String r4aNtpGetTime12(uint32_t seconds);
 
+// Get the time string in 12 hour format
+// Inputs:
+//   seconds: The number of seconds from 1 Jan 1970
+//   buffer: Address of the buffer to receive the time
+//   bufferLength: Number of bytes in the buffer, R4A_NTP_STRING_BYTES
+// Outputs:
+//   Returns the buffer address, containing the time as hh:mm:ss xM or
+//   "Time not set"
+const char * r4aNtpGetTime12(uint32_t seconds, char * buffer, size_t bufferLength);
+
 // Get the time string in 24 hour format
 // Outputs:
 //   Returns time as hh:mm:ss or "Time not set"
+[[deprecated("Use r4aNtpGetTime24 with a buffer instead.")]]
 String r4aNtpGetTime24(uint32_t seconds);
 
+// Get the time string in 24 hour format
+// Inputs:
+//   seconds: The number of seconds from 1 Jan 1970
+//   buffer: Address of the buffer to receive the time
+//   bufferLength: Number of bytes in the buffer, R4A_NTP_STRING_BYTES
+// Outputs:
+//   Returns the buffer address, containing the time as hh:mm:ss or
+//   "Time not set"
+const char * r4aNtpGetTime24(uint32_t seconds, char * buffer, size_t bufferLength);
+
 // Determine if the time is valid
 // Outputs:
 //   Returns true when the time and date are valid
@@ -521,6 +2059,10 @@ void r4aNtpSetup(long timeZoneOffsetSeconds, bool displayInitialTime);
 //   wifiConnected: True when WiFi is connected to an access point, false otherwise
 void r4aNtpUpdate(bool wifiConnected);
 
+// Update the NTP client and system time using the link state from
+// r4aLinkBegin
+void r4aNtpUpdate();
+
 //****************************************
 // NTRIP Client
 //****************************************
@@ -609,6 +2151,7 @@ class R4A_NTRIP_CLIENT
 
     // The network connection to the NTRIP caster to obtain RTCM data.
     NetworkClient * _client;
+    uint32_t _linkGeneration;   // Link generation of the caster connection
     volatile uint8_t _state;
 
     // Throttle the time between connection attempts
@@ -690,6 +2233,9 @@ class R4A_NTRIP_CLIENT
     // _receeiveTimeout
     void update(bool wifiConnected);
 
+    // Update the NTRIP client using the link state from r4aLinkBegin
+    void update();
+
     // Verify the NTRIP client tables
     void validateTables();
 };
@@ -712,6 +2258,7 @@ extern const R4A_MENU_ENTRY r4aNtripClientMenuTable[];
 //   port: Address of a Bluetooth serial port structure
 // Outputs:
 //   nullptr when the line is not complete
+[[deprecated("Use r4aReadLine with a character array instead.")]]
 String * r4aReadLine(bool echo, String * buffer, BluetoothSerial * port);
 
 // Read a line of input from a serial port into a character array
@@ -721,6 +2268,7 @@ String * r4aReadLine(bool echo, String * buffer, BluetoothSerial * port);
 //   port: Address of a HardwareSerial port structure
 // Outputs:
 //   nullptr when the line is not complete
+[[deprecated("Use r4aReadLine with a character array instead.")]]
 String * r4aReadLine(bool echo, String * buffer, HardwareSerial * port = &Serial);
 
 // Read a line of input from a WiFi client into a character array
@@ -730,8 +2278,24 @@ String * r4aReadLine(bool echo, String * buffer, HardwareSerial * port = &Serial
 //   port: Address of a NetworkClient port structure
 // Outputs:
 //   nullptr when the line is not complete
+[[deprecated("Use r4aReadLine with a character array instead.")]]
 String * r4aReadLine(bool echo, String * buffer, NetworkClient * port);
 
+// Read a line of input from a stream into a character array.  The
+// partial line is kept in the buffer between calls, set buffer[0] to
+// zero before the first call and after processing each line.  A bell is
+// output when the line does not fit in the buffer.
+// Inputs:
+//   echo: Specify true to enable echo of input characters and false otherwise
+//   buffer: Address of a zero terminated character array holding the line
+//   bufferLength: Number of bytes in the buffer
+//   port: Address of a Stream object, such as Serial, a BluetoothSerial
+//         or a NetworkClient
+// Outputs:
+//   Returns the buffer address when the line is complete and nullptr
+//   when the line is not complete
+char * r4aReadLine(bool echo, char * buffer, size_t bufferLength, Stream * port);
+
 //****************************************
 // Robot Challenge class
 //****************************************
@@ -910,14 +2474,240 @@ bool r4aBluetoothMenu(R4A_MENU * menu, BluetoothSerial * port);
 //   menu: Address of the menu object
 void r4aSerialMenu(R4A_MENU * menu);
 
+#define R4A_SERIAL_COMMAND_BYTES    128     // Longest command line
+#define R4A_SERIAL_EVENT_QUEUE      16      // UART driver events
+#define R4A_SERIAL_PATTERN_QUEUE    8       // Pending command lines
+#define R4A_SERIAL_RX_BYTES         512     // UART driver receive buffer
+#define R4A_SERIAL_TX_BYTES         1024    // UART driver transmit buffer
+
+// Serial console using the UART driver.  The UART detects the carriage
+// return and the console reads the complete command line at once from
+// the UART driver's buffer.  No work is done while waiting for input.
+// The UART pattern detection matches a single character, so the
+// terminal must end each line with a carriage return (CR or CR LF),
+// lines ending with only a linefeed are not detected.  The linefeed
+// following the carriage return is removed from the next line.  The
+// input characters are not echoed until the line is complete, use
+// the terminal's local echo.  The UART must not be used by a
+// HardwareSerial object, call Serial.end() before begin when using the
+// console on UART 0.
+class R4A_SERIAL_CONSOLE : public Print
+{
+  private:
+
+    char _command[R4A_SERIAL_COMMAND_BYTES]; // Command being processed
+    R4A_MENU_CURSOR _cursor;    // Position in the menu system
+    bool _echo;                 // Echo the command line
+    QueueHandle_t _eventQueue;  // UART driver events
+    bool _installed;            // True when the UART driver is installed
+    R4A_MENU_COMPILED _menu;    // Menu description
+    uart_port_t _port;          // UART number
+
+    // Read a command line from the UART driver
+    // Inputs:
+    //   length: Number of bytes in the line including the carriage return
+    // Outputs:
+    //   Returns true when the command fits in the buffer and false otherwise
+    bool readLine(int length);
+
+  public:
+
+    // Constructor
+    // Inputs:
+    //   port: UART number
+    //   menuTable: Address of table containing the menu descriptions, the
+    //              main menu must be the first entry in the table.
+    //   menuTableEntries: Number of entries in the menu table
+    //   echo: Echo the command line after it is received
+    R4A_SERIAL_CONSOLE(uart_port_t port,
+                       const R4A_MENU_TABLE * menuTable,
+                       int menuTableEntries,
+                       bool echo = false);
+
+    // Destructor
+    ~R4A_SERIAL_CONSOLE();
+
+    // Determine the space available in the transmit buffer
+    // Outputs:
+    //   Returns the number of bytes available
+    int availableForWrite();
+
+    // Install the UART driver and display the menu
+    // Inputs:
+    //   baudRate: Speed of the serial port
+    //   txPin: Transmit pin number, UART_PIN_NO_CHANGE for the default
+    //   rxPin: Receive pin number, UART_PIN_NO_CHANGE for the default
+    // Outputs:
+    //   Returns true if successful and false upon failure
+    bool begin(int baudRate = 115200,
+               int txPin = UART_PIN_NO_CHANGE,
+               int rxPin = UART_PIN_NO_CHANGE);
+
+    // Process the UART events and the command lines, call from loop
+    // Outputs:
+    //   Returns true when the user exits the menu system and false
+    //   otherwise
+    bool update();
+
+    // Send a byte to the UART
+    // Inputs:
+    //   data: Byte to send
+    // Outputs:
+    //   Returns the number of bytes written
+    size_t write(uint8_t data);
+
+    // Send data to the UART
+    // Inputs:
+    //   buffer: Address of the data
+    //   length: Number of bytes to send
+    // Outputs:
+    //   Returns the number of bytes written
+    size_t write(const uint8_t * buffer, size_t length);
+};
+
+//****************************************
+// Service API
+//****************************************
+
+#define R4A_SERVICE_MAX         31          // Maximum number of services
+#define R4A_SERVICE_LINK        0x80000000  // Depends on the network link
+
+// Start the service, called repeatedly from r4aServicesUpdate until it
+// returns true, must not block
+// Inputs:
+//   parameter: Parameter value from the service table
+// Outputs:
+//   Returns true when the service is running
+typedef bool (* R4A_SERVICE_START)(intptr_t parameter);
+
+// Update the running service, called from r4aServicesUpdate
+// Inputs:
+//   parameter: Parameter value from the service table
+typedef void (* R4A_SERVICE_UPDATE)(intptr_t parameter);
+
+typedef struct _R4A_SERVICE
+{
+    const char * name;          // Name of the service
+    uint32_t dependencies;      // (1 << service index) | R4A_SERVICE_LINK
+    R4A_SERVICE_START start;    // Start routine, nullptr if none
+    R4A_SERVICE_UPDATE update;  // Update routine, nullptr if none
+    intptr_t parameter;         // Parameter for the routines
+} R4A_SERVICE;
+
+extern volatile uint32_t r4aServicesRunning;    // Bit mask of running services
+
+// Initialize the service table, record the start of the boot timeline
+// Inputs:
+//   services: Address of the service table, the table index is the bit
+//             number used in the dependencies
+//   entries: Number of entries in the service table
+// Outputs:
+//   Returns true if successful and false when the table is too large
+bool r4aServicesBegin(const R4A_SERVICE * services, int entries);
+
+// Display the boot timeline
+// Inputs:
+//   display: Device used for output
+void r4aServicesDisplay(Print * display = &Serial);
+
+// Display the boot timeline
+// Inputs:
+//   menuEntry: Address of the object describing the menu entry
+//   command: Zero terminated command string
+//   display: Device used for output
+void r4aServicesMenuDisplay(const R4A_MENU_ENTRY * menuEntry,
+                            const char * command,
+                            Print * display);
+
+// Start the services whose dependencies are running and update the
+// running services, call from the loop
+void r4aServicesUpdate();
+
+// Determine if a service is running
+// Inputs:
+//   index: Index of the service in the service table
+// Outputs:
+//   Returns true if the service is running
+inline bool r4aServiceIsRunning(int index)
+{
+    return (r4aServicesRunning & (1 << index)) != 0;
+}
+
 //****************************************
 // SPI API
 //****************************************
 
+#define R4A_SPI_MAX_IN_FLIGHT   4   // Maximum transactions started at once
+
+enum R4A_SPI_PRIORITY
+{
+    R4A_SPI_PRIORITY_LOW = 0,       // Bulk output, LED frames
+    R4A_SPI_PRIORITY_NORMAL,        // Default priority
+    R4A_SPI_PRIORITY_HIGH,          // Latency sensitive, sensor reads
+};
+
+struct _R4A_SPI_TRANSACTION;
+
+// Routine called when the SPI transaction completes, called by the task
+// calling R4A_SPI::service
+// Inputs:
+//   transaction: Address of the completed transaction
+typedef void (* R4A_SPI_CALLBACK)(struct _R4A_SPI_TRANSACTION * transaction);
+
+typedef struct _R4A_SPI_TRANSACTION
+{
+    struct _R4A_SPI_TRANSACTION * next; // Next transaction in the queue
+    const uint8_t * txBuffer;   // Address of the data to send
+    uint8_t * rxBuffer;         // Address of the receive buffer, may be nullptr
+    uint32_t length;            // Number of data bytes to transfer
+    uint8_t priority;           // R4A_SPI_PRIORITY value
+    R4A_SPI_CALLBACK callback;  // Completion routine, may be nullptr
+    intptr_t parameter;         // Parameter for the callback routine
+    uint32_t queuedUsec;        // Time when the transaction was queued
+    uint32_t completeUsec;      // Time when the transaction completed
+    volatile bool busy;         // True from queue until completion
+} R4A_SPI_TRANSACTION;
+
 class R4A_SPI
 {
+  protected:
+
+    R4A_SPI_TRANSACTION * _queueHead;   // Queue sorted by priority
+    portMUX_TYPE _queueMux = portMUX_INITIALIZER_UNLOCKED;
+    uint8_t _inFlight;                  // Transactions started, not complete
+    uint8_t _maxInFlight;               // Limit on the started transactions
+
+    // Mark the transaction as complete, the derived classes call this
+    // routine from pollTransactions
+    // Inputs:
+    //   transaction: Address of the completed transaction
+    void complete(R4A_SPI_TRANSACTION * transaction);
+
+    // Complete the transactions that finished since the last call.  The
+    // base class completes each transaction in startTransactions and
+    // does nothing here.
+    virtual void pollTransactions();
+
+    // Start a list of transactions.  The base class performs the blocking
+    // transfer for each transaction and completes it before returning.
+    // The derived classes may instead start the transfers, such as with
+    // spi_device_queue_trans, and complete them from pollTransactions.
+    // Inputs:
+    //   list: Address of the transaction list in priority order
+    //   count: Number of transactions in the list
+    // Outputs:
+    //   Returns the number of transactions started, the remaining
+    //   transactions are returned to the queue
+    virtual uint8_t startTransactions(R4A_SPI_TRANSACTION ** list,
+                                      uint8_t count);
+
   public:
 
+    // Constructor
+    // Inputs:
+    //   maxInFlight: Maximum number of transactions started at once
+    R4A_SPI(uint8_t maxInFlight = 1);
+
     // Allocate DMA buffer
     // Inputs:
     //   length: Number of data bytes to allocate
@@ -934,6 +2724,25 @@ class R4A_SPI
     //   Return true if successful and false upon failure
     virtual bool begin(uint8_t spiNumber, uint8_t pinMOSI, uint32_t clockHz);
 
+    // Determine if the SPI controller is idle
+    // Outputs:
+    //   Returns true when no transactions are queued or in flight
+    bool isIdle();
+
+    // Add a transaction to the queue.  The transaction is placed after
+    // the other transactions of the same or higher priority.
+    // Inputs:
+    //   transaction: Address of the transaction, must remain valid until
+    //                the busy flag is cleared
+    // Outputs:
+    //   Returns true if the transaction was queued and false if it is
+    //   already busy
+    bool queue(R4A_SPI_TRANSACTION * transaction);
+
+    // Complete the finished transactions and start the queued
+    // transactions, call from the loop
+    void service();
+
     // Transfer data to the SPI device
     // Inputs:
     //   txBuffer: Address of the buffer containing the data to send
@@ -944,6 +2753,86 @@ class R4A_SPI
                           uint32_t length);
 };
 
+// SPI controller using the ESP-IDF SPI master driver.  startTransactions
+// queues the transactions with spi_device_queue_trans and returns without
+// waiting, the DMA sends the data while the CPU encodes the next frame.
+// pollTransactions completes the finished transactions using
+// spi_device_get_trans_result, clearing the busy flags.  The driver
+// chains the DMA descriptors for transfers up to maxTransferBytes.
+class R4A_SPI_ESP32 : public R4A_SPI
+{
+  private:
+
+    spi_device_handle_t _device;    // SPI device, nullptr before begin
+    int _maxTransferBytes;          // Longest transfer in bytes
+    spi_host_device_t _spiHost;     // SPI controller
+    spi_transaction_t _transactions[R4A_SPI_MAX_IN_FLIGHT]; // Driver descriptors
+    uint8_t _transactionCount;      // Descriptors in use
+    uint8_t _transactionNext;       // Next descriptor to use
+
+    void pollTransactions();
+    uint8_t startTransactions(R4A_SPI_TRANSACTION ** list, uint8_t count);
+
+  public:
+
+    // Constructor
+    // Inputs:
+    //   maxInFlight: Maximum number of transactions queued to the driver
+    //   maxTransferBytes: Longest transfer in bytes, sizes the DMA
+    //                     descriptor chain
+    R4A_SPI_ESP32(uint8_t maxInFlight = R4A_SPI_MAX_IN_FLIGHT,
+                  int maxTransferBytes = 32768);
+
+    uint8_t * allocateDmaBuffer(int length);
+    bool begin(uint8_t spiNumber, uint8_t pinMOSI, uint32_t clockHz);
+    void transfer(const uint8_t * txBuffer,
+                  uint8_t * rxBuffer,
+                  uint32_t length);
+};
+
+// Simulated SPI controller which models the bus time without using
+// the SPI hardware.  The transactions are completed by service after the
+// time needed to transfer the data at the clock rate, allowing the
+// latency (r4a_spi_latency_usec) and throughput to be measured without
+// the SPI devices.  The transmit data is looped back to the receive
+// buffer.
+class R4A_SPI_SIMULATOR : public R4A_SPI
+{
+  private:
+
+    uint32_t _busyUntilUsec;    // Time when the simulated bus becomes idle
+    uint32_t _clockHz;          // SPI clock frequency in Hertz
+    uint32_t _completeUsec[R4A_SPI_MAX_IN_FLIGHT]; // Completion times
+    uint32_t _setupUsec;        // Overhead for each transaction
+    R4A_SPI_TRANSACTION * _started[R4A_SPI_MAX_IN_FLIGHT]; // In start order
+    uint8_t _startedCount;      // Number of started transactions
+
+    // Compute the bus time for a transfer
+    // Inputs:
+    //   length: Number of data bytes to transfer
+    // Outputs:
+    //   Returns the number of microseconds needed for the transfer
+    uint32_t busUsec(uint32_t length);
+
+    void pollTransactions();
+    uint8_t startTransactions(R4A_SPI_TRANSACTION ** list, uint8_t count);
+
+  public:
+
+    // Constructor
+    // Inputs:
+    //   maxInFlight: Maximum number of transactions started at once
+    //   setupUsec: Overhead in microseconds for each transaction
+    R4A_SPI_SIMULATOR(uint8_t maxInFlight = R4A_SPI_MAX_IN_FLIGHT,
+                      uint32_t setupUsec = 10);
+
+    uint8_t * allocateDmaBuffer(int length);
+    bool begin(uint8_t spiNumber, uint8_t pinMOSI, uint32_t clockHz);
+    void transfer(const uint8_t * txBuffer,
+                  uint8_t * rxBuffer,
+                  uint32_t length);
+};
+
 extern R4A_SPI * r4aSpi;
 
 //****************************************
@@ -1002,7 +2891,8 @@ void r4aSupportTrimWhiteSpace(uint8_t * parameter);
 // Telnet Client API
 //****************************************
 
-// Process input characters from the telnet client
+// Process input characters from the telnet client, also called when no
+// input is available to allow long running commands to make progress
 // Inputs:
 //   client: Address of a NetworkClient object
 //   parameter: Address of object allocated by r4aTelnetClientBegin
@@ -1029,8 +2919,7 @@ class R4A_TELNET_CLIENT
 {
   private:
 
-    NetworkClient _client;
-    String _command;
+    R4A_CAPTURE_CLIENT _client;
     R4A_TELNET_CONTEXT_CREATE _contextCreate;
     void * _contextData;
     R4A_TELNET_CONTEXT_DELETE _contextDelete;
@@ -1072,16 +2961,20 @@ class R4A_TELNET_CLIENT
     uint16_t remotePort();
 };
 
+#define R4A_TELNET_COMMAND_BYTES    128     // Longest command line
+
 //*********************************************************************
 // Data associated with the telnet connection
 class R4A_TELNET_CONTEXT
 {
 public:
 
-    String _command; // User command received via telnet
+    char _command[R4A_TELNET_COMMAND_BYTES]; // User command received via telnet
     bool _displayOptions;
     bool _echo;
-    R4A_MENU _menu;  // Strcture describing the menu system
+    R4A_MENU_CURSOR _cursor;    // Position in the menu system
+    const R4A_MENU_COMPILED * _menu;  // Menu shared by the telnet sessions
+    R4A_MENU_COMPILED * _menuAllocated; // Menu allocated by the constructor
 
     // Constructor
     // Inputs:
@@ -1102,6 +2995,18 @@ public:
                        bool blankLineAfterMenuHeader = false,
                        bool alignCommands = true,
                        bool blankLineAfterMenu = false);
+
+    // Constructor
+    // Inputs:
+    //   menu: Address of the menu shared by the telnet sessions
+    //   displayOptions: Display the telnet options received from the client
+    //   echo: Echo the input characters
+    R4A_TELNET_CONTEXT(const R4A_MENU_COMPILED * menu,
+                       bool displayOptions = false,
+                       bool echo = false);
+
+    // Destructor
+    ~R4A_TELNET_CONTEXT();
 };
 
 // Finish creating the network client
@@ -1119,6 +3024,18 @@ bool r4aTelnetContextCreate(NetworkClient * client,
                             int menuTableEntries,
                             void ** contextData);
 
+// Finish creating the network client, the sessions share the menu
+// Inputs:
+//   client: Address of a NetworkClient object
+//   menu: Address of the menu shared by the telnet sessions
+//   contextData: Buffer to receive the address of an object allocated by
+//                this routine
+// Outputs:
+//   Returns true if the routine was successful and false upon failure.
+bool r4aTelnetContextCreate(NetworkClient * client,
+                            const R4A_MENU_COMPILED * menu,
+                            void ** contextData);
+
 // Clean up after the parameter object returned by r4aTelnetClientBegin
 // Inputs:
 //   contextData: Address of object allocated by r4aTelnetClientBegin
@@ -1145,7 +3062,12 @@ class R4A_TELNET_SERVER
     R4A_TELNET_CONTEXT_CREATE _contextCreate;
     R4A_TELNET_CONTEXT_DELETE _contextDelete;
     IPAddress _ipAddress;
+    uint32_t _linkGeneration;       // Link generation of the client connections
     const int _maxClients;
+    char _metricLabels[16];         // Prometheus labels, port="nnnnn"
+    R4A_METRIC _metricClients;      // Active clients
+    R4A_METRIC _metricConnections;  // Client connections accepted
+    R4A_METRIC _metricRejects;      // Client connections rejected
     uint16_t _port;
     R4A_TELNET_CLIENT_PROCESS_INPUT _processInput;
     NetworkServer * _server;
@@ -1208,6 +3130,9 @@ class R4A_TELNET_SERVER
     //   connected: True when the network is connected and false upon
     //              network failure
     void update(bool connected);
+
+    // Update the server state using the link state from r4aLinkBegin
+    void update();
 };
 
 //****************************************
@@ -1340,4 +3265,43 @@ double r4aWaypointLambertDistance(R4A_LAT_LONG_POINT_PAIR * point);
 //   Returns true if the position is close enough to the waypoint
 bool r4aWaypointReached(R4A_LAT_LONG_POINT_PAIR * point);
 
+//****************************************
+// WiFi API
+//****************************************
+
+#define R4A_WIFI_MAX_APS                4       // Maximum number of access points
+#define R4A_WIFI_CACHED_TIMEOUT_MSEC    3000    // Cached connection timeout
+#define R4A_WIFI_CONNECT_TIMEOUT_MSEC   10000   // Connection timeout after scan
+
+extern bool r4aWiFiDebugStates;         // Set true to display state changes
+// Set true to skip DHCP by reusing the previous lease as a static
+// address.  The address is not renewed by DHCP, use only when the DHCP
+// server reserves the address for this device.
+extern bool r4aWiFiUseCachedLease;
+extern uint32_t r4aWiFiConnectMsec;     // Time for the last connection
+extern bool r4aWiFiConnectCached;       // Last connection used the cache
+
+// Add an access point to the list of access points
+// Inputs:
+//   ssid: Zero terminated name of the access point
+//   password: Zero terminated password for the access point
+// Outputs:
+//   Returns true if the access point was added and false when the list
+//   is full
+bool r4aWiFiAddAP(const char * ssid, const char * password);
+
+// Start connecting to an access point.  The connection is made directly
+// using the BSSID, channel and lease from the last good connection, saved
+// in RTC memory.  A scan is only done when the direct connection fails.
+void r4aWiFiBegin();
+
+// Display the WiFi connection status
+// Inputs:
+//   display: Device used for output
+void r4aWiFiDisplayStatus(Print * display = &Serial);
+
+// Update the WiFi connection, reconnect when the connection breaks.
+// This routine does not block.
+void r4aWiFiUpdate();
+
 #endif  // __R4A_ROBOT_H__
@@ -9,6 +9,24 @@
 
 #define SWITCH_STATE(newState)      __atomic_exchange_1((uint8_t *)&_state, newState, 0)
 
+//****************************************
+// Metrics
+//****************************************
+
+static const int32_t r4aRobotMetricChallengeBounds[] = {100, 500, 1000, 5000, 10000, 50000};
+static uint32_t r4aRobotMetricChallengeBuckets[sizeof(r4aRobotMetricChallengeBounds) / sizeof(int32_t) + 1];
+static R4A_METRIC r4aRobotMetricChallengeUsec("r4a_robot_challenge_usec",
+                                              "Microseconds spent in each call to the challenge routine",
+                                              r4aRobotMetricChallengeBounds,
+                                              sizeof(r4aRobotMetricChallengeBounds) / sizeof(int32_t),
+                                              r4aRobotMetricChallengeBuckets);
+static R4A_METRIC r4aRobotMetricChallenges("r4a_robot_challenges_total",
+                                           "Robot challenges started",
+                                           R4A_METRIC_COUNTER);
+static R4A_METRIC r4aRobotMetricState("r4a_robot_state",
+                                      "Robot layer state number",
+                                      R4A_METRIC_GAUGE);
+
 //*********************************************************************
 // Constructor
 // Inputs:
@@ -129,6 +147,7 @@ bool R4A_ROBOT::init(R4A_ROBOT_CHALLENGE * challenge,
 
     // Call the initialization routine
     challenge->_init(challenge);
+    r4aRobotMetricChallenges.add();
 
     // Start the robot
     _challenge = challenge;    // Update the LED colors
@@ -146,6 +165,7 @@ bool R4A_ROBOT::init(R4A_ROBOT_CHALLENGE * challenge,
 void R4A_ROBOT::running(uint32_t currentMsec)
 {
     R4A_ROBOT_CHALLENGE * challenge;
+    uint32_t startUsec;
 
     // Synchronize with the stop routine
     _busy = true;
@@ -156,8 +176,12 @@ void R4A_ROBOT::running(uint32_t currentMsec)
     {
         // Determine the challenge should stop
         if (((int32_t)(_endMsec - currentMsec)) > 0)
+        {
             // Perform the robot challenge
+            startUsec = micros();
             challenge->_challenge(challenge);
+            r4aRobotMetricChallengeUsec.observe(micros() - startUsec);
+        }
         else
             // Stop the robot
             stop(currentMsec);
@@ -243,6 +267,7 @@ void R4A_ROBOT::update(uint32_t currentMsec)
 
     // Process the robot state
     state = _state;
+    r4aRobotMetricState.set(state);
     if (state == STATE_RUNNING)
         running(currentMsec);
     else if (state == STATE_COUNT_DOWN)
@@ -256,7 +281,7 @@ void R4A_ROBOT::update(uint32_t currentMsec)
     }
     else
     {
-        Serial.printf("ERROR: Unknown robot state %d\r\n", state);
+        r4aLogError(R4A_MODULE_ROBOT, "Unknown robot state %d", state);
         r4aReportFatalError("Unknown robot state");
     }
 }
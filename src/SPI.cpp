@@ -0,0 +1,395 @@
+/**********************************************************************
+  SPI.cpp
+
+  Robots-For-All (R4A)
+  SPI transaction queue support
+
+  The SPI devices share the controller by queuing transactions.  The
+  queue is sorted by priority allowing a sensor read to be placed ahead
+  of an LED frame.  The base class is a synchronous priority queue,
+  service performs each transfer using the blocking transfer routine
+  and calls the completion routine before returning.  The derived
+  classes override startTransactions and pollTransactions to keep
+  several transactions in flight.  R4A_SPI_ESP32 queues them to the
+  ESP-IDF SPI master driver and R4A_SPI_SIMULATOR models the bus time.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Metrics
+//****************************************
+
+static const int32_t r4aSpiMetricLatencyBounds[] = {100, 500, 1000, 5000, 10000, 50000};
+static uint32_t r4aSpiMetricLatencyBuckets[sizeof(r4aSpiMetricLatencyBounds) / sizeof(int32_t) + 1];
+static R4A_METRIC r4aSpiMetricLatencyUsec("r4a_spi_latency_usec",
+                                          "Microseconds from queue to SPI transaction completion",
+                                          r4aSpiMetricLatencyBounds,
+                                          sizeof(r4aSpiMetricLatencyBounds) / sizeof(int32_t),
+                                          r4aSpiMetricLatencyBuckets);
+static R4A_METRIC r4aSpiMetricTransactions("r4a_spi_transactions_total",
+                                           "SPI transactions",
+                                           R4A_METRIC_COUNTER);
+
+//*********************************************************************
+// Constructor
+R4A_SPI::R4A_SPI(uint8_t maxInFlight)
+    : _queueHead{nullptr}, _inFlight{0}, _maxInFlight{maxInFlight}
+{
+    if (_maxInFlight < 1)
+        _maxInFlight = 1;
+    if (_maxInFlight > R4A_SPI_MAX_IN_FLIGHT)
+        _maxInFlight = R4A_SPI_MAX_IN_FLIGHT;
+}
+
+//*********************************************************************
+// Mark the transaction as complete
+void R4A_SPI::complete(R4A_SPI_TRANSACTION * transaction)
+{
+    // Account for the transaction
+    transaction->completeUsec = micros();
+    portENTER_CRITICAL(&_queueMux);
+    _inFlight -= 1;
+    portEXIT_CRITICAL(&_queueMux);
+    r4aSpiMetricLatencyUsec.observe(transaction->completeUsec - transaction->queuedUsec);
+    r4aSpiMetricTransactions.add();
+
+    // Release the transaction before the callback to allow the callback
+    // to queue the transaction again
+    __atomic_store_n(&transaction->busy, false, __ATOMIC_RELEASE);
+    if (transaction->callback)
+        transaction->callback(transaction);
+}
+
+//*********************************************************************
+// Determine if the SPI controller is idle
+bool R4A_SPI::isIdle()
+{
+    bool idle;
+
+    portENTER_CRITICAL(&_queueMux);
+    idle = (_queueHead == nullptr) && (_inFlight == 0);
+    portEXIT_CRITICAL(&_queueMux);
+    return idle;
+}
+
+//*********************************************************************
+// Complete the finished transactions
+void R4A_SPI::pollTransactions()
+{
+    // The base class completes the transactions in startTransactions
+}
+
+//*********************************************************************
+// Add a transaction to the queue
+bool R4A_SPI::queue(R4A_SPI_TRANSACTION * transaction)
+{
+    R4A_SPI_TRANSACTION ** previous;
+
+    // Don't queue the transaction twice
+    if (__atomic_exchange_n(&transaction->busy, true, __ATOMIC_ACQUIRE))
+        return false;
+    transaction->queuedUsec = micros();
+
+    // Place the transaction after the others of the same or higher priority
+    portENTER_CRITICAL(&_queueMux);
+    previous = &_queueHead;
+    while (*previous && ((*previous)->priority >= transaction->priority))
+        previous = &(*previous)->next;
+    transaction->next = *previous;
+    *previous = transaction;
+    portEXIT_CRITICAL(&_queueMux);
+    return true;
+}
+
+//*********************************************************************
+// Start the queued transactions
+void R4A_SPI::service()
+{
+    uint8_t count;
+    int index;
+    R4A_SPI_TRANSACTION * list[R4A_SPI_MAX_IN_FLIGHT];
+    R4A_SPI_TRANSACTION ** previous;
+    uint8_t started;
+    R4A_SPI_TRANSACTION * transaction;
+
+    // Complete the finished transactions
+    pollTransactions();
+
+    // Remove the highest priority transactions from the queue
+    count = 0;
+    portENTER_CRITICAL(&_queueMux);
+    while (_queueHead && ((_inFlight + count) < _maxInFlight))
+    {
+        list[count++] = _queueHead;
+        _queueHead = _queueHead->next;
+    }
+    _inFlight += count;
+    portEXIT_CRITICAL(&_queueMux);
+    if (!count)
+        return;
+
+    // Start the transactions
+    started = startTransactions(list, count);
+    if (started >= count)
+        return;
+
+    // Return the remaining transactions to the queue, ahead of the
+    // transactions with the same priority
+    portENTER_CRITICAL(&_queueMux);
+    _inFlight -= count - started;
+    for (index = count - 1; index >= started; index--)
+    {
+        transaction = list[index];
+        previous = &_queueHead;
+        while (*previous && ((*previous)->priority > transaction->priority))
+            previous = &(*previous)->next;
+        transaction->next = *previous;
+        *previous = transaction;
+    }
+    portEXIT_CRITICAL(&_queueMux);
+}
+
+//*********************************************************************
+// Start a list of transactions
+uint8_t R4A_SPI::startTransactions(R4A_SPI_TRANSACTION ** list,
+                                   uint8_t count)
+{
+    R4A_SPI_TRANSACTION * transaction;
+
+    // Perform each of the transfers
+    for (int index = 0; index < count; index++)
+    {
+        transaction = list[index];
+        transfer(transaction->txBuffer, transaction->rxBuffer, transaction->length);
+        complete(transaction);
+    }
+    return count;
+}
+
+//*********************************************************************
+// Constructor
+R4A_SPI_ESP32::R4A_SPI_ESP32(uint8_t maxInFlight, int maxTransferBytes)
+    : R4A_SPI(maxInFlight), _device{nullptr},
+      _maxTransferBytes{maxTransferBytes}, _spiHost{SPI2_HOST},
+      _transactionCount{0}, _transactionNext{0}
+{
+}
+
+//*********************************************************************
+// Allocate DMA buffer
+uint8_t * R4A_SPI_ESP32::allocateDmaBuffer(int length)
+{
+    // The buffer is released with free
+    return (uint8_t *)heap_caps_malloc(length, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+}
+
+//*********************************************************************
+// Initialize the SPI controller
+bool R4A_SPI_ESP32::begin(uint8_t spiNumber, uint8_t pinMOSI, uint32_t clockHz)
+{
+    spi_bus_config_t busConfig;
+    spi_device_interface_config_t deviceConfig;
+    esp_err_t status;
+
+    // Only initialize the controller once
+    if (_device)
+        return true;
+
+    // Initialize the bus, the Arduino SPI numbers start at 1 (FSPI) and
+    // the driver numbers start at 0 (SPI1_HOST)
+    _spiHost = (spi_host_device_t)(spiNumber - 1);
+    memset(&busConfig, 0, sizeof(busConfig));
+    busConfig.mosi_io_num = pinMOSI;
+    busConfig.miso_io_num = -1;
+    busConfig.sclk_io_num = -1;
+    busConfig.quadwp_io_num = -1;
+    busConfig.quadhd_io_num = -1;
+    busConfig.max_transfer_sz = _maxTransferBytes;
+    busConfig.flags = SPICOMMON_BUSFLAG_MASTER;
+    status = spi_bus_initialize(_spiHost, &busConfig, SPI_DMA_CH_AUTO);
+    if (status != ESP_OK)
+    {
+        r4aLogError(R4A_MODULE_APPLICATION, "spi_bus_initialize failed, status: %d", status);
+        return false;
+    }
+
+    // Add the device, allowing maxInFlight transactions in the driver queue
+    memset(&deviceConfig, 0, sizeof(deviceConfig));
+    deviceConfig.clock_speed_hz = clockHz;
+    deviceConfig.mode = 0;
+    deviceConfig.spics_io_num = -1;
+    deviceConfig.queue_size = _maxInFlight;
+    status = spi_bus_add_device(_spiHost, &deviceConfig, &_device);
+    if (status != ESP_OK)
+    {
+        r4aLogError(R4A_MODULE_APPLICATION, "spi_bus_add_device failed, status: %d", status);
+        spi_bus_free(_spiHost);
+        _device = nullptr;
+        return false;
+    }
+    return true;
+}
+
+//*********************************************************************
+// Complete the finished transactions
+void R4A_SPI_ESP32::pollTransactions()
+{
+    spi_transaction_t * descriptor;
+
+    // The driver returns the transactions in the order they were queued
+    while (_transactionCount
+        && (spi_device_get_trans_result(_device, &descriptor, 0) == ESP_OK))
+    {
+        _transactionCount -= 1;
+        complete((R4A_SPI_TRANSACTION *)descriptor->user);
+    }
+}
+
+//*********************************************************************
+// Start a list of transactions
+uint8_t R4A_SPI_ESP32::startTransactions(R4A_SPI_TRANSACTION ** list,
+                                         uint8_t count)
+{
+    spi_transaction_t * descriptor;
+    int index;
+    R4A_SPI_TRANSACTION * transaction;
+
+    // Queue the transactions to the driver without waiting
+    for (index = 0; index < count; index++)
+    {
+        if ((!_device) || (_transactionCount >= R4A_SPI_MAX_IN_FLIGHT))
+            break;
+        transaction = list[index];
+
+        // The driver owns the descriptor until spi_device_get_trans_result
+        // returns it, the descriptors are used in rotation
+        descriptor = &_transactions[_transactionNext];
+        memset(descriptor, 0, sizeof(*descriptor));
+        descriptor->length = transaction->length * 8;
+        descriptor->tx_buffer = transaction->txBuffer;
+        descriptor->rx_buffer = transaction->rxBuffer;
+        descriptor->user = transaction;
+        if (spi_device_queue_trans(_device, descriptor, 0) != ESP_OK)
+            break;
+        _transactionNext = (_transactionNext + 1) % R4A_SPI_MAX_IN_FLIGHT;
+        _transactionCount += 1;
+    }
+    return index;
+}
+
+//*********************************************************************
+// Transfer data to the SPI device
+void R4A_SPI_ESP32::transfer(const uint8_t * txBuffer,
+                             uint8_t * rxBuffer,
+                             uint32_t length)
+{
+    spi_transaction_t descriptor;
+
+    // Wait for the queued transactions
+    while (!isIdle())
+        service();
+
+    // Perform the transfer
+    memset(&descriptor, 0, sizeof(descriptor));
+    descriptor.length = length * 8;
+    descriptor.tx_buffer = txBuffer;
+    descriptor.rx_buffer = rxBuffer;
+    spi_device_transmit(_device, &descriptor);
+}
+
+//*********************************************************************
+// Constructor
+R4A_SPI_SIMULATOR::R4A_SPI_SIMULATOR(uint8_t maxInFlight, uint32_t setupUsec)
+    : R4A_SPI(maxInFlight), _busyUntilUsec{0}, _clockHz{0},
+      _setupUsec{setupUsec}, _startedCount{0}
+{
+}
+
+//*********************************************************************
+// Allocate DMA buffer
+uint8_t * R4A_SPI_SIMULATOR::allocateDmaBuffer(int length)
+{
+    // The buffer is released with free
+    return (uint8_t *)malloc(length);
+}
+
+//*********************************************************************
+// Initialize the SPI controller
+bool R4A_SPI_SIMULATOR::begin(uint8_t spiNumber, uint8_t pinMOSI, uint32_t clockHz)
+{
+    if (!clockHz)
+    {
+        r4aLogError(R4A_MODULE_APPLICATION, "clockHz needs to be non-zero!");
+        return false;
+    }
+    _clockHz = clockHz;
+    return true;
+}
+
+//*********************************************************************
+// Compute the bus time for a transfer
+uint32_t R4A_SPI_SIMULATOR::busUsec(uint32_t length)
+{
+    return _setupUsec + (uint32_t)(((uint64_t)length * 8 * 1000 * 1000) / _clockHz);
+}
+
+//*********************************************************************
+// Complete the finished transactions
+void R4A_SPI_SIMULATOR::pollTransactions()
+{
+    R4A_SPI_TRANSACTION * transaction;
+
+    // The transactions complete in the order they were started
+    while (_startedCount && ((int32_t)(micros() - _completeUsec[0]) >= 0))
+    {
+        transaction = _started[0];
+        _startedCount -= 1;
+        memmove(&_started[0], &_started[1], _startedCount * sizeof(_started[0]));
+        memmove(&_completeUsec[0], &_completeUsec[1], _startedCount * sizeof(_completeUsec[0]));
+
+        // Loop the transmit data back to the receive buffer
+        if (transaction->rxBuffer)
+            memcpy(transaction->rxBuffer, transaction->txBuffer, transaction->length);
+        complete(transaction);
+    }
+}
+
+//*********************************************************************
+// Start a list of transactions
+uint8_t R4A_SPI_SIMULATOR::startTransactions(R4A_SPI_TRANSACTION ** list,
+                                             uint8_t count)
+{
+    uint32_t currentUsec;
+    int index;
+
+    // Start after the previous transactions complete
+    currentUsec = micros();
+    if (!_startedCount || ((int32_t)(currentUsec - _busyUntilUsec) > 0))
+        _busyUntilUsec = currentUsec;
+
+    // Compute the completion time for each transaction
+    for (index = 0; index < count; index++)
+    {
+        _busyUntilUsec += busUsec(list[index]->length);
+        _started[_startedCount] = list[index];
+        _completeUsec[_startedCount++] = _busyUntilUsec;
+    }
+    return count;
+}
+
+//*********************************************************************
+// Transfer data to the SPI device
+void R4A_SPI_SIMULATOR::transfer(const uint8_t * txBuffer,
+                                 uint8_t * rxBuffer,
+                                 uint32_t length)
+{
+    // Wait for the queued transactions and the transfer
+    while (!isIdle())
+        service();
+    delayMicroseconds(busUsec(length));
+
+    // Loop the transmit data back to the receive buffer
+    if (rxBuffer)
+        memcpy(rxBuffer, txBuffer, length);
+}
@@ -3,10 +3,35 @@
 
   Robots-For-All (R4A)
   Serial stream support
+
+  The serial console uses the UART driver's pattern detection to find
+  the carriage return at the end of each command line.  The UART driver
+  places an event in the queue for each line, the console reads the
+  entire line with a single call.  While waiting for input, the update
+  routine only checks the event queue.
 **********************************************************************/
 
 #include "R4A_Robot.h"
 
+//****************************************
+// Constants
+//****************************************
+
+#define R4A_SERIAL_PATTERN_CHR_TOUT 9   // Baud cycles between the pattern characters
+#define R4A_SERIAL_PATTERN_POST_IDLE 0  // Baud cycles after the pattern
+#define R4A_SERIAL_PATTERN_PRE_IDLE 0   // Baud cycles before the pattern
+
+//****************************************
+// Metrics
+//****************************************
+
+static R4A_METRIC r4aSerialMetricLines("r4a_serial_lines_total",
+                                       "Command lines received by the serial console",
+                                       R4A_METRIC_COUNTER);
+static R4A_METRIC r4aSerialMetricOverflows("r4a_serial_overflows_total",
+                                           "Serial console input discarded due to overflow",
+                                           R4A_METRIC_COUNTER);
+
 //*********************************************************************
 // Read a line of input from a Serial port into a String
 String * r4aReadLine(bool echo, String * buffer, HardwareSerial * port)
@@ -68,6 +93,71 @@ String * r4aReadLine(bool echo, String * buffer, HardwareSerial * port)
     return line;
 }
 
+//*********************************************************************
+// Read a line of input from a stream into a character array
+char * r4aReadLine(bool echo, char * buffer, size_t bufferLength, Stream * port)
+{
+    int data;
+    size_t length;
+
+    // Get the length of the partial line
+    length = strlen(buffer);
+
+    // Wait for an input character
+    while ((data = port->read()) >= 0)
+    {
+        if ((data != '\r') && (data != '\n'))
+        {
+            // Handle backspace
+            if (data == 8)
+            {
+                // Output a bell when the buffer is empty
+                if (length == 0)
+                    port->write(7);
+                else
+                {
+                    // Remove the character from the line
+                    port->write(data);
+                    port->write(' ');
+                    port->write(data);
+
+                    // Remove the character from the buffer
+                    buffer[--length] = 0;
+                }
+            }
+
+            // Output a bell when the buffer is full
+            else if (length >= (bufferLength - 1))
+                port->write(7);
+            else
+            {
+                // Echo the character
+                if (echo)
+                    port->write(data);
+
+                // Add the character to the line
+                buffer[length++] = data;
+                buffer[length] = 0;
+            }
+        }
+
+        // Echo a carriage return and linefeed
+        else if (data == '\r')
+        {
+            if (echo)
+                port->println();
+            return buffer;
+        }
+
+        // Echo the linefeed
+        else if (echo && (data == '\n'))
+            port->println();
+    }
+
+    // The line is not complete
+    return nullptr;
+}
+
 //*********************************************************************
 // Repeatedly display a fatal error message
 void r4aReportFatalError(const char * errorMessage,
@@ -90,22 +180,261 @@ void r4aReportFatalError(const char * errorMessage,
 void r4aSerialMenu(R4A_MENU * menu)
 {
     const char * command;
-    String * line;
-    static String serialBuffer;
+    static char serialBuffer[R4A_SERIAL_COMMAND_BYTES];
+
+    // Run any long command
+    menu->update(&Serial);
 
     // Process input from the serial port
-    line = r4aReadLine(true, &serialBuffer, &Serial);
-    if (line)
+    command = r4aReadLine(true, serialBuffer, sizeof(serialBuffer), &Serial);
+    if (command)
     {
-        // Get the command
-        command = line->c_str();
-
         // Process the command
         if (!menu->process(command, &Serial))
             // Display the menu
             menu->process(nullptr, &Serial);
 
         // Start building the next command
-        serialBuffer = "";
+        serialBuffer[0] = 0;
     }
 }
+
+//*********************************************************************
+// Constructor
+R4A_SERIAL_CONSOLE::R4A_SERIAL_CONSOLE(uart_port_t port,
+                                       const R4A_MENU_TABLE * menuTable,
+                                       int menuTableEntries,
+                                       bool echo)
+    : _cursor{}, _echo{echo}, _eventQueue{nullptr}, _installed{false},
+      _menu{R4A_MENU_COMPILED(menuTable, menuTableEntries)}, _port{port}
+{
+}
+
+//*********************************************************************
+// Destructor
+R4A_SERIAL_CONSOLE::~R4A_SERIAL_CONSOLE()
+{
+    _menu.cancel(&_cursor);
+    if (_installed)
+    {
+        uart_driver_delete(_port);
+        _installed = false;
+    }
+}
+
+//*********************************************************************
+// Determine the space available in the transmit buffer
+int R4A_SERIAL_CONSOLE::availableForWrite()
+{
+    size_t space;
+
+    if ((!_installed) || (uart_get_tx_buffer_free_size(_port, &space) != ESP_OK))
+        return 0;
+    return space;
+}
+
+//*********************************************************************
+// Install the UART driver and display the menu
+bool R4A_SERIAL_CONSOLE::begin(int baudRate, int txPin, int rxPin)
+{
+    uart_config_t config;
+    esp_err_t error;
+
+    do
+    {
+        // Install the UART driver with an event queue
+        error = uart_driver_install(_port,
+                                    R4A_SERIAL_RX_BYTES,
+                                    R4A_SERIAL_TX_BYTES,
+                                    R4A_SERIAL_EVENT_QUEUE,
+                                    &_eventQueue,
+                                    0);
+        if (error != ESP_OK)
+        {
+            r4aLogError(R4A_MODULE_SERIAL, "Failed to install the UART %d driver, error: %s!",
+                        _port, esp_err_to_name(error));
+            break;
+        }
+        _installed = true;
+
+        // Configure the UART
+        memset(&config, 0, sizeof(config));
+        config.baud_rate = baudRate;
+        config.data_bits = UART_DATA_8_BITS;
+        config.parity = UART_PARITY_DISABLE;
+        config.stop_bits = UART_STOP_BITS_1;
+        config.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+        config.source_clk = UART_SCLK_DEFAULT;
+        error = uart_param_config(_port, &config);
+        if (error == ESP_OK)
+            error = uart_set_pin(_port, txPin, rxPin,
+                                 UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+        if (error != ESP_OK)
+        {
+            r4aLogError(R4A_MODULE_SERIAL, "Failed to configure UART %d, error: %s!",
+                        _port, esp_err_to_name(error));
+            break;
+        }
+
+        // Detect the carriage return at the end of the command line
+        error = uart_enable_pattern_det_baud_intr(_port,
+                                                  '\r',
+                                                  1,
+                                                  R4A_SERIAL_PATTERN_CHR_TOUT,
+                                                  R4A_SERIAL_PATTERN_POST_IDLE,
+                                                  R4A_SERIAL_PATTERN_PRE_IDLE);
+        if (error == ESP_OK)
+            error = uart_pattern_queue_reset(_port, R4A_SERIAL_PATTERN_QUEUE);
+        if (error != ESP_OK)
+        {
+            r4aLogError(R4A_MODULE_SERIAL, "Failed to enable UART %d pattern detection, error: %s!",
+                        _port, esp_err_to_name(error));
+            break;
+        }
+
+        // Display the menu
+        _menu.process(&_cursor, nullptr, this);
+        return true;
+    } while (0);
+
+    // Release the UART driver
+    if (_installed)
+    {
+        uart_driver_delete(_port);
+        _installed = false;
+    }
+    return false;
+}
+
+//*********************************************************************
+// Read a command line from the UART driver
+bool R4A_SERIAL_CONSOLE::readLine(int length)
+{
+    int bytes;
+    char data;
+    int dest;
+
+    // Discard the lines that are too long
+    if (length >= (int)sizeof(_command))
+    {
+        while (length > 0)
+        {
+            bytes = uart_read_bytes(_port,
+                                    _command,
+                                    (length < (int)sizeof(_command)) ? length : sizeof(_command),
+                                    0);
+            if (bytes <= 0)
+                break;
+            length -= bytes;
+        }
+        r4aSerialMetricOverflows.add();
+        return false;
+    }
+
+    // Read the line including the carriage return
+    bytes = uart_read_bytes(_port, _command, length, 0);
+    if (bytes < 0)
+        bytes = 0;
+
+    // Remove the linefeeds, carriage return and backspaces, terminals
+    // send either backspace (0x08) or delete (0x7f) for the backspace key
+    dest = 0;
+    for (int index = 0; index < bytes; index++)
+    {
+        data = _command[index];
+        if ((data == 8) || (data == 0x7f))
+        {
+            if (dest)
+                dest -= 1;
+        }
+        else if ((data != '\r') && (data != '\n'))
+            _command[dest++] = data;
+    }
+    _command[dest] = 0;
+    r4aSerialMetricLines.add();
+    return true;
+}
+
+//*********************************************************************
+// Process the UART events and the command lines
+bool R4A_SERIAL_CONSOLE::update()
+{
+    bool done;
+    uart_event_t event;
+    int position;
+
+    if (!_installed)
+        return false;
+
+    // Process the UART events
+    done = false;
+    while ((!done) && (xQueueReceive(_eventQueue, &event, 0) == pdTRUE))
+    {
+        switch (event.type)
+        {
+        // A command line is available
+        case UART_PATTERN_DET:
+            // Get the length of the line
+            position = uart_pattern_pop_pos(_port);
+            if (position < 0)
+            {
+                // The pattern queue overflowed, discard the input
+                uart_flush_input(_port);
+                r4aSerialMetricOverflows.add();
+                break;
+            }
+
+            // Read the line
+            if (!readLine(position + 1))
+            {
+                println("Error: Command too long");
+                break;
+            }
+
+            // Process the command
+            if (_echo)
+                println(_command);
+            done = _menu.process(&_cursor, _command, this);
+            if (!done)
+                // Display the menu
+                _menu.process(&_cursor, nullptr, this);
+            break;
+
+        // Discard the input when the receive buffer overflows
+        case UART_BUFFER_FULL:
+        case UART_FIFO_OVF:
+            uart_flush_input(_port);
+            xQueueReset(_eventQueue);
+            r4aSerialMetricOverflows.add();
+            break;
+
+        // Ignore the data and other events until the line is complete
+        default:
+            break;
+        }
+    }
+
+    // Run any long command
+    if (!done)
+        _menu.update(&_cursor, this);
+    return done;
+}
+
+//*********************************************************************
+// Send a byte to the UART
+size_t R4A_SERIAL_CONSOLE::write(uint8_t data)
+{
+    return write(&data, 1);
+}
+
+//*********************************************************************
+// Send data to the UART
+size_t R4A_SERIAL_CONSOLE::write(const uint8_t * buffer, size_t length)
+{
+    int bytes;
+
+    if (!_installed)
+        return 0;
+    bytes = uart_write_bytes(_port, buffer, length);
+    return (bytes < 0) ? 0 : bytes;
+}
@@ -0,0 +1,159 @@
+/**********************************************************************
+  Service.cpp
+
+  Robots-For-All (R4A)
+  Service startup support
+
+  Each service declares the services it depends on and optionally the
+  network link.  The loop calls r4aServicesUpdate which starts each
+  service once its dependencies are running.  The start routines don't
+  block, so the local services (LEDs, menus, robot) run within
+  milliseconds of boot while the network services start in the
+  background once the link is up.  The time when each service became
+  ready is recorded as the boot timeline.
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Types
+//****************************************
+
+typedef struct _R4A_SERVICE_TIMES
+{
+    uint32_t readyMsec;     // Time when the service started running
+    uint32_t startMsec;     // Time when the dependencies were met
+} R4A_SERVICE_TIMES;
+
+//****************************************
+// Globals
+//****************************************
+
+volatile uint32_t r4aServicesRunning;
+
+//****************************************
+// Locals
+//****************************************
+
+static uint32_t r4aServicesBeginMsec;   // Time when r4aServicesBegin was called
+static int r4aServicesEntries;
+static const R4A_SERVICE * r4aServicesTable;
+static R4A_SERVICE_TIMES r4aServicesTimes[R4A_SERVICE_MAX];
+
+//*********************************************************************
+// Initialize the service table
+bool r4aServicesBegin(const R4A_SERVICE * services, int entries)
+{
+    // Validate the table size
+    if (entries > R4A_SERVICE_MAX)
+    {
+        r4aLogError(R4A_MODULE_SERVICE, "Too many services, maximum is %d!",
+                    R4A_SERVICE_MAX);
+        return false;
+    }
+
+    // Start the boot timeline
+    r4aServicesBeginMsec = millis();
+    memset(r4aServicesTimes, 0, sizeof(r4aServicesTimes));
+    r4aServicesRunning = 0;
+    r4aServicesTable = services;
+    r4aServicesEntries = entries;
+
+    // Start the services without dependencies
+    r4aServicesUpdate();
+    return true;
+}
+
+//*********************************************************************
+// Display the boot timeline
+void r4aServicesDisplay(Print * display)
+{
+    const R4A_SERVICE * service;
+    R4A_SERVICE_TIMES * times;
+
+    display->printf("Boot timeline, services began at %ld mSec\r\n",
+                    r4aServicesBeginMsec);
+    display->println("    Service              Start mSec   Ready mSec   Delta mSec");
+    for (int index = 0; index < r4aServicesEntries; index++)
+    {
+        service = &r4aServicesTable[index];
+        times = &r4aServicesTimes[index];
+        if (r4aServiceIsRunning(index))
+            display->printf("    %-20s %10ld   %10ld   %10ld\r\n",
+                            service->name,
+                            times->startMsec,
+                            times->readyMsec,
+                            times->readyMsec - times->startMsec);
+        else if (times->startMsec)
+            display->printf("    %-20s %10ld     Starting\r\n",
+                            service->name,
+                            times->startMsec);
+        else
+            display->printf("    %-20s    Waiting%s\r\n",
+                            service->name,
+                            ((service->dependencies & R4A_SERVICE_LINK)
+                                && (!r4aLinkIsUp())) ? " for link" : "");
+    }
+}
+
+//*********************************************************************
+// Display the boot timeline
+void r4aServicesMenuDisplay(const R4A_MENU_ENTRY * menuEntry,
+                            const char * command,
+                            Print * display)
+{
+    r4aServicesDisplay(display);
+}
+
+//*********************************************************************
+// Start the services and update the running services
+void r4aServicesUpdate()
+{
+    uint32_t available;
+    uint32_t bit;
+    uint32_t currentMsec;
+    uint32_t running;
+    const R4A_SERVICE * service;
+    R4A_SERVICE_TIMES * times;
+
+    // Determine which dependencies are available
+    running = r4aServicesRunning;
+    available = running;
+    if (r4aLinkIsUp())
+        available |= R4A_SERVICE_LINK;
+
+    // Walk the list of services
+    for (int index = 0; index < r4aServicesEntries; index++)
+    {
+        service = &r4aServicesTable[index];
+        bit = 1 << index;
+
+        // Update the running services
+        if (running & bit)
+        {
+            if (service->update)
+                service->update(service->parameter);
+            continue;
+        }
+
+        // Wait for the dependencies
+        if ((service->dependencies & available) != service->dependencies)
+            continue;
+
+        // Start the service
+        times = &r4aServicesTimes[index];
+        currentMsec = millis();
+        if (!times->startMsec)
+            times->startMsec = currentMsec;
+        if (service->start && (!service->start(service->parameter)))
+            continue;
+
+        // The service is running
+        times->readyMsec = millis();
+        running |= bit;
+        available |= bit;
+        r4aServicesRunning = running;
+        r4aLogInfo(R4A_MODULE_SERVICE, "%s running at %ld mSec",
+                   service->name, times->readyMsec);
+    }
+}
@@ -14,20 +14,25 @@ R4A_TELNET_CLIENT::R4A_TELNET_CLIENT(NetworkClient client,
                                      R4A_TELNET_CLIENT_PROCESS_INPUT processInput,
                                      R4A_TELNET_CONTEXT_CREATE contextCreate,
                                      R4A_TELNET_CONTEXT_DELETE contextDelete)
-    : _command{String("")}, _client{client}, _contextCreate{contextCreate},
+    : _client{client, R4A_MODULE_TELNET}, _contextCreate{contextCreate},
       _contextData{nullptr}, _contextDelete{contextDelete},
       _processInput{processInput}
 {
-    // Save the user parameter
-    if (_contextCreate)
-        _contextCreate(&_client, &_contextData);
+    // Save the user parameter, break the connection when the context is
+    // not available, processInput then returns false to free the client
+    if (_contextCreate && !_contextCreate(&_client, &_contextData))
+    {
+        r4aLogError(R4A_MODULE_TELNET, "Failed to create the telnet client context!");
+        _contextData = nullptr;
+        _client.stop();
+    }
 }
 
 //*********************************************************************
 // Destructor: Cleanup the things allocated in the constructor
 R4A_TELNET_CLIENT::~R4A_TELNET_CLIENT()
 {
-    if (_contextDelete)
+    if (_contextDelete && _contextData)
         _contextDelete(_contextData);
 }
 
@@ -70,6 +75,13 @@ bool R4A_TELNET_CLIENT::processInput()
                 }
             }
         }
+
+        // Allow the long running commands to make progress
+        else if (_processInput && _processInput(&_client, _contextData))
+        {
+            disconnect();
+            connected = false;
+        }
     }
 
     // The client is no longer connected, disconnect on the server side
@@ -27,11 +27,42 @@ R4A_TELNET_CONTEXT::R4A_TELNET_CONTEXT(const R4A_MENU_TABLE * menuTable,
                                        bool blankLineAfterMenuHeader,
                                        bool alignCommands,
                                        bool blankLineAfterMenu)
-    : _command{String("")}, _displayOptions{displayOptions}, _echo{echo},
-      _menu{R4A_MENU(menuTable, menuTableEntries, blankLineBeforePreMenu,
-            blankLineBeforeMenuHeader, blankLineAfterMenuHeader,
-            alignCommands, blankLineAfterMenu)}
+    : _command{0}, _displayOptions{displayOptions}, _echo{echo},
+      _cursor{}
 {
+    // Allocate a menu for this session
+    _menuAllocated = r4aNew<R4A_MENU_COMPILED>(R4A_MODULE_TELNET,
+                                               menuTable,
+                                               menuTableEntries,
+                                               blankLineBeforePreMenu,
+                                               blankLineBeforeMenuHeader,
+                                               blankLineAfterMenuHeader,
+                                               alignCommands,
+                                               blankLineAfterMenu);
+    _menu = _menuAllocated;
+}
+
+//*********************************************************************
+// Constructor
+// Inputs:
+//   menu: Address of the menu shared by the telnet sessions
+//   displayOptions: Display the telnet options received from the client
+//   echo: Echo the input characters
+R4A_TELNET_CONTEXT::R4A_TELNET_CONTEXT(const R4A_MENU_COMPILED * menu,
+                                       bool displayOptions,
+                                       bool echo)
+    : _command{0}, _displayOptions{displayOptions}, _echo{echo},
+      _cursor{}, _menu{menu}, _menuAllocated{nullptr}
+{
+}
+
+//*********************************************************************
+// Destructor
+R4A_TELNET_CONTEXT::~R4A_TELNET_CONTEXT()
+{
+    if (_menu)
+        _menu->cancel(&_cursor);
+    r4aDelete(_menuAllocated);
 }
 
 //*********************************************************************
@@ -54,12 +85,47 @@ bool r4aTelnetContextCreate(NetworkClient * client,
 
     // Return an optional object address to be used as a parameter for
     // r4aTelnetClientProcessInput
-    context = new R4A_TELNET_CONTEXT(menuTable, menuTableEntries);
+    context = r4aNew<R4A_TELNET_CONTEXT>(R4A_MODULE_TELNET,
+                                          menuTable,
+                                          menuTableEntries);
+    if (context && (!context->_menu))
+    {
+        r4aDelete(context);
+        context = nullptr;
+    }
+    *contextData = (void *)context;
+    if (context)
+    {
+        // Display the menu
+        context->_menu->process(&context->_cursor, nullptr, client);
+    }
+
+    return (context != nullptr);
+}
+
+//*********************************************************************
+// Finish creating the network client, the sessions share the menu
+// Inputs:
+//   client: Address of a NetworkClient object
+//   menu: Address of the menu shared by the telnet sessions
+//   contextData: Buffer to receive the address of an object allocated by
+//                this routine
+// Outputs:
+//   Returns true if the routine was successful and false upon failure.
+bool r4aTelnetContextCreate(NetworkClient * client,
+                            const R4A_MENU_COMPILED * menu,
+                            void ** contextData)
+{
+    R4A_TELNET_CONTEXT * context;
+
+    // Return an optional object address to be used as a parameter for
+    // r4aTelnetClientProcessInput
+    context = r4aNew<R4A_TELNET_CONTEXT>(R4A_MODULE_TELNET, menu);
     *contextData = (void *)context;
-    if (contextData)
+    if (context)
     {
         // Display the menu
-        context->_menu.process(nullptr, client);
+        context->_menu->process(&context->_cursor, nullptr, client);
     }
 
     return (context != nullptr);
@@ -71,7 +137,7 @@ bool r4aTelnetContextCreate(NetworkClient * client,
 //   contextData: Address of object allocated by r4aTelnetClientBegin
 void r4aTelnetContextDelete(void * contextData)
 {
-    delete (R4A_TELNET_CONTEXT *)contextData;
+    r4aDelete((R4A_TELNET_CONTEXT *)contextData);
 }
 
 //*********************************************************************
@@ -86,7 +152,6 @@ bool r4aTelnetContextProcessInput(NetworkClient * client, void * contextData)
     bool clientDone;
     const char * command;
     R4A_TELNET_CONTEXT * context;
-    String * line;
     uint8_t option;
     uint8_t parameter;
 
@@ -120,21 +185,26 @@ bool r4aTelnetContextProcessInput(NetworkClient * client, void * contextData)
         }
     }
 
+    // Run any long command
+    context->_menu->update(&context->_cursor, client);
+
     // Get a command from this client
-    line = r4aReadLine(context->_echo, &context->_command, client);
+    command = r4aReadLine(context->_echo,
+                          context->_command,
+                          sizeof(context->_command),
+                          client);
 
     // If a command is available, process it
-    if (line)
+    if (command)
     {
         // Process the command
-        command = line->c_str();
-        clientDone = context->_menu.process(command, client);
+        clientDone = context->_menu->process(&context->_cursor, command, client);
         if (!clientDone)
             // Display the menu
-            context->_menu.process(nullptr, client);
+            context->_menu->process(&context->_cursor, nullptr, client);
 
         // Start building the next command
-        context->_command = "";
+        context->_command[0] = 0;
     }
 
     // Notify the upper layers when the client wants to exit
@@ -16,14 +16,26 @@ R4A_TELNET_SERVER::R4A_TELNET_SERVER(uint16_t maxClients,
                                      R4A_TELNET_CONTEXT_DELETE contextDelete)
     : _activeClients{0}, _clients{nullptr}, _contextCreate{contextCreate},
       _contextDelete{contextDelete}, _ipAddress{IPAddress((uint32_t)0)},
-      _maxClients{maxClients}, _port{0}, _processInput{processInput},
-      _server{nullptr}
+      _linkGeneration{0}, _maxClients{maxClients}, _metricLabels{""},
+      _metricClients{"r4a_telnet_clients",
+                     "Active telnet clients",
+                     R4A_METRIC_GAUGE,
+                     _metricLabels},
+      _metricConnections{"r4a_telnet_connections_total",
+                         "Telnet client connections accepted",
+                         R4A_METRIC_COUNTER,
+                         _metricLabels},
+      _metricRejects{"r4a_telnet_rejects_total",
+                     "Telnet client connections rejected",
+                     R4A_METRIC_COUNTER,
+                     _metricLabels},
+      _port{0}, _processInput{processInput}, _server{nullptr}
 {
     size_t length;
 
     // Allocate the client list
     length = _maxClients * sizeof(R4A_TELNET_CLIENT *);
-    _clients = (R4A_TELNET_CLIENT **)malloc(length);
+    _clients = (R4A_TELNET_CLIENT **)r4aMalloc(R4A_MODULE_TELNET, length);
     if (_clients)
         memset(_clients, 0, length);
 }
@@ -38,7 +50,7 @@ R4A_TELNET_SERVER::~R4A_TELNET_SERVER()
     // Done with the client list
     if (_clients)
     {
-        free(_clients);
+        r4aFree(_clients);
         _clients = nullptr;
     }
 }
@@ -52,12 +64,13 @@ bool R4A_TELNET_SERVER::begin(IPAddress ipAddress, uint16_t port)
     // Determine if the server was already initialized
     if (_server == nullptr)
     {
-        // Save the port for display
+        // Save the port for display and to label the metrics
         _ipAddress = ipAddress;
         _port = port;
+        snprintf(_metricLabels, sizeof(_metricLabels), "port=\"%d\"", _port);
 
         // Allocate the network object
-        _server = new NetworkServer(_port);
+        _server = r4aNew<NetworkServer>(R4A_MODULE_TELNET, _port);
         if (_server)
         {
             // Initialize the network server object
@@ -77,7 +90,8 @@ void R4A_TELNET_SERVER::closeClient(uint16_t i)
     if (_clients && _clients[i])
     {
         _activeClients -= 1;
-        delete _clients[i];
+        _metricClients.subtract();
+        r4aDelete(_clients[i]);
         _clients[i] = nullptr;
     }
 }
@@ -100,7 +114,7 @@ void R4A_TELNET_SERVER::end()
     // Done with the server
     if (_server)
     {
-        delete _server;
+        r4aDelete(_server);
         _server = nullptr;
         _ipAddress = IPAddress{(uint32_t)0};
         _port = 0;
@@ -152,21 +166,32 @@ void R4A_TELNET_SERVER::newClient()
         if (!_clients[i])
         {
             // Fill the slot with the telnet client
-            _clients[i] = new R4A_TELNET_CLIENT(client,
-                                                _processInput,
-                                                _contextCreate,
-                                                _contextDelete);
+            _clients[i] = r4aNew<R4A_TELNET_CLIENT>(R4A_MODULE_TELNET,
+                                                    client,
+                                                    _processInput,
+                                                    _contextCreate,
+                                                    _contextDelete);
             if (_clients[i])
+            {
                 _activeClients += 1;
+                _metricClients.add();
+                _metricConnections.add();
+            }
             else
+            {
+                _metricRejects.add();
                 client.stop();
+            }
             break;
         }
     }
 
     // If no free slots then reject incoming server connection request
     if (i >= _maxClients)
+    {
+        _metricRejects.add();
         client.stop();
+    }
 }
 
 //*********************************************************************
@@ -230,3 +255,10 @@ void R4A_TELNET_SERVER::update(bool connected)
         }
     }
 }
+
+//*********************************************************************
+// Update the server state using the link state
+void R4A_TELNET_SERVER::update()
+{
+    update(r4aLinkIsUp(&_linkGeneration));
+}
@@ -0,0 +1,376 @@
+/**********************************************************************
+  WiFi_Connect.cpp
+
+  Robots-For-All (R4A)
+  Fast WiFi connection support
+
+  The BSSID, channel and DHCP lease of the last good connection are
+  saved in RTC memory which survives software resets and brownouts.
+  The next connection attempt goes directly to the saved access point
+  without a scan and without waiting for DHCP.  A scan is only done
+  when the direct connection fails.
+
+                            R4A_WIFI_STATE_OFF
+                                    |
+                                    | r4aWiFiBegin
+                                    v
+                .-------> R4A_WIFI_STATE_START -----------.
+                |                   |                     | No cache
+                |                   | Cache valid         |
+                |                   v                     v
+                |   R4A_WIFI_STATE_CACHED_CONNECTING -->  R4A_WIFI_STATE_SCAN_START <--.
+                |                   |           Timeout   |                            |
+                |                   |                     v                            |
+                |                   |         R4A_WIFI_STATE_SCANNING ---------------->+
+                |                   |                     |        No AP found         ^
+                |                   |                     v                            |
+                |                   |         R4A_WIFI_STATE_CONNECTING -------------->'
+                |                   |                     |        Timeout
+                |                   v                     |
+                '------- R4A_WIFI_STATE_CONNECTED <-------'
+                  Link lost
+**********************************************************************/
+
+#include "R4A_Robot.h"
+
+//****************************************
+// Constants
+//****************************************
+
+#define R4A_WIFI_CACHE_MAGIC        0x52344157  // "R4AW"
+
+enum R4A_WIFI_STATE
+{
+    R4A_WIFI_STATE_OFF = 0,
+    R4A_WIFI_STATE_START,
+    R4A_WIFI_STATE_CACHED_CONNECTING,
+    R4A_WIFI_STATE_SCAN_START,
+    R4A_WIFI_STATE_SCANNING,
+    R4A_WIFI_STATE_CONNECTING,
+    R4A_WIFI_STATE_CONNECTED,
+    // Add new states above this line
+    R4A_WIFI_STATE_MAX
+};
+
+const char * const r4aWiFiStateName[] =
+{
+    "Off",
+    "Start",
+    "Cached connecting",
+    "Scan start",
+    "Scanning",
+    "Connecting",
+    "Connected",
+};
+const int r4aWiFiStateNameEntries = sizeof(r4aWiFiStateName) / sizeof(r4aWiFiStateName[0]);
+
+//****************************************
+// Types
+//****************************************
+
+// Last good connection, saved in RTC memory
+typedef struct _R4A_WIFI_CACHE
+{
+    uint32_t magic;         // R4A_WIFI_CACHE_MAGIC when valid
+    uint8_t apIndex;        // Index into the access point list
+    uint8_t channel;        // WiFi channel number
+    uint8_t bssid[6];       // MAC address of the access point
+    uint32_t ipAddress;     // DHCP lease values
+    uint32_t gateway;
+    uint32_t subnetMask;
+    uint32_t dns;
+    uint32_t checksum;      // Checksum of the values above
+} R4A_WIFI_CACHE;
+
+//****************************************
+// Globals
+//****************************************
+
+bool r4aWiFiConnectCached;
+uint32_t r4aWiFiConnectMsec;
+bool r4aWiFiDebugStates;
+bool r4aWiFiUseCachedLease;
+
+//****************************************
+// Locals
+//****************************************
+
+static RTC_NOINIT_ATTR R4A_WIFI_CACHE r4aWiFiCache;
+
+static uint8_t r4aWiFiApCount;
+static uint8_t r4aWiFiApIndex;
+static const char * r4aWiFiPassword[R4A_WIFI_MAX_APS];
+static uint32_t r4aWiFiReconnects;
+static const char * r4aWiFiSsid[R4A_WIFI_MAX_APS];
+static uint32_t r4aWiFiStartMsec;
+static uint8_t r4aWiFiState;
+static uint32_t r4aWiFiTimer;
+
+//****************************************
+// Metrics
+//****************************************
+
+static R4A_METRIC r4aWiFiMetricConnectMsec("r4a_wifi_connect_msec",
+                                           "Milliseconds for the last WiFi connection",
+                                           R4A_METRIC_GAUGE);
+static R4A_METRIC r4aWiFiMetricConnections("r4a_wifi_connections_total",
+                                           "WiFi connections",
+                                           R4A_METRIC_COUNTER);
+static R4A_METRIC r4aWiFiMetricScans("r4a_wifi_scans_total",
+                                     "WiFi scans",
+                                     R4A_METRIC_COUNTER);
+
+//*********************************************************************
+// Compute the checksum of the cache
+// Outputs:
+//   Returns the checksum value
+static uint32_t r4aWiFiCacheChecksum()
+{
+    uint32_t checksum;
+    const uint8_t * data;
+
+    checksum = R4A_WIFI_CACHE_MAGIC;
+    data = (const uint8_t *)&r4aWiFiCache;
+    for (size_t index = 0; index < offsetof(R4A_WIFI_CACHE, checksum); index++)
+        checksum = (checksum << 5) + (checksum >> 27) + data[index];
+    return checksum;
+}
+
+//*********************************************************************
+// Determine if the cache contains a good connection
+// Outputs:
+//   Returns true when the cache is valid and false otherwise
+static bool r4aWiFiCacheValid()
+{
+    return (r4aWiFiCache.magic == R4A_WIFI_CACHE_MAGIC)
+        && (r4aWiFiCache.checksum == r4aWiFiCacheChecksum())
+        && (r4aWiFiCache.apIndex < r4aWiFiApCount);
+}
+
+//*********************************************************************
+// Set the WiFi connection state
+// Inputs:
+//   newState: The next WiFi connection state
+static void r4aWiFiSetState(uint8_t newState)
+{
+    if (r4aWiFiDebugStates)
+        r4aLogInfo(R4A_MODULE_WIFI, "WiFi: %s --> %s",
+                   (r4aWiFiState < R4A_WIFI_STATE_MAX) ? r4aWiFiStateName[r4aWiFiState] : "Unknown",
+                   (newState < R4A_WIFI_STATE_MAX) ? r4aWiFiStateName[newState] : "Unknown");
+    r4aWiFiState = newState;
+}
+
+//*********************************************************************
+// Account for the connection and save it in the cache
+// Inputs:
+//   currentMsec: Number of milliseconds since boot
+//   cached: True when the connection was made using the cache
+static void r4aWiFiConnected(uint32_t currentMsec, bool cached)
+{
+    // Account for the connection
+    r4aWiFiConnectMsec = currentMsec - r4aWiFiStartMsec;
+    r4aWiFiConnectCached = cached;
+    r4aWiFiMetricConnectMsec.set(r4aWiFiConnectMsec);
+    r4aWiFiMetricConnections.add();
+    r4aLogInfo(R4A_MODULE_WIFI, "WiFi connected to %s in %ld mSec (%s)",
+               r4aWiFiSsid[r4aWiFiApIndex],
+               r4aWiFiConnectMsec,
+               cached ? "cached" : "scan");
+
+    // Save the connection
+    r4aWiFiCache.magic = R4A_WIFI_CACHE_MAGIC;
+    r4aWiFiCache.apIndex = r4aWiFiApIndex;
+    r4aWiFiCache.channel = WiFi.channel();
+    memcpy(r4aWiFiCache.bssid, WiFi.BSSID(), sizeof(r4aWiFiCache.bssid));
+    r4aWiFiCache.ipAddress = WiFi.localIP();
+    r4aWiFiCache.gateway = WiFi.gatewayIP();
+    r4aWiFiCache.subnetMask = WiFi.subnetMask();
+    r4aWiFiCache.dns = WiFi.dnsIP();
+    r4aWiFiCache.checksum = r4aWiFiCacheChecksum();
+    r4aWiFiSetState(R4A_WIFI_STATE_CONNECTED);
+}
+
+//*********************************************************************
+// Add an access point to the list of access points
+bool r4aWiFiAddAP(const char * ssid, const char * password)
+{
+    if (r4aWiFiApCount >= R4A_WIFI_MAX_APS)
+        return false;
+    r4aWiFiSsid[r4aWiFiApCount] = ssid;
+    r4aWiFiPassword[r4aWiFiApCount] = password;
+    r4aWiFiApCount += 1;
+    return true;
+}
+
+//*********************************************************************
+// Start connecting to an access point
+void r4aWiFiBegin()
+{
+    // The state machine handles the reconnection
+    WiFi.persistent(false);
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false);
+
+    // Start the connection
+    r4aWiFiStartMsec = millis();
+    r4aWiFiSetState(R4A_WIFI_STATE_START);
+}
+
+//*********************************************************************
+// Display the WiFi connection status
+void r4aWiFiDisplayStatus(Print * display)
+{
+    display->printf("WiFi: %s\r\n",
+                    (r4aWiFiState < R4A_WIFI_STATE_MAX) ? r4aWiFiStateName[r4aWiFiState] : "Unknown");
+    if (r4aWiFiState == R4A_WIFI_STATE_CONNECTED)
+        display->printf("    %s, %s, channel %ld\r\n",
+                        r4aWiFiSsid[r4aWiFiApIndex],
+                        WiFi.localIP().toString().c_str(),
+                        WiFi.channel());
+    display->printf("    Last connection: %ld mSec (%s)\r\n",
+                    r4aWiFiConnectMsec,
+                    r4aWiFiConnectCached ? "cached" : "scan");
+    display->printf("    Reconnects: %ld\r\n", r4aWiFiReconnects);
+    display->printf("    Cache: %s\r\n", r4aWiFiCacheValid() ? "Valid" : "Invalid");
+}
+
+//*********************************************************************
+// Update the WiFi connection
+void r4aWiFiUpdate()
+{
+    int32_t bestRssi;
+    int bestScan;
+    uint32_t currentMsec;
+    int index;
+    int16_t scanCount;
+    wl_status_t status;
+
+    currentMsec = millis();
+    status = WiFi.status();
+    switch (r4aWiFiState)
+    {
+    default:
+        r4aLogError(R4A_MODULE_WIFI, "Unknown WiFi state %d", r4aWiFiState);
+        r4aWiFiSetState(R4A_WIFI_STATE_START);
+        break;
+
+    case R4A_WIFI_STATE_OFF:
+        break;
+
+    case R4A_WIFI_STATE_START:
+        // Connect directly to the last access point if possible
+        if (!r4aWiFiCacheValid())
+            r4aWiFiSetState(R4A_WIFI_STATE_SCAN_START);
+        else
+        {
+            // Skip DHCP by reusing the previous lease
+            if (r4aWiFiUseCachedLease && r4aWiFiCache.ipAddress)
+                WiFi.config(IPAddress(r4aWiFiCache.ipAddress),
+                            IPAddress(r4aWiFiCache.gateway),
+                            IPAddress(r4aWiFiCache.subnetMask),
+                            IPAddress(r4aWiFiCache.dns));
+
+            // Skip the scan by using the BSSID and channel
+            r4aWiFiApIndex = r4aWiFiCache.apIndex;
+            WiFi.begin(r4aWiFiSsid[r4aWiFiApIndex],
+                       r4aWiFiPassword[r4aWiFiApIndex],
+                       r4aWiFiCache.channel,
+                       r4aWiFiCache.bssid);
+            r4aWiFiTimer = currentMsec;
+            r4aWiFiSetState(R4A_WIFI_STATE_CACHED_CONNECTING);
+        }
+        break;
+
+    case R4A_WIFI_STATE_CACHED_CONNECTING:
+        if (status == WL_CONNECTED)
+            r4aWiFiConnected(currentMsec, true);
+        else if ((currentMsec - r4aWiFiTimer) >= R4A_WIFI_CACHED_TIMEOUT_MSEC)
+        {
+            // The access point or lease is no longer valid
+            r4aWiFiCache.magic = 0;
+            WiFi.disconnect();
+            r4aWiFiSetState(R4A_WIFI_STATE_SCAN_START);
+        }
+        break;
+
+    case R4A_WIFI_STATE_SCAN_START:
+        // Use DHCP for connections following a scan
+        WiFi.config(IPAddress((uint32_t)0),
+                    IPAddress((uint32_t)0),
+                    IPAddress((uint32_t)0));
+
+        // Start an asynchronous scan
+        if (WiFi.scanNetworks(true) != WIFI_SCAN_FAILED)
+        {
+            r4aWiFiMetricScans.add();
+            r4aWiFiSetState(R4A_WIFI_STATE_SCANNING);
+        }
+        break;
+
+    case R4A_WIFI_STATE_SCANNING:
+        // Wait for the scan to complete
+        scanCount = WiFi.scanComplete();
+        if (scanCount == WIFI_SCAN_RUNNING)
+            break;
+        if (scanCount < 0)
+        {
+            r4aWiFiSetState(R4A_WIFI_STATE_SCAN_START);
+            break;
+        }
+
+        // Locate the access point with the strongest signal
+        bestRssi = -1000;
+        bestScan = -1;
+        for (int scan = 0; scan < scanCount; scan++)
+        {
+            for (index = 0; index < r4aWiFiApCount; index++)
+            {
+                if ((WiFi.RSSI(scan) > bestRssi)
+                    && (strcmp(WiFi.SSID(scan).c_str(), r4aWiFiSsid[index]) == 0))
+                {
+                    bestRssi = WiFi.RSSI(scan);
+                    bestScan = scan;
+                    r4aWiFiApIndex = index;
+                }
+            }
+        }
+
+        // Scan again if no access point was found
+        if (bestScan < 0)
+        {
+            WiFi.scanDelete();
+            r4aWiFiSetState(R4A_WIFI_STATE_SCAN_START);
+            break;
+        }
+
+        // Connect to the access point
+        WiFi.begin(r4aWiFiSsid[r4aWiFiApIndex],
+                   r4aWiFiPassword[r4aWiFiApIndex],
+                   WiFi.channel(bestScan),
+                   WiFi.BSSID(bestScan));
+        WiFi.scanDelete();
+        r4aWiFiTimer = currentMsec;
+        r4aWiFiSetState(R4A_WIFI_STATE_CONNECTING);
+        break;
+
+    case R4A_WIFI_STATE_CONNECTING:
+        if (status == WL_CONNECTED)
+            r4aWiFiConnected(currentMsec, false);
+        else if ((currentMsec - r4aWiFiTimer) >= R4A_WIFI_CONNECT_TIMEOUT_MSEC)
+        {
+            WiFi.disconnect();
+            r4aWiFiSetState(R4A_WIFI_STATE_SCAN_START);
+        }
+        break;
+
+    case R4A_WIFI_STATE_CONNECTED:
+        // Reconnect when the connection breaks
+        if (status != WL_CONNECTED)
+        {
+            r4aWiFiReconnects += 1;
+            r4aWiFiStartMsec = currentMsec;
+            r4aWiFiSetState(R4A_WIFI_STATE_START);
+        }
+        break;
+    }
+}